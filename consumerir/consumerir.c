@@ -17,6 +17,7 @@
 #define LOG_TAG "ConsumerIrHal"
 
 #include <cutils/log.h>
+#include <cutils/properties.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <hardware/hardware.h>
@@ -24,6 +25,7 @@
 #include <malloc.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
@@ -33,91 +35,320 @@
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof(a[0]))
 #define UNUSED __attribute__((unused))
 
+/* Override IR_PATH, e.g. with a FIFO for testing */
+#define IR_PATH_PROP "ro.consumerir.path"
+/* "1" makes transmit() queue the pattern and return before it is sent */
+#define IR_ASYNC_PROP "ro.consumerir.async"
+
+/* Encoded patterns kept for repeated sends */
+#define IR_CACHE_SIZE 8
+/* Patterns waiting to be written in async mode */
+#define IR_QUEUE_SIZE 16
+/* "-2147483648," */
+#define IR_MAX_NUMBER_LEN 12
+
+struct ir_encoded {
+    uint32_t hash;
+    int carrier_freq;
+    int pattern_len;
+    int *pattern;
+    char *data;
+    int len;
+    unsigned int last_used;
+};
+
+struct ir_request {
+    char *data;
+    int len;
+};
+
 static int fd = 0;
+static char g_path[PROPERTY_VALUE_MAX];
 static pthread_mutex_t g_mtx;
 
-static bool try_append_number(char *buffer, int *len, int size, int number)
-{
-    int stored;
+/* scratch buffer for encoding, grown to the longest pattern seen */
+static char *g_buffer;
+static int g_buffer_size;
 
-    stored = snprintf(&buffer[*len], size - *len, "%d,", number);
+/*
+ * What a sync transmit() writes once g_mtx is dropped, grown like g_buffer.
+ * g_send_mtx is held from the copy until the write returns, take it before
+ * g_mtx.
+ */
+static pthread_mutex_t g_send_mtx;
+static char *g_send_buffer;
+static int g_send_buffer_size;
+
+static struct ir_encoded g_cache[IR_CACHE_SIZE];
+static unsigned int g_cache_clock;
+
+static bool g_async;
+static bool g_worker_exit;
+static pthread_t g_worker;
+static pthread_cond_t g_queue_cond;
+static struct ir_request g_queue[IR_QUEUE_SIZE];
+static int g_queue_head;
+static int g_queue_count;
+
+static uint32_t pattern_hash(int carrier_freq, const int pattern[], int pattern_len)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    int i;
 
-    if (stored < 0 || stored >= (size - *len))
-        return false;
+    hash = (hash ^ (uint32_t) carrier_freq) * 16777619u;
+    for (i = 0; i < pattern_len; i++)
+        hash = (hash ^ (uint32_t) pattern[i]) * 16777619u;
 
-    *len += stored;
-    return true;
+    return hash;
 }
 
-static bool grow_buffer(char **buffer, int *size)
+/* Write number and a trailing ',' to buffer, returns the characters written */
+static int append_number(char *buffer, int number)
 {
-    char *new_buffer;
+    char digits[IR_MAX_NUMBER_LEN];
+    unsigned int value;
+    int len = 0;
+    int n = 0;
+
+    if (number < 0) {
+        buffer[len++] = '-';
+        value = 0u - (unsigned int) number;
+    } else {
+        value = (unsigned int) number;
+    }
 
-    *size *= 2;
-    new_buffer = realloc(*buffer, *size);
-    if (new_buffer == NULL)
-        return false;
+    do {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while (value != 0);
 
-    *buffer = new_buffer;
-    return true;
+    while (n > 0)
+        buffer[len++] = digits[--n];
+    buffer[len++] = ',';
+
+    return len;
 }
 
-static bool append_number(char **buffer, int *len, int *size, int number)
+/* Make *buffer hold at least size bytes, it never shrinks */
+static int grow_buffer(char **buffer, int *buffer_size, int size)
 {
-    if (try_append_number(*buffer, len, *size, number))
-        return true;
+    char *new_buffer;
 
-    if (!grow_buffer(buffer, size))
-        return false;
+    if (size > *buffer_size) {
+        new_buffer = realloc(*buffer, size);
+        if (new_buffer == NULL)
+            return -ENOMEM;
+        *buffer = new_buffer;
+        *buffer_size = size;
+    }
 
-    return try_append_number(*buffer, len, *size, number);
+    return 0;
 }
 
-static int consumerir_transmit(UNUSED struct consumerir_device *dev,
-   int carrier_freq, const int pattern[], int pattern_len)
+/* Encode into g_buffer, returns the length without the terminating NUL */
+static int encode_pattern(int carrier_freq, const int pattern[], int pattern_len)
 {
-    int buffer_len = 0;
-    int buffer_size = 128;
+    int size = (pattern_len + 1) * IR_MAX_NUMBER_LEN + 1;
+    int len = 0;
     int i;
-    float factor;
-    char *buffer;
 
-    pthread_mutex_lock(&g_mtx);
-
-    buffer = malloc(buffer_size);
-    if (buffer == NULL)
+    if (grow_buffer(&g_buffer, &g_buffer_size, size) < 0)
         return -ENOMEM;
 
     // Write the header
-    if (!append_number(&buffer, &buffer_len, &buffer_size, carrier_freq))
-        goto error;
+    len += append_number(&g_buffer[len], carrier_freq);
 
+    // Write out the timing pattern
+    for (i = 0; i < pattern_len; i++) {
 #ifndef MS_IR_SIGNAL
-    // Calculate factor of conversion from microseconds to pulses
-    factor = 1000000 / carrier_freq;
+        // Convert microseconds to carrier pulses, rounded to nearest
+        len += append_number(&g_buffer[len],
+                (int) (((int64_t) pattern[i] * carrier_freq + 500000) / 1000000));
 #else
-    factor = 1;
+        len += append_number(&g_buffer[len], pattern[i]);
 #endif
+    }
 
-    // Write out the timing pattern
-    for (i = 0; i < pattern_len; i++) {
-        if (!append_number(&buffer, &buffer_len, &buffer_size,
-                (int) (pattern[i] / factor)))
-            goto error;
+    // Drop the trailing ','
+    g_buffer[--len] = 0;
+
+    return len;
+}
+
+/* You need to hold g_mtx before calling this function */
+static struct ir_encoded *cache_lookup(uint32_t hash, int carrier_freq,
+        const int pattern[], int pattern_len)
+{
+    struct ir_encoded *entry;
+    int i;
+
+    for (i = 0; i < IR_CACHE_SIZE; i++) {
+        entry = &g_cache[i];
+        if (entry->data != NULL &&
+                entry->hash == hash &&
+                entry->carrier_freq == carrier_freq &&
+                entry->pattern_len == pattern_len &&
+                memcmp(entry->pattern, pattern, pattern_len * sizeof(int)) == 0) {
+            entry->last_used = ++g_cache_clock;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* Store g_buffer in the least recently used slot, you need to hold g_mtx */
+static void cache_insert(uint32_t hash, int carrier_freq,
+        const int pattern[], int pattern_len, int len)
+{
+    struct ir_encoded *entry = &g_cache[0];
+    int i;
+
+    for (i = 1; i < IR_CACHE_SIZE; i++) {
+        if (g_cache[i].last_used < entry->last_used)
+            entry = &g_cache[i];
     }
 
-    buffer[buffer_len - 1] = 0;
-    write(fd, buffer, buffer_len - 1);
+    free(entry->pattern);
+    free(entry->data);
+    memset(entry, 0, sizeof(*entry));
+
+    entry->pattern = malloc(pattern_len * sizeof(int) + 1);
+    entry->data = malloc(len + 1);
+    if (entry->pattern == NULL || entry->data == NULL) {
+        free(entry->pattern);
+        free(entry->data);
+        memset(entry, 0, sizeof(*entry));
+        return;
+    }
 
-    free(buffer);
+    memcpy(entry->pattern, pattern, pattern_len * sizeof(int));
+    memcpy(entry->data, g_buffer, len + 1);
+    entry->hash = hash;
+    entry->carrier_freq = carrier_freq;
+    entry->pattern_len = pattern_len;
+    entry->len = len;
+    entry->last_used = ++g_cache_clock;
+}
 
+static int ir_write(const char *data, int len)
+{
+    ssize_t ret;
+    int err;
+
+    ret = write(fd, data, len);
+    if (ret < 0) {
+        err = errno;
+        ALOGE("%s: Error writing to %s: %s", __func__, g_path, strerror(err));
+        return -err;
+    }
+
+    return 0;
+}
+
+static void *consumerir_worker(UNUSED void *arg)
+{
+    struct ir_request request;
+
+    pthread_mutex_lock(&g_mtx);
+    for (;;) {
+        while (g_queue_count == 0 && !g_worker_exit)
+            pthread_cond_wait(&g_queue_cond, &g_mtx);
+        if (g_queue_count == 0)
+            break;
+
+        request = g_queue[g_queue_head];
+        g_queue_head = (g_queue_head + 1) % IR_QUEUE_SIZE;
+        g_queue_count--;
+        pthread_cond_broadcast(&g_queue_cond);
+
+        pthread_mutex_unlock(&g_mtx);
+        ir_write(request.data, request.len);
+        free(request.data);
+        pthread_mutex_lock(&g_mtx);
+    }
     pthread_mutex_unlock(&g_mtx);
 
+    return NULL;
+}
+
+/* You need to hold g_mtx before calling this function */
+static int queue_request(const char *data, int len)
+{
+    struct ir_request *request;
+
+    while (g_queue_count == IR_QUEUE_SIZE && !g_worker_exit)
+        pthread_cond_wait(&g_queue_cond, &g_mtx);
+    if (g_worker_exit)
+        return -EPIPE;
+
+    request = &g_queue[(g_queue_head + g_queue_count) % IR_QUEUE_SIZE];
+    request->data = malloc(len);
+    if (request->data == NULL)
+        return -ENOMEM;
+    memcpy(request->data, data, len);
+    request->len = len;
+    g_queue_count++;
+    pthread_cond_broadcast(&g_queue_cond);
+
     return 0;
+}
+
+static int consumerir_transmit(UNUSED struct consumerir_device *dev,
+   int carrier_freq, const int pattern[], int pattern_len)
+{
+    struct ir_encoded *entry;
+    const char *data;
+    uint32_t hash;
+    int len;
+    int ret;
+
+    if (carrier_freq <= 0 || pattern_len < 0)
+        return -EINVAL;
+
+    hash = pattern_hash(carrier_freq, pattern, pattern_len);
+
+    if (!g_async)
+        pthread_mutex_lock(&g_send_mtx);
+    pthread_mutex_lock(&g_mtx);
 
-error:
-    free(buffer);
-    return -ENOMEM;
+    entry = cache_lookup(hash, carrier_freq, pattern, pattern_len);
+    if (entry != NULL) {
+        data = entry->data;
+        len = entry->len;
+    } else {
+        len = encode_pattern(carrier_freq, pattern, pattern_len);
+        if (len < 0) {
+            pthread_mutex_unlock(&g_mtx);
+            if (!g_async)
+                pthread_mutex_unlock(&g_send_mtx);
+            return len;
+        }
+        cache_insert(hash, carrier_freq, pattern, pattern_len, len);
+        data = g_buffer;
+    }
+
+    if (g_async) {
+        ret = queue_request(data, len);
+        pthread_mutex_unlock(&g_mtx);
+        return ret;
+    }
+
+    // The write blocks while the pattern is sent, do not hold g_mtx over it
+    if (grow_buffer(&g_send_buffer, &g_send_buffer_size, len) < 0) {
+        pthread_mutex_unlock(&g_mtx);
+        pthread_mutex_unlock(&g_send_mtx);
+        return -ENOMEM;
+    }
+    memcpy(g_send_buffer, data, len);
+
+    pthread_mutex_unlock(&g_mtx);
+
+    ret = ir_write(g_send_buffer, len);
+    pthread_mutex_unlock(&g_send_mtx);
+
+    return ret;
 }
 
 static int consumerir_get_num_carrier_freqs(UNUSED struct consumerir_device *dev)
@@ -137,9 +368,34 @@ static int consumerir_get_carrier_freqs(struct consumerir_device *dev,
 
 static int consumerir_close(hw_device_t *dev)
 {
+    int i;
+
+    if (g_async) {
+        // Let the worker send whatever is still queued
+        pthread_mutex_lock(&g_mtx);
+        g_worker_exit = true;
+        pthread_cond_broadcast(&g_queue_cond);
+        pthread_mutex_unlock(&g_mtx);
+        pthread_join(g_worker, NULL);
+        pthread_cond_destroy(&g_queue_cond);
+    }
+
+    for (i = 0; i < IR_CACHE_SIZE; i++) {
+        free(g_cache[i].pattern);
+        free(g_cache[i].data);
+    }
+    memset(g_cache, 0, sizeof(g_cache));
+    free(g_buffer);
+    g_buffer = NULL;
+    g_buffer_size = 0;
+    free(g_send_buffer);
+    g_send_buffer = NULL;
+    g_send_buffer_size = 0;
+
     free(dev);
     close(fd);
     pthread_mutex_destroy(&g_mtx);
+    pthread_mutex_destroy(&g_send_mtx);
     return 0;
 }
 
@@ -149,6 +405,8 @@ static int consumerir_close(hw_device_t *dev)
 static int consumerir_open(const hw_module_t *module, const char *name,
         hw_device_t **device)
 {
+    int ret;
+
     if (strcmp(name, CONSUMERIR_TRANSMITTER) != 0)
         return -EINVAL;
 
@@ -170,10 +428,34 @@ static int consumerir_open(const hw_module_t *module, const char *name,
     dev->get_carrier_freqs     = consumerir_get_carrier_freqs;
     dev->get_num_carrier_freqs = consumerir_get_num_carrier_freqs;
 
+    property_get(IR_PATH_PROP, g_path, IR_PATH);
+
+    // Open the device before anything that close() would have to undo
+    fd = open(g_path, O_RDWR);
+    if (fd < 0) {
+        ret = -errno;
+        ALOGE("%s: Error opening %s: %s", __func__, g_path, strerror(-ret));
+        free(dev);
+        return ret;
+    }
+
     pthread_mutex_init(&g_mtx, NULL);
+    pthread_mutex_init(&g_send_mtx, NULL);
+
+    g_async = property_get_bool(IR_ASYNC_PROP, false);
+    if (g_async) {
+        g_worker_exit = false;
+        g_queue_head = 0;
+        g_queue_count = 0;
+        pthread_cond_init(&g_queue_cond, NULL);
+        if (pthread_create(&g_worker, NULL, consumerir_worker, NULL) != 0) {
+            ALOGE("%s: failed to start the transmit thread, using sync mode", __func__);
+            pthread_cond_destroy(&g_queue_cond);
+            g_async = false;
+        }
+    }
 
     *device = (hw_device_t*) dev;
-    fd = open(IR_PATH, O_RDWR);
     return fd;
 }
 
@@ -8,7 +8,8 @@ LOCAL_COPY_HEADERS := \
 	include/srp_error.h
 
 LOCAL_SRC_FILES := \
-	src/srp_api.c
+	src/srp_api.c \
+	src/srp_fake.c
 
 LOCAL_C_INCLUDES := \
 	$(LOCAL_PATH)/include
@@ -24,3 +25,5 @@ LOCAL_STATIC_LIBRARIES :=
 LOCAL_SHARED_LIBRARIES :=
 
 include $(BUILD_STATIC_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
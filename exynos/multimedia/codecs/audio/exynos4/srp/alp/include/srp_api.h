@@ -12,6 +12,9 @@
 #define SRP_PENDING_STATE_RUNNING       0
 #define SRP_PENDING_STATE_PENDING       1
 
+/* Number of decode sessions the RP can run at once */
+#define SRP_MAX_SESSIONS                1
+
 struct srp_buf_info {
     void *mmapped_addr;
     void *addr;
@@ -25,10 +28,34 @@ struct srp_dec_info {
     unsigned int channels;
 };
 
+typedef struct srp_context *SRP_HANDLE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Context based API. Every call works on the session returned by
+ * SRP_Ctx_Create(), which fails fast with SRP_ERROR_BUSY when all RP
+ * sessions are taken. SRP_Ctx_Available() is a cheap check that
+ * opens nothing.
+ */
+int SRP_Ctx_Available(void);
+int SRP_Ctx_Create(SRP_HANDLE *phandle, int block_mode);
+int SRP_Ctx_Init(SRP_HANDLE handle);
+int SRP_Ctx_Decode(SRP_HANDLE handle, void *buff, int size_byte);
+int SRP_Ctx_Send_EOS(SRP_HANDLE handle);
+int SRP_Ctx_SetParams(SRP_HANDLE handle, int id, unsigned long val);
+int SRP_Ctx_GetParams(SRP_HANDLE handle, int id, unsigned long *pval);
+int SRP_Ctx_Deinit(SRP_HANDLE handle);
+int SRP_Ctx_Terminate(SRP_HANDLE handle);
+int SRP_Ctx_Get_Ibuf_Info(SRP_HANDLE handle, void **addr, unsigned int *size, unsigned int *num);
+int SRP_Ctx_Get_Obuf_Info(SRP_HANDLE handle, void **addr, unsigned int *size, unsigned int *num);
+int SRP_Ctx_Get_Dec_Info(SRP_HANDLE handle, struct srp_dec_info *dec_info);
+int SRP_Ctx_Get_PCM(SRP_HANDLE handle, void **addr, unsigned int *size);
+int SRP_Ctx_Flush(SRP_HANDLE handle);
+
+/* Single session API, kept for existing users */
 int SRP_Create(int block_mode);
 int SRP_Init();
 int SRP_Decode(void *buff, int size_byte);
@@ -45,6 +72,15 @@ int SRP_Get_Dec_Info(struct srp_dec_info *dec_info);
 int SRP_Get_PCM(void **addr, unsigned int *size);
 int SRP_Flush(void);
 
+#ifdef SRP_FAKE_DEVICE
+/* Host builds: make the next call of the given kind fail with err */
+#define SRP_FAKE_OP_OPEN    0
+#define SRP_FAKE_OP_IOCTL   1
+#define SRP_FAKE_OP_WRITE   2
+#define SRP_FAKE_OP_READ    3
+void SRP_Fake_Fail_Next(int op, int err);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,7 @@ typedef enum {
     SRP_ERROR_OPEN_FAIL       = -1000,
     SRP_ERROR_ALREADY_OPEN    = -1001,
     SRP_ERROR_NOT_READY       = -1002,
+    SRP_ERROR_BUSY            = -1003,
 
     SRP_ERROR_IBUF_OVERFLOW   = -2000,
     SRP_ERROR_IBUF_INFO       = -2001,
@@ -9,253 +9,375 @@
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
 
 #include "srp_api.h"
+#include "srp_fake.h"
 
 #define LOG_NDEBUG 1
 #define LOG_TAG "libsrpapi"
 #include <utils/Log.h>
 
-static struct srp_buf_info ibuf_info;
-static struct srp_buf_info obuf_info;
-static struct srp_buf_info pcm_info;
+struct srp_context {
+    int dev;
+    int block_mode;
+    struct srp_buf_info ibuf_info;
+    struct srp_buf_info obuf_info;
+    struct srp_buf_info pcm_info;
+};
 
-static int srp_dev = -1;
-static int srp_block_mode = SRP_INIT_BLOCK_MODE;
+static pthread_mutex_t srp_lock = PTHREAD_MUTEX_INITIALIZER;
+static int srp_sessions = 0;
 
-int SRP_Create(int block_mode)
+/* Session behind the single session API */
+static SRP_HANDLE srp_compat = NULL;
+
+int SRP_Ctx_Available(void)
+{
+    int busy;
+
+    pthread_mutex_lock(&srp_lock);
+    busy = (srp_sessions >= SRP_MAX_SESSIONS);
+    pthread_mutex_unlock(&srp_lock);
+
+    if (busy)
+        return 0;
+
+    return (access(SRP_DEV_NAME, R_OK | W_OK) == 0);
+}
+
+int SRP_Ctx_Create(SRP_HANDLE *phandle, int block_mode)
 {
-    if (srp_dev == -1) {
-        srp_block_mode = block_mode;
-        srp_dev = open(SRP_DEV_NAME, O_RDWR |
-                    ((block_mode == SRP_INIT_NONBLOCK_MODE) ? O_NDELAY : 0));
-        if (srp_dev > 0)
-            return srp_dev;
-        else
-            return SRP_ERROR_OPEN_FAIL;
+    struct srp_context *ctx;
+    int ret = SRP_RETURN_OK;
+
+    if (phandle == NULL)
+        return SRP_ERROR_INVALID_SETTING;
+
+    *phandle = NULL;
+
+    pthread_mutex_lock(&srp_lock);
+    if (srp_sessions >= SRP_MAX_SESSIONS) {
+        ALOGV("%s: All %d sessions in use", __func__, SRP_MAX_SESSIONS);
+        ret = SRP_ERROR_BUSY;
+        goto exit;
     }
 
-    ALOGE("%s: Device is already opened", __func__);
-    return SRP_ERROR_ALREADY_OPEN;
+    ctx = (struct srp_context *)calloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        ret = SRP_ERROR_OPEN_FAIL;
+        goto exit;
+    }
+
+    ctx->block_mode = block_mode;
+    ctx->dev = open(SRP_DEV_NAME, O_RDWR |
+                ((block_mode == SRP_INIT_NONBLOCK_MODE) ? O_NDELAY : 0));
+    if (ctx->dev < 0) {
+        ret = (errno == EBUSY) ? SRP_ERROR_BUSY : SRP_ERROR_OPEN_FAIL;
+        ALOGE("%s: Failed to open %s: %s", __func__, SRP_DEV_NAME, strerror(errno));
+        free(ctx);
+        goto exit;
+    }
+
+    srp_sessions++;
+    *phandle = ctx;
+
+exit:
+    pthread_mutex_unlock(&srp_lock);
+    return ret;
 }
 
-int SRP_Init()
+int SRP_Ctx_Init(SRP_HANDLE ctx)
 {
     int ret = SRP_RETURN_OK;
     unsigned int mmapped_size = 0;
+    void *addr;
 
-    if (srp_dev != -1) {
-        ret = ioctl(srp_dev, SRP_INIT);
-        if (ret < 0)
-            return ret;
+    if (ctx == NULL) {
+        ALOGE("%s: Device is not ready", __func__);
+        return SRP_ERROR_NOT_READY; /* device is not created */
+    }
 
-        /* mmap for OBUF */
-        ret = ioctl(srp_dev, SRP_GET_MMAP_SIZE, &mmapped_size);
-        if (ret < 0) {
-            ALOGE("%s: SRP_GET_MMAP_SIZE is failed", __func__);
-            return SRP_ERROR_OBUF_MMAP;
-        }
-        obuf_info.mmapped_addr = mmap(0, mmapped_size,
-                    PROT_READ | PROT_WRITE, MAP_SHARED, srp_dev, 0);
-        if (!obuf_info.mmapped_addr) {
-            ALOGE("%s: mmap is failed", __func__);
-            return SRP_ERROR_OBUF_MMAP;
-        }
-        obuf_info.mmapped_size = mmapped_size;
+    ret = ioctl(ctx->dev, SRP_INIT);
+    if (ret < 0)
+        return ret;
 
-        ret = SRP_RETURN_OK;
-    } else {
-        ALOGE("%s: Device is not ready", __func__);
-        ret = SRP_ERROR_NOT_READY; /* device is not created */
+    /* mmap for OBUF */
+    ret = ioctl(ctx->dev, SRP_GET_MMAP_SIZE, &mmapped_size);
+    if (ret < 0) {
+        ALOGE("%s: SRP_GET_MMAP_SIZE is failed", __func__);
+        return SRP_ERROR_OBUF_MMAP;
+    }
+    addr = mmap(0, mmapped_size, PROT_READ | PROT_WRITE, MAP_SHARED, ctx->dev, 0);
+    if (addr == MAP_FAILED || addr == NULL) {
+        ALOGE("%s: mmap is failed", __func__);
+        return SRP_ERROR_OBUF_MMAP;
     }
+    ctx->obuf_info.mmapped_addr = addr;
+    ctx->obuf_info.mmapped_size = mmapped_size;
 
-    return ret;
+    return SRP_RETURN_OK;
 }
 
-int SRP_Decode(void *buff, int size_byte)
+int SRP_Ctx_Decode(SRP_HANDLE ctx, void *buff, int size_byte)
 {
     int ret = SRP_RETURN_OK;
 
-    if (srp_dev != -1) {
-        if (size_byte > 0) {
-            ALOGV("%s: Send data to RP (%d bytes)", __func__, size_byte);
-
-            ret = write(srp_dev, buff, size_byte);  /* Write Buffer to RP Driver */
-            if (ret < 0) {
-                if (ret != SRP_ERROR_IBUF_OVERFLOW)
-                    ALOGE("SRP_Decode returned error code: %d", ret);
-            }
-            return ret; /* Write Success */
-        } else {
-            return ret;
+    if (ctx == NULL) {
+        ALOGE("%s: Device is not ready", __func__);
+        return SRP_ERROR_NOT_READY;
+    }
+
+    if (size_byte > 0) {
+        ALOGV("%s: Send data to RP (%d bytes)", __func__, size_byte);
+
+        ret = write(ctx->dev, buff, size_byte);  /* Write Buffer to RP Driver */
+        if (ret < 0) {
+            if (ret != SRP_ERROR_IBUF_OVERFLOW)
+                ALOGE("SRP_Decode returned error code: %d", ret);
         }
     }
 
-    ALOGE("%s: Device is not ready", __func__);
-    return SRP_ERROR_NOT_READY;
+    return ret;
 }
 
-int SRP_Send_EOS(void)
+int SRP_Ctx_Send_EOS(SRP_HANDLE ctx)
 {
-    if (srp_dev != -1)
-        return ioctl(srp_dev, SRP_SEND_EOS);
+    if (ctx != NULL)
+        return ioctl(ctx->dev, SRP_SEND_EOS);
 
     return SRP_ERROR_NOT_READY;
 }
 
-int SRP_SetParams(int id, unsigned long val)
+int SRP_Ctx_SetParams(SRP_HANDLE ctx, int id, unsigned long val)
 {
-    if (srp_dev != -1)
+    if (ctx != NULL)
         return 0; /* not yet */
 
     return SRP_ERROR_NOT_READY;
 }
 
-int SRP_GetParams(int id, unsigned long *pval)
+int SRP_Ctx_GetParams(SRP_HANDLE ctx, int id, unsigned long *pval)
 {
-    if (srp_dev != -1)
-        return ioctl(srp_dev, id, pval);
+    if (ctx != NULL)
+        return ioctl(ctx->dev, id, pval);
 
     return SRP_ERROR_NOT_READY;
 }
 
-int SRP_Flush(void)
+int SRP_Ctx_Flush(SRP_HANDLE ctx)
 {
-    if (srp_dev != -1)
-        return ioctl(srp_dev, SRP_FLUSH);
+    if (ctx != NULL)
+        return ioctl(ctx->dev, SRP_FLUSH);
 
     return SRP_ERROR_NOT_READY;
 }
 
-int SRP_Get_PCM(void **addr, unsigned int *size)
+int SRP_Ctx_Get_PCM(SRP_HANDLE ctx, void **addr, unsigned int *size)
 {
-    int ret = SRP_RETURN_OK;
-
-    if (srp_dev != -1) {
-        ret = read(srp_dev, &pcm_info, 0);
-        if (ret == -1) {
-            *size = 0;
-            ALOGE("%s: PCM read fail", __func__);
-            return SRP_ERROR_OBUF_READ;
-        }
+    int ret;
 
-        *addr = pcm_info.addr;
-        *size = pcm_info.size;
-    } else {
+    if (ctx == NULL)
         return SRP_ERROR_NOT_READY;
+
+    ret = read(ctx->dev, &ctx->pcm_info, 0);
+    if (ret == -1) {
+        *size = 0;
+        ALOGE("%s: PCM read fail", __func__);
+        return SRP_ERROR_OBUF_READ;
     }
 
+    *addr = ctx->pcm_info.addr;
+    *size = ctx->pcm_info.size;
+
     return ret; /* Read Success */
 }
 
-int SRP_Get_Dec_Info(struct srp_dec_info *dec_info)
+int SRP_Ctx_Get_Dec_Info(SRP_HANDLE ctx, struct srp_dec_info *dec_info)
 {
     int ret;
 
-    if (srp_dev != -1) {
-        ret = ioctl(srp_dev, SRP_GET_DEC_INFO, dec_info);
-        if (ret < 0) {
-            ALOGE("%s: Failed to get dec info", __func__);
-            return SRP_ERROR_GETINFO_FAIL;
-        }
-
-        ALOGV("numChannels(%d), samplingRate(%d)", dec_info->channels, dec_info->sample_rate);
+    if (ctx == NULL)
+        return SRP_ERROR_NOT_READY;
 
-        ret = SRP_RETURN_OK;
-    } else {
-        ret = SRP_ERROR_NOT_READY;
+    ret = ioctl(ctx->dev, SRP_GET_DEC_INFO, dec_info);
+    if (ret < 0) {
+        ALOGE("%s: Failed to get dec info", __func__);
+        return SRP_ERROR_GETINFO_FAIL;
     }
 
-    return ret;
+    ALOGV("numChannels(%d), samplingRate(%d)", dec_info->channels, dec_info->sample_rate);
+
+    return SRP_RETURN_OK;
 }
 
-int SRP_Get_Ibuf_Info(void **addr, unsigned int *size, unsigned int *num)
+int SRP_Ctx_Get_Ibuf_Info(SRP_HANDLE ctx, void **addr, unsigned int *size, unsigned int *num)
 {
-    int ret = SRP_RETURN_OK;
+    int ret;
 
-    if (srp_dev != -1) {
-        ret = ioctl(srp_dev, SRP_GET_IBUF_INFO, &ibuf_info);
-        if (ret == -1) {
-            ALOGE("%s: Failed to get Ibuf info", __func__);
-            return SRP_ERROR_IBUF_INFO;
-        }
+    if (ctx == NULL)
+        return SRP_ERROR_NOT_READY;
 
-        *addr = ibuf_info.addr;
-        *size = ibuf_info.size;
-        *num = ibuf_info.num;
+    ret = ioctl(ctx->dev, SRP_GET_IBUF_INFO, &ctx->ibuf_info);
+    if (ret == -1) {
+        ALOGE("%s: Failed to get Ibuf info", __func__);
+        return SRP_ERROR_IBUF_INFO;
+    }
 
-        if (*num == 0) {
-            ALOGE("%s: IBUF num is 0", __func__);
-            return SRP_ERROR_INVALID_SETTING;
-        }
+    *addr = ctx->ibuf_info.addr;
+    *size = ctx->ibuf_info.size;
+    *num = ctx->ibuf_info.num;
 
-        ret = SRP_RETURN_OK;
-    } else {
-        ret = SRP_ERROR_NOT_READY;
+    if (*num == 0) {
+        ALOGE("%s: IBUF num is 0", __func__);
+        return SRP_ERROR_INVALID_SETTING;
     }
 
-    return ret;
+    return SRP_RETURN_OK;
 }
 
-int SRP_Get_Obuf_Info(void **addr, unsigned int *size, unsigned int *num)
+int SRP_Ctx_Get_Obuf_Info(SRP_HANDLE ctx, void **addr, unsigned int *size, unsigned int *num)
 {
-    int ret = SRP_RETURN_OK;
+    int ret;
+
+    if (ctx == NULL)
+        return SRP_ERROR_NOT_READY;
 
-    if (srp_dev != -1) {
-        if (obuf_info.addr == NULL) {
-            ret = ioctl(srp_dev, SRP_GET_OBUF_INFO, &obuf_info);
-            if (ret < 0) {
-                ALOGE("%s: SRP_GET_OBUF_INFO is failed", __func__);
-                return SRP_ERROR_OBUF_INFO;
-            }
+    if (ctx->obuf_info.addr == NULL) {
+        ret = ioctl(ctx->dev, SRP_GET_OBUF_INFO, &ctx->obuf_info);
+        if (ret < 0) {
+            ALOGE("%s: SRP_GET_OBUF_INFO is failed", __func__);
+            return SRP_ERROR_OBUF_INFO;
         }
+    }
 
-        *addr = obuf_info.addr;
-        *size = obuf_info.size;
-        *num = obuf_info.num;
+    *addr = ctx->obuf_info.addr;
+    *size = ctx->obuf_info.size;
+    *num = ctx->obuf_info.num;
 
-        if (*num == 0) {
-            ALOGE("%s: OBUF num is 0", __func__);
-            return SRP_ERROR_INVALID_SETTING;
-        }
+    if (*num == 0) {
+        ALOGE("%s: OBUF num is 0", __func__);
+        return SRP_ERROR_INVALID_SETTING;
+    }
+
+    return SRP_RETURN_OK;
+}
 
-        ret = SRP_RETURN_OK;
-    } else {
-        ret = SRP_ERROR_NOT_READY;
+int SRP_Ctx_Deinit(SRP_HANDLE ctx)
+{
+    if (ctx == NULL)
+        return SRP_ERROR_NOT_READY;
+
+    if (ctx->obuf_info.mmapped_addr != NULL) {
+        munmap(ctx->obuf_info.mmapped_addr, ctx->obuf_info.mmapped_size);
+        ctx->obuf_info.mmapped_addr = NULL;
     }
 
-    return ret;
+    return ioctl(ctx->dev, SRP_DEINIT);
 }
 
-int SRP_Deinit(void)
+int SRP_Ctx_Terminate(SRP_HANDLE ctx)
+{
+    if (ctx == NULL)
+        return SRP_ERROR_NOT_READY;
+
+    if (close(ctx->dev) != 0)
+        return SRP_ERROR_NOT_READY;
+
+    pthread_mutex_lock(&srp_lock);
+    srp_sessions--;
+    pthread_mutex_unlock(&srp_lock);
+
+    free(ctx);
+    return SRP_RETURN_OK;
+}
+
+int SRP_Create(int block_mode)
 {
-    if (srp_dev != -1) {
-        munmap(obuf_info.mmapped_addr, obuf_info.mmapped_size);
-        return ioctl(srp_dev, SRP_DEINIT);
+    int ret;
+
+    if (srp_compat != NULL) {
+        ALOGE("%s: Device is already opened", __func__);
+        return SRP_ERROR_ALREADY_OPEN;
     }
 
-    return SRP_ERROR_NOT_READY;
+    ret = SRP_Ctx_Create(&srp_compat, block_mode);
+    if (ret != SRP_RETURN_OK)
+        return (ret == SRP_ERROR_BUSY) ? ret : SRP_ERROR_OPEN_FAIL;
+
+    return srp_compat->dev;
+}
+
+int SRP_Init()
+{
+    return SRP_Ctx_Init(srp_compat);
+}
+
+int SRP_Decode(void *buff, int size_byte)
+{
+    return SRP_Ctx_Decode(srp_compat, buff, size_byte);
+}
+
+int SRP_Send_EOS(void)
+{
+    return SRP_Ctx_Send_EOS(srp_compat);
+}
+
+int SRP_SetParams(int id, unsigned long val)
+{
+    return SRP_Ctx_SetParams(srp_compat, id, val);
+}
+
+int SRP_GetParams(int id, unsigned long *pval)
+{
+    return SRP_Ctx_GetParams(srp_compat, id, pval);
+}
+
+int SRP_Flush(void)
+{
+    return SRP_Ctx_Flush(srp_compat);
+}
+
+int SRP_Get_PCM(void **addr, unsigned int *size)
+{
+    return SRP_Ctx_Get_PCM(srp_compat, addr, size);
+}
+
+int SRP_Get_Dec_Info(struct srp_dec_info *dec_info)
+{
+    return SRP_Ctx_Get_Dec_Info(srp_compat, dec_info);
+}
+
+int SRP_Get_Ibuf_Info(void **addr, unsigned int *size, unsigned int *num)
+{
+    return SRP_Ctx_Get_Ibuf_Info(srp_compat, addr, size, num);
+}
+
+int SRP_Get_Obuf_Info(void **addr, unsigned int *size, unsigned int *num)
+{
+    return SRP_Ctx_Get_Obuf_Info(srp_compat, addr, size, num);
+}
+
+int SRP_Deinit(void)
+{
+    return SRP_Ctx_Deinit(srp_compat);
 }
 
 int SRP_Terminate(void)
 {
     int ret;
 
-    if (srp_dev != -1) {
-        ret = close(srp_dev);
-
-        if (ret == 0) {
-            srp_dev = -1; /* device closed */
-            return SRP_RETURN_OK;
-        }
-    }
+    ret = SRP_Ctx_Terminate(srp_compat);
+    if (ret == SRP_RETURN_OK)
+        srp_compat = NULL; /* device closed */
 
-    return SRP_ERROR_NOT_READY;
+    return ret;
 }
 
 int SRP_IsOpen(void)
 {
-    if (srp_dev == -1) {
+    if (srp_compat == NULL) {
         ALOGV("%s: Device is not opened", __func__);
         return 0;
     }
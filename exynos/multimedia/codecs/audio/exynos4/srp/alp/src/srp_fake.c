@@ -0,0 +1,203 @@
+#ifdef SRP_FAKE_DEVICE
+#include <sys/types.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "srp_api.h"
+#include "srp_fake.h"
+
+/*
+ * Model of one RP decoder: a single open at a time, IBUF_NUM input buffers
+ * of IBUF_SIZE bytes, and one PCM frame produced per IBUF consumed. The
+ * format is reported once any data has been written.
+ */
+#define FAKE_FD             0x5250
+#define FAKE_IBUF_SIZE      (16 * 1024)
+#define FAKE_IBUF_NUM       2
+#define FAKE_OBUF_SIZE      (4608)
+#define FAKE_OBUF_NUM       2
+#define FAKE_SAMPLE_RATE    44100
+#define FAKE_CHANNELS       2
+
+static pthread_mutex_t fake_lock = PTHREAD_MUTEX_INITIALIZER;
+static int fake_opened;
+static int fake_pending;
+static int fake_written;
+static int fake_eos;
+static int fake_fail_op = -1;
+static int fake_fail_err;
+
+void SRP_Fake_Fail_Next(int op, int err)
+{
+    pthread_mutex_lock(&fake_lock);
+    fake_fail_op = op;
+    fake_fail_err = err;
+    pthread_mutex_unlock(&fake_lock);
+}
+
+/* Consumes an injected failure for op, called with fake_lock held */
+static int fake_check_fail(int op)
+{
+    if (fake_fail_op != op)
+        return 0;
+
+    fake_fail_op = -1;
+    errno = fake_fail_err;
+    return -1;
+}
+
+int srp_fake_access(const char *path, int mode)
+{
+    return 0;
+}
+
+int srp_fake_open(const char *path, int flags, ...)
+{
+    int ret = FAKE_FD;
+
+    pthread_mutex_lock(&fake_lock);
+    if (fake_check_fail(SRP_FAKE_OP_OPEN)) {
+        ret = -1;
+    } else if (fake_opened) {
+        errno = EBUSY;
+        ret = -1;
+    } else {
+        fake_opened = 1;
+        fake_pending = 0;
+        fake_written = 0;
+        fake_eos = 0;
+    }
+    pthread_mutex_unlock(&fake_lock);
+
+    return ret;
+}
+
+int srp_fake_close(int fd)
+{
+    pthread_mutex_lock(&fake_lock);
+    fake_opened = 0;
+    pthread_mutex_unlock(&fake_lock);
+
+    return 0;
+}
+
+int srp_fake_ioctl(int fd, int req, ...)
+{
+    struct srp_buf_info *info;
+    struct srp_dec_info *dec_info;
+    va_list ap;
+    void *arg;
+    int ret = 0;
+
+    va_start(ap, req);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+
+    pthread_mutex_lock(&fake_lock);
+    if (fake_check_fail(SRP_FAKE_OP_IOCTL)) {
+        ret = -1;
+        goto exit;
+    }
+
+    switch (req) {
+    case SRP_INIT:
+    case SRP_FLUSH:
+        fake_pending = 0;
+        fake_eos = 0;
+        break;
+    case SRP_DEINIT:
+        break;
+    case SRP_GET_MMAP_SIZE:
+        *(unsigned int *)arg = FAKE_OBUF_SIZE * FAKE_OBUF_NUM;
+        break;
+    case SRP_GET_IBUF_INFO:
+        info = (struct srp_buf_info *)arg;
+        info->addr = NULL;
+        info->size = FAKE_IBUF_SIZE;
+        info->num = FAKE_IBUF_NUM;
+        break;
+    case SRP_GET_OBUF_INFO:
+        info = (struct srp_buf_info *)arg;
+        info->addr = NULL;
+        info->size = FAKE_OBUF_SIZE;
+        info->num = FAKE_OBUF_NUM;
+        break;
+    case SRP_GET_DEC_INFO:
+        dec_info = (struct srp_dec_info *)arg;
+        dec_info->sample_rate = fake_written ? FAKE_SAMPLE_RATE : 0;
+        dec_info->channels = fake_written ? FAKE_CHANNELS : 0;
+        break;
+    case SRP_SEND_EOS:
+        fake_eos = 1;
+        break;
+    case SRP_STOP_EOS_STATE:
+        *(unsigned long *)arg = (fake_eos && fake_pending == 0);
+        break;
+    default:
+        errno = EINVAL;
+        ret = -1;
+        break;
+    }
+
+exit:
+    pthread_mutex_unlock(&fake_lock);
+    return ret;
+}
+
+ssize_t srp_fake_write(int fd, const void *buf, size_t count)
+{
+    ssize_t ret;
+
+    pthread_mutex_lock(&fake_lock);
+    if (fake_check_fail(SRP_FAKE_OP_WRITE)) {
+        ret = -1;
+    } else if (fake_pending + (int)count > FAKE_IBUF_SIZE * FAKE_IBUF_NUM) {
+        ret = SRP_ERROR_IBUF_OVERFLOW;
+    } else {
+        fake_pending += count;
+        fake_written = 1;
+        ret = count;
+    }
+    pthread_mutex_unlock(&fake_lock);
+
+    return ret;
+}
+
+ssize_t srp_fake_read(int fd, void *buf, size_t count)
+{
+    static unsigned char pcm[FAKE_OBUF_SIZE];
+    struct srp_buf_info *info = (struct srp_buf_info *)buf;
+    ssize_t ret = 0;
+
+    pthread_mutex_lock(&fake_lock);
+    if (fake_check_fail(SRP_FAKE_OP_READ)) {
+        ret = -1;
+    } else if (fake_pending > 0) {
+        fake_pending -= (fake_pending < FAKE_IBUF_SIZE) ? fake_pending : FAKE_IBUF_SIZE;
+        info->addr = pcm;
+        info->size = FAKE_OBUF_SIZE;
+    } else {
+        info->addr = pcm;
+        info->size = 0;
+    }
+    pthread_mutex_unlock(&fake_lock);
+
+    return ret;
+}
+
+void *srp_fake_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    void *p = calloc(1, length);
+
+    return p ? p : (void *)-1;
+}
+
+int srp_fake_munmap(void *addr, size_t length)
+{
+    free(addr);
+    return 0;
+}
+#endif /* SRP_FAKE_DEVICE */
@@ -0,0 +1,30 @@
+#ifndef __SRP_FAKE_H__
+#define __SRP_FAKE_H__
+
+/*
+ * With SRP_FAKE_DEVICE the driver calls made by srp_api.c are routed to an
+ * in-process model of the RP device, so the library can run on a host.
+ */
+#ifdef SRP_FAKE_DEVICE
+#include <sys/types.h>
+
+int srp_fake_access(const char *path, int mode);
+int srp_fake_open(const char *path, int flags, ...);
+int srp_fake_close(int fd);
+int srp_fake_ioctl(int fd, int req, ...);
+ssize_t srp_fake_write(int fd, const void *buf, size_t count);
+ssize_t srp_fake_read(int fd, void *buf, size_t count);
+void *srp_fake_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset);
+int srp_fake_munmap(void *addr, size_t length);
+
+#define access  srp_fake_access
+#define open    srp_fake_open
+#define close   srp_fake_close
+#define ioctl   srp_fake_ioctl
+#define write   srp_fake_write
+#define read    srp_fake_read
+#define mmap    srp_fake_mmap
+#define munmap  srp_fake_munmap
+#endif
+
+#endif /* __SRP_FAKE_H__ */
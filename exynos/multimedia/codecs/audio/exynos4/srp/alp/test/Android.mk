@@ -0,0 +1,48 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#               srp_ctx_test binary
+# --------------------------------------------- #
+
+# runs against the RP model in srp_fake.c, no /dev/srp needed
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	srp_ctx_test.c \
+	../src/srp_api.c \
+	../src/srp_fake.c
+
+LOCAL_MODULE := srp_ctx_test
+
+LOCAL_CFLAGS := -DSRP_FAKE_DEVICE
+
+LOCAL_SHARED_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	srp_ctx_test.c \
+	../src/srp_api.c \
+	../src/srp_fake.c
+
+LOCAL_MODULE := srp_ctx_test-host
+
+LOCAL_CFLAGS := -DSRP_FAKE_DEVICE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,166 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The SRP context API against the in-process RP model of srp_fake.c,
+ * built with SRP_FAKE_DEVICE: session counting, the error codes of each
+ * driver call and the single session compat entry points.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <pthread.h>
+
+#include "srp_api.h"
+
+#define RACE_THREADS    8
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("srp_ctx_test: %s:%d: %s\n",                     \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static pthread_mutex_t race_lock = PTHREAD_MUTEX_INITIALIZER;
+static SRP_HANDLE race_winner;
+static int race_wins;
+
+static void *race_create(void *arg)
+{
+    SRP_HANDLE handle;
+
+    if (SRP_Ctx_Create(&handle, SRP_INIT_BLOCK_MODE) == 0) {
+        pthread_mutex_lock(&race_lock);
+        race_wins++;
+        race_winner = handle;
+        pthread_mutex_unlock(&race_lock);
+    }
+
+    return NULL;
+}
+
+/* one session at a time, a second one fails fast */
+static void test_sessions(void)
+{
+    SRP_HANDLE a, b;
+
+    CHECK(SRP_Ctx_Available());
+    CHECK(SRP_Ctx_Create(&a, SRP_INIT_BLOCK_MODE) == 0);
+    CHECK(!SRP_Ctx_Available());
+    CHECK(SRP_Ctx_Create(&b, SRP_INIT_BLOCK_MODE) == SRP_ERROR_BUSY);
+    CHECK(b == NULL);
+    CHECK(SRP_Create(SRP_INIT_BLOCK_MODE) == SRP_ERROR_BUSY);
+    CHECK(SRP_Ctx_Terminate(a) == 0);
+    CHECK(SRP_Ctx_Available());
+
+    SRP_Fake_Fail_Next(SRP_FAKE_OP_OPEN, ENOENT);
+    CHECK(SRP_Ctx_Create(&a, SRP_INIT_BLOCK_MODE) == SRP_ERROR_OPEN_FAIL);
+    CHECK(SRP_Ctx_Available());
+}
+
+/* a full decode on one session, with a read failure on the way */
+static void test_decode(void)
+{
+    static char buf[16 * 1024];
+    struct srp_dec_info dec_info;
+    unsigned long eos;
+    unsigned int size, num;
+    SRP_HANDLE h;
+    void *addr;
+
+    CHECK(SRP_Ctx_Create(&h, SRP_INIT_BLOCK_MODE) == 0);
+    CHECK(SRP_Ctx_Init(h) == 0);
+    CHECK(SRP_Ctx_Get_Ibuf_Info(h, &addr, &size, &num) == 0);
+    CHECK(size == sizeof(buf) && num == 2);
+
+    /* no format before any data went in */
+    CHECK(SRP_Ctx_Get_Dec_Info(h, &dec_info) == 0);
+    CHECK(dec_info.sample_rate == 0);
+
+    CHECK(SRP_Ctx_Decode(h, buf, sizeof(buf)) == sizeof(buf));
+    CHECK(SRP_Ctx_Decode(h, buf, sizeof(buf)) == sizeof(buf));
+    CHECK(SRP_Ctx_Decode(h, buf, 1) == SRP_ERROR_IBUF_OVERFLOW);
+    CHECK(SRP_Ctx_Get_Dec_Info(h, &dec_info) == 0);
+    CHECK(dec_info.sample_rate == 44100 && dec_info.channels == 2);
+
+    CHECK(SRP_Ctx_Get_PCM(h, &addr, &size) == 0);
+    CHECK(size > 0);
+    SRP_Fake_Fail_Next(SRP_FAKE_OP_READ, EIO);
+    CHECK(SRP_Ctx_Get_PCM(h, &addr, &size) == SRP_ERROR_OBUF_READ);
+    CHECK(size == 0);
+
+    /* EOS is reached once the last IBUF has been decoded */
+    CHECK(SRP_Ctx_Send_EOS(h) == 0);
+    CHECK(SRP_Ctx_GetParams(h, SRP_STOP_EOS_STATE, &eos) == 0);
+    CHECK(eos == 0);
+    CHECK(SRP_Ctx_Get_PCM(h, &addr, &size) == 0);
+    CHECK(SRP_Ctx_GetParams(h, SRP_STOP_EOS_STATE, &eos) == 0);
+    CHECK(eos == 1);
+
+    CHECK(SRP_Ctx_Deinit(h) == 0);
+    CHECK(SRP_Ctx_Terminate(h) == 0);
+}
+
+/* the old global entry points on top of one compat session */
+static void test_compat(void)
+{
+    static char buf[16];
+
+    CHECK(SRP_Create(SRP_INIT_BLOCK_MODE) > 0);
+    CHECK(SRP_IsOpen());
+    CHECK(SRP_Create(SRP_INIT_BLOCK_MODE) == SRP_ERROR_ALREADY_OPEN);
+    CHECK(!SRP_Ctx_Available());
+    CHECK(SRP_Init() == 0);
+    CHECK(SRP_Decode(buf, sizeof(buf)) == sizeof(buf));
+    CHECK(SRP_Flush() == 0);
+    CHECK(SRP_Deinit() == 0);
+    CHECK(SRP_Terminate() == 0);
+    CHECK(!SRP_IsOpen());
+    CHECK(SRP_Ctx_Available());
+}
+
+/* concurrent creates: exactly one gets the session */
+static void test_race(void)
+{
+    pthread_t threads[RACE_THREADS];
+    int i;
+
+    for (i = 0; i < RACE_THREADS; i++)
+        pthread_create(&threads[i], NULL, race_create, NULL);
+    for (i = 0; i < RACE_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    CHECK(race_wins == 1);
+    if (race_wins == 1)
+        CHECK(SRP_Ctx_Terminate(race_winner) == 0);
+}
+
+int main(int argc, char **argv)
+{
+    test_sessions();
+    test_decode();
+    test_compat();
+    test_race();
+
+    printf("srp_ctx_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -21,3 +21,5 @@ LOCAL_COPY_HEADERS := \
 	include/srp_ioctl.h
 
 include $(BUILD_STATIC_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -3,12 +3,15 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <ctype.h>
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #include "srp_api.h"
 
@@ -27,15 +30,26 @@
 
 #ifdef _USE_WBUF_
 #define WBUF_LEN_MUL        2
+/* Longest wait for the RP driver to take an IBUF before giving up */
+#define WBUF_WRITE_TIMEOUT_MS   2000
 #endif
 
 static int srp_dev = -1;
 static int srp_ibuf_size = 0;
 static int srp_block_mode = SRP_INIT_BLOCK_MODE;
 
+#ifdef _USE_WBUF_
+/*
+ * Circular staging buffer. Data is handed to the RP driver in IBUF sized
+ * chunks gathered with writev() straight from the ring and the caller's
+ * buffer, so resident bytes are never moved. Only the tail that does not
+ * fill a whole IBUF is copied in, which always fits.
+ */
 static unsigned char *wbuf;
 static int wbuf_size;
-static int wbuf_pos;
+static int wbuf_head;   /* Offset of the oldest staged byte */
+static int wbuf_len;    /* Number of staged bytes */
+#endif
 
 #ifdef _DUMP_TO_FILE_
 static FILE *fp_dump = NULL;
@@ -46,8 +60,13 @@ static int WriteBuff_Init(void)
 {
     if (wbuf == NULL) {
         wbuf_size = srp_ibuf_size * WBUF_LEN_MUL;
-        wbuf_pos = 0;
+        wbuf_head = 0;
+        wbuf_len = 0;
         wbuf = (unsigned char *)malloc(wbuf_size);
+        if (wbuf == NULL) {
+            ALOGE("%s: WriteBuffer allocation failed", __func__);
+            return -1;
+        }
         ALOGD("%s: WriteBuffer %dbytes allocated", __func__, wbuf_size);
         return 0;
     }
@@ -68,30 +87,135 @@ static int WriteBuff_Deinit(void)
     return -1;
 }
 
-static int WriteBuff_Write(unsigned char *buff, int size_byte)
+/* Appends size_byte bytes from buff, or of value fill when buff is NULL */
+static int WriteBuff_Write(unsigned char *buff, int size_byte, int fill)
 {
-    int write_byte;
+    int tail, first;
 
-    if ((wbuf_pos + size_byte) < wbuf_size) {
-        memcpy(&wbuf[wbuf_pos], buff, size_byte);
-        wbuf_pos += size_byte;
-    } else {
-        ALOGE("%s: WriteBuffer is filled [%d], ignoring write [%d]", __func__, wbuf_pos, size_byte);
+    if (size_byte > wbuf_size - wbuf_len) {
+        ALOGE("%s: WriteBuffer is filled [%d], cannot stage [%d]", __func__, wbuf_len, size_byte);
         return -1;    /* Insufficient buffer */
     }
 
-    return wbuf_pos;
+    tail = (wbuf_head + wbuf_len) % wbuf_size;
+    first = wbuf_size - tail;
+    if (first > size_byte)
+        first = size_byte;
+
+    if (buff != NULL) {
+        memcpy(&wbuf[tail], buff, first);
+        memcpy(wbuf, buff + first, size_byte - first);
+    } else {
+        memset(&wbuf[tail], fill, first);
+        memset(wbuf, fill, size_byte - first);
+    }
+    wbuf_len += size_byte;
+
+    return wbuf_len;
 }
 
-static void WriteBuff_Consume(void)
+static void WriteBuff_Consume(int size_byte)
 {
-    memcpy(wbuf, &wbuf[srp_ibuf_size], srp_ibuf_size * (WBUF_LEN_MUL - 1));
-    wbuf_pos -= srp_ibuf_size;
+    wbuf_head = (wbuf_head + size_byte) % wbuf_size;
+    wbuf_len -= size_byte;
+    if (wbuf_len == 0)
+        wbuf_head = 0;
 }
 
 static void WriteBuff_Flush(void)
 {
-    wbuf_pos = 0;
+    wbuf_head = 0;
+    wbuf_len = 0;
+}
+
+/*
+ * Sends one IBUF to the RP driver: the staged bytes first, then the head
+ * of buff. The caller guarantees wbuf_len + size_byte >= srp_ibuf_size.
+ * When the device cannot take more data, the call waits up to
+ * WBUF_WRITE_TIMEOUT_MS for it if wait is set, and returns -EAGAIN
+ * otherwise. Returns the number of bytes taken from buff, or -1 on error.
+ */
+static int WriteBuff_Send(unsigned char *buff, int size_byte, int wait, int *err_code)
+{
+    struct iovec iov[3];
+    struct pollfd pfd;
+    int remain = srp_ibuf_size;
+    int used = 0;
+    int cnt, first, staged, ret, val;
+
+    while (remain > 0) {
+        cnt = 0;
+        staged = (wbuf_len < remain) ? wbuf_len : remain;
+        if (staged > 0) {
+            first = wbuf_size - wbuf_head;
+            if (first > staged)
+                first = staged;
+            iov[cnt].iov_base = &wbuf[wbuf_head];
+            iov[cnt++].iov_len = first;
+            if (staged > first) {
+                iov[cnt].iov_base = wbuf;
+                iov[cnt++].iov_len = staged - first;
+            }
+        }
+        if (remain > staged) {
+            iov[cnt].iov_base = buff + used;
+            iov[cnt++].iov_len = remain - staged;
+        }
+
+        ret = writev(srp_dev, iov, cnt); /* Write Buffer to RP Driver */
+        if (ret == 0) {
+            ALOGE("%s: RP driver took no data", __func__);
+            return -1;
+        }
+        if (ret == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN) {   /* Device busy */
+                if (!wait)
+                    return -EAGAIN;
+                pfd.fd = srp_dev;
+                pfd.events = POLLOUT;
+                ret = poll(&pfd, 1, WBUF_WRITE_TIMEOUT_MS);
+                if (ret == 0) {
+                    ALOGE("%s: RP driver took no data for %dms", __func__, WBUF_WRITE_TIMEOUT_MS);
+                    return -1;
+                }
+                if (ret == -1 && errno != EINTR) {
+                    ALOGE("%s: poll fail", __func__);
+                    return -1;
+                }
+                continue;
+            }
+
+            ioctl(srp_dev, SRP_ERROR_STATE, &val);
+            if (!val) {    /* Write error? */
+                ALOGE("%s: IBUF write fail", __func__);
+                return -1;
+            }
+
+            /* Write OK, but RP decode error? */
+            *err_code = val;
+            ALOGE("%s: RP decode error [0x%05X]", __func__, val);
+            ret = remain;
+        }
+#ifdef _DUMP_TO_FILE_
+        if (fp_dump) {
+            int i, len, left = ret;
+            for (i = 0; i < cnt && left > 0; i++) {
+                len = ((int)iov[i].iov_len < left) ? (int)iov[i].iov_len : left;
+                fwrite(iov[i].iov_base, len, 1, fp_dump);
+                left -= len;
+            }
+        }
+#endif
+
+        staged = (wbuf_len < ret) ? wbuf_len : ret;
+        WriteBuff_Consume(staged);
+        used += ret - staged;
+        remain -= ret;
+    }
+
+    return used;
 }
 #endif
 
@@ -154,40 +278,75 @@ int SRP_Init(unsigned int ibuf_size)
 }
 
 #ifdef _USE_WBUF_
+/*
+ * Non-blocking mode: buff is either taken as a whole or, when the RP
+ * driver is busy and the ring cannot hold it, not at all and -EAGAIN is
+ * returned. As before the ring was circular, a single call is limited to
+ * the free room of the ring.
+ */
+static int SRP_Decode_NonBlock(unsigned char *in, int size_byte)
+{
+    int ret;
+    int err_code = 0;
+
+    /* Make room by sending whole IBUFs from the ring only */
+    while (wbuf_len >= srp_ibuf_size) {
+        ret = WriteBuff_Send(NULL, 0, 0, &err_code);
+        if (ret == -EAGAIN)
+            break;
+        if (ret == -1)
+            return -1;
+    }
+
+    if (size_byte > wbuf_size - wbuf_len) {
+        if (wbuf_len >= srp_ibuf_size)
+            return -EAGAIN;
+        ALOGE("%s: [%d] does not fit in the WriteBuffer", __func__, size_byte);
+        return -1;
+    }
+
+    WriteBuff_Write(in, size_byte, 0);
+
+    /* Push what is whole now, whatever the driver does not take waits */
+    while (wbuf_len >= srp_ibuf_size) {
+        ret = WriteBuff_Send(NULL, 0, 0, &err_code);
+        if (ret == -EAGAIN)
+            break;
+        if (ret == -1)
+            return -1;
+    }
+
+    return err_code;
+}
+
 int SRP_Decode(void *buff, int size_byte)
 {
+    unsigned char *in = (unsigned char *)buff;
     int ret;
-    int val;
     int err_code = 0;
 
     if (srp_dev != -1) {
-        /* Check wbuf before writing buff */
-        while (wbuf_pos >= srp_ibuf_size) { /* Write_Buffer filled? (IBUF Size)*/
+        if (srp_block_mode == SRP_INIT_NONBLOCK_MODE)
+            return SRP_Decode_NonBlock(in, size_byte);
+
+        /* Send every whole IBUF available from wbuf and buff */
+        while (wbuf_len + size_byte >= srp_ibuf_size) {
             ALOGD("%s: Write Buffer is full, Send data to RP", __func__);
 
-            ret = write(srp_dev, wbuf, srp_ibuf_size); /* Write Buffer to RP Driver */
-            if (ret == -1) { /* Fail? */
-                ioctl(srp_dev, SRP_ERROR_STATE, &val);
-                if (!val) {    /* Write error? */
-                    ALOGE("%s: IBUF write fail", __func__);
-                    return -1;
-                } else {       /* Write OK, but RP decode error? */
-                    err_code = val;
-                    ALOGE("%s: RP decode error [0x%05X]", __func__, err_code);
-                }
-            }
-#ifdef _DUMP_TO_FILE_
-            if (fp_dump)
-                fwrite(wbuf, srp_ibuf_size, 1, fp_dump);
-#endif
-            WriteBuff_Consume();
+            ret = WriteBuff_Send(in, size_byte, 1, &err_code);
+            if (ret < 0)
+                return -1;
+
+            in += ret;
+            size_byte -= ret;
         }
 
-        ret = WriteBuff_Write((unsigned char *)buff, size_byte);
+        /* Stage the remainder, less than one IBUF */
+        ret = WriteBuff_Write(in, size_byte, 0);
         if (ret == -1)
             return -1;  /* Buffering error */
 
-        ALOGD("%s: Write Buffer remain [%d]", __func__, wbuf_pos);
+        ALOGD("%s: Write Buffer remain [%d]", __func__, wbuf_len);
         return err_code;  /* Write Success */
     }
 
@@ -197,38 +356,25 @@ int SRP_Decode(void *buff, int size_byte)
 
 int SRP_Send_EOS(void)
 {
-    int ret;
-    int val;
+    int err_code = 0;
 
     if (srp_dev != -1) {
-        /* Check wbuf before writing buff */
-        while (wbuf_pos) { /* Write_Buffer ramain?*/
-            if (wbuf_pos < srp_ibuf_size) {
-                memset(wbuf + wbuf_pos, 0xFF, srp_ibuf_size - wbuf_pos); /* Fill dummy data */
-                wbuf_pos = srp_ibuf_size;
-            }
+        /* Send whole IBUFs a non-blocking SRP_Decode() left behind */
+        while (wbuf_len >= srp_ibuf_size) {
+            if (WriteBuff_Send(NULL, 0, 1, &err_code) < 0 || err_code)
+                return -1;
+        }
 
-            ret = write(srp_dev, wbuf, srp_ibuf_size); /* Write Buffer to RP Driver */
-            if (ret == -1) {  /* Fail? */
-                ret = ioctl(srp_dev, SRP_ERROR_STATE, &val);
-                if (!val) {   /* Write error? */
-                    ALOGE("%s: IBUF write fail", __func__);
-                    return -1;
-                } else {      /* RP decoe error? */
-                    ALOGE("%s: RP decode error [0x%05X]", __func__, val);
-                    return -1;
-                }
-            } else {          /* Success? */
-#ifdef _DUMP_TO_FILE_
-                if (fp_dump)
-                    fwrite(wbuf, srp_ibuf_size, 1, fp_dump);
-#endif
-                WriteBuff_Consume();
-            }
+        /* Pad the staged remainder to a whole IBUF and send it */
+        if (wbuf_len) {
+            WriteBuff_Write(NULL, srp_ibuf_size - wbuf_len, 0xFF); /* Fill dummy data */
+            if (WriteBuff_Send(NULL, 0, 1, &err_code) < 0 || err_code)
+                return -1;
         }
 
-        memset(wbuf, 0xFF, srp_ibuf_size);      /* Fill dummy data */
-        write(srp_dev, wbuf, srp_ibuf_size); /* Write Buffer to RP Driver */
+        WriteBuff_Write(NULL, srp_ibuf_size, 0xFF);  /* Fill dummy data */
+        WriteBuff_Send(NULL, 0, 1, &err_code);       /* Write Buffer to RP Driver */
+        WriteBuff_Flush();
 
         /* Wait until RP decoding over */
         return ioctl(srp_dev, SRP_WAIT_EOS);
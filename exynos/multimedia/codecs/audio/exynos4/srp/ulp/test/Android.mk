@@ -0,0 +1,45 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#              srp_wbuf_test binary
+# --------------------------------------------- #
+
+# srp_api.c is built here with the write buffer on, libsrpapi leaves it off
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	srp_wbuf_test.c \
+	../src/srp_api.c
+
+LOCAL_MODULE := srp_wbuf_test
+
+LOCAL_CFLAGS := -D_USE_WBUF_
+
+LOCAL_SHARED_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	srp_wbuf_test.c \
+	../src/srp_api.c
+
+LOCAL_MODULE := srp_wbuf_test-host
+
+LOCAL_CFLAGS := -D_USE_WBUF_ -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The _USE_WBUF_ write path of srp_api.c against a fake RP driver.
+ * open/close/ioctl/writev/poll are defined here: SRP_DEV_NAME never
+ * reaches the kernel, every other fd is passed on. The fake takes at
+ * most 'chunk' bytes per writev() and 'room' bytes before it reports
+ * EAGAIN, poll() either makes room again or times out.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#include "srp_api.h"
+
+#define FAKE_SRP_FD     1000
+#define IBUF_SIZE       4096
+#define INPUT_SIZE      (IBUF_SIZE * 64 + 123)
+#define OUTPUT_SIZE     (INPUT_SIZE + IBUF_SIZE * 4)
+
+struct fake_srp {
+    int chunk;          /* most bytes taken by one writev() */
+    int room;           /* bytes taken before EAGAIN, -1 for no limit */
+    int poll_refill;    /* room made by a poll(), 0 times it out */
+    int zero;           /* writev() returns 0 */
+    int writes;
+    int polls;
+    int poll_timeout;
+    int len;
+    unsigned char out[OUTPUT_SIZE];
+};
+
+static struct fake_srp fake;
+static unsigned char input[INPUT_SIZE];
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("srp_wbuf_test: %s:%d: %s\n",                    \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+int open(const char *path, int flags, ...)
+{
+    va_list ap;
+    int mode;
+
+    if (strcmp(path, SRP_DEV_NAME) == 0)
+        return FAKE_SRP_FD;
+
+    va_start(ap, flags);
+    mode = va_arg(ap, int);
+    va_end(ap);
+
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+int close(int fd)
+{
+    if (fd == FAKE_SRP_FD)
+        return 0;
+
+    return syscall(SYS_close, fd);
+}
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+int ioctl(int fd, int req, ...)
+#else
+int ioctl(int fd, unsigned long req, ...)
+#endif
+{
+    va_list ap;
+    void *arg;
+
+    va_start(ap, req);
+    arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fd != FAKE_SRP_FD)
+        return syscall(SYS_ioctl, fd, req, arg);
+
+    if (req == SRP_ERROR_STATE)
+        *(int *)arg = 0;    /* a failed write is a write error, not a decode error */
+
+    return 0;
+}
+
+ssize_t writev(int fd, const struct iovec *iov, int iovcnt)
+{
+    int i, len, total = 0;
+
+    if (fd != FAKE_SRP_FD)
+        return syscall(SYS_writev, fd, iov, iovcnt);
+
+    fake.writes++;
+    if (fake.zero)
+        return 0;
+    if (fake.room == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    for (i = 0; i < iovcnt; i++) {
+        len = iov[i].iov_len;
+        if (len > fake.chunk - total)
+            len = fake.chunk - total;
+        if (fake.room > 0 && len > fake.room - total)
+            len = fake.room - total;
+        if (len <= 0)
+            break;
+        memcpy(&fake.out[fake.len], iov[i].iov_base, len);
+        fake.len += len;
+        total += len;
+    }
+    if (fake.room > 0)
+        fake.room -= total;
+
+    return total;
+}
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    if (nfds != 1 || fds[0].fd != FAKE_SRP_FD)
+        return syscall(SYS_ppoll, fds, nfds, NULL, NULL, 0);
+
+    fake.polls++;
+    fake.poll_timeout = timeout;
+    if (fake.poll_refill == 0)
+        return 0;
+
+    fake.room = fake.poll_refill;
+    fds[0].revents = POLLOUT;
+
+    return 1;
+}
+
+static void reset(int block_mode)
+{
+    memset(&fake, 0, sizeof(fake));
+    fake.chunk = IBUF_SIZE;
+    fake.room = -1;
+
+    CHECK(SRP_Create(block_mode) == FAKE_SRP_FD);
+    CHECK(SRP_Init(IBUF_SIZE) == 0);
+}
+
+static void finish(void)
+{
+    SRP_Deinit();
+    SRP_Terminate();
+}
+
+/* the whole input, then 0xFF up to and including one full IBUF of padding */
+static int output_matches(int len)
+{
+    int i;
+
+    if (fake.len % IBUF_SIZE != 0 || fake.len < len + IBUF_SIZE)
+        return 0;
+    if (memcmp(fake.out, input, len) != 0)
+        return 0;
+    for (i = len; i < fake.len; i++) {
+        if (fake.out[i] != 0xFF)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* random sized calls, short writes and a busy driver, nothing lost */
+static void test_blocking(void)
+{
+    int pos = 0, size;
+
+    reset(SRP_INIT_BLOCK_MODE);
+    fake.chunk = 1000;
+    fake.room = IBUF_SIZE * 3 + 17;
+    fake.poll_refill = IBUF_SIZE * 5;
+
+    srand(1);
+    while (pos < INPUT_SIZE) {
+        size = rand() % 20000 + 1;
+        if (size > INPUT_SIZE - pos)
+            size = INPUT_SIZE - pos;
+        CHECK(SRP_Decode(&input[pos], size) == 0);
+        pos += size;
+    }
+    CHECK(SRP_Send_EOS() == 0);
+
+    CHECK(output_matches(INPUT_SIZE));
+    CHECK(fake.polls > 0);
+    CHECK(fake.poll_timeout > 0);
+    finish();
+}
+
+/* a driver that never takes data again fails the call instead of hanging */
+static void test_blocking_timeout(void)
+{
+    reset(SRP_INIT_BLOCK_MODE);
+    fake.room = 0;
+
+    CHECK(SRP_Decode(input, IBUF_SIZE * 2) == -1);
+    CHECK(fake.polls == 1);
+    CHECK(fake.poll_timeout > 0);
+    finish();
+}
+
+/* writev() taking nothing is an error, not a reason to spin */
+static void test_zero_write(void)
+{
+    reset(SRP_INIT_BLOCK_MODE);
+    fake.zero = 1;
+
+    CHECK(SRP_Decode(input, IBUF_SIZE) == -1);
+    CHECK(fake.writes == 1);
+    finish();
+}
+
+/* a busy driver: calls are staged while they fit, then refused whole */
+static void test_nonblocking(void)
+{
+    int pos = 0, size = 1500, ret, refused = 0;
+
+    reset(SRP_INIT_NONBLOCK_MODE);
+    fake.room = 0;
+
+    while (pos < INPUT_SIZE) {
+        if (size > INPUT_SIZE - pos)
+            size = INPUT_SIZE - pos;
+        ret = SRP_Decode(&input[pos], size);
+        if (ret == -EAGAIN) {
+            /* nothing of the refused call was taken, let the driver drain */
+            refused++;
+            fake.room = IBUF_SIZE;
+            continue;
+        }
+        CHECK(ret == 0);
+        if (ret != 0)
+            break;
+        pos += size;
+        if (fake.room > 0)
+            fake.room = 0;
+    }
+    CHECK(refused > 0);
+    CHECK(fake.polls == 0);
+
+    fake.room = -1;
+    CHECK(SRP_Send_EOS() == 0);
+    CHECK(output_matches(INPUT_SIZE));
+    finish();
+}
+
+int main(int argc, char **argv)
+{
+    int i;
+
+    for (i = 0; i < INPUT_SIZE; i++)
+        input[i] = (i * 31 + i / 7) & 0xFF;
+
+    test_blocking();
+    test_blocking_timeout();
+    test_zero_write();
+    test_nonblocking();
+
+    printf("srp_wbuf_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -127,6 +127,92 @@ void SsbSipMfcDecSetMFCName(char *devicename)
     mfc_dev_name = devicename;
 }
 
+/* request and map 'count' stream buffers, the depth of the input ring */
+static int mfc_dec_request_src(_MFCLIB *pCTX, unsigned int count)
+{
+    int ret;
+    unsigned int i, j;
+
+    struct v4l2_requestbuffers reqbuf;
+    struct v4l2_buffer buf;
+    struct v4l2_plane planes[MFC_DEC_NUM_PLANES];
+
+    memset(&(reqbuf), 0, sizeof (reqbuf));
+    reqbuf.count = count;
+    reqbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    reqbuf.memory = V4L2_MEMORY_MMAP;
+
+    ret = ioctl(pCTX->hMFC, VIDIOC_REQBUFS, &reqbuf);
+    if (ret != 0) {
+        ALOGE("[%s] VIDIOC_REQBUFS failed",__func__);
+        return -1;
+    }
+
+    if (reqbuf.count > MFC_DEC_MAX_SRC_BUFS)
+        reqbuf.count = MFC_DEC_MAX_SRC_BUFS;
+    pCTX->v4l2_dec.mfc_num_src_bufs   = reqbuf.count;
+
+    for (i = 0; i < pCTX->v4l2_dec.mfc_num_src_bufs; ++i) {
+        memset(&(buf), 0, sizeof (buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        buf.m.planes = planes;
+        buf.length = 1;
+
+        ret = ioctl(pCTX->hMFC, VIDIOC_QUERYBUF, &buf);
+        if (ret != 0) {
+            ALOGE("[%s] VIDIOC_QUERYBUF failed",__func__);
+            goto error;
+        }
+
+        pCTX->v4l2_dec.mfc_src_bufs[i] = mmap(NULL, buf.m.planes[0].length,
+        PROT_READ | PROT_WRITE, MAP_SHARED, pCTX->hMFC, buf.m.planes[0].m.mem_offset);
+        if (pCTX->v4l2_dec.mfc_src_bufs[i] == MAP_FAILED) {
+            ALOGE("[%s] mmap failed (%d)",__func__,i);
+            goto error;
+        }
+    }
+
+    for (i = 0; i < MFC_DEC_MAX_SRC_BUFS; i++)
+        pCTX->v4l2_dec.mfc_src_buf_flags[i] = BUF_DEQUEUED;
+
+    pCTX->v4l2_dec.beingUsedIndex = 0;
+    pCTX->v4l2_dec.src_queued_mask = 0;
+    pCTX->v4l2_dec.num_src_queued = 0;
+    pCTX->v4l2_dec.src_eos_index = -1;
+    pCTX->inter_buff_status |= MFC_USE_STRM_BUFF;
+
+    return 0;
+
+error:
+    for (j = 0; j < i; j++)
+        munmap(pCTX->v4l2_dec.mfc_src_bufs[j], pCTX->v4l2_dec.mfc_src_bufs_len);
+    pCTX->v4l2_dec.mfc_num_src_bufs = 0;
+
+    return -1;
+}
+
+static void mfc_dec_release_src(_MFCLIB *pCTX)
+{
+    struct v4l2_requestbuffers reqbuf;
+    unsigned int i;
+
+    if (!(pCTX->inter_buff_status & MFC_USE_STRM_BUFF))
+        return;
+
+    for (i = 0; i < pCTX->v4l2_dec.mfc_num_src_bufs; i++)
+        munmap(pCTX->v4l2_dec.mfc_src_bufs[i], pCTX->v4l2_dec.mfc_src_bufs_len);
+    pCTX->v4l2_dec.mfc_num_src_bufs = 0;
+    pCTX->inter_buff_status &= ~(MFC_USE_STRM_BUFF);
+
+    memset(&(reqbuf), 0, sizeof (reqbuf));
+    reqbuf.count = 0;
+    reqbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    reqbuf.memory = V4L2_MEMORY_MMAP;
+    ioctl(pCTX->hMFC, VIDIOC_REQBUFS, &reqbuf);
+}
+
 void *SsbSipMfcDecOpen(void)
 {
     int hMFCOpen;
@@ -135,14 +221,9 @@ void *SsbSipMfcDecOpen(void)
     char mfc_dev_name[64];
 
     int ret;
-    unsigned int i, j;
     struct v4l2_capability cap;
     struct v4l2_format fmt;
 
-    struct v4l2_requestbuffers reqbuf;
-    struct v4l2_buffer buf;
-    struct v4l2_plane planes[MFC_DEC_NUM_PLANES];
-
     ALOGI("[%s] MFC Library Ver %d.%02d",__func__, MFC_LIB_VER_MAJOR, MFC_LIB_VER_MINOR);
 #ifdef CONFIG_MFC_FPS
     framecount = 0;
@@ -209,41 +290,8 @@ void *SsbSipMfcDecOpen(void)
 
     pCTX->v4l2_dec.mfc_src_bufs_len = MAX_DECODER_INPUT_BUFFER_SIZE;
 
-    memset(&(reqbuf), 0, sizeof (reqbuf));
-    reqbuf.count = MFC_DEC_NUM_SRC_BUFS;
-    reqbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-    reqbuf.memory = V4L2_MEMORY_MMAP;
-
-    ret = ioctl(pCTX->hMFC, VIDIOC_REQBUFS, &reqbuf);
-    if (ret != 0) {
-        ALOGE("[%s] VIDIOC_REQBUFS failed",__func__);
+    if (mfc_dec_request_src(pCTX, MFC_DEC_NUM_SRC_BUFS) < 0)
         goto error_case2;
-    }
-
-    pCTX->v4l2_dec.mfc_num_src_bufs   = reqbuf.count;
-
-    for (i = 0; i < pCTX->v4l2_dec.mfc_num_src_bufs; ++i) {
-        memset(&(buf), 0, sizeof (buf));
-        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-        buf.memory = V4L2_MEMORY_MMAP;
-        buf.index = i;
-        buf.m.planes = planes;
-        buf.length = 1;
-
-        ret = ioctl(pCTX->hMFC, VIDIOC_QUERYBUF, &buf);
-        if (ret != 0) {
-            ALOGE("[%s] VIDIOC_QUERYBUF failed",__func__);
-            goto error_case3;
-        }
-
-        pCTX->v4l2_dec.mfc_src_bufs[i] = mmap(NULL, buf.m.planes[0].length,
-        PROT_READ | PROT_WRITE, MAP_SHARED, pCTX->hMFC, buf.m.planes[0].m.mem_offset);
-        if (pCTX->v4l2_dec.mfc_src_bufs[i] == MAP_FAILED) {
-            ALOGE("[%s] mmap failed (%d)",__func__,i);
-            goto error_case3;
-        }
-    }
-    pCTX->inter_buff_status |= MFC_USE_STRM_BUFF;
 
     /* set extra DPB size to 5 as default for optimal performce (heuristic method) */
     pCTX->dec_numextradpb = DEFAULT_NUMBER_OF_EXTRA_DPB;
@@ -253,17 +301,8 @@ void *SsbSipMfcDecOpen(void)
 
     pCTX->cacheablebuffer = NO_CACHE;
 
-    for (i = 0; i<MFC_DEC_NUM_SRC_BUFS; i++)
-        pCTX->v4l2_dec.mfc_src_buf_flags[i] = BUF_DEQUEUED;
-
-    pCTX->v4l2_dec.beingUsedIndex = 0;
-
     return (void *) pCTX;
 
-error_case3:
-    for (j = 0; j < i; j++)
-        munmap(pCTX->v4l2_dec.mfc_src_bufs[j], pCTX->v4l2_dec.mfc_src_bufs_len);
-
 error_case2:
     close(pCTX->hMFC);
 
@@ -333,11 +372,7 @@ SSBSIP_MFC_ERROR_CODE SsbSipMfcDecClose(void *openHandle)
         pCTX->inter_buff_status &= ~(MFC_USE_SRC_STREAMON);
     }
 
-    if (pCTX->inter_buff_status & MFC_USE_STRM_BUFF) {
-        for (i = 0; i < pCTX->v4l2_dec.mfc_num_src_bufs; i++)
-            munmap(pCTX->v4l2_dec.mfc_src_bufs[i], pCTX->v4l2_dec.mfc_src_bufs_len);
-        pCTX->inter_buff_status &= ~(MFC_USE_STRM_BUFF);
-    }
+    mfc_dec_release_src(pCTX);
 
     if (pCTX->inter_buff_status & MFC_USE_YUV_BUFF) {
         for (i = 0; i < pCTX->v4l2_dec.mfc_num_dst_bufs; i++) {
@@ -811,11 +846,19 @@ SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExe(void *openHandle, int lengthBufFill)
     return MFC_RET_OK;
 }
 
-#if 0
+/*
+ * Non-blocking decode: queue the stream buffer selected by GetInBuf/SetInBuf
+ * and return at once. Up to mfc_num_src_bufs buffers (MFC_DEC_SETCONF_INBUF_NUM)
+ * can be owned by the hardware, so the caller fills the next one while the
+ * previous ones are being decoded. SsbSipMfcDecWaitForOutBuf() retires them
+ * in order and reports each one to the SsbSipMfcDecSetInBufDoneCallback()
+ * callback, a retired buffer is handed out again by GetInBuf.
+ */
 SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExeNb(void *openHandle, int lengthBufFill)
 {
     _MFCLIB *pCTX;
     int ret;
+    int index;
 
     struct v4l2_buffer qbuf;
     struct v4l2_plane planes[MFC_DEC_NUM_PLANES];
@@ -834,49 +877,53 @@ SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExeNb(void *openHandle, int lengthBufFill)
     }
 
     pCTX  = (_MFCLIB *) openHandle;
+    index = pCTX->v4l2_dec.beingUsedIndex;
 
-    if ((lengthBufFill > 0) && (SSBSIP_MFC_LAST_FRAME_PROCESSED != pCTX->lastframe)) {
-        /* Queue the stream frame */
-        memset(&qbuf, 0, sizeof(qbuf));
-        qbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-        qbuf.memory = V4L2_MEMORY_MMAP;
-        qbuf.index = pCTX->v4l2_dec.beingUsedIndex;
-        qbuf.m.planes = planes;
-        qbuf.length = 1;
-        qbuf.m.planes[0].bytesused = lengthBufFill;
+    if ((lengthBufFill == 0) || (SSBSIP_MFC_LAST_FRAME_PROCESSED == pCTX->lastframe)) {
+        /* only one empty buffer is queued to drain the decoder */
+        if (pCTX->v4l2_dec.bBeingFinalized != 0 ||
+            SSBSIP_MFC_LAST_FRAME_RECEIVED == pCTX->lastframe)
+            return MFC_RET_OK;
+        lengthBufFill = 0;
+    }
 
-        ret = ioctl(pCTX->hMFC, VIDIOC_QBUF, &qbuf);
-        if (ret != 0) {
-            ALOGE("[%s] VIDIOC_QBUF failed, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE",__func__);
-            return MFC_RET_DEC_EXE_ERR;
-        }
-    } else if(pCTX->v4l2_dec.bBeingFinalized == 0) {
-        /* Queue the stream frame */
-        memset(&qbuf, 0, sizeof(qbuf));
-        qbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-        qbuf.memory = V4L2_MEMORY_MMAP;
-        qbuf.index = pCTX->v4l2_dec.beingUsedIndex;
-        qbuf.m.planes = planes;
-        qbuf.length = 1;
-        qbuf.m.planes[0].bytesused = 0;
+    if (pCTX->v4l2_dec.src_queued_mask & (1 << index)) {
+        ALOGE("[%s] stream buffer %d is still being decoded",__func__, index);
+        return MFC_RET_DEC_EXE_ERR;
+    }
 
-        ret = ioctl(pCTX->hMFC, VIDIOC_QBUF, &qbuf);
-        if (ret != 0) {
-            ALOGE("[%s] VIDIOC_QBUF failed, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE",__func__);
-            return MFC_RET_DEC_EXE_ERR;
-        }
+    /* Queue the stream frame */
+    memset(&qbuf, 0, sizeof(qbuf));
+    qbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    qbuf.memory = V4L2_MEMORY_MMAP;
+    qbuf.index = index;
+    qbuf.m.planes = planes;
+    qbuf.length = 1;
+    qbuf.m.planes[0].bytesused = lengthBufFill;
+
+    ret = ioctl(pCTX->hMFC, VIDIOC_QBUF, &qbuf);
+    if (ret != 0) {
+        ALOGE("[%s] VIDIOC_QBUF failed, V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE",__func__);
+        return MFC_RET_DEC_EXE_ERR;
     }
 
-    if ((SSBSIP_MFC_LAST_FRAME_PROCESSED != pCTX->lastframe) && (lengthBufFill == 0))
+    pCTX->v4l2_dec.src_queued_mask |= (1 << index);
+    pCTX->v4l2_dec.num_src_queued++;
+    pCTX->v4l2_dec.mfc_src_buf_flags[index] = BUF_ENQUEUED;
+
+    if (lengthBufFill == 0) {
         pCTX->lastframe = SSBSIP_MFC_LAST_FRAME_RECEIVED;
+        pCTX->v4l2_dec.src_eos_index = index;
+    }
 
     return MFC_RET_OK;
 }
 
-SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_MFC_DEC_OUTPUT_INFO *output_info)
+/* retire the oldest stream buffer, returns its index or -1 */
+static int mfc_dec_wait_src(_MFCLIB *pCTX)
 {
-    _MFCLIB *pCTX;
     int ret;
+    int index;
 
     struct v4l2_buffer qbuf;
     struct v4l2_plane planes[MFC_DEC_NUM_PLANES];
@@ -884,73 +931,84 @@ SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_
     struct pollfd poll_events;
     int poll_state;
 
-    pCTX  = (_MFCLIB *) openHandle;
-
     /* note: #define POLLOUT 0x0004 */
     poll_events.fd = pCTX->hMFC;
     poll_events.events = POLLOUT | POLLERR;
     poll_events.revents = 0;
 
-    if (SSBSIP_MFC_LAST_FRAME_PROCESSED != pCTX->lastframe) {
-        memset(&qbuf, 0, sizeof(qbuf));
-        qbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
-        qbuf.memory = V4L2_MEMORY_MMAP;
-        qbuf.m.planes = planes;
-        qbuf.length = 1;
+    memset(&qbuf, 0, sizeof(qbuf));
+    qbuf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
+    qbuf.memory = V4L2_MEMORY_MMAP;
+    qbuf.m.planes = planes;
+    qbuf.length = 1;
 
-        /* wait for decoding */
-        do {
-            poll_state = poll((struct pollfd*)&poll_events, 1, POLL_DEC_WAIT_TIMEOUT);
-            if (0 < poll_state) {
-                if (poll_events.revents & POLLOUT) { /* POLLOUT */
-                    ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
-                    if (ret == 0) {
-                        if (qbuf.flags & V4L2_BUF_FLAG_ERROR)
-                            return MFC_GETOUTBUF_STATUS_NULL;
-                        break;
-                    }
-                } else if (poll_events.revents & POLLERR) { /* POLLERR */
-                    ALOGE("[%s] POLLERR\n",__func__);
-                    return MFC_GETOUTBUF_STATUS_NULL;
-                } else {
-                    ALOGE("[%s] poll() returns 0x%x\n",__func__, poll_events.revents);
-                    return MFC_GETOUTBUF_STATUS_NULL;
-                }
-            } else if (0 > poll_state) {
-                return MFC_GETOUTBUF_STATUS_NULL;
+    /* wait for decoding */
+    do {
+        poll_state = poll((struct pollfd*)&poll_events, 1, POLL_DEC_WAIT_TIMEOUT);
+        if (0 < poll_state) {
+            if (poll_events.revents & POLLOUT) { /* POLLOUT */
+                ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
+                if (ret == 0)
+                    break;
+            } else if (poll_events.revents & POLLERR) { /* POLLERR */
+                ALOGE("[%s] POLLERR\n",__func__);
+                return -1;
+            } else {
+                ALOGE("[%s] poll() returns 0x%x\n",__func__, poll_events.revents);
+                return -1;
             }
-        } while (0 == poll_state);
+        } else if (0 > poll_state) {
+            return -1;
+        }
+    } while (0 == poll_state);
 
-        pCTX->v4l2_dec.mfc_src_buf_flags[qbuf.index] = BUF_DEQUEUED;
+    index = qbuf.index;
 
-        memset(&qbuf, 0, sizeof(qbuf));
-        qbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
-        qbuf.memory = V4L2_MEMORY_MMAP;
-        qbuf.m.planes = planes;
-        qbuf.length = MFC_DEC_NUM_PLANES;
+    pCTX->v4l2_dec.src_queued_mask &= ~(1 << index);
+    pCTX->v4l2_dec.num_src_queued--;
+    pCTX->v4l2_dec.mfc_src_buf_flags[index] = BUF_DEQUEUED;
 
-        ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
+    if ((pCTX->v4l2_dec.inbuf_done_cb != NULL) && (index != pCTX->v4l2_dec.src_eos_index))
+        pCTX->v4l2_dec.inbuf_done_cb(pCTX->v4l2_dec.inbuf_done_data,
+                                     pCTX->v4l2_dec.mfc_src_bufs[index]);
 
-        if (ret != 0) {
-            pCTX->displayStatus = MFC_GETOUTBUF_DECODING_ONLY;
-            pCTX->decOutInfo.disp_pic_frame_type = -1;
-            return SsbSipMfcDecGetOutBuf(pCTX, output_info);;
-        } else {
-            pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_DECODING;
-        }
+    if (qbuf.flags & V4L2_BUF_FLAG_ERROR)
+        return -1;
 
-        pCTX->decOutInfo.YVirAddr = pCTX->v4l2_dec.mfc_dst_bufs[qbuf.index][0];
-        pCTX->decOutInfo.CVirAddr = pCTX->v4l2_dec.mfc_dst_bufs[qbuf.index][1];
+    return index;
+}
 
-        pCTX->decOutInfo.YPhyAddr = (unsigned int)pCTX->v4l2_dec.mfc_dst_phys[qbuf.index][0];
-        pCTX->decOutInfo.CPhyAddr = (unsigned int)pCTX->v4l2_dec.mfc_dst_phys[qbuf.index][1];
+SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_MFC_DEC_OUTPUT_INFO *output_info)
+{
+    _MFCLIB *pCTX;
+    int ret;
+    int index;
 
-        if (SSBSIP_MFC_LAST_FRAME_RECEIVED == pCTX->lastframe)
-            pCTX->lastframe = SSBSIP_MFC_LAST_FRAME_PROCESSED;
-    } else if (pCTX->v4l2_dec.bBeingFinalized == 0) {
-        pCTX->lastframe = SSBSIP_MFC_LAST_FRAME_PROCESSED;
+    struct v4l2_buffer qbuf;
+    struct v4l2_plane planes[MFC_DEC_NUM_PLANES];
 
-        pCTX->v4l2_dec.bBeingFinalized = 1; /* true */
+    if (openHandle == NULL) {
+        ALOGE("[%s] openHandle is NULL",__func__);
+        return MFC_GETOUTBUF_STATUS_NULL;
+    }
+
+    pCTX  = (_MFCLIB *) openHandle;
+
+    if ((SSBSIP_MFC_LAST_FRAME_PROCESSED != pCTX->lastframe) &&
+        (pCTX->v4l2_dec.num_src_queued > 0)) {
+        int eos;
+
+        index = mfc_dec_wait_src(pCTX);
+        if (index < 0)
+            return MFC_GETOUTBUF_STATUS_NULL;
+
+        /* the empty buffer queued by ExeNb() has been retired */
+        eos = (index == pCTX->v4l2_dec.src_eos_index);
+        if (eos) {
+            pCTX->lastframe = SSBSIP_MFC_LAST_FRAME_PROCESSED;
+            pCTX->v4l2_dec.bBeingFinalized = 1; /* true */
+            pCTX->v4l2_dec.src_eos_index = -1;
+        }
 
         memset(&qbuf, 0, sizeof(qbuf));
         qbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
@@ -958,18 +1016,27 @@ SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_
         qbuf.m.planes = planes;
         qbuf.length = MFC_DEC_NUM_PLANES;
 
-        /* wait for decoding */
-        do {
-            ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
-        } while (ret != 0);
+        ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
 
-        pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_ONLY;
+        if (ret != 0) {
+            pCTX->displayStatus = eos ? MFC_GETOUTBUF_DISPLAY_END : MFC_GETOUTBUF_DECODING_ONLY;
+            pCTX->decOutInfo.disp_pic_frame_type = -1;
+            return SsbSipMfcDecGetOutBuf(pCTX, output_info);
+        } else if (eos) {
+            /* as SsbSipMfcDecExe(), the frames after the EOS buffer are display only */
+            pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_ONLY;
+        } else {
+            pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_DECODING;
+        }
 
         pCTX->decOutInfo.YVirAddr = pCTX->v4l2_dec.mfc_dst_bufs[qbuf.index][0];
         pCTX->decOutInfo.CVirAddr = pCTX->v4l2_dec.mfc_dst_bufs[qbuf.index][1];
 
         pCTX->decOutInfo.YPhyAddr = (unsigned int)pCTX->v4l2_dec.mfc_dst_phys[qbuf.index][0];
         pCTX->decOutInfo.CPhyAddr = (unsigned int)pCTX->v4l2_dec.mfc_dst_phys[qbuf.index][1];
+    } else if (pCTX->v4l2_dec.bBeingFinalized == 0) {
+        /* nothing has been queued with ExeNb() */
+        return MFC_GETOUTBUF_STATUS_NULL;
     } else {
         memset(&qbuf, 0, sizeof(qbuf));
         qbuf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
@@ -979,10 +1046,10 @@ SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_
 
         ret = ioctl(pCTX->hMFC, VIDIOC_DQBUF, &qbuf);
 
-        if (qbuf.m.planes[0].bytesused == 0) {
+        if ((ret != 0) || (qbuf.m.planes[0].bytesused == 0)) {
             pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_END;
             pCTX->decOutInfo.disp_pic_frame_type = -1;
-            return SsbSipMfcDecGetOutBuf(pCTX, output_info);;
+            return SsbSipMfcDecGetOutBuf(pCTX, output_info);
         } else {
             pCTX->displayStatus = MFC_GETOUTBUF_DISPLAY_ONLY;
         }
@@ -1015,7 +1082,23 @@ SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_
 
     return SsbSipMfcDecGetOutBuf(pCTX, output_info);
 }
-#endif
+
+SSBSIP_MFC_ERROR_CODE SsbSipMfcDecSetInBufDoneCallback(void *openHandle, SSBSIP_MFC_DEC_INBUF_DONE_CB cb, void *cbData)
+{
+    _MFCLIB *pCTX;
+
+    if (openHandle == NULL) {
+        ALOGE("[%s] openHandle is NULL",__func__);
+        return MFC_RET_INVALID_PARAM;
+    }
+
+    pCTX  = (_MFCLIB *) openHandle;
+
+    pCTX->v4l2_dec.inbuf_done_cb = cb;
+    pCTX->v4l2_dec.inbuf_done_data = cbData;
+
+    return MFC_RET_OK;
+}
 
 void  *SsbSipMfcDecGetInBuf(void *openHandle, void **phyInBuf, int inputBufferSize)
 {
@@ -1034,11 +1117,11 @@ void  *SsbSipMfcDecGetInBuf(void *openHandle, void **phyInBuf, int inputBufferSi
 
     pCTX  = (_MFCLIB *) openHandle;
 
-    for (i = 0; i < MFC_DEC_NUM_SRC_BUFS; i++)
+    for (i = 0; i < (int)pCTX->v4l2_dec.mfc_num_src_bufs; i++)
         if (BUF_DEQUEUED == pCTX->v4l2_dec.mfc_src_buf_flags[i])
             break;
 
-    if (i == MFC_DEC_NUM_SRC_BUFS) {
+    if (i == (int)pCTX->v4l2_dec.mfc_num_src_bufs) {
         ALOGV("[%s] No buffer is available.",__func__);
         return NULL;
     } else {
@@ -1064,11 +1147,11 @@ SSBSIP_MFC_ERROR_CODE SsbSipMfcDecSetInBuf(void *openHandle, void *phyInBuf, voi
 
     pCTX  = (_MFCLIB *) openHandle;
 
-    for (i = 0; i<MFC_DEC_NUM_SRC_BUFS; i++)
+    for (i = 0; i < (int)pCTX->v4l2_dec.mfc_num_src_bufs; i++)
         if (pCTX->v4l2_dec.mfc_src_bufs[i] == virInBuf)
             break;
 
-    if (i == MFC_DEC_NUM_SRC_BUFS) {
+    if (i == (int)pCTX->v4l2_dec.mfc_num_src_bufs) {
         ALOGE("[%s] Can not use the buffer",__func__);
         return MFC_RET_INVALID_PARAM;
     } else {
@@ -1178,6 +1261,31 @@ SSBSIP_MFC_ERROR_CODE SsbSipMfcDecSetConfig(void *openHandle, SSBSIP_MFC_DEC_CON
          pCTX->fimv1_res.height = (int)(fimv1_res->height);
          return MFC_RET_OK;
 
+    case MFC_DEC_SETCONF_INBUF_NUM:
+        /* the stream buffers are requested again, none may be in use yet */
+        if ((*((int *) value) < 1) || (*((int *) value) > MFC_DEC_MAX_SRC_BUFS)) {
+            ALOGE("[%s] %d input buffers, 1 to %d are supported",__func__,
+                  *((int *) value), MFC_DEC_MAX_SRC_BUFS);
+            return MFC_RET_INVALID_PARAM;
+        }
+        if (pCTX->inter_buff_status & MFC_USE_SRC_STREAMON) {
+            ALOGE("[%s] the input ring depth is set before SsbSipMfcDecInit",__func__);
+            return MFC_RET_DEC_SET_CONF_FAIL;
+        }
+        for (i = 0; i < (int)pCTX->v4l2_dec.mfc_num_src_bufs; i++) {
+            if (pCTX->v4l2_dec.mfc_src_buf_flags[i] != BUF_DEQUEUED) {
+                ALOGE("[%s] input buffer %d is in use",__func__, i);
+                return MFC_RET_DEC_SET_CONF_FAIL;
+            }
+        }
+        if ((int)pCTX->v4l2_dec.mfc_num_src_bufs == *((int *) value))
+            return MFC_RET_OK;
+
+        mfc_dec_release_src(pCTX);
+        if (mfc_dec_request_src(pCTX, *((int *) value)) < 0)
+            return MFC_RET_DEC_SET_CONF_FAIL;
+        return MFC_RET_OK;
+
     case MFC_DEC_SETCONF_IS_LAST_FRAME:
         if (SSBSIP_MFC_LAST_FRAME_PROCESSED != pCTX->lastframe) {
             pCTX->lastframe = SSBSIP_MFC_LAST_FRAME_RECEIVED;
@@ -99,7 +99,10 @@ typedef enum {
     MFC_DEC_SETCONF_IMMEDIATELY_DISPLAY,
     MFC_DEC_SETCONF_DPB_FLUSH,
     MFC_DEC_SETCONF_PIXEL_CACHE,
-    MFC_DEC_GETCONF_WIDTH_HEIGHT
+    MFC_DEC_GETCONF_WIDTH_HEIGHT,
+
+    /* depth of the ExeNb() input ring, be set before the first GetInBuf */
+    MFC_DEC_SETCONF_INBUF_NUM
 } SSBSIP_MFC_DEC_CONF;
 
 typedef enum {
@@ -329,6 +332,9 @@ typedef struct {
     int crop_right_offset;
 } SSBSIP_MFC_CROP_INFORMATION;
 
+/* called by SsbSipMfcDecWaitForOutBuf() when the hardware has consumed an input buffer */
+typedef void (*SSBSIP_MFC_DEC_INBUF_DONE_CB)(void *cbData, void *virInBuf);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -340,10 +346,11 @@ void *SsbSipMfcDecOpen(void);
 void *SsbSipMfcDecOpenExt(void *value);
 SSBSIP_MFC_ERROR_CODE SsbSipMfcDecInit(void *openHandle, SSBSIP_MFC_CODEC_TYPE codec_type, int Frameleng);
 SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExe(void *openHandle, int lengthBufFill);
-//SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExeNb(void *openHandle, int lengthBufFill);
+SSBSIP_MFC_ERROR_CODE SsbSipMfcDecExeNb(void *openHandle, int lengthBufFill);
 SSBSIP_MFC_ERROR_CODE SsbSipMfcDecClose(void *openHandle);
 void  *SsbSipMfcDecGetInBuf(void *openHandle, void **phyInBuf, int inputBufferSize);
-//SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_MFC_DEC_OUTPUT_INFO *output_info);
+SSBSIP_MFC_DEC_OUTBUF_STATUS SsbSipMfcDecWaitForOutBuf(void *openHandle, SSBSIP_MFC_DEC_OUTPUT_INFO *output_info);
+SSBSIP_MFC_ERROR_CODE SsbSipMfcDecSetInBufDoneCallback(void *openHandle, SSBSIP_MFC_DEC_INBUF_DONE_CB cb, void *cbData);
 
 #if (defined(CONFIG_VIDEO_MFC_VCM_UMP) || defined(USE_UMP))
 SSBSIP_MFC_ERROR_CODE SsbSipMfcDecSetInBuf(void *openHandle, unsigned int secure_id, int size);
@@ -57,7 +57,8 @@
 #define MFC_ENC_MAX_DST_BUFS    2 /* The maximum number of buffers */
 #define MFC_ENC_NUM_PLANES  2 /* Number of planes used by MFC Input */
 
-#define MFC_DEC_NUM_SRC_BUFS    2  /* Number of source buffers to request */
+#define MFC_DEC_NUM_SRC_BUFS    2  /* Number of source buffers to request by default */
+#define MFC_DEC_MAX_SRC_BUFS    4  /* The maximum depth of the input ring, MFC_DEC_SETCONF_INBUF_NUM */
 #define MFC_DEC_MAX_DST_BUFS    32 /* The maximum number of buffers */
 #define MFC_DEC_NUM_PLANES  2  /* Number of planes used by MFC output */
 
@@ -447,7 +448,7 @@ enum BUF_STATUS {
 };
 
 struct mfc_dec_v4l2 {
-    char *mfc_src_bufs[MFC_DEC_NUM_SRC_BUFS];                   /* information of source buffers */
+    char *mfc_src_bufs[MFC_DEC_MAX_SRC_BUFS];                   /* information of source buffers */
     char *mfc_dst_bufs[MFC_DEC_MAX_DST_BUFS][MFC_DEC_NUM_PLANES];   /* information of destination buffers */
     char *mfc_dst_phys[MFC_DEC_MAX_DST_BUFS][MFC_DEC_NUM_PLANES];   /* cma information of destination buffers */
 
@@ -457,10 +458,17 @@ struct mfc_dec_v4l2 {
     unsigned int mfc_num_src_bufs;  /* the number of source buffers */
     unsigned int mfc_num_dst_bufs;  /* the number of destination buffers */
 
-    char mfc_src_buf_flags[MFC_DEC_NUM_SRC_BUFS];
+    char mfc_src_buf_flags[MFC_DEC_MAX_SRC_BUFS];
     int bBeingFinalized;
     int allocIndex;
     int beingUsedIndex;
+
+    /* input ring for ExeNb()/WaitForOutBuf() */
+    unsigned int src_queued_mask;   /* source buffers owned by the hardware */
+    int num_src_queued;
+    int src_eos_index;              /* the empty EOS buffer, -1 if none is queued */
+    SSBSIP_MFC_DEC_INBUF_DONE_CB inbuf_done_cb;
+    void *inbuf_done_data;
 };
 
 struct mfc_enc_v4l2 {
@@ -0,0 +1,39 @@
+LOCAL_PATH := $(call my-dir)
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	../dec/src/SsbSipMfcDecAPI.c \
+	mfc_dec_nb_test.c
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/../include \
+	device/samsung/$(TARGET_BOARD_PLATFORM)/include
+
+LOCAL_MODULE := mfc_dec_nb_test
+
+LOCAL_SHARED_LIBRARIES := liblog
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host, the library keeps addresses in 32 bits
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	../dec/src/SsbSipMfcDecAPI.c \
+	mfc_dec_nb_test.c
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/../include \
+	device/samsung/$(TARGET_BOARD_PLATFORM)/include
+
+LOCAL_MODULE := mfc_dec_nb_test-host
+LOCAL_MULTILIB := 32
+
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,308 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SsbSipMfcDecExeNb()/SsbSipMfcDecWaitForOutBuf() against a fake MFC, at
+ * the default ring depth and at MFC_DEC_MAX_SRC_BUFS. The decoder context
+ * is set up by hand, the stream buffers through MFC_DEC_SETCONF_INBUF_NUM.
+ * ioctl(), poll() and mmap() are defined here and model the stream queue
+ * in order, every stream buffer yields one frame, the empty EOS buffer
+ * releases 'drain_frames' more.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "videodev2.h"
+#include "mfc_interface.h"
+#include "SsbSipMfcApi.h"
+
+#define FAKE_MFC_FD     1000
+#define STRM_SIZE       4096
+
+static char strm[MFC_DEC_MAX_SRC_BUFS][STRM_SIZE];
+static char frame[MFC_DEC_MAX_DST_BUFS][MFC_DEC_NUM_PLANES][16];
+
+static int src_fifo[MFC_DEC_MAX_SRC_BUFS + 1];
+static int src_head, src_tail;
+static int src_queued;
+static int src_count;           /* REQBUFS */
+static int mapped;
+static void *retired[MFC_DEC_MAX_SRC_BUFS];
+static int num_retired;
+static int frames_ready;
+static int drain_frames;
+static int next_dst;
+static int bad;
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("mfc_dec_nb_test: %s:%d: %s\n",                  \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+int ioctl(int fd, int req, ...)
+#else
+int ioctl(int fd, unsigned long req, ...)
+#endif
+{
+    struct v4l2_buffer *buf;
+    va_list ap;
+
+    va_start(ap, req);
+    buf = va_arg(ap, struct v4l2_buffer *);
+    va_end(ap);
+
+    if (fd != FAKE_MFC_FD) {
+        bad++;
+        return -1;
+    }
+
+    switch (req) {
+    case VIDIOC_REQBUFS:
+        src_count = ((struct v4l2_requestbuffers *)buf)->count;
+        if (src_count > MFC_DEC_MAX_SRC_BUFS)
+            ((struct v4l2_requestbuffers *)buf)->count = src_count = MFC_DEC_MAX_SRC_BUFS;
+        return 0;
+    case VIDIOC_QUERYBUF:
+        if ((int)buf->index >= src_count) {
+            bad++;
+            return -1;
+        }
+        buf->m.planes[0].length = STRM_SIZE;
+        buf->m.planes[0].m.mem_offset = buf->index * STRM_SIZE;
+        return 0;
+    case VIDIOC_QBUF:
+        if (buf->type == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE) {
+            if (src_queued == src_count || (int)buf->index >= src_count) {
+                bad++;
+                return -1;
+            }
+            src_fifo[src_tail] = buf->index;
+            src_tail = (src_tail + 1) % (MFC_DEC_MAX_SRC_BUFS + 1);
+            src_queued++;
+            if (buf->m.planes[0].bytesused == 0)
+                frames_ready += drain_frames;
+            else
+                frames_ready++;
+        }
+        return 0;
+    case VIDIOC_DQBUF:
+        if (buf->type == V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE) {
+            if (src_queued == 0) {
+                bad++;
+                return -1;
+            }
+            buf->index = src_fifo[src_head];
+            src_head = (src_head + 1) % (MFC_DEC_MAX_SRC_BUFS + 1);
+            src_queued--;
+            return 0;
+        }
+        if (frames_ready == 0) {
+            buf->m.planes[0].bytesused = 0;
+            return -1;
+        }
+        frames_ready--;
+        buf->index = next_dst;
+        buf->m.planes[0].bytesused = 16;
+        next_dst = (next_dst + 1) % 4;
+        return 0;
+    }
+
+    bad++;
+    return -1;
+}
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+    if (nfds != 1 || fds[0].fd != FAKE_MFC_FD || src_queued == 0) {
+        bad++;
+        return -1;
+    }
+    fds[0].revents = POLLOUT;
+    return 1;
+}
+
+void *mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    if (fd != FAKE_MFC_FD)
+        return (void *)syscall(SYS_mmap, addr, length, prot, flags, fd, offset);
+    if (length != STRM_SIZE || offset % STRM_SIZE != 0 || offset / STRM_SIZE >= src_count) {
+        bad++;
+        return MAP_FAILED;
+    }
+    mapped++;
+    return strm[offset / STRM_SIZE];
+}
+
+int munmap(void *addr, size_t length)
+{
+    if ((char *)addr >= strm[0] && (char *)addr < strm[MFC_DEC_MAX_SRC_BUFS]) {
+        mapped--;
+        return 0;
+    }
+    return syscall(SYS_munmap, addr, length);
+}
+
+static void inbuf_done(void *data, void *virt)
+{
+    if (data != &num_retired) {
+        bad++;
+        return;
+    }
+    retired[num_retired++ % MFC_DEC_MAX_SRC_BUFS] = virt;
+}
+
+static void init_ctx(_MFCLIB *ctx, int depth)
+{
+    int i;
+
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->hMFC = FAKE_MFC_FD;
+    ctx->lastframe = SSBSIP_MFC_LAST_FRAME_NOT_RECEIVED;
+    ctx->v4l2_dec.mfc_src_bufs_len = STRM_SIZE;
+    ctx->v4l2_dec.mfc_num_dst_bufs = 4;
+    for (i = 0; i < 4; i++) {
+        ctx->v4l2_dec.mfc_dst_bufs[i][0] = frame[i][0];
+        ctx->v4l2_dec.mfc_dst_bufs[i][1] = frame[i][1];
+    }
+
+    src_head = src_tail = src_queued = 0;
+    mapped = 0;
+    frames_ready = drain_frames = next_dst = 0;
+
+    CHECK(SsbSipMfcDecSetConfig(ctx, MFC_DEC_SETCONF_INBUF_NUM, &depth) == MFC_RET_OK);
+    CHECK((int)ctx->v4l2_dec.mfc_num_src_bufs == depth);
+    CHECK(mapped == depth);
+    CHECK(SsbSipMfcDecSetInBufDoneCallback(ctx, inbuf_done, &num_retired) == MFC_RET_OK);
+}
+
+/* fill and queue the next free stream buffer, 0 when none is free */
+static int feed(_MFCLIB *ctx, int len)
+{
+    void *virt = SsbSipMfcDecGetInBuf(ctx, NULL, STRM_SIZE);
+
+    if (virt == NULL)
+        return 0;
+    CHECK(SsbSipMfcDecSetInBuf(ctx, NULL, virt, STRM_SIZE) == MFC_RET_OK);
+    CHECK(SsbSipMfcDecExeNb(ctx, len) == MFC_RET_OK);
+    return 1;
+}
+
+static void run(int depth)
+{
+    SSBSIP_MFC_DEC_OUTPUT_INFO out;
+    _MFCLIB ctx;
+    int fed, decoded, i;
+
+    init_ctx(&ctx, depth);
+
+    /* the ring takes 'depth' buffers, then the caller waits */
+    for (i = 0; i < depth; i++)
+        CHECK(feed(&ctx, 100));
+    CHECK(!feed(&ctx, 100));
+    CHECK(ctx.v4l2_dec.num_src_queued == depth);
+
+    /* a queued buffer can not be queued again */
+    ctx.v4l2_dec.beingUsedIndex = 0;
+    CHECK(SsbSipMfcDecExeNb(&ctx, 100) == MFC_RET_DEC_EXE_ERR);
+
+    /* steady state: retire one, refill one */
+    fed = depth;
+    decoded = 0;
+    for (i = 0; i < 100; i++) {
+        num_retired = 0;
+        CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_DECODING);
+        CHECK(out.YVirAddr == frame[decoded % 4][0]);
+        /* the callback saw the oldest buffer, in queueing order */
+        CHECK(num_retired == 1 && retired[0] == strm[decoded % depth]);
+        decoded++;
+        CHECK(ctx.v4l2_dec.num_src_queued == depth - 1);
+        CHECK(feed(&ctx, 100));
+        fed++;
+    }
+
+    /* EOS: one empty buffer, the decoder then drains three frames */
+    drain_frames = 3;
+    while (ctx.v4l2_dec.num_src_queued == depth) {
+        CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_DECODING);
+        decoded++;
+    }
+    CHECK(feed(&ctx, 0));
+    CHECK(ctx.lastframe == SSBSIP_MFC_LAST_FRAME_RECEIVED);
+    /* a second EOS is not queued */
+    CHECK(SsbSipMfcDecExeNb(&ctx, 0) == MFC_RET_OK);
+
+    while (ctx.v4l2_dec.num_src_queued > 1) {
+        CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_DECODING);
+        decoded++;
+    }
+    /* retiring the EOS buffer returns the first drained frame, display only,
+     * and the empty buffer is not reported to the callback */
+    num_retired = 0;
+    CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_ONLY);
+    CHECK(num_retired == 0);
+    decoded++;
+    CHECK(ctx.lastframe == SSBSIP_MFC_LAST_FRAME_PROCESSED);
+    CHECK(decoded == fed + 1);
+
+    for (i = 0; i < 2; i++) {
+        CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_ONLY);
+        decoded++;
+    }
+    CHECK(SsbSipMfcDecWaitForOutBuf(&ctx, &out) == MFC_GETOUTBUF_DISPLAY_END);
+    CHECK(decoded == fed + drain_frames);
+
+    printf("mfc_dec_nb_test: depth %d, fed %d decoded %d\n", depth, fed, decoded);
+}
+
+int main(int argc, char **argv)
+{
+    _MFCLIB ctx;
+    int depth;
+
+    run(MFC_DEC_NUM_SRC_BUFS);
+    run(MFC_DEC_MAX_SRC_BUFS);
+
+    /* the depth is bounded, and fixed once a buffer has been handed out */
+    init_ctx(&ctx, MFC_DEC_NUM_SRC_BUFS);
+    depth = MFC_DEC_MAX_SRC_BUFS + 1;
+    CHECK(SsbSipMfcDecSetConfig(&ctx, MFC_DEC_SETCONF_INBUF_NUM, &depth) == MFC_RET_INVALID_PARAM);
+    depth = 0;
+    CHECK(SsbSipMfcDecSetConfig(&ctx, MFC_DEC_SETCONF_INBUF_NUM, &depth) == MFC_RET_INVALID_PARAM);
+    CHECK(SsbSipMfcDecGetInBuf(&ctx, NULL, STRM_SIZE) != NULL);
+    depth = MFC_DEC_MAX_SRC_BUFS;
+    CHECK(SsbSipMfcDecSetConfig(&ctx, MFC_DEC_SETCONF_INBUF_NUM, &depth) == MFC_RET_DEC_SET_CONF_FAIL);
+    CHECK((int)ctx.v4l2_dec.mfc_num_src_bufs == MFC_DEC_NUM_SRC_BUFS);
+
+    CHECK(bad == 0);
+
+    printf("mfc_dec_nb_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -15,9 +15,12 @@ SEC_OMX_INC := $(SEC_OMX_TOP)/include/
 SEC_OMX_COMPONENT := $(SEC_OMX_TOP)/component
 
 include $(SEC_OMX_TOP)/osal/Android.mk
+include $(SEC_OMX_TOP)/osal/test/Android.mk
+include $(SEC_OMX_TOP)/osal/tools/Android.mk
 include $(SEC_OMX_TOP)/core/Android.mk
 
 include $(SEC_OMX_COMPONENT)/common/Android.mk
+include $(SEC_OMX_COMPONENT)/common/test/Android.mk
 include $(SEC_OMX_COMPONENT)/video/dec/Android.mk
 include $(SEC_OMX_COMPONENT)/video/dec/h264/Android.mk
 include $(SEC_OMX_COMPONENT)/video/dec/mpeg4/Android.mk
@@ -29,6 +32,7 @@ include $(SEC_OMX_COMPONENT)/video/enc/mpeg4/Android.mk
 ifeq ($(BOARD_USE_ALP_AUDIO), true)
 include $(SEC_OMX_COMPONENT)/audio/dec/Android.mk
 include $(SEC_OMX_COMPONENT)/audio/dec/mp3/Android.mk
+include $(SEC_OMX_COMPONENT)/audio/dec/mp3/test/Android.mk
 endif
 
 endif
@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include "SEC_OMX_Macros.h"
 #include "SEC_OSAL_Event.h"
 #include "SEC_OMX_Adec.h"
@@ -91,7 +92,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -124,7 +125,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     ret = OMX_ErrorInsufficientResources;
 
 EXIT:
@@ -188,7 +189,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         SEC_OSAL_Free(temp_buffer);
         temp_buffer = NULL;
@@ -222,7 +223,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     SEC_OSAL_Free(temp_buffer);
     ret = OMX_ErrorInsufficientResources;
 
@@ -289,7 +290,7 @@ OMX_ERRORTYPE SEC_OMX_FreeBuffer(
                 }
                 pSECPort->assignedBufferNum--;
                 if (pSECPort->bufferStateAllocate[i] & HEADER_STATE_ALLOCATED) {
-                    SEC_OSAL_Free(pSECPort->bufferHeader[i]);
+                    SEC_OSAL_ArenaFree(pSECPort->bufferHeader[i]);
                     pSECPort->bufferHeader[i] = NULL;
                     pBufferHdr = NULL;
                 }
@@ -465,7 +466,7 @@ OMX_ERRORTYPE SEC_InputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             dataBuffer->nFlags = dataBuffer->bufferHeader->nFlags;
             dataBuffer->timeStamp = dataBuffer->bufferHeader->nTimeStamp;
 
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
 
             if (dataBuffer->allocSize <= dataBuffer->dataLen)
                 SEC_OSAL_Log(SEC_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", dataBuffer->allocSize, dataBuffer->dataLen);
@@ -479,6 +480,36 @@ EXIT:
     return ret;
 }
 
+static OMX_S64 SEC_AudioDecodeNowMs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (OMX_S64)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void SEC_OMX_AudioDecodeCountWakeup(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec)
+{
+    if (pAudioDec->nWakeups == 0)
+        pAudioDec->nWakeupStartTime = SEC_AudioDecodeNowMs();
+    pAudioDec->nWakeups++;
+}
+
+OMX_U32 SEC_OMX_AudioDecodeWakeupRate(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec)
+{
+    OMX_S64 elapsed;
+
+    if (pAudioDec->nWakeups == 0)
+        return 0;
+
+    elapsed = SEC_AudioDecodeNowMs() - pAudioDec->nWakeupStartTime;
+    if (elapsed <= 0)
+        return 0;
+
+    return (OMX_U32)((OMX_S64)pAudioDec->nWakeups * 1000 / elapsed);
+}
+
 static OMX_ERRORTYPE SEC_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE          ret = OMX_ErrorNone;
@@ -491,6 +522,8 @@ static OMX_ERRORTYPE SEC_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
     FunctionIn();
 
     if (bufferHeader != NULL) {
+        SEC_OMX_AudioDecodeCountWakeup((SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle);
+
         bufferHeader->nFilledLen = dataBuffer->remainDataLen;
         bufferHeader->nOffset    = 0;
         bufferHeader->nFlags     = dataBuffer->nFlags;
@@ -577,7 +610,7 @@ OMX_ERRORTYPE SEC_OutputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             pSECComponent->processData[OUTPUT_PORT_INDEX].dataBuffer = dataBuffer->bufferHeader->pBuffer;
             pSECComponent->processData[OUTPUT_PORT_INDEX].allocSize = dataBuffer->bufferHeader->nAllocLen;
 
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
         }
         SEC_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -630,6 +663,7 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_BOOL               ret = OMX_FALSE;
     SEC_OMX_BASECOMPONENT *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
     SEC_OMX_BASEPORT      *secInputPort = &pSECComponent->pSECPort[INPUT_PORT_INDEX];
     SEC_OMX_DATABUFFER    *inputUseBuffer = &pSECComponent->secDataBuffer[INPUT_PORT_INDEX];
     SEC_OMX_DATA          *inputData = &pSECComponent->processData[INPUT_PORT_INDEX];
@@ -719,7 +753,9 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
     if (flagEOF == OMX_TRUE) {
         if (pSECComponent->checkTimeStamp.needSetStartTimeStamp == OMX_TRUE) {
             /* Flush SRP buffers */
-            SRP_Flush();
+            if (pAudioDec->hSRPHandle != NULL)
+                SRP_Ctx_Flush((SRP_HANDLE)pAudioDec->hSRPHandle);
+            pAudioDec->nInputStageLen = 0;
 
             pSECComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_TRUE;
             pSECComponent->checkTimeStamp.startTimeStamp = inputData->timeStamp;
@@ -739,10 +775,24 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
     return ret;
 }
 
+/* True when the output buffer should go back now rather than gather more PCM */
+static OMX_BOOL SEC_OutputBatchReady(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec, SEC_OMX_DATABUFFER *outputUseBuffer)
+{
+    if (pAudioDec->nOutputBatchBytes == 0)
+        return OMX_TRUE;
+    if (outputUseBuffer->remainDataLen >= pAudioDec->nOutputBatchBytes)
+        return OMX_TRUE;
+    if ((outputUseBuffer->allocSize - outputUseBuffer->dataLen) < pAudioDec->nOutputChunkBytes)
+        return OMX_TRUE;
+
+    return OMX_FALSE;
+}
+
 OMX_BOOL SEC_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_BOOL               ret = OMX_FALSE;
     SEC_OMX_BASECOMPONENT *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
     SEC_OMX_BASEPORT      *secOutputPort = &pSECComponent->pSECPort[OUTPUT_PORT_INDEX];
     SEC_OMX_DATABUFFER    *outputUseBuffer = &pSECComponent->secDataBuffer[OUTPUT_PORT_INDEX];
     SEC_OMX_DATA          *outputData = &pSECComponent->processData[OUTPUT_PORT_INDEX];
@@ -771,17 +821,20 @@ OMX_BOOL SEC_Postprocess_OutputData(OMX_COMPONENTTYPE *pOMXComponent)
         if (outputData->remainDataLen <= (outputUseBuffer->allocSize - outputUseBuffer->dataLen)) {
             copySize = outputData->remainDataLen;
 
+            /* A batched buffer keeps the timestamp of its first PCM */
+            if (outputUseBuffer->dataLen == 0)
+                outputUseBuffer->timeStamp = outputData->timeStamp;
             outputUseBuffer->dataLen += copySize;
             outputUseBuffer->remainDataLen += copySize;
             outputUseBuffer->nFlags = outputData->nFlags;
-            outputUseBuffer->timeStamp = outputData->timeStamp;
 
             ret = OMX_TRUE;
 
             /* reset outputData */
             SEC_DataReset(pOMXComponent, OUTPUT_PORT_INDEX);
 
-            if ((outputUseBuffer->remainDataLen > 0) ||
+            if (((outputUseBuffer->remainDataLen > 0) &&
+                 (SEC_OutputBatchReady(pAudioDec, outputUseBuffer) == OMX_TRUE)) ||
                 (outputUseBuffer->nFlags & OMX_BUFFERFLAG_EOS) ||
                 (CHECK_PORT_BEING_FLUSHED(secOutputPort)))
                 SEC_OutputBufferReturn(pOMXComponent);
@@ -1120,6 +1173,14 @@ OMX_ERRORTYPE SEC_OMX_AudioDecodeGetConfig(
     }
 
     switch (nIndex) {
+    case OMX_IndexConfigAudioWakeupRate:
+    {
+        SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
+
+        *((OMX_U32 *)pComponentConfigStructure) = SEC_OMX_AudioDecodeWakeupRate(pAudioDec);
+        ret = OMX_ErrorNone;
+    }
+        break;
     default:
         ret = SEC_OMX_GetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -1227,7 +1288,12 @@ OMX_ERRORTYPE SEC_OMX_AudioDecodeGetExtensionIndex(
         goto EXIT;
     }
 
-    ret = SEC_OMX_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+    if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_CONFIG_AUDIO_WAKEUP_RATE) == 0) {
+        *pIndexType = OMX_IndexConfigAudioWakeupRate;
+        ret = OMX_ErrorNone;
+    } else {
+        ret = SEC_OMX_GetExtensionIndex(hComponent, cParameterName, pIndexType);
+    }
 
 EXIT:
     FunctionOut();
@@ -58,11 +58,25 @@ typedef struct _SRP_DEC_INPUT_BUFFER
 typedef struct _SEC_OMX_AUDIODEC_COMPONENT
 {
     OMX_HANDLETYPE hCodecHandle;
+    OMX_HANDLETYPE hSRPHandle;  /* SRP session of the codec, if any */
 
     OMX_BOOL bFirstFrame;
     OMX_PTR pInputBuffer;
     SRP_DEC_INPUT_BUFFER SRPDecInputBuffer[MAX_AUDIO_INPUTBUFFER_NUM];
     OMX_U32  indexInputBuffer;
+
+    /* PCM batching, an output buffer is held until it has nOutputBatchBytes */
+    OMX_U32  nOutputBatchBytes;
+    OMX_U32  nOutputChunkBytes;     /* Most PCM one decode call can produce */
+
+    /* Input coalescing, small input buffers are gathered before an SRP write */
+    OMX_U8  *pInputStage;
+    OMX_U32  nInputStageSize;
+    OMX_U32  nInputStageLen;
+
+    /* Wake-ups: SRP writes and output buffers returned */
+    OMX_U32  nWakeups;
+    OMX_S64  nWakeupStartTime;
 } SEC_OMX_AUDIODEC_COMPONENT;
 
 
@@ -123,6 +137,8 @@ OMX_ERRORTYPE SEC_OMX_AudioDecodeGetExtensionIndex(
 OMX_ERRORTYPE SEC_OMX_AudioDecodeComponentInit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_ERRORTYPE SEC_OMX_AudioDecodeComponentDeinit(OMX_IN OMX_HANDLETYPE hComponent);
 OMX_BOOL SEC_Check_BufferProcess_State(SEC_OMX_BASECOMPONENT *pSECComponent);
+void SEC_OMX_AudioDecodeCountWakeup(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec);
+OMX_U32 SEC_OMX_AudioDecodeWakeupRate(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec);
 inline void SEC_UpdateFrameSize(OMX_COMPONENTTYPE *pOMXComponent);
 
 #ifdef __cplusplus
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <cutils/properties.h>
 
 #include "SEC_OMX_Macros.h"
 #include "SEC_OMX_Basecomponent.h"
@@ -52,6 +53,86 @@ FILE *inFile;
 FILE *outFile;
 #endif
 
+/* Converts the batch duration to bytes for the current PCM format */
+static void SEC_SRP_Mp3Dec_UpdateBatch(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec, SEC_MP3_HANDLE *pMp3Dec)
+{
+    OMX_U32 nBytesPerSec = pMp3Dec->pcmParam.nSamplingRate * pMp3Dec->pcmParam.nChannels *
+                           (pMp3Dec->pcmParam.nBitPerSample / 8);
+
+    pAudioDec->nOutputBatchBytes = (OMX_U32)((OMX_U64)nBytesPerSec * pMp3Dec->nBatchMs / 1000);
+}
+
+/* Writes the staged input to the SRP */
+static OMX_S32 SEC_SRP_Mp3Dec_FlushStage(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec, SRP_HANDLE hSRP)
+{
+    OMX_S32 returnCodec;
+
+    if (pAudioDec->nInputStageLen == 0)
+        return 0;
+
+    SEC_OMX_AudioDecodeCountWakeup(pAudioDec);
+    returnCodec = SRP_Ctx_Decode(hSRP, pAudioDec->pInputStage, pAudioDec->nInputStageLen);
+    if (returnCodec >= 0)
+        pAudioDec->nInputStageLen = 0;
+
+    return returnCodec;
+}
+
+/*
+ * Hands the input to the SRP. With an input stage, buffers are gathered
+ * until a whole IBUF is ready, or EOS, so the driver sees one write per
+ * IBUF instead of one per MP3 frame. Returns the result of the last
+ * SRP_Ctx_Decode(), or 0 if the data was only staged.
+ */
+static OMX_S32 SEC_SRP_Mp3Dec_WriteInput(SEC_OMX_AUDIODEC_COMPONENT *pAudioDec, SEC_MP3_HANDLE *pMp3Dec, SEC_OMX_DATA *pInputData)
+{
+    SRP_HANDLE hSRP = (SRP_HANDLE)pMp3Dec->hSRPMp3Handle.hSRPHandle;
+    OMX_S32    returnCodec = 0;
+
+    if ((pAudioDec->pInputStage == NULL) || (pInputData->dataLen > pAudioDec->nInputStageSize)) {
+        returnCodec = SEC_SRP_Mp3Dec_FlushStage(pAudioDec, hSRP);
+        if (returnCodec < 0)
+            return returnCodec;
+
+        SEC_OMX_AudioDecodeCountWakeup(pAudioDec);
+        return SRP_Ctx_Decode(hSRP, pInputData->dataBuffer, pInputData->dataLen);
+    }
+
+    if (pMp3Dec->hSRPMp3Handle.bInputStaged == OMX_FALSE) {
+        if ((pAudioDec->nInputStageLen + pInputData->dataLen) > pAudioDec->nInputStageSize) {
+            returnCodec = SEC_SRP_Mp3Dec_FlushStage(pAudioDec, hSRP);
+            if (returnCodec < 0)
+                return returnCodec;
+        }
+
+        SEC_OSAL_Memcpy(pAudioDec->pInputStage + pAudioDec->nInputStageLen,
+                        pInputData->dataBuffer, pInputData->dataLen);
+        pAudioDec->nInputStageLen += pInputData->dataLen;
+        pMp3Dec->hSRPMp3Handle.bInputStaged = OMX_TRUE;
+    }
+
+    if ((pAudioDec->nInputStageLen >= pAudioDec->nInputStageSize) ||
+        (pInputData->nFlags & OMX_BUFFERFLAG_EOS))
+        returnCodec = SEC_SRP_Mp3Dec_FlushStage(pAudioDec, hSRP);
+
+    return returnCodec;
+}
+
+/* Staged input belongs to the buffers a flush has just returned */
+static OMX_ERRORTYPE SEC_SRP_Mp3Dec_Flush(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex)
+{
+    SEC_OMX_BASECOMPONENT      *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
+    SEC_MP3_HANDLE             *pMp3Dec = (SEC_MP3_HANDLE *)pAudioDec->hCodecHandle;
+
+    if (nPortIndex == INPUT_PORT_INDEX) {
+        pMp3Dec->hSRPMp3Handle.bInputStaged = OMX_FALSE;
+        pAudioDec->nInputStageLen = 0;
+    }
+
+    return OMX_ErrorNone;
+}
+
 OMX_ERRORTYPE SEC_SRP_Mp3Dec_GetParameter(
     OMX_IN    OMX_HANDLETYPE hComponent,
     OMX_IN    OMX_INDEXTYPE  nParamIndex,
@@ -291,6 +372,14 @@ OMX_ERRORTYPE SEC_SRP_Mp3Dec_GetConfig(
     }
 
     switch (nIndex) {
+    case OMX_IndexConfigAudioPcmBatch:
+    {
+        SEC_MP3_HANDLE *pMp3Dec = (SEC_MP3_HANDLE *)((SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle)->hCodecHandle;
+
+        *((OMX_U32 *)pComponentConfigStructure) = pMp3Dec->nBatchMs;
+        ret = OMX_ErrorNone;
+    }
+        break;
     default:
         ret = SEC_OMX_AudioDecodeGetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -334,6 +423,16 @@ OMX_ERRORTYPE SEC_SRP_Mp3Dec_SetConfig(
     }
 
     switch (nIndex) {
+    case OMX_IndexConfigAudioPcmBatch:
+    {
+        SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
+        SEC_MP3_HANDLE *pMp3Dec = (SEC_MP3_HANDLE *)pAudioDec->hCodecHandle;
+
+        pMp3Dec->nBatchMs = *((OMX_U32 *)pComponentConfigStructure);
+        SEC_SRP_Mp3Dec_UpdateBatch(pAudioDec, pMp3Dec);
+        ret = OMX_ErrorNone;
+    }
+        break;
     default:
         ret = SEC_OMX_AudioDecodeSetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
@@ -381,7 +480,12 @@ OMX_ERRORTYPE SEC_SRP_Mp3Dec_GetExtensionIndex(
         goto EXIT;
     }
 
-    ret = SEC_OMX_AudioDecodeGetExtensionIndex(hComponent, cParameterName, pIndexType);
+    if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_CONFIG_AUDIO_PCM_BATCH) == 0) {
+        *pIndexType = OMX_IndexConfigAudioPcmBatch;
+        ret = OMX_ErrorNone;
+    } else {
+        ret = SEC_OMX_AudioDecodeGetExtensionIndex(hComponent, cParameterName, pIndexType);
+    }
 
 EXIT:
     FunctionOut();
@@ -448,6 +552,9 @@ OMX_ERRORTYPE SEC_SRP_Mp3Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pSECComponent->bSaveFlagEOS = OMX_FALSE;
     pMp3Dec->hSRPMp3Handle.bConfiguredSRP = OMX_FALSE;
     pMp3Dec->hSRPMp3Handle.bSRPSendEOS = OMX_FALSE;
+    pMp3Dec->hSRPMp3Handle.bInputStaged = OMX_FALSE;
+    pAudioDec->nInputStageLen = 0;
+    pAudioDec->nWakeups = 0;
     pSECComponent->getAllDelayBuffer = OMX_FALSE;
 
 #ifdef SRP_DUMP_TO_FILE
@@ -465,9 +572,13 @@ OMX_ERRORTYPE SEC_SRP_Mp3Dec_Terminate(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE               ret = OMX_ErrorNone;
     SEC_OMX_BASECOMPONENT      *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
 
     FunctionIn();
 
+    SEC_OSAL_Log(SEC_LOG_TRACE, "wake-ups: %u total, %u/s",
+        pAudioDec->nWakeups, SEC_OMX_AudioDecodeWakeupRate(pAudioDec));
+
 #ifdef SRP_DUMP_TO_FILE
     fclose(inFile);
     fclose(outFile);
@@ -491,6 +602,7 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
     OMX_PTR                     dataBuffer = NULL;
     unsigned int                dataLen = 0;
     OMX_BOOL                    isSRPIbufOverflow = OMX_FALSE;
+    SRP_HANDLE                  hSRP = (SRP_HANDLE)pMp3Dec->hSRPMp3Handle.hSRPHandle;
 
     FunctionIn();
 
@@ -506,11 +618,11 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
 
     /* Decoding mp3 frames by SRP */
     if (pSECComponent->getAllDelayBuffer == OMX_FALSE) {
-        returnCodec = SRP_Decode(pInputData->dataBuffer, pInputData->dataLen);
+        returnCodec = SEC_SRP_Mp3Dec_WriteInput(pAudioDec, pMp3Dec, pInputData);
 
         if (returnCodec >= 0) {
             if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-                SRP_Send_EOS();
+                SRP_Ctx_Send_EOS(hSRP);
                 pMp3Dec->hSRPMp3Handle.bSRPSendEOS = OMX_TRUE;
             }
         } else if (returnCodec == SRP_ERROR_IBUF_OVERFLOW) {
@@ -520,7 +632,7 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
     }
 
     if (pMp3Dec->hSRPMp3Handle.bConfiguredSRP == OMX_FALSE) {
-        returnCodec = SRP_Get_Dec_Info(&codecDecInfo);
+        returnCodec = SRP_Ctx_Get_Dec_Info(hSRP, &codecDecInfo);
         if (returnCodec < 0) {
             SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Get_Dec_Info failed: %d", returnCodec);
             ret = OMX_ErrorHardware;
@@ -550,6 +662,7 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
             /* Change channel count and sampling rate information */
             pMp3Dec->pcmParam.nChannels = codecDecInfo.channels;
             pMp3Dec->pcmParam.nSamplingRate = codecDecInfo.sample_rate;
+            SEC_SRP_Mp3Dec_UpdateBatch(pAudioDec, pMp3Dec);
 
             /* Send Port Settings changed call back */
             (*(pSECComponent->pCallbacks->EventHandler))
@@ -578,10 +691,13 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
     }
 
     /* Get decoded data from SRP */
-    returnCodec = SRP_Get_PCM(&dataBuffer, &dataLen);
+    returnCodec = SRP_Ctx_Get_PCM(hSRP, &dataBuffer, &dataLen);
     if (dataLen > 0) {
+        /* Append to PCM already batched in this output buffer */
+        OMX_U32 nBatched = pSECComponent->secDataBuffer[OUTPUT_PORT_INDEX].dataLen;
+
         pOutputData->dataLen = dataLen;
-        SEC_OSAL_Memcpy(pOutputData->dataBuffer, dataBuffer, dataLen);
+        SEC_OSAL_Memcpy((OMX_U8 *)pOutputData->dataBuffer + nBatched, dataBuffer, dataLen);
     } else {
         pOutputData->dataLen = 0;
     }
@@ -594,7 +710,7 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
     /* Delay EOS signal until all the PCM is returned from the SRP driver. */
     if (pMp3Dec->hSRPMp3Handle.bSRPSendEOS == OMX_TRUE) {
         if (pInputData->nFlags & OMX_BUFFERFLAG_EOS) {
-            returnCodec = SRP_GetParams(SRP_STOP_EOS_STATE, &isSRPStopped);
+            returnCodec = SRP_Ctx_GetParams(hSRP, SRP_STOP_EOS_STATE, &isSRPStopped);
             if (returnCodec != 0)
                 SEC_OSAL_Log(SEC_LOG_ERROR, "Fail SRP_STOP_EOS_STATE");
             if (isSRPStopped == 1) {
@@ -611,6 +727,9 @@ OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
         }
     }
 EXIT:
+    if (ret != OMX_ErrorInputDataDecodeYet)
+        pMp3Dec->hSRPMp3Handle.bInputStaged = OMX_FALSE;
+
     FunctionOut();
 
     return ret;
@@ -686,6 +805,9 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     unsigned int                outputBufferSize = 0;
     unsigned int                outputBufferNum = 0;
     OMX_S32                     returnCodec;
+    SRP_HANDLE                  hSRP = NULL;
+    OMX_U32                     nBatchChunks = 1;
+    char                        value[PROPERTY_VALUE_MAX];
     int i = 0;
 
     FunctionIn();
@@ -731,14 +853,23 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
 
     /* Create and Init SRP */
     pMp3Dec->hSRPMp3Handle.bSRPLoaded = OMX_FALSE;
-    returnCodec = SRP_Create(SRP_INIT_BLOCK_MODE);
+    if (!SRP_Ctx_Available()) {
+        SEC_OSAL_Log(SEC_LOG_ERROR, "SRP is not available");
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT_ERROR_3;
+    }
+    returnCodec = SRP_Ctx_Create(&hSRP, SRP_INIT_BLOCK_MODE);
     if (returnCodec < 0) {
-        SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Create failed: %d", returnCodec);
-        ret = OMX_ErrorHardware;
+        SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Ctx_Create failed: %d", returnCodec);
+        if (returnCodec == SRP_ERROR_BUSY)
+            ret = OMX_ErrorInsufficientResources;
+        else
+            ret = OMX_ErrorHardware;
         goto EXIT_ERROR_3;
     }
-    pMp3Dec->hSRPMp3Handle.hSRPHandle = (OMX_HANDLETYPE)returnCodec; /* SRP's fd */
-    returnCodec = SRP_Init();
+    pMp3Dec->hSRPMp3Handle.hSRPHandle = (OMX_HANDLETYPE)hSRP;
+    pAudioDec->hSRPHandle = (OMX_HANDLETYPE)hSRP;
+    returnCodec = SRP_Ctx_Init(hSRP);
     if (returnCodec < 0) {
         SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Init failed: %d", returnCodec);
         ret = OMX_ErrorHardware;
@@ -747,7 +878,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     pMp3Dec->hSRPMp3Handle.bSRPLoaded = OMX_TRUE;
 
     /* Get input buffer info from SRP */
-    returnCodec = SRP_Get_Ibuf_Info(&pInputBuffer, &inputBufferSize, &inputBufferNum);
+    returnCodec = SRP_Ctx_Get_Ibuf_Info(hSRP, &pInputBuffer, &inputBufferSize, &inputBufferNum);
     if (returnCodec < 0) {
         SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Get_Ibuf_Info failed: %d", returnCodec);
         ret = OMX_ErrorHardware;
@@ -762,13 +893,39 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
         goto EXIT_ERROR_5;
     }
 
+    property_get(SRP_MP3_BATCH_PROPERTY, value, "0");
+    pMp3Dec->nBatchMs = atoi(value);
+
+    /* Stage for coalescing small input buffers into IBUF sized writes, only when batching */
+    if (pMp3Dec->nBatchMs > 0) {
+        pAudioDec->pInputStage = SEC_OSAL_Malloc(inputBufferSize);
+        if (pAudioDec->pInputStage == NULL) {
+            SEC_OSAL_Log(SEC_LOG_ERROR, "Input stage alloc failed");
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT_ERROR_6;
+        }
+        pAudioDec->nInputStageSize = inputBufferSize;
+    }
+    pAudioDec->nInputStageLen = 0;
+
     /* Get output buffer info from SRP */
-    returnCodec = SRP_Get_Obuf_Info(&pOutputBuffer, &outputBufferSize, &outputBufferNum);
+    returnCodec = SRP_Ctx_Get_Obuf_Info(hSRP, &pOutputBuffer, &outputBufferSize, &outputBufferNum);
     if (returnCodec < 0) {
         SEC_OSAL_Log(SEC_LOG_ERROR, "SRP_Get_Obuf_Info failed: %d", returnCodec);
         ret = OMX_ErrorHardware;
-        goto EXIT_ERROR_6;
+        goto EXIT_ERROR_7;
+    }
+
+    /* Output buffers hold enough SRP chunks for the batch at the default format */
+    if (pMp3Dec->nBatchMs > 0 && outputBufferSize > 0) {
+        OMX_U32 nBatchBytes = (OMX_U32)((OMX_U64)pMp3Dec->nBatchMs * DEFAULT_AUDIO_SAMPLING_FREQ *
+                              DEFAULT_AUDIO_CHANNELS_NUM * (DEFAULT_AUDIO_BIT_PER_SAMPLE / 8) / 1000);
+
+        nBatchChunks = (nBatchBytes + outputBufferSize - 1) / outputBufferSize;
+        if (nBatchChunks > SRP_MP3_MAX_BATCH_CHUNKS)
+            nBatchChunks = SRP_MP3_MAX_BATCH_CHUNKS;
     }
+    pAudioDec->nOutputChunkBytes = outputBufferSize;
 
     /* Set componentVersion */
     pSECComponent->componentVersion.s.nVersionMajor = VERSIONMAJOR_NUMBER;
@@ -798,7 +955,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     pSECPort = &pSECComponent->pSECPort[OUTPUT_PORT_INDEX];
     pSECPort->portDefinition.nBufferCountActual = outputBufferNum;
     pSECPort->portDefinition.nBufferCountMin = outputBufferNum;
-    pSECPort->portDefinition.nBufferSize = outputBufferSize;
+    pSECPort->portDefinition.nBufferSize = outputBufferSize * nBatchChunks;
     pSECPort->portDefinition.bEnabled = OMX_TRUE;
     SEC_OSAL_Memset(pSECPort->portDefinition.format.audio.cMIMEType, 0, MAX_OMX_MIMETYPE_SIZE);
     SEC_OSAL_Strcpy(pSECPort->portDefinition.format.audio.cMIMEType, "audio/raw");
@@ -828,6 +985,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     pMp3Dec->pcmParam.ePCMMode           = OMX_AUDIO_PCMModeLinear;
     pMp3Dec->pcmParam.eChannelMapping[0] = OMX_AUDIO_ChannelLF;
     pMp3Dec->pcmParam.eChannelMapping[1] = OMX_AUDIO_ChannelRF;
+    SEC_SRP_Mp3Dec_UpdateBatch(pAudioDec, pMp3Dec);
 
     pOMXComponent->GetParameter      = &SEC_SRP_Mp3Dec_GetParameter;
     pOMXComponent->SetParameter      = &SEC_SRP_Mp3Dec_SetParameter;
@@ -841,6 +999,7 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     pSECComponent->sec_mfc_componentInit      = &SEC_SRP_Mp3Dec_Init;
     pSECComponent->sec_mfc_componentTerminate = &SEC_SRP_Mp3Dec_Terminate;
     pSECComponent->sec_mfc_bufferProcess      = &SEC_SRP_Mp3Dec_bufferProcess;
+    pSECComponent->sec_codecFlush             = &SEC_SRP_Mp3Dec_Flush;
     pSECComponent->sec_checkInputFrame = NULL;
 
     pSECComponent->currentState = OMX_StateLoaded;
@@ -848,14 +1007,20 @@ OSCL_EXPORT_REF OMX_ERRORTYPE SEC_OMX_ComponentInit(OMX_HANDLETYPE hComponent, O
     ret = OMX_ErrorNone;
     goto EXIT; /* This function is performed successfully. */
 
+EXIT_ERROR_7:
+    if (pAudioDec->pInputStage != NULL) {
+        SEC_OSAL_Free(pAudioDec->pInputStage);
+        pAudioDec->pInputStage = NULL;
+    }
 EXIT_ERROR_6:
     SEC_OSAL_Free(pSECComponent->processData[INPUT_PORT_INDEX].dataBuffer);
     pSECComponent->processData[INPUT_PORT_INDEX].dataBuffer = NULL;
     pSECComponent->processData[INPUT_PORT_INDEX].allocSize = 0;
 EXIT_ERROR_5:
-    SRP_Deinit();
+    SRP_Ctx_Deinit(hSRP);
 EXIT_ERROR_4:
-    SRP_Terminate();
+    SRP_Ctx_Terminate(hSRP);
+    pAudioDec->hSRPHandle = NULL;
 EXIT_ERROR_3:
     SEC_OSAL_Free(pMp3Dec);
     pAudioDec->hCodecHandle = NULL;
@@ -896,9 +1061,17 @@ OMX_ERRORTYPE SEC_OMX_ComponentDeinit(OMX_HANDLETYPE hComponent)
 
     pMp3Dec = (SEC_MP3_HANDLE *)((SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle)->hCodecHandle;
     if (pMp3Dec != NULL) {
+        SEC_OMX_AUDIODEC_COMPONENT *pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle;
+
+        if (pAudioDec->pInputStage != NULL) {
+            SEC_OSAL_Free(pAudioDec->pInputStage);
+            pAudioDec->pInputStage = NULL;
+        }
         if (pMp3Dec->hSRPMp3Handle.bSRPLoaded == OMX_TRUE) {
-            SRP_Deinit();
-            SRP_Terminate();
+            SRP_Ctx_Deinit((SRP_HANDLE)pMp3Dec->hSRPMp3Handle.hSRPHandle);
+            SRP_Ctx_Terminate((SRP_HANDLE)pMp3Dec->hSRPMp3Handle.hSRPHandle);
+            pMp3Dec->hSRPMp3Handle.hSRPHandle = NULL;
+            ((SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle)->hSRPHandle = NULL;
         }
         SEC_OSAL_Free(pMp3Dec);
         ((SEC_OMX_AUDIODEC_COMPONENT *)pSECComponent->hComponentHandle)->hCodecHandle = NULL;
@@ -30,12 +30,17 @@
 #include "SEC_OMX_Def.h"
 #include "OMX_Component.h"
 
+/* PCM to gather per output buffer, in ms, 0 returns every SRP chunk */
+#define SRP_MP3_BATCH_PROPERTY      "ro.sec.omx.mp3.batch_ms"
+#define SRP_MP3_MAX_BATCH_CHUNKS    8
+
 typedef struct _SEC_SRP_MP3_HANDLE
 {
     OMX_HANDLETYPE hSRPHandle;
     OMX_BOOL       bConfiguredSRP;
     OMX_BOOL       bSRPLoaded;
     OMX_BOOL       bSRPSendEOS;
+    OMX_BOOL       bInputStaged;    /* Current input already in the stage */
     OMX_S32        returnCodec;
 } SEC_SRP_MP3_HANDLE;
 
@@ -44,6 +49,7 @@ typedef struct _SEC_MP3_HANDLE
     /* OMX Codec specific */
     OMX_AUDIO_PARAM_MP3TYPE     mp3Param;
     OMX_AUDIO_PARAM_PCMMODETYPE pcmParam;
+    OMX_U32                     nBatchMs;
 
     /* SEC SRP Codec specific */
     SEC_SRP_MP3_HANDLE      hSRPMp3Handle;
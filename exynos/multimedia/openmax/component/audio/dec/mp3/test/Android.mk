@@ -0,0 +1,71 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#              mp3_stage_test binary
+# --------------------------------------------- #
+
+# the SRP is the in-process model of libsrpapi, built with SRP_FAKE_DEVICE
+
+SRP_ALP_PATH := $(SEC_OMX_TOP)/../codecs/audio/exynos4/srp/alp
+
+MP3_STAGE_TEST_SRC := \
+	mp3_stage_test.c \
+	../SEC_OMX_Mp3dec.c \
+	../../SEC_OMX_Adec.c \
+	../../../../common/SEC_OMX_Basecomponent.c \
+	../../../../common/SEC_OMX_Baseport.c \
+	../../../../../osal/SEC_OSAL_Event.c \
+	../../../../../osal/SEC_OSAL_Queue.c \
+	../../../../../osal/SEC_OSAL_ETC.c \
+	../../../../../osal/SEC_OSAL_Mutex.c \
+	../../../../../osal/SEC_OSAL_Thread.c \
+	../../../../../osal/SEC_OSAL_Memory.c \
+	../../../../../osal/SEC_OSAL_Semaphore.c \
+	../../../../../osal/SEC_OSAL_Log.c \
+	../../../../../osal/SEC_OSAL_Trace.c \
+	../../../../../../codecs/audio/exynos4/srp/alp/src/srp_api.c \
+	../../../../../../codecs/audio/exynos4/srp/alp/src/srp_fake.c
+
+MP3_STAGE_TEST_INC := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal \
+	$(SEC_OMX_TOP)/core \
+	$(SEC_OMX_COMPONENT)/common \
+	$(SEC_OMX_COMPONENT)/audio/dec \
+	$(SEC_OMX_COMPONENT)/audio/dec/mp3 \
+	$(SRP_ALP_PATH)/include
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := $(MP3_STAGE_TEST_SRC)
+
+LOCAL_MODULE := sec_omx_mp3_stage_test
+
+LOCAL_CFLAGS := -DSRP_FAKE_DEVICE
+
+LOCAL_SHARED_LIBRARIES := libcutils libutils liblog
+
+LOCAL_C_INCLUDES := $(MP3_STAGE_TEST_INC)
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := $(MP3_STAGE_TEST_SRC)
+
+LOCAL_MODULE := sec_omx_mp3_stage_test-host
+
+LOCAL_CFLAGS := -DSRP_FAKE_DEVICE -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+
+LOCAL_C_INCLUDES := $(MP3_STAGE_TEST_INC)
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,237 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        mp3_stage_test.c
+ * @brief       MP3 decoder input staging against the SRP model of
+ *              libsrpapi built with SRP_FAKE_DEVICE
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cutils/properties.h>
+
+#include "SEC_OMX_Def.h"
+#include "SEC_OMX_Macros.h"
+#include "SEC_OMX_Basecomponent.h"
+#include "SEC_OMX_Baseport.h"
+#include "SEC_OMX_Adec.h"
+#include "library_register.h"
+#include "SEC_OMX_Mp3dec.h"
+#include "srp_api.h"
+
+#define MP3_FRAME_SIZE      418
+#define MP3_FRAMES          80
+#define MP3_FRAME_MAX       1024
+#define PCM_BUFFER_SIZE     (4608 * SRP_MP3_MAX_BATCH_CHUNKS)
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("mp3_stage_test: %s:%d: %s\n",                   \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+OMX_ERRORTYPE SEC_SRP_Mp3_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX_DATA *pInputData, SEC_OMX_DATA *pOutputData);
+
+/* the resource manager is not under test */
+OMX_ERRORTYPE SEC_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Update_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+
+/* the batch property as the component sees it, NULL when unset */
+static const char *gBatchMs;
+
+int property_get(const char *key, char *value, const char *default_value)
+{
+    const char *v = default_value;
+
+    if (strcmp(key, SRP_MP3_BATCH_PROPERTY) == 0 && gBatchMs != NULL)
+        v = gBatchMs;
+
+    strncpy(value, v, PROPERTY_VALUE_MAX - 1);
+    value[PROPERTY_VALUE_MAX - 1] = '\0';
+
+    return strlen(value);
+}
+
+static OMX_ERRORTYPE eventHandler(OMX_HANDLETYPE hComponent, OMX_PTR pAppData,
+                                  OMX_EVENTTYPE eEvent, OMX_U32 nData1,
+                                  OMX_U32 nData2, OMX_PTR pEventData)
+{
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE gCallbacks = { eventHandler, NULL, NULL };
+
+static OMX_U8 gFrame[MP3_FRAME_MAX];
+static OMX_U8 gPcm[PCM_BUFFER_SIZE];
+
+typedef struct {
+    OMX_COMPONENTTYPE           component;
+    SEC_OMX_BASECOMPONENT      *pSECComponent;
+    SEC_OMX_AUDIODEC_COMPONENT *pAudioDec;
+    SEC_MP3_HANDLE             *pMp3Dec;
+} MP3_TEST_COMPONENT;
+
+static int createComponent(MP3_TEST_COMPONENT *pTest, const char *batchMs)
+{
+    OMX_COMPONENTTYPE *pOMXComponent = &pTest->component;
+
+    gBatchMs = batchMs;
+    INIT_SET_SIZE_VERSION(pOMXComponent, OMX_COMPONENTTYPE);
+    if (SEC_OMX_ComponentInit(pOMXComponent, SEC_OMX_COMPONENT_MP3_DEC) != OMX_ErrorNone)
+        return -1;
+
+    pTest->pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    pTest->pAudioDec = (SEC_OMX_AUDIODEC_COMPONENT *)pTest->pSECComponent->hComponentHandle;
+    pTest->pMp3Dec = (SEC_MP3_HANDLE *)pTest->pAudioDec->hCodecHandle;
+
+    pOMXComponent->SetCallbacks(pOMXComponent, &gCallbacks, NULL);
+    pTest->pSECComponent->sec_mfc_componentInit(pOMXComponent);
+
+    return 0;
+}
+
+static void destroyComponent(MP3_TEST_COMPONENT *pTest)
+{
+    pTest->pSECComponent->sec_mfc_componentTerminate(&pTest->component);
+    pTest->component.ComponentDeInit(&pTest->component);
+}
+
+static OMX_ERRORTYPE decodeFrame(MP3_TEST_COMPONENT *pTest, OMX_U32 nSize, OMX_U32 nFlags)
+{
+    SEC_OMX_DATA inputData, outputData;
+
+    SEC_OSAL_Memset(&inputData, 0, sizeof(inputData));
+    SEC_OSAL_Memset(&outputData, 0, sizeof(outputData));
+    inputData.dataBuffer = gFrame;
+    inputData.dataLen = nSize;
+    inputData.allocSize = nSize;
+    inputData.nFlags = nFlags;
+    outputData.dataBuffer = gPcm;
+    outputData.allocSize = PCM_BUFFER_SIZE;
+
+    return SEC_SRP_Mp3_Decode_Block(&pTest->component, &inputData, &outputData);
+}
+
+/* property unset: no stage, every frame is its own SRP write */
+static void testUnbatched(void)
+{
+    MP3_TEST_COMPONENT test;
+    int i;
+
+    CHECK(createComponent(&test, NULL) == 0);
+    CHECK(test.pAudioDec->pInputStage == NULL);
+
+    for (i = 0; i < MP3_FRAMES; i++)
+        CHECK(decodeFrame(&test, MP3_FRAME_SIZE, 0) == OMX_ErrorNone);
+    CHECK(test.pAudioDec->nWakeups == MP3_FRAMES);
+
+    destroyComponent(&test);
+}
+
+/* property set: frames are gathered into IBUF sized writes */
+static void testBatched(void)
+{
+    MP3_TEST_COMPONENT test;
+    OMX_U32 nPerStage;
+    int i;
+
+    CHECK(createComponent(&test, "40") == 0);
+    CHECK(test.pAudioDec->pInputStage != NULL);
+    nPerStage = test.pAudioDec->nInputStageSize / MP3_FRAME_SIZE;
+
+    for (i = 0; i < MP3_FRAMES; i++)
+        CHECK(decodeFrame(&test, MP3_FRAME_SIZE, 0) == OMX_ErrorNone);
+    CHECK(test.pAudioDec->nWakeups == MP3_FRAMES / nPerStage);
+    CHECK(test.pAudioDec->nInputStageLen == (MP3_FRAMES % nPerStage) * MP3_FRAME_SIZE);
+
+    /* EOS writes out what is left */
+    decodeFrame(&test, MP3_FRAME_SIZE, OMX_BUFFERFLAG_EOS);
+    CHECK(test.pAudioDec->nWakeups == MP3_FRAMES / nPerStage + 1);
+    CHECK(test.pAudioDec->nInputStageLen == 0);
+
+    destroyComponent(&test);
+}
+
+/*
+ * A full SRP refuses the stage that the last frame completed, so that
+ * frame waits staged for a retry. Flushing the input port then drops
+ * both: the next frame after the seek must be staged, not taken for the
+ * retried one. Frames here fill the stage exactly.
+ */
+static void testFlushWhileStaged(void)
+{
+    MP3_TEST_COMPONENT test;
+    SRP_HANDLE hSRP;
+    OMX_U8 *pFill;
+    unsigned int nIbufSize, nIbufNum;
+    void *pIbuf;
+    OMX_U32 nSize;
+    int i;
+
+    CHECK(createComponent(&test, "40") == 0);
+    hSRP = (SRP_HANDLE)test.pMp3Dec->hSRPMp3Handle.hSRPHandle;
+    nSize = test.pAudioDec->nInputStageSize / 32;
+    CHECK(nSize <= MP3_FRAME_MAX);
+
+    for (i = 0; i < 31; i++)
+        CHECK(decodeFrame(&test, nSize, 0) == OMX_ErrorNone);
+
+    /* fill every IBUF behind the component's back */
+    CHECK(SRP_Ctx_Get_Ibuf_Info(hSRP, &pIbuf, &nIbufSize, &nIbufNum) == 0);
+    pFill = calloc(nIbufNum, nIbufSize);
+    CHECK(SRP_Ctx_Decode(hSRP, pFill, nIbufSize * nIbufNum) == (int)(nIbufSize * nIbufNum));
+    free(pFill);
+
+    CHECK(decodeFrame(&test, nSize, 0) == OMX_ErrorInputDataDecodeYet);
+    CHECK(test.pMp3Dec->hSRPMp3Handle.bInputStaged == OMX_TRUE);
+
+    SEC_OMX_FlushPort(&test.component, INPUT_PORT_INDEX);
+    SRP_Ctx_Flush(hSRP);
+    CHECK(test.pAudioDec->nInputStageLen == 0);
+    CHECK(test.pMp3Dec->hSRPMp3Handle.bInputStaged == OMX_FALSE);
+
+    CHECK(decodeFrame(&test, nSize, 0) == OMX_ErrorNone);
+    CHECK(test.pAudioDec->nInputStageLen == nSize);
+
+    destroyComponent(&test);
+}
+
+int main(int argc, char **argv)
+{
+    memset(gFrame, 0xA5, sizeof(gFrame));
+
+    testUnbatched();
+    testBatched();
+    testFlushWhileStaged();
+
+    printf("mp3_stage_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
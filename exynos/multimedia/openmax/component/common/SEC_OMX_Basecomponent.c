@@ -35,6 +35,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Mutex.h"
+#include "SEC_OSAL_Trace.h"
 #include "SEC_OMX_Baseport.h"
 #include "SEC_OMX_Basecomponent.h"
 #include "SEC_OMX_Resourcemanager.h"
@@ -309,7 +310,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentStateSet(OMX_COMPONENTTYPE *pOMXComponent, OMX_U3
                     while (SEC_OSAL_GetElemNum(&pSECPort->bufferQ) > 0) {
                         message = (SEC_OMX_MESSAGE*)SEC_OSAL_Dequeue(&pSECPort->bufferQ);
                         if (message != NULL)
-                            SEC_OSAL_Free(message);
+                            SEC_OSAL_ArenaFree(message);
                     }
                     ret = pSECComponent->sec_FreeTunnelBuffer(pSECPort, i);
                     if (OMX_ErrorNone != ret) {
@@ -433,6 +434,8 @@ OMX_ERRORTYPE SEC_OMX_ComponentStateSet(OMX_COMPONENTTYPE *pOMXComponent, OMX_U3
                 }
             }
 
+            SEC_OMX_Update_Resource(pOMXComponent);
+
             pSECComponent->transientState = SEC_OMX_TransStateMax;
             pSECComponent->currentState = OMX_StateExecuting;
             SEC_OSAL_SignalSet(pSECComponent->pauseEvent);
@@ -529,7 +532,9 @@ static OMX_ERRORTYPE SEC_OMX_MessageHandlerThread(OMX_PTR threadData)
     OMX_COMPONENTTYPE     *pOMXComponent = NULL;
     SEC_OMX_BASECOMPONENT *pSECComponent = NULL;
     SEC_OMX_MESSAGE       *message = NULL;
+    SEC_OMX_MESSAGE       *batch[MAX_QUEUE_ELEMENTS];
     OMX_U32                messageType = 0, portIndex = 0;
+    OMX_S32                nBatch = 0, i = 0;
 
     FunctionIn();
 
@@ -548,15 +553,49 @@ static OMX_ERRORTYPE SEC_OMX_MessageHandlerThread(OMX_PTR threadData)
 
     while (pSECComponent->bExitMessageHandlerThread == OMX_FALSE) {
         SEC_OSAL_SemaphoreWait(pSECComponent->msgSemaphoreHandle);
-        message = (SEC_OMX_MESSAGE *)SEC_OSAL_Dequeue(&pSECComponent->messageQ);
-        if (message != NULL) {
+
+        /*
+         * Take every command queued since the last wakeup, and the
+         * semaphore count each of them posted past the one just taken.
+         * A command whose post has not landed yet leaves a count behind,
+         * which only costs an empty pass.
+         */
+        nBatch = 0;
+        while ((nBatch < MAX_QUEUE_ELEMENTS) &&
+               ((batch[nBatch] = (SEC_OMX_MESSAGE *)SEC_OSAL_Dequeue(&pSECComponent->messageQ)) != NULL))
+            nBatch++;
+        for (i = 1; i < nBatch; i++) {
+            if (SEC_OSAL_SemaphoreTryWait(pSECComponent->msgSemaphoreHandle) != OMX_ErrorNone)
+                break;
+        }
+
+        for (i = 0; i < nBatch; i++) {
+            message = batch[i];
+            if (pSECComponent->bExitMessageHandlerThread == OMX_TRUE) {
+                /* queued behind the DeInit: the component is going away, drop it */
+                SEC_OSAL_ArenaFree(message);
+                continue;
+            }
             messageType = message->messageType;
             switch (messageType) {
             case OMX_CommandStateSet:
                 ret = SEC_OMX_ComponentStateSet(pOMXComponent, message->messageParam);
                 break;
             case OMX_CommandFlush:
-                ret = SEC_OMX_BufferFlushProcess(pOMXComponent, message->messageParam);
+                portIndex = message->messageParam;
+                /*
+                 * A seek flushes input then output back to back: flush both
+                 * before either port is released, so the first frame after
+                 * the seek is not decoded into the output about to be flushed.
+                 * The completions still go out input first, as sent.
+                 */
+                if ((portIndex == INPUT_PORT_INDEX) && (i + 1 < nBatch) &&
+                    (batch[i + 1]->messageType == OMX_CommandFlush) &&
+                    (batch[i + 1]->messageParam == OUTPUT_PORT_INDEX)) {
+                    SEC_OSAL_ArenaFree(batch[++i]);
+                    portIndex = ALL_PORT_INDEX;
+                }
+                ret = SEC_OMX_BufferFlushProcess(pOMXComponent, portIndex);
                 break;
             case OMX_CommandPortDisable:
                 ret = SEC_OMX_PortDisableProcess(pOMXComponent, message->messageParam);
@@ -575,7 +614,7 @@ static OMX_ERRORTYPE SEC_OMX_MessageHandlerThread(OMX_PTR threadData)
             default:
                 break;
             }
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
             message = NULL;
         }
     }
@@ -769,7 +808,7 @@ static OMX_ERRORTYPE SEC_OMX_CommandQueue(
     OMX_PTR                pCmdData)
 {
     OMX_ERRORTYPE    ret = OMX_ErrorNone;
-    SEC_OMX_MESSAGE *command = (SEC_OMX_MESSAGE *)SEC_OSAL_Malloc(sizeof(SEC_OMX_MESSAGE));
+    SEC_OMX_MESSAGE *command = (SEC_OMX_MESSAGE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_MESSAGE);
 
     if (command == NULL) {
         ret = OMX_ErrorInsufficientResources;
@@ -781,6 +820,7 @@ static OMX_ERRORTYPE SEC_OMX_CommandQueue(
 
     ret = SEC_OSAL_Queue(&pSECComponent->messageQ, (void *)command);
     if (ret != 0) {
+        SEC_OSAL_ArenaFree(command);
         ret = OMX_ErrorUndefined;
         goto EXIT;
     }
@@ -1258,6 +1298,21 @@ OMX_ERRORTYPE SEC_OMX_GetConfig(
     }
 
     switch (nIndex) {
+    case OMX_IndexConfigResourceStatus:
+        /* SEC_OMX_RM_STATUS of the MFC pool the component is charged to */
+        ret = SEC_OMX_ResourceManager_Query(pSECComponent->codecType,
+                                            (SEC_OMX_RM_STATUS *)pComponentConfigStructure);
+        if (ret == OMX_ErrorBadParameter)
+            ret = OMX_ErrorUnsupportedIndex;
+        break;
+    case OMX_IndexConfigResourceEvents:
+    {
+        SEC_OMX_RM_EVENTLIST *pEventList = (SEC_OMX_RM_EVENTLIST *)pComponentConfigStructure;
+
+        pEventList->nEvents = SEC_OMX_ResourceManager_GetEvents(pEventList->pEvents, pEventList->nMaxEvents);
+        ret = OMX_ErrorNone;
+    }
+        break;
     default:
         ret = OMX_ErrorUnsupportedIndex;
         break;
@@ -1353,7 +1408,15 @@ OMX_ERRORTYPE SEC_OMX_GetExtensionIndex(
         goto EXIT;
     }
 
-    ret = OMX_ErrorBadParameter;
+    if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_CONFIG_RESOURCE_STATUS) == 0) {
+        *pIndexType = OMX_IndexConfigResourceStatus;
+        ret = OMX_ErrorNone;
+    } else if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_CONFIG_RESOURCE_EVENTS) == 0) {
+        *pIndexType = OMX_IndexConfigResourceEvents;
+        ret = OMX_ErrorNone;
+    } else {
+        ret = OMX_ErrorBadParameter;
+    }
 
 EXIT:
     FunctionOut();
@@ -1422,6 +1485,11 @@ OMX_ERRORTYPE SEC_OMX_UseEGLImage(
     return OMX_ErrorNotImplemented;
 }
 
+static const OMX_U32 memClassSize[SEC_OMX_MEMCLASS_MAX] = {
+    sizeof(OMX_BUFFERHEADERTYPE),   /* SEC_OMX_MEMCLASS_BUFFERHEADER */
+    sizeof(SEC_OMX_MESSAGE)         /* SEC_OMX_MEMCLASS_MESSAGE */
+};
+
 OMX_ERRORTYPE SEC_OMX_BaseComponent_Constructor(
     OMX_IN OMX_HANDLETYPE hComponent)
 {
@@ -1446,6 +1514,16 @@ OMX_ERRORTYPE SEC_OMX_BaseComponent_Constructor(
     SEC_OSAL_Memset(pSECComponent, 0, sizeof(SEC_OMX_BASECOMPONENT));
     pOMXComponent->pComponentPrivate = (OMX_PTR)pSECComponent;
 
+    /* this library's copy of the trace flag */
+    SEC_OSAL_TraceInit();
+
+    ret = SEC_OSAL_ArenaCreate(&pSECComponent->hMemArena, SEC_LOG_TAG, memClassSize, SEC_OMX_MEMCLASS_MAX);
+    if (ret != OMX_ErrorNone) {
+        ret = OMX_ErrorInsufficientResources;
+        SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_ErrorInsufficientResources, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
     ret = SEC_OSAL_SemaphoreCreate(&pSECComponent->msgSemaphoreHandle);
     if (ret != OMX_ErrorNone) {
         ret = OMX_ErrorInsufficientResources;
@@ -1506,6 +1584,8 @@ OMX_ERRORTYPE SEC_OMX_BaseComponent_Destructor(
     }
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
 
+    SEC_OSAL_TraceReport(pOMXComponent);
+
     SEC_OMX_CommandQueue(pSECComponent, SEC_OMX_CommandComponentDeInit, 0, NULL);
     SEC_OSAL_SleepMillisec(0);
     SEC_OSAL_Get_SemaphoreCount(pSECComponent->msgSemaphoreHandle, &semaValue);
@@ -1522,6 +1602,10 @@ OMX_ERRORTYPE SEC_OMX_BaseComponent_Destructor(
     pSECComponent->msgSemaphoreHandle = NULL;
     SEC_OSAL_QueueTerminate(&pSECComponent->messageQ);
 
+    /* buffer headers and messages still live here were leaked by the IL client or a port */
+    SEC_OSAL_ArenaTerminate(pSECComponent->hMemArena);
+    pSECComponent->hMemArena = NULL;
+
     SEC_OSAL_Free(pSECComponent);
     pSECComponent = NULL;
 
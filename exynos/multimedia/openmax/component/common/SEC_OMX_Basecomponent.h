@@ -41,6 +41,14 @@ typedef struct _SEC_OMX_MESSAGE
     OMX_PTR pCmdData;
 } SEC_OMX_MESSAGE;
 
+/* object classes of the per-component arena (hMemArena) */
+typedef enum _SEC_OMX_MEMCLASS
+{
+    SEC_OMX_MEMCLASS_BUFFERHEADER = 0,
+    SEC_OMX_MEMCLASS_MESSAGE,
+    SEC_OMX_MEMCLASS_MAX
+} SEC_OMX_MEMCLASS;
+
 typedef struct _SEC_OMX_DATABUFFER
 {
     OMX_HANDLETYPE        bufferMutex;
@@ -86,10 +94,12 @@ typedef struct _SEC_OMX_BASECOMPONENT
 
     SEC_CODEC_TYPE           codecType;
     SEC_OMX_PRIORITYMGMTTYPE compPriority;
+    OMX_PTR                  pRMComponent; /* resource manager entry, NULL if not admitted */
     OMX_MARKTYPE             propagateMarkType;
     OMX_HANDLETYPE           compMutex;
 
     OMX_HANDLETYPE           hComponentHandle;
+    OMX_HANDLETYPE           hMemArena;
 
     /* Message Handler */
     OMX_BOOL                 bExitMessageHandlerThread;
@@ -137,6 +147,8 @@ typedef struct _SEC_OMX_BASECOMPONENT
     OMX_ERRORTYPE (*sec_mfc_componentInit)(OMX_COMPONENTTYPE *pOMXComponent);
     OMX_ERRORTYPE (*sec_mfc_componentTerminate)(OMX_COMPONENTTYPE *pOMXComponent);
     OMX_ERRORTYPE (*sec_mfc_bufferProcess) (OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX_DATA *pInputData, SEC_OMX_DATA *pOutputData);
+    /* Optional, drops codec state tied to the buffers of a flushed port */
+    OMX_ERRORTYPE (*sec_codecFlush)(OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 nPortIndex);
 
     OMX_ERRORTYPE (*sec_AllocateTunnelBuffer)(SEC_OMX_BASEPORT *pOMXBasePort, OMX_U32 nPortIndex);
     OMX_ERRORTYPE (*sec_FreeTunnelBuffer)(SEC_OMX_BASEPORT *pOMXBasePort, OMX_U32 nPortIndex);
@@ -33,6 +33,7 @@
 #include "SEC_OSAL_Event.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Mutex.h"
+#include "SEC_OSAL_Trace.h"
 
 #include "SEC_OMX_Baseport.h"
 #include "SEC_OMX_Basecomponent.h"
@@ -51,16 +52,13 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
     OMX_BUFFERHEADERTYPE  *bufferHeader = NULL;
     SEC_OMX_MESSAGE       *message = NULL;
     OMX_U32                flushNum = 0;
-    OMX_S32                semValue = 0;
 
     FunctionIn();
 
     pSECPort = &pSECComponent->pSECPort[portIndex];
     while (SEC_OSAL_GetElemNum(&pSECPort->bufferQ) > 0) {
-        SEC_OSAL_Get_SemaphoreCount(pSECComponent->pSECPort[portIndex].bufferSemID, &semValue);
-        if (semValue == 0)
-            SEC_OSAL_SemaphorePost(pSECComponent->pSECPort[portIndex].bufferSemID);
-        SEC_OSAL_SemaphoreWait(pSECComponent->pSECPort[portIndex].bufferSemID);
+        /* take the count that belongs to this buffer, if the process thread has not already */
+        SEC_OSAL_SemaphoreTryWait(pSECComponent->pSECPort[portIndex].bufferSemID);
 
         message = (SEC_OMX_MESSAGE *)SEC_OSAL_Dequeue(&pSECPort->bufferQ);
         if (message != NULL) {
@@ -73,7 +71,7 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
                 } else {
                     OMX_FillThisBuffer(pSECPort->tunneledComponent, bufferHeader);
                 }
-                SEC_OSAL_Free(message);
+                SEC_OSAL_ArenaFree(message);
                 message = NULL;
             } else if (CHECK_PORT_TUNNELED(pSECPort) && CHECK_PORT_BUFFER_SUPPLIER(pSECPort)) {
                 SEC_OSAL_Log(SEC_LOG_ERROR, "Tunneled mode is not working, Line:%d", __LINE__);
@@ -87,7 +85,7 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
                     pSECComponent->pCallbacks->EmptyBufferDone(pOMXComponent, pSECComponent->callbackData, bufferHeader);
                 }
 
-                SEC_OSAL_Free(message);
+                SEC_OSAL_ArenaFree(message);
                 message = NULL;
             }
         }
@@ -95,7 +93,7 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
 
     if (pSECComponent->secDataBuffer[portIndex].dataValid == OMX_TRUE) {
         if (CHECK_PORT_TUNNELED(pSECPort) && CHECK_PORT_BUFFER_SUPPLIER(pSECPort)) {
-            message = SEC_OSAL_Malloc(sizeof(SEC_OMX_MESSAGE));
+            message = SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_MESSAGE);
             message->pCmdData = pSECComponent->secDataBuffer[portIndex].bufferHeader;
             message->messageType = 0;
             message->messageParam = -1;
@@ -116,12 +114,8 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
         if (SEC_OSAL_GetElemNum(&pSECPort->bufferQ) != (int)pSECPort->assignedBufferNum)
             SEC_OSAL_SetElemNum(&pSECPort->bufferQ, pSECPort->assignedBufferNum);
     } else {
-        while(1) {
-            OMX_S32 cnt = 0;
-            SEC_OSAL_Get_SemaphoreCount(pSECComponent->pSECPort[portIndex].bufferSemID, &cnt);
-            if (cnt <= 0)
-                break;
-            SEC_OSAL_SemaphoreWait(pSECComponent->pSECPort[portIndex].bufferSemID);
+        while (SEC_OSAL_SemaphoreTryWait(pSECComponent->pSECPort[portIndex].bufferSemID) == OMX_ErrorNone) {
+            /* drop every count left without a buffer behind it */
         }
         SEC_OSAL_SetElemNum(&pSECPort->bufferQ, 0);
     }
@@ -132,6 +126,9 @@ OMX_ERRORTYPE SEC_OMX_FlushPort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 portIn
     pSECComponent->processData[portIndex].timeStamp     = 0;
     pSECComponent->processData[portIndex].usedDataLen   = 0;
 
+    if (pSECComponent->sec_codecFlush != NULL)
+        pSECComponent->sec_codecFlush(pOMXComponent, portIndex);
+
 EXIT:
     FunctionOut();
 
@@ -146,6 +143,7 @@ OMX_ERRORTYPE SEC_OMX_BufferFlushProcess(OMX_COMPONENTTYPE *pOMXComponent, OMX_S
     OMX_S32                portIndex = 0;
     OMX_U32                i = 0, cnt = 0;
     SEC_OMX_DATABUFFER    *flushBuffer = NULL;
+    OMX_ERRORTYPE          portRet[ALL_PORT_NUM];
 
     FunctionIn();
 
@@ -166,6 +164,7 @@ OMX_ERRORTYPE SEC_OMX_BufferFlushProcess(OMX_COMPONENTTYPE *pOMXComponent, OMX_S
 
     cnt = (nPortIndex == ALL_PORT_INDEX ) ? ALL_PORT_NUM : 1;
 
+    /* every port is flushed before any of them is released */
     for (i = 0; i < cnt; i++) {
         if (nPortIndex == ALL_PORT_INDEX)
             portIndex = i;
@@ -177,19 +176,9 @@ OMX_ERRORTYPE SEC_OMX_BufferFlushProcess(OMX_COMPONENTTYPE *pOMXComponent, OMX_S
         flushBuffer = &pSECComponent->secDataBuffer[portIndex];
 
         SEC_OSAL_MutexLock(flushBuffer->bufferMutex);
-        ret = SEC_OMX_FlushPort(pOMXComponent, portIndex);
+        portRet[i] = SEC_OMX_FlushPort(pOMXComponent, portIndex);
         SEC_OSAL_MutexUnlock(flushBuffer->bufferMutex);
 
-        pSECComponent->pSECPort[portIndex].bIsPortFlushed = OMX_FALSE;
-
-        if (ret == OMX_ErrorNone) {
-            SEC_OSAL_Log(SEC_LOG_TRACE,"OMX_CommandFlush EventCmdComplete");
-            pSECComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
-                            pSECComponent->callbackData,
-                            OMX_EventCmdComplete,
-                            OMX_CommandFlush, portIndex, NULL);
-        }
-
         if (portIndex == INPUT_PORT_INDEX) {
             pSECComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
             pSECComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_FALSE;
@@ -198,11 +187,31 @@ OMX_ERRORTYPE SEC_OMX_BufferFlushProcess(OMX_COMPONENTTYPE *pOMXComponent, OMX_S
             pSECComponent->getAllDelayBuffer = OMX_FALSE;
             pSECComponent->bSaveFlagEOS = OMX_FALSE;
             pSECComponent->reInputData = OMX_FALSE;
+            SEC_OSAL_Trace(SEC_TRACE_FLUSH_DONE, pOMXComponent, SEC_TRACE_KEY_NONE);
         } else if (portIndex == OUTPUT_PORT_INDEX) {
             pSECComponent->remainOutputData = OMX_FALSE;
         }
     }
 
+    for (i = 0; i < cnt; i++) {
+        portIndex = (nPortIndex == ALL_PORT_INDEX) ? (OMX_S32)i : nPortIndex;
+        pSECComponent->pSECPort[portIndex].bIsPortFlushed = OMX_FALSE;
+    }
+
+    for (i = 0; i < cnt; i++) {
+        portIndex = (nPortIndex == ALL_PORT_INDEX) ? (OMX_S32)i : nPortIndex;
+
+        if (portRet[i] == OMX_ErrorNone) {
+            SEC_OSAL_Log(SEC_LOG_TRACE,"OMX_CommandFlush EventCmdComplete");
+            pSECComponent->pCallbacks->EventHandler((OMX_HANDLETYPE)pOMXComponent,
+                            pSECComponent->callbackData,
+                            OMX_EventCmdComplete,
+                            OMX_CommandFlush, portIndex, NULL);
+        } else {
+            ret = portRet[i];
+        }
+    }
+
 EXIT:
     if ((ret != OMX_ErrorNone) && (pOMXComponent != NULL) && (pSECComponent != NULL)) {
             pSECComponent->pCallbacks->EventHandler(pOMXComponent,
@@ -407,7 +416,7 @@ OMX_ERRORTYPE SEC_OMX_DisablePort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 port
         if (CHECK_PORT_TUNNELED(pSECPort) && CHECK_PORT_BUFFER_SUPPLIER(pSECPort)) {
             while (SEC_OSAL_GetElemNum(&pSECPort->bufferQ) >0 ) {
                 message = (SEC_OMX_MESSAGE*)SEC_OSAL_Dequeue(&pSECPort->bufferQ);
-                SEC_OSAL_Free(message);
+                SEC_OSAL_ArenaFree(message);
             }
             ret = pSECComponent->sec_FreeTunnelBuffer(pSECPort, portIndex);
             if (OMX_ErrorNone != ret) {
@@ -421,7 +430,7 @@ OMX_ERRORTYPE SEC_OMX_DisablePort(OMX_COMPONENTTYPE *pOMXComponent, OMX_S32 port
             if (CHECK_PORT_BUFFER_SUPPLIER(pSECPort)) {
                 while (SEC_OSAL_GetElemNum(&pSECPort->bufferQ) >0 ) {
                     message = (SEC_OMX_MESSAGE*)SEC_OSAL_Dequeue(&pSECPort->bufferQ);
-                    SEC_OSAL_Free(message);
+                    SEC_OSAL_ArenaFree(message);
                 }
             }
             pSECPort->portDefinition.bPopulated = OMX_FALSE;
@@ -602,7 +611,7 @@ OMX_ERRORTYPE SEC_OMX_EmptyThisBuffer(
         ret = OMX_ErrorNone;
     }
 
-    message = SEC_OSAL_Malloc(sizeof(SEC_OMX_MESSAGE));
+    message = SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_MESSAGE);
     if (message == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -611,6 +620,8 @@ OMX_ERRORTYPE SEC_OMX_EmptyThisBuffer(
     message->messageParam = (OMX_U32) i;
     message->pCmdData = (OMX_PTR)pBuffer;
 
+    SEC_OSAL_Trace(SEC_TRACE_INPUT_ARRIVE, pOMXComponent, pBuffer->nTimeStamp);
+
     ret = SEC_OSAL_Queue(&pSECPort->bufferQ, (void *)message);
     if (ret != 0) {
         ret = OMX_ErrorUndefined;
@@ -703,7 +714,7 @@ OMX_ERRORTYPE SEC_OMX_FillThisBuffer(
         ret = OMX_ErrorNone;
     }
 
-    message = SEC_OSAL_Malloc(sizeof(SEC_OMX_MESSAGE));
+    message = SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_MESSAGE);
     if (message == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include "SEC_OMX_Resourcemanager.h"
 #include "SEC_OMX_Basecomponent.h"
@@ -39,48 +40,194 @@
 #include "SEC_OSAL_Log.h"
 
 
-#define MAX_RESOURCE_VIDEO_DEC 3 /* for Android */
-#define MAX_RESOURCE_VIDEO_ENC 1 /* for Android */
+#define MAX_RESOURCE_VIDEO_DEC 6 /* for Android */
+#define MAX_RESOURCE_VIDEO_ENC 2 /* for Android */
 
-/* Max allowable video scheduler component instance */
-static SEC_OMX_RM_COMPONENT_LIST *gpVideoDecRMComponentList = NULL;
-static SEC_OMX_RM_COMPONENT_LIST *gpVideoDecRMWaitingList = NULL;
-static SEC_OMX_RM_COMPONENT_LIST *gpVideoEncRMComponentList = NULL;
-static SEC_OMX_RM_COMPONENT_LIST *gpVideoEncRMWaitingList = NULL;
-static OMX_HANDLETYPE ghVideoRMComponentListMutex = NULL;
+/* MFC throughput in macroblocks per second */
+#define MB_PER_FRAME(w, h)              ((((w) + 15) >> 4) * (((h) + 15) >> 4))
+#define RESOURCE_VIDEO_DEC_CAPACITY     (MB_PER_FRAME(1920, 1080) * 60)
+#define RESOURCE_VIDEO_ENC_CAPACITY     (MB_PER_FRAME(1920, 1080) * 30)
+/* charged when the ports do not carry a size or frame rate yet */
+#define RESOURCE_DEFAULT_WIDTH          640
+#define RESOURCE_DEFAULT_HEIGHT         480
+#define RESOURCE_DEFAULT_FRAMERATE      30
 
+#define MAX_RESOURCE_EVENT              64 /* power of two */
+
+typedef struct _SEC_OMX_RM_POOL
+{
+    OMX_U32                    nCapacity;
+    OMX_U32                    nMaxInstances;
+    OMX_U32                    nLoad;
+    OMX_U32                    nInstances;
+    OMX_U32                    nWaiting;
+    /* admitted components, max-heap on groupPriority (lowest priority on top) */
+    SEC_OMX_RM_COMPONENT_LIST *pHeap[MAX_RESOURCE_VIDEO_DEC];
+    SEC_OMX_RM_COMPONENT_LIST *pWaitingList;
+} SEC_OMX_RM_POOL;
+
+static SEC_OMX_RM_POOL  gVideoDecRMPool = { RESOURCE_VIDEO_DEC_CAPACITY, MAX_RESOURCE_VIDEO_DEC };
+static SEC_OMX_RM_POOL  gVideoEncRMPool = { RESOURCE_VIDEO_ENC_CAPACITY, MAX_RESOURCE_VIDEO_ENC };
+static OMX_HANDLETYPE   ghVideoRMComponentListMutex = NULL;
+
+static SEC_OMX_RM_EVENT gRMEvent[MAX_RESOURCE_EVENT];
+static OMX_U32          gRMEventCount = 0;
+
+
+static SEC_OMX_RM_POOL *getPool(SEC_CODEC_TYPE codecType)
+{
+    if (codecType == HW_VIDEO_DEC_CODEC)
+        return &gVideoDecRMPool;
+    else if (codecType == HW_VIDEO_ENC_CODEC)
+        return &gVideoEncRMPool;
+
+    return NULL;
+}
+
+static OMX_U32 getComponentLoad(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    SEC_OMX_BASECOMPONENT        *pSECComponent = NULL;
+    OMX_VIDEO_PORTDEFINITIONTYPE *pVideo = NULL;
+    OMX_U32 width = 0, height = 0, framerate = 0;
+    int i;
+
+    pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+
+    if (pSECComponent->pSECPort != NULL) {
+        for (i = 0; i < ALL_PORT_NUM; i++) {
+            pVideo = &pSECComponent->pSECPort[i].portDefinition.format.video;
+            if (pVideo->nFrameWidth * pVideo->nFrameHeight > width * height) {
+                width = pVideo->nFrameWidth;
+                height = pVideo->nFrameHeight;
+            }
+            if ((pVideo->xFramerate >> 16) > framerate)
+                framerate = pVideo->xFramerate >> 16;
+        }
+    }
+
+    if ((width == 0) || (height == 0)) {
+        width = RESOURCE_DEFAULT_WIDTH;
+        height = RESOURCE_DEFAULT_HEIGHT;
+    }
+    if (framerate == 0)
+        framerate = RESOURCE_DEFAULT_FRAMERATE;
+
+    return MB_PER_FRAME(width, height) * framerate;
+}
+
+static void logEvent(SEC_OMX_RM_EVENTTYPE eventType, SEC_OMX_RM_POOL *pPool,
+                     OMX_COMPONENTTYPE *pOMXComponent, OMX_U32 groupPriority, OMX_U32 nLoad)
+{
+    SEC_OMX_RM_EVENT *pEvent = &gRMEvent[gRMEventCount & (MAX_RESOURCE_EVENT - 1)];
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    pEvent->timeStamp = (OMX_TICKS)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+    pEvent->eventType = eventType;
+    pEvent->codecType = (pPool == &gVideoDecRMPool) ? HW_VIDEO_DEC_CODEC : HW_VIDEO_ENC_CODEC;
+    pEvent->pOMXComponent = pOMXComponent;
+    pEvent->groupPriority = groupPriority;
+    pEvent->nLoad = nLoad;
+    pEvent->nPoolLoad = pPool->nLoad;
+    gRMEventCount++;
+
+    SEC_OSAL_Log(SEC_LOG_TRACE, "event %d, comp %p, priority %d, load %d, pool %d/%d",
+                 eventType, pOMXComponent, groupPriority, nLoad, pPool->nLoad, pPool->nCapacity);
+}
+
+static void heapSwap(SEC_OMX_RM_POOL *pPool, int a, int b)
+{
+    SEC_OMX_RM_COMPONENT_LIST *pTemp = pPool->pHeap[a];
+
+    pPool->pHeap[a] = pPool->pHeap[b];
+    pPool->pHeap[b] = pTemp;
+    pPool->pHeap[a]->nHeapIndex = a;
+    pPool->pHeap[b]->nHeapIndex = b;
+}
+
+static void heapUp(SEC_OMX_RM_POOL *pPool, int i)
+{
+    while (i > 0) {
+        int parent = (i - 1) >> 1;
+        if (pPool->pHeap[parent]->groupPriority >= pPool->pHeap[i]->groupPriority)
+            break;
+        heapSwap(pPool, parent, i);
+        i = parent;
+    }
+}
+
+static void heapDown(SEC_OMX_RM_POOL *pPool, int i)
+{
+    int n = pPool->nInstances;
+
+    while (1) {
+        int child = (i << 1) + 1;
+        if (child >= n)
+            break;
+        if ((child + 1 < n) &&
+            (pPool->pHeap[child + 1]->groupPriority > pPool->pHeap[child]->groupPriority))
+            child++;
+        if (pPool->pHeap[i]->groupPriority >= pPool->pHeap[child]->groupPriority)
+            break;
+        heapSwap(pPool, i, child);
+        i = child;
+    }
+}
+
+static void heapInsert(SEC_OMX_RM_POOL *pPool, SEC_OMX_RM_COMPONENT_LIST *pRMComp)
+{
+    pRMComp->nHeapIndex = pPool->nInstances;
+    pPool->pHeap[pPool->nInstances++] = pRMComp;
+    pPool->nLoad += pRMComp->nLoad;
+    heapUp(pPool, pRMComp->nHeapIndex);
+}
+
+static void heapRemove(SEC_OMX_RM_POOL *pPool, SEC_OMX_RM_COMPONENT_LIST *pRMComp)
+{
+    int i = pRMComp->nHeapIndex;
+    int last = --pPool->nInstances;
+
+    pPool->nLoad -= pRMComp->nLoad;
+    pRMComp->nHeapIndex = -1;
+
+    if (i != last) {
+        pPool->pHeap[i] = pPool->pHeap[last];
+        pPool->pHeap[i]->nHeapIndex = i;
+        heapUp(pPool, i);
+        heapDown(pPool, pPool->pHeap[i]->nHeapIndex);
+    }
+    pPool->pHeap[last] = NULL;
+}
 
 OMX_ERRORTYPE addElementList(SEC_OMX_RM_COMPONENT_LIST **ppList, OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE              ret = OMX_ErrorNone;
     SEC_OMX_RM_COMPONENT_LIST *pTempComp = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pNewComp = NULL;
     SEC_OMX_BASECOMPONENT     *pSECComponent = NULL;
 
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+
+    pNewComp = (SEC_OMX_RM_COMPONENT_LIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_RM_COMPONENT_LIST));
+    if (pNewComp == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    pNewComp->pNext = NULL;
+    pNewComp->pOMXStandComp = pOMXComponent;
+    pNewComp->groupPriority = pSECComponent->compPriority.nGroupPriority;
+    pNewComp->nLoad = 0;
+    pNewComp->nHeapIndex = -1;
+
     if (*ppList != NULL) {
         pTempComp = *ppList;
         while (pTempComp->pNext != NULL) {
             pTempComp = pTempComp->pNext;
         }
-        pTempComp->pNext = (SEC_OMX_RM_COMPONENT_LIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_RM_COMPONENT_LIST));
-        if (pTempComp->pNext == NULL) {
-            ret = OMX_ErrorInsufficientResources;
-            goto EXIT;
-        }
-        ((SEC_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->pNext = NULL;
-        ((SEC_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->pOMXStandComp = pOMXComponent;
-        ((SEC_OMX_RM_COMPONENT_LIST *)(pTempComp->pNext))->groupPriority = pSECComponent->compPriority.nGroupPriority;
-        goto EXIT;
+        pTempComp->pNext = pNewComp;
     } else {
-        *ppList = (SEC_OMX_RM_COMPONENT_LIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_RM_COMPONENT_LIST));
-        if (*ppList == NULL) {
-            ret = OMX_ErrorInsufficientResources;
-            goto EXIT;
-        }
-        pTempComp = *ppList;
-        pTempComp->pNext = NULL;
-        pTempComp->pOMXStandComp = pOMXComponent;
-        pTempComp->groupPriority = pSECComponent->compPriority.nGroupPriority;
+        *ppList = pNewComp;
     }
 
 EXIT:
@@ -128,41 +275,6 @@ EXIT:
     return ret;
 }
 
-int searchLowPriority(SEC_OMX_RM_COMPONENT_LIST *RMComp_list, OMX_U32 inComp_priority, SEC_OMX_RM_COMPONENT_LIST **outLowComp)
-{
-    int ret = 0;
-    SEC_OMX_RM_COMPONENT_LIST *pTempComp = NULL;
-    SEC_OMX_RM_COMPONENT_LIST *pCandidateComp = NULL;
-
-    if (RMComp_list == NULL)
-        ret = -1;
-
-    pTempComp = RMComp_list;
-    *outLowComp = 0;
-
-    while (pTempComp != NULL) {
-        if (pTempComp->groupPriority > inComp_priority) {
-            if (pCandidateComp != NULL) {
-                if (pCandidateComp->groupPriority < pTempComp->groupPriority)
-                    pCandidateComp = pTempComp;
-            } else {
-                pCandidateComp = pTempComp;
-            }
-        }
-
-        pTempComp = pTempComp->pNext;
-    }
-
-    *outLowComp = pCandidateComp;
-    if (pCandidateComp == NULL)
-        ret = 0;
-    else
-        ret = 1;
-
-EXIT:
-    return ret;
-}
-
 OMX_ERRORTYPE removeComponent(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE          ret = OMX_ErrorNone;
@@ -188,6 +300,144 @@ EXIT:
     return ret;
 }
 
+/*
+ * Admit pOMXComponent into pPool, pre-empting lower priority components if
+ * the pool is out of instances or throughput. Only Idle components can be
+ * pre-empted (see removeComponent), the victims are all chosen before any
+ * of them is touched so nothing is pre-empted unless it frees enough room.
+ *
+ * Victims are taken best first from the heap top: the frontier holds the
+ * heap entries whose parents have been visited, and since no child outranks
+ * its parent the walk stops at the first entry that is not below priority.
+ * Entries that are not Idle are passed over but their children still count.
+ */
+static OMX_ERRORTYPE acquireResource(SEC_OMX_RM_POOL *pPool, OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE              ret = OMX_ErrorNone;
+    SEC_OMX_BASECOMPONENT     *pSECComponent = NULL;
+    SEC_OMX_BASECOMPONENT     *pVictimComponent = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pRMComp = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pVictim = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pVictims[MAX_RESOURCE_VIDEO_DEC];
+    OMX_U32                    nFrontier[MAX_RESOURCE_VIDEO_DEC];
+    OMX_U32 priority, load;
+    OMX_U32 freeLoad, freeInstances;
+    OMX_U32 nVictims = 0, nFrontierNum = 0;
+    OMX_U32 i, top, child;
+
+    pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    priority = pSECComponent->compPriority.nGroupPriority;
+    load = getComponentLoad(pOMXComponent);
+
+    if (load > pPool->nCapacity) {
+        logEvent(SEC_OMX_RM_EVENT_REJECT, pPool, pOMXComponent, priority, load);
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    freeLoad = pPool->nCapacity - pPool->nLoad;
+    freeInstances = pPool->nMaxInstances - pPool->nInstances;
+    if (pPool->nInstances > 0)
+        nFrontier[nFrontierNum++] = 0;
+
+    /* lowest priority Idle components first */
+    while ((freeInstances == 0) || (freeLoad < load)) {
+        pVictim = NULL;
+        while ((pVictim == NULL) && (nFrontierNum > 0)) {
+            top = 0;
+            for (i = 1; i < nFrontierNum; i++) {
+                if (pPool->pHeap[nFrontier[i]]->groupPriority > pPool->pHeap[nFrontier[top]]->groupPriority)
+                    top = i;
+            }
+            i = nFrontier[top];
+            nFrontier[top] = nFrontier[--nFrontierNum];
+            if (pPool->pHeap[i]->groupPriority <= priority) {
+                nFrontierNum = 0;
+                break;
+            }
+
+            child = (i << 1) + 1;
+            if (child < pPool->nInstances)
+                nFrontier[nFrontierNum++] = child;
+            if (child + 1 < pPool->nInstances)
+                nFrontier[nFrontierNum++] = child + 1;
+
+            pVictimComponent = (SEC_OMX_BASECOMPONENT *)pPool->pHeap[i]->pOMXStandComp->pComponentPrivate;
+            if (pVictimComponent->currentState == OMX_StateIdle)
+                pVictim = pPool->pHeap[i];
+        }
+        if (pVictim == NULL) {
+            logEvent(SEC_OMX_RM_EVENT_REJECT, pPool, pOMXComponent, priority, load);
+            ret = OMX_ErrorInsufficientResources;
+            goto EXIT;
+        }
+        pVictims[nVictims++] = pVictim;
+        freeLoad += pVictim->nLoad;
+        freeInstances++;
+    }
+
+    pRMComp = (SEC_OMX_RM_COMPONENT_LIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_RM_COMPONENT_LIST));
+    if (pRMComp == NULL) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+
+    /*
+     * A victim has been told its resources are lost and is expected to go
+     * to Loaded on its own, so its share is released even if the
+     * StateSet command could not be queued.
+     */
+    for (i = 0; i < nVictims; i++) {
+        pVictim = pVictims[i];
+        heapRemove(pPool, pVictim);
+        logEvent(SEC_OMX_RM_EVENT_PREEMPT, pPool, pVictim->pOMXStandComp,
+                 pVictim->groupPriority, pVictim->nLoad);
+        pVictimComponent = (SEC_OMX_BASECOMPONENT *)pVictim->pOMXStandComp->pComponentPrivate;
+        pVictimComponent->pRMComponent = NULL;
+        if (removeComponent(pVictim->pOMXStandComp) != OMX_ErrorNone)
+            SEC_OSAL_Log(SEC_LOG_WARNING, "pre-empted component %p did not take the StateSet command",
+                         pVictim->pOMXStandComp);
+        SEC_OSAL_Free(pVictim);
+    }
+
+    pRMComp->pOMXStandComp = pOMXComponent;
+    pRMComp->groupPriority = priority;
+    pRMComp->nLoad = load;
+    pRMComp->pNext = NULL;
+
+    heapInsert(pPool, pRMComp);
+    pSECComponent->pRMComponent = pRMComp;
+    logEvent(SEC_OMX_RM_EVENT_ACQUIRE, pPool, pOMXComponent, priority, load);
+
+    ret = OMX_ErrorNone;
+
+EXIT:
+    return ret;
+}
+
+static void freePool(SEC_OMX_RM_POOL *pPool)
+{
+    SEC_OMX_RM_COMPONENT_LIST *pCurrComponent;
+    SEC_OMX_RM_COMPONENT_LIST *pNextComponent;
+    OMX_U32 i;
+
+    for (i = 0; i < pPool->nInstances; i++) {
+        SEC_OSAL_Free(pPool->pHeap[i]);
+        pPool->pHeap[i] = NULL;
+    }
+    pPool->nInstances = 0;
+    pPool->nLoad = 0;
+
+    pCurrComponent = pPool->pWaitingList;
+    while (pCurrComponent != NULL) {
+        pNextComponent = pCurrComponent->pNext;
+        SEC_OSAL_Free(pCurrComponent);
+        pCurrComponent = pNextComponent;
+    }
+    pPool->pWaitingList = NULL;
+    pPool->nWaiting = 0;
+}
+
 
 OMX_ERRORTYPE SEC_OMX_ResourceManager_Init()
 {
@@ -195,6 +445,7 @@ OMX_ERRORTYPE SEC_OMX_ResourceManager_Init()
 
     FunctionIn();
     ret = SEC_OSAL_MutexCreate(&ghVideoRMComponentListMutex);
+    gRMEventCount = 0;
     FunctionOut();
 
     return ret;
@@ -203,50 +454,13 @@ OMX_ERRORTYPE SEC_OMX_ResourceManager_Init()
 OMX_ERRORTYPE SEC_OMX_ResourceManager_Deinit()
 {
     OMX_ERRORTYPE ret = OMX_ErrorNone;
-    SEC_OMX_RM_COMPONENT_LIST *pCurrComponent;
-    SEC_OMX_RM_COMPONENT_LIST *pNextComponent;
 
     FunctionIn();
 
     SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
-    if (gpVideoDecRMComponentList) {
-        pCurrComponent = gpVideoDecRMComponentList;
-        while (pCurrComponent != NULL) {
-            pNextComponent = pCurrComponent->pNext;
-            SEC_OSAL_Free(pCurrComponent);
-            pCurrComponent = pNextComponent;
-        }
-        gpVideoDecRMComponentList = NULL;
-    }
-    if (gpVideoDecRMWaitingList) {
-        pCurrComponent = gpVideoDecRMWaitingList;
-        while (pCurrComponent != NULL) {
-            pNextComponent = pCurrComponent->pNext;
-            SEC_OSAL_Free(pCurrComponent);
-            pCurrComponent = pNextComponent;
-        }
-        gpVideoDecRMWaitingList = NULL;
-    }
-
-    if (gpVideoEncRMComponentList) {
-        pCurrComponent = gpVideoEncRMComponentList;
-        while (pCurrComponent != NULL) {
-            pNextComponent = pCurrComponent->pNext;
-            SEC_OSAL_Free(pCurrComponent);
-            pCurrComponent = pNextComponent;
-        }
-        gpVideoEncRMComponentList = NULL;
-    }
-    if (gpVideoEncRMWaitingList) {
-        pCurrComponent = gpVideoEncRMWaitingList;
-        while (pCurrComponent != NULL) {
-            pNextComponent = pCurrComponent->pNext;
-            SEC_OSAL_Free(pCurrComponent);
-            pCurrComponent = pNextComponent;
-        }
-        gpVideoEncRMWaitingList = NULL;
-    }
+    freePool(&gVideoDecRMPool);
+    freePool(&gVideoEncRMPool);
 
     SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
 
@@ -262,12 +476,9 @@ EXIT:
 
 OMX_ERRORTYPE SEC_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
 {
-    OMX_ERRORTYPE              ret = OMX_ErrorNone;
-    SEC_OMX_BASECOMPONENT     *pSECComponent = NULL;
-    SEC_OMX_RM_COMPONENT_LIST *pComponentTemp = NULL;
-    SEC_OMX_RM_COMPONENT_LIST *pComponentCandidate = NULL;
-    int numElem = 0;
-    int lowCompDetect = 0;
+    OMX_ERRORTYPE          ret = OMX_ErrorNone;
+    SEC_OMX_BASECOMPONENT *pSECComponent = NULL;
+    SEC_OMX_RM_POOL       *pPool = NULL;
 
     FunctionIn();
 
@@ -275,80 +486,19 @@ OMX_ERRORTYPE SEC_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent)
 
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
 
-    if (pSECComponent->codecType == HW_VIDEO_DEC_CODEC) {
-        pComponentTemp = gpVideoDecRMComponentList;
-        if (pComponentTemp != NULL) {
-            while (pComponentTemp) {
-                numElem++;
-                pComponentTemp = pComponentTemp->pNext;
-            }
-        } else {
-            numElem = 0;
-        }
-        if (numElem >= MAX_RESOURCE_VIDEO_DEC) {
-            lowCompDetect = searchLowPriority(gpVideoDecRMComponentList, pSECComponent->compPriority.nGroupPriority, &pComponentCandidate);
-            if (lowCompDetect <= 0) {
-                ret = OMX_ErrorInsufficientResources;
-                goto EXIT;
-            } else {
-                ret = removeComponent(pComponentCandidate->pOMXStandComp);
-                if (ret != OMX_ErrorNone) {
-                    ret = OMX_ErrorInsufficientResources;
-                    goto EXIT;
-                } else {
-                    ret = removeElementList(&gpVideoDecRMComponentList, pComponentCandidate->pOMXStandComp);
-                    ret = addElementList(&gpVideoDecRMComponentList, pOMXComponent);
-                    if (ret != OMX_ErrorNone) {
-                        ret = OMX_ErrorInsufficientResources;
-                        goto EXIT;
-                    }
-                }
-            }
-        } else {
-            ret = addElementList(&gpVideoDecRMComponentList, pOMXComponent);
-            if (ret != OMX_ErrorNone) {
-                ret = OMX_ErrorInsufficientResources;
-                goto EXIT;
-            }
-        }
-    } else if (pSECComponent->codecType == HW_VIDEO_ENC_CODEC) {
-        pComponentTemp = gpVideoEncRMComponentList;
-        if (pComponentTemp != NULL) {
-            while (pComponentTemp) {
-                numElem++;
-                pComponentTemp = pComponentTemp->pNext;
-            }
-        } else {
-            numElem = 0;
-        }
-        if (numElem >= MAX_RESOURCE_VIDEO_ENC) {
-            lowCompDetect = searchLowPriority(gpVideoEncRMComponentList, pSECComponent->compPriority.nGroupPriority, &pComponentCandidate);
-            if (lowCompDetect <= 0) {
-                ret = OMX_ErrorInsufficientResources;
-                goto EXIT;
-            } else {
-                ret = removeComponent(pComponentCandidate->pOMXStandComp);
-                if (ret != OMX_ErrorNone) {
-                    ret = OMX_ErrorInsufficientResources;
-                    goto EXIT;
-                } else {
-                    ret = removeElementList(&gpVideoEncRMComponentList, pComponentCandidate->pOMXStandComp);
-                    ret = addElementList(&gpVideoEncRMComponentList, pOMXComponent);
-                    if (ret != OMX_ErrorNone) {
-                        ret = OMX_ErrorInsufficientResources;
-                        goto EXIT;
-                    }
-                }
-            }
-        } else {
-            ret = addElementList(&gpVideoEncRMComponentList, pOMXComponent);
-            if (ret != OMX_ErrorNone) {
-                ret = OMX_ErrorInsufficientResources;
-                goto EXIT;
-            }
-        }
+    pPool = getPool(pSECComponent->codecType);
+    if (pPool == NULL) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
     }
-    ret = OMX_ErrorNone;
+
+    /* already admitted when it was woken up from the waiting list */
+    if (pSECComponent->pRMComponent != NULL) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    ret = acquireResource(pPool, pOMXComponent);
 
 EXIT:
 
@@ -363,64 +513,95 @@ OMX_ERRORTYPE SEC_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE              ret = OMX_ErrorNone;
     SEC_OMX_BASECOMPONENT     *pSECComponent = NULL;
-    SEC_OMX_RM_COMPONENT_LIST *pComponentTemp = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pRMComp = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pWaitComp = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pTempComp = NULL;
+    SEC_OMX_RM_POOL           *pPool = NULL;
     OMX_COMPONENTTYPE         *pOMXWaitComponent = NULL;
-    int numElem = 0;
 
     FunctionIn();
 
     SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    
-    if (pSECComponent->codecType == HW_VIDEO_DEC_CODEC) {
-        pComponentTemp = gpVideoDecRMWaitingList;
-        if (gpVideoDecRMComponentList == NULL) {
-            ret = OMX_ErrorUndefined;
-            goto EXIT;
-        }
 
-        ret = removeElementList(&gpVideoDecRMComponentList, pOMXComponent);
+    pPool = getPool(pSECComponent->codecType);
+    if (pPool == NULL) {
+        ret = OMX_ErrorNone;
+        goto EXIT;
+    }
+
+    pRMComp = (SEC_OMX_RM_COMPONENT_LIST *)pSECComponent->pRMComponent;
+    if (pRMComp == NULL) {
+        /* never admitted, or pre-empted */
+        ret = OMX_ErrorUndefined;
+        goto EXIT;
+    }
+
+    heapRemove(pPool, pRMComp);
+    pSECComponent->pRMComponent = NULL;
+    logEvent(SEC_OMX_RM_EVENT_RELEASE, pPool, pOMXComponent, pRMComp->groupPriority, pRMComp->nLoad);
+    SEC_OSAL_Free(pRMComp);
+
+    /* wake up the highest priority waiter, first come first served */
+    for (pTempComp = pPool->pWaitingList; pTempComp != NULL; pTempComp = pTempComp->pNext) {
+        if ((pWaitComp == NULL) || (pTempComp->groupPriority < pWaitComp->groupPriority))
+            pWaitComp = pTempComp;
+    }
+    if (pWaitComp != NULL) {
+        pOMXWaitComponent = pWaitComp->pOMXStandComp;
+        ret = acquireResource(pPool, pOMXWaitComponent);
         if (ret != OMX_ErrorNone) {
-            ret = OMX_ErrorUndefined;
+            /* keep waiting */
+            ret = OMX_ErrorNone;
             goto EXIT;
         }
-        while (pComponentTemp) {
-            numElem++;
-            pComponentTemp = pComponentTemp->pNext;
-        }
-        if (numElem > 0) {
-            pOMXWaitComponent = gpVideoDecRMWaitingList->pOMXStandComp;
-            removeElementList(&gpVideoDecRMWaitingList, pOMXWaitComponent);
-            ret = OMX_SendCommand(pOMXWaitComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
-            if (ret != OMX_ErrorNone) {
-                goto EXIT;
-            }
-        }
-    } else if (pSECComponent->codecType == HW_VIDEO_ENC_CODEC) {
-        pComponentTemp = gpVideoEncRMWaitingList;
-        if (gpVideoEncRMComponentList == NULL) {
-            ret = OMX_ErrorUndefined;
-            goto EXIT;
-        }
-
-        ret = removeElementList(&gpVideoEncRMComponentList, pOMXComponent);
+        removeElementList(&pPool->pWaitingList, pOMXWaitComponent);
+        pPool->nWaiting--;
+        logEvent(SEC_OMX_RM_EVENT_WAKE, pPool, pOMXWaitComponent,
+                 ((SEC_OMX_BASECOMPONENT *)pOMXWaitComponent->pComponentPrivate)->compPriority.nGroupPriority, 0);
+        ret = OMX_SendCommand(pOMXWaitComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
         if (ret != OMX_ErrorNone) {
-            ret = OMX_ErrorUndefined;
             goto EXIT;
         }
-        while (pComponentTemp) {
-            numElem++;
-            pComponentTemp = pComponentTemp->pNext;
-        }
-        if (numElem > 0) {
-            pOMXWaitComponent = gpVideoEncRMWaitingList->pOMXStandComp;
-            removeElementList(&gpVideoEncRMWaitingList, pOMXWaitComponent);
-            ret = OMX_SendCommand(pOMXWaitComponent, OMX_CommandStateSet, OMX_StateIdle, NULL);
-            if (ret != OMX_ErrorNone) {
-                goto EXIT;
-            }
-        }
+    }
+
+EXIT:
+
+    SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+    FunctionOut();
+
+    return ret;
+}
+
+/* recompute the load once the ports carry the real stream parameters */
+OMX_ERRORTYPE SEC_OMX_Update_Resource(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    OMX_ERRORTYPE              ret = OMX_ErrorNone;
+    SEC_OMX_BASECOMPONENT     *pSECComponent = NULL;
+    SEC_OMX_RM_COMPONENT_LIST *pRMComp = NULL;
+    SEC_OMX_RM_POOL           *pPool = NULL;
+    OMX_U32 load;
+
+    FunctionIn();
+
+    SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
+
+    pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+
+    pPool = getPool(pSECComponent->codecType);
+    pRMComp = (SEC_OMX_RM_COMPONENT_LIST *)pSECComponent->pRMComponent;
+    if ((pPool == NULL) || (pRMComp == NULL))
+        goto EXIT;
+
+    load = getComponentLoad(pOMXComponent);
+    if (load != pRMComp->nLoad) {
+        pPool->nLoad = pPool->nLoad - pRMComp->nLoad + load;
+        pRMComp->nLoad = load;
+        logEvent(SEC_OMX_RM_EVENT_UPDATE, pPool, pOMXComponent, pRMComp->groupPriority, load);
+        if (pPool->nLoad > pPool->nCapacity)
+            SEC_OSAL_Log(SEC_LOG_WARNING, "MFC overcommitted: %d/%d MB/s", pPool->nLoad, pPool->nCapacity);
     }
 
 EXIT:
@@ -436,16 +617,22 @@ OMX_ERRORTYPE SEC_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE          ret = OMX_ErrorNone;
     SEC_OMX_BASECOMPONENT *pSECComponent = NULL;
+    SEC_OMX_RM_POOL       *pPool = NULL;
 
     FunctionIn();
 
     SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    if (pSECComponent->codecType == HW_VIDEO_DEC_CODEC)
-        ret = addElementList(&gpVideoDecRMWaitingList, pOMXComponent);
-    else if (pSECComponent->codecType == HW_VIDEO_ENC_CODEC)
-        ret = addElementList(&gpVideoEncRMWaitingList, pOMXComponent);
+    pPool = getPool(pSECComponent->codecType);
+    if (pPool != NULL) {
+        ret = addElementList(&pPool->pWaitingList, pOMXComponent);
+        if (ret == OMX_ErrorNone) {
+            pPool->nWaiting++;
+            logEvent(SEC_OMX_RM_EVENT_WAIT, pPool, pOMXComponent,
+                     pSECComponent->compPriority.nGroupPriority, 0);
+        }
+    }
 
     SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
 
@@ -458,16 +645,19 @@ OMX_ERRORTYPE SEC_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent)
 {
     OMX_ERRORTYPE          ret = OMX_ErrorNone;
     SEC_OMX_BASECOMPONENT *pSECComponent = NULL;
+    SEC_OMX_RM_POOL       *pPool = NULL;
 
     FunctionIn();
 
     SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
 
     pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
-    if (pSECComponent->codecType == HW_VIDEO_DEC_CODEC)
-        ret = removeElementList(&gpVideoDecRMWaitingList, pOMXComponent);
-    else if (pSECComponent->codecType == HW_VIDEO_ENC_CODEC)
-        ret = removeElementList(&gpVideoEncRMWaitingList, pOMXComponent);
+    pPool = getPool(pSECComponent->codecType);
+    if (pPool != NULL) {
+        ret = removeElementList(&pPool->pWaitingList, pOMXComponent);
+        if (ret == OMX_ErrorNone)
+            pPool->nWaiting--;
+    }
 
     SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
 
@@ -476,3 +666,54 @@ OMX_ERRORTYPE SEC_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent)
     return ret;
 }
 
+OMX_ERRORTYPE SEC_OMX_ResourceManager_Query(SEC_CODEC_TYPE codecType, SEC_OMX_RM_STATUS *pStatus)
+{
+    OMX_ERRORTYPE    ret = OMX_ErrorNone;
+    SEC_OMX_RM_POOL *pPool = NULL;
+
+    FunctionIn();
+
+    pPool = getPool(codecType);
+    if ((pPool == NULL) || (pStatus == NULL)) {
+        ret = OMX_ErrorBadParameter;
+        goto EXIT;
+    }
+
+    SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
+    pStatus->nCapacity = pPool->nCapacity;
+    pStatus->nLoad = pPool->nLoad;
+    pStatus->nInstances = pPool->nInstances;
+    pStatus->nMaxInstances = pPool->nMaxInstances;
+    pStatus->nWaiting = pPool->nWaiting;
+    SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+EXIT:
+    FunctionOut();
+
+    return ret;
+}
+
+/* copy up to nMaxEvents of the most recent events, oldest first */
+OMX_U32 SEC_OMX_ResourceManager_GetEvents(SEC_OMX_RM_EVENT *pEvents, OMX_U32 nMaxEvents)
+{
+    OMX_U32 first, count, i;
+
+    if (pEvents == NULL)
+        return 0;
+
+    SEC_OSAL_MutexLock(ghVideoRMComponentListMutex);
+
+    count = gRMEventCount;
+    if (count > MAX_RESOURCE_EVENT)
+        count = MAX_RESOURCE_EVENT;
+    if (count > nMaxEvents)
+        count = nMaxEvents;
+    first = gRMEventCount - count;
+
+    for (i = 0; i < count; i++)
+        SEC_OSAL_Memcpy(&pEvents[i], &gRMEvent[(first + i) & (MAX_RESOURCE_EVENT - 1)], sizeof(SEC_OMX_RM_EVENT));
+
+    SEC_OSAL_MutexUnlock(ghVideoRMComponentListMutex);
+
+    return count;
+}
@@ -37,9 +37,51 @@ typedef struct _SEC_OMX_RM_COMPONENT_LIST
 {
     OMX_COMPONENTTYPE         *pOMXStandComp;
     OMX_U32                    groupPriority;
+    OMX_U32                    nLoad;       /* macroblocks per second */
+    OMX_S32                    nHeapIndex;  /* position in the pool heap, -1 if waiting */
     struct _SEC_OMX_RM_COMPONENT_LIST *pNext;
 } SEC_OMX_RM_COMPONENT_LIST;
 
+/* snapshot of one MFC pool, see SEC_OMX_ResourceManager_Query() */
+typedef struct _SEC_OMX_RM_STATUS
+{
+    OMX_U32 nCapacity;      /* macroblocks per second */
+    OMX_U32 nLoad;          /* macroblocks per second in use */
+    OMX_U32 nInstances;
+    OMX_U32 nMaxInstances;
+    OMX_U32 nWaiting;
+} SEC_OMX_RM_STATUS;
+
+typedef enum _SEC_OMX_RM_EVENTTYPE
+{
+    SEC_OMX_RM_EVENT_ACQUIRE = 0,
+    SEC_OMX_RM_EVENT_RELEASE,
+    SEC_OMX_RM_EVENT_PREEMPT,
+    SEC_OMX_RM_EVENT_REJECT,
+    SEC_OMX_RM_EVENT_WAIT,
+    SEC_OMX_RM_EVENT_WAKE,
+    SEC_OMX_RM_EVENT_UPDATE
+} SEC_OMX_RM_EVENTTYPE;
+
+typedef struct _SEC_OMX_RM_EVENT
+{
+    OMX_TICKS            timeStamp;     /* monotonic, in us */
+    SEC_OMX_RM_EVENTTYPE eventType;
+    SEC_CODEC_TYPE       codecType;
+    OMX_COMPONENTTYPE   *pOMXComponent;
+    OMX_U32              groupPriority;
+    OMX_U32              nLoad;         /* load of the component */
+    OMX_U32              nPoolLoad;     /* load of the pool after the event */
+} SEC_OMX_RM_EVENT;
+
+/* OMX_IndexConfigResourceEvents, see SEC_OMX_ResourceManager_GetEvents() */
+typedef struct _SEC_OMX_RM_EVENTLIST
+{
+    OMX_U32           nMaxEvents;   /* room in pEvents */
+    OMX_U32           nEvents;      /* filled in, oldest first */
+    SEC_OMX_RM_EVENT *pEvents;
+} SEC_OMX_RM_EVENTLIST;
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -49,8 +91,11 @@ OMX_ERRORTYPE SEC_OMX_ResourceManager_Init();
 OMX_ERRORTYPE SEC_OMX_ResourceManager_Deinit();
 OMX_ERRORTYPE SEC_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE SEC_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE SEC_OMX_Update_Resource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE SEC_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
 OMX_ERRORTYPE SEC_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent);
+OMX_ERRORTYPE SEC_OMX_ResourceManager_Query(SEC_CODEC_TYPE codecType, SEC_OMX_RM_STATUS *pStatus);
+OMX_U32 SEC_OMX_ResourceManager_GetEvents(SEC_OMX_RM_EVENT *pEvents, OMX_U32 nMaxEvents);
 
 #ifdef __cplusplus
 };
@@ -0,0 +1,114 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#                cmdq_test binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := cmdq_test.c
+
+LOCAL_MODULE := sec_omx_cmdq_test
+
+LOCAL_STATIC_LIBRARIES := libsecbasecomponent libsecosal
+LOCAL_SHARED_LIBRARIES := libcutils libutils liblog
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal \
+	$(SEC_OMX_COMPONENT)/common
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	cmdq_test.c \
+	../SEC_OMX_Basecomponent.c \
+	../SEC_OMX_Baseport.c \
+	../../../osal/SEC_OSAL_Event.c \
+	../../../osal/SEC_OSAL_Queue.c \
+	../../../osal/SEC_OSAL_ETC.c \
+	../../../osal/SEC_OSAL_Mutex.c \
+	../../../osal/SEC_OSAL_Thread.c \
+	../../../osal/SEC_OSAL_Memory.c \
+	../../../osal/SEC_OSAL_Semaphore.c \
+	../../../osal/SEC_OSAL_Log.c \
+	../../../osal/SEC_OSAL_Trace.c
+
+LOCAL_MODULE := sec_omx_cmdq_test-host
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal \
+	$(SEC_OMX_COMPONENT)/common
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# --------------------------------------------- #
+#                rm_test binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := rm_test.c
+
+LOCAL_MODULE := sec_omx_rm_test
+
+LOCAL_STATIC_LIBRARIES := libsecbasecomponent libsecosal
+LOCAL_SHARED_LIBRARIES := libSEC_OMX_Resourcemanager libcutils libutils liblog
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal \
+	$(SEC_OMX_COMPONENT)/common
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	rm_test.c \
+	../SEC_OMX_Resourcemanager.c \
+	../SEC_OMX_Basecomponent.c \
+	../SEC_OMX_Baseport.c \
+	../../../osal/SEC_OSAL_Event.c \
+	../../../osal/SEC_OSAL_Queue.c \
+	../../../osal/SEC_OSAL_ETC.c \
+	../../../osal/SEC_OSAL_Mutex.c \
+	../../../osal/SEC_OSAL_Thread.c \
+	../../../osal/SEC_OSAL_Memory.c \
+	../../../osal/SEC_OSAL_Semaphore.c \
+	../../../osal/SEC_OSAL_Log.c \
+	../../../osal/SEC_OSAL_Trace.c
+
+LOCAL_MODULE := sec_omx_rm_test-host
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal \
+	$(SEC_OMX_COMPONENT)/common
+
+include $(BUILD_HOST_EXECUTABLE)
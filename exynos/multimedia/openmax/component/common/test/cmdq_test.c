@@ -0,0 +1,381 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        cmdq_test.c
+ * @brief       Base component message handler against a stub codec:
+ *              command order inside one wakeup, DeInit cut-off and
+ *              seek to first frame latency
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "SEC_OMX_Def.h"
+#include "SEC_OMX_Macros.h"
+#include "SEC_OSAL_Memory.h"
+#include "SEC_OSAL_ETC.h"
+#include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
+#include "SEC_OMX_Basecomponent.h"
+#include "SEC_OMX_Baseport.h"
+#include "SEC_OMX_Resourcemanager.h"
+
+#ifdef __BIONIC__
+#define CMDQ_TEST_DIR           "/data/local/tmp"
+#else
+#define CMDQ_TEST_DIR           "/tmp"
+#endif
+
+#define CMDQ_TEST_MAX_EVENTS    32
+#define CMDQ_TEST_SEEK_KEY      1000
+#define CMDQ_TEST_FRAME_WAIT_MS 1000
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("cmdq_test: %s:%d: %s\n",                        \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+typedef struct {
+    OMX_EVENTTYPE event;
+    OMX_U32       data1;
+    OMX_U32       data2;
+} CMDQ_EVENT;
+
+static pthread_mutex_t gLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  gCond = PTHREAD_COND_INITIALIZER;
+static CMDQ_EVENT      gEvents[CMDQ_TEST_MAX_EVENTS];
+static int             gNumEvents;
+
+/* while set, the handler thread stops in the callback of the next completion */
+static int             gGateArmed, gGateHeld;
+
+/*
+ * Seek: once armed, the input flush completion queues one input, which the
+ * stub codec decodes as soon as the input port is back. It comes out as a
+ * frame, or is lost if the output port is still being flushed.
+ */
+static int             gSeekArmed, gFramePending, gFramesOut, gFramesDropped;
+static OMX_S64         gFirstFrameNs;
+
+/* the resource manager is not under test */
+OMX_ERRORTYPE SEC_OMX_Get_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Release_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Update_Resource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_In_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_Out_WaitForResource(OMX_COMPONENTTYPE *pOMXComponent) { return OMX_ErrorNone; }
+OMX_ERRORTYPE SEC_OMX_ResourceManager_Query(SEC_CODEC_TYPE codecType, SEC_OMX_RM_STATUS *pStatus) { return OMX_ErrorBadParameter; }
+OMX_U32 SEC_OMX_ResourceManager_GetEvents(SEC_OMX_RM_EVENT *pEvents, OMX_U32 nMaxEvents) { return 0; }
+
+static OMX_S64 nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (OMX_S64)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* stub codec: no hardware, the process thread only decodes the seek input */
+static OMX_ERRORTYPE stubInit(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE stubTerminate(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE stubBufferProcess(OMX_HANDLETYPE hComponent)
+{
+    OMX_COMPONENTTYPE     *pOMXComponent = (OMX_COMPONENTTYPE *)hComponent;
+    SEC_OMX_BASECOMPONENT *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+
+    SEC_OMX_BASEPORT      *pInputPort = &pSECComponent->pSECPort[INPUT_PORT_INDEX];
+    SEC_OMX_BASEPORT      *pOutputPort = &pSECComponent->pSECPort[OUTPUT_PORT_INDEX];
+
+    while (pSECComponent->bExitBufferProcessThread == OMX_FALSE) {
+        pthread_mutex_lock(&gLock);
+        if (gFramePending && !CHECK_PORT_BEING_FLUSHED(pInputPort)) {
+            gFramePending = 0;
+            if (CHECK_PORT_BEING_FLUSHED(pOutputPort)) {
+                gFramesDropped++;
+            } else {
+                gFirstFrameNs = nowNs();
+                SEC_OSAL_Trace(SEC_TRACE_OUTPUT_RETURN, pOMXComponent, CMDQ_TEST_SEEK_KEY);
+                gFramesOut++;
+            }
+            pthread_cond_broadcast(&gCond);
+        }
+        pthread_mutex_unlock(&gLock);
+        SEC_OSAL_SleepMillisec(1);
+    }
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE eventHandler(OMX_HANDLETYPE hComponent, OMX_PTR pAppData,
+                                  OMX_EVENTTYPE eEvent, OMX_U32 nData1,
+                                  OMX_U32 nData2, OMX_PTR pEventData)
+{
+    pthread_mutex_lock(&gLock);
+    if (gNumEvents < CMDQ_TEST_MAX_EVENTS) {
+        gEvents[gNumEvents].event = eEvent;
+        gEvents[gNumEvents].data1 = nData1;
+        gEvents[gNumEvents].data2 = nData2;
+        gNumEvents++;
+    }
+    if (gSeekArmed && (eEvent == OMX_EventCmdComplete) &&
+        (nData1 == OMX_CommandFlush) && (nData2 == INPUT_PORT_INDEX)) {
+        gSeekArmed = 0;
+        gFramePending = 1;
+    }
+    if (gGateArmed) {
+        gGateArmed = 0;
+        gGateHeld = 1;
+        pthread_cond_broadcast(&gCond);
+        while (gGateHeld)
+            pthread_cond_wait(&gCond, &gLock);
+    }
+    pthread_cond_broadcast(&gCond);
+    pthread_mutex_unlock(&gLock);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE gCallbacks = { eventHandler, NULL, NULL };
+
+static int waitEvents(int n)
+{
+    int ret;
+
+    pthread_mutex_lock(&gLock);
+    while (gNumEvents < n)
+        pthread_cond_wait(&gCond, &gLock);
+    ret = gNumEvents;
+    pthread_mutex_unlock(&gLock);
+
+    return ret;
+}
+
+static void armGate(void)
+{
+    pthread_mutex_lock(&gLock);
+    gGateArmed = 1;
+    pthread_mutex_unlock(&gLock);
+}
+
+/* returns once the handler thread sits in the callback */
+static void waitGate(void)
+{
+    pthread_mutex_lock(&gLock);
+    while (!gGateHeld)
+        pthread_cond_wait(&gCond, &gLock);
+    pthread_mutex_unlock(&gLock);
+}
+
+static void releaseGate(void)
+{
+    pthread_mutex_lock(&gLock);
+    gGateHeld = 0;
+    pthread_cond_broadcast(&gCond);
+    pthread_mutex_unlock(&gLock);
+}
+
+/* returns the number of seek inputs decoded, kept or lost */
+static int waitFrame(void)
+{
+    struct timespec deadline;
+    int ret;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += CMDQ_TEST_FRAME_WAIT_MS / 1000;
+
+    pthread_mutex_lock(&gLock);
+    while ((gFramesOut + gFramesDropped == 0) &&
+           (pthread_cond_timedwait(&gCond, &gLock, &deadline) == 0))
+        ;
+    ret = gFramesOut + gFramesDropped;
+    pthread_mutex_unlock(&gLock);
+
+    return ret;
+}
+
+static void checkEvent(int i, OMX_EVENTTYPE event, OMX_U32 data1, OMX_U32 data2)
+{
+    CHECK(gEvents[i].event == event);
+    CHECK(gEvents[i].data1 == data1);
+    CHECK(gEvents[i].data2 == data2);
+}
+
+static void setState(OMX_COMPONENTTYPE *pOMXComponent, OMX_STATETYPE state)
+{
+    int n = gNumEvents;
+
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandStateSet, state, NULL);
+    waitEvents(n + 1);
+    checkEvent(n, OMX_EventCmdComplete, OMX_CommandStateSet, state);
+}
+
+static int countFlushTraces(void)
+{
+    SEC_TRACE_RECORD *pRecords = NULL;
+    char              path[128];
+    OMX_S32           n, i, cnt = 0;
+
+    snprintf(path, sizeof(path), "%s/cmdq_test_%d.json", CMDQ_TEST_DIR, getpid());
+    SEC_OSAL_TraceExport(path);
+    n = SEC_OSAL_TraceLoad(path, &pRecords);
+    unlink(path);
+    for (i = 0; i < n; i++) {
+        if (pRecords[i].event == SEC_TRACE_FLUSH_DONE)
+            cnt++;
+    }
+    free(pRecords);
+
+    return cnt;
+}
+
+int main(int argc, char **argv)
+{
+    OMX_COMPONENTTYPE      component;
+    OMX_COMPONENTTYPE     *pOMXComponent = &component;
+    SEC_OMX_BASECOMPONENT *pSECComponent = NULL;
+    char                   summary[1024];
+    OMX_S64                seekStartNs;
+    int                    i, n;
+
+    INIT_SET_SIZE_VERSION(pOMXComponent, OMX_COMPONENTTYPE);
+
+    SEC_OSAL_TraceInit();
+    gSECTraceEnabled = 1;
+
+    CHECK(SEC_OMX_BaseComponent_Constructor(pOMXComponent) == OMX_ErrorNone);
+    CHECK(SEC_OMX_Port_Constructor(pOMXComponent) == OMX_ErrorNone);
+    pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    pSECComponent->currentState = OMX_StateLoaded;
+    pSECComponent->sec_mfc_componentInit = stubInit;
+    pSECComponent->sec_mfc_componentTerminate = stubTerminate;
+    pSECComponent->sec_BufferProcess = stubBufferProcess;
+
+    /* no buffers: with both ports disabled Idle needs no allocation */
+    for (i = 0; i < ALL_PORT_NUM; i++)
+        pSECComponent->pSECPort[i].portDefinition.bEnabled = OMX_FALSE;
+
+    CHECK(pOMXComponent->SetCallbacks(pOMXComponent, &gCallbacks, NULL) == OMX_ErrorNone);
+
+    setState(pOMXComponent, OMX_StateIdle);
+    setState(pOMXComponent, OMX_StateExecuting);
+
+    /*
+     * Hold the handler in the completion of a first flush, queue an
+     * output then input flush behind it so they are taken in one wakeup,
+     * and check each completes on its own, in the order sent.
+     */
+    n = gNumEvents;
+    armGate();
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, INPUT_PORT_INDEX, NULL);
+    waitGate();
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, OUTPUT_PORT_INDEX, NULL);
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, INPUT_PORT_INDEX, NULL);
+    releaseGate();
+    CHECK(waitEvents(n + 3) == n + 3);
+    checkEvent(n + 0, OMX_EventCmdComplete, OMX_CommandFlush, INPUT_PORT_INDEX);
+    checkEvent(n + 1, OMX_EventCmdComplete, OMX_CommandFlush, OUTPUT_PORT_INDEX);
+    checkEvent(n + 2, OMX_EventCmdComplete, OMX_CommandFlush, INPUT_PORT_INDEX);
+
+    /*
+     * Seek: an input then output flush taken in one wakeup. The handler is
+     * held in the input flush completion, where the client has just queued
+     * the first input after the seek: it must be decoded into a frame right
+     * away, not into the output port that is still waiting to be flushed.
+     */
+    n = gNumEvents;
+    armGate();
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, OUTPUT_PORT_INDEX, NULL);
+    waitGate();
+    seekStartNs = nowNs();
+    gSeekArmed = 1;
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, INPUT_PORT_INDEX, NULL);
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandFlush, OUTPUT_PORT_INDEX, NULL);
+    armGate();
+    releaseGate();
+    waitGate();
+    CHECK(waitFrame() == 1);
+    releaseGate();
+    CHECK(waitEvents(n + 3) == n + 3);
+    checkEvent(n + 0, OMX_EventCmdComplete, OMX_CommandFlush, OUTPUT_PORT_INDEX);
+    checkEvent(n + 1, OMX_EventCmdComplete, OMX_CommandFlush, INPUT_PORT_INDEX);
+    checkEvent(n + 2, OMX_EventCmdComplete, OMX_CommandFlush, OUTPUT_PORT_INDEX);
+    CHECK(gFramesOut == 1);
+    CHECK(gFramesDropped == 0);
+    if (gFramesOut == 1)
+        printf("cmdq_test: seek to first frame %lld us\n", (gFirstFrameNs - seekStartNs) / 1000);
+
+    /* the trace summary measures the same seek from the input flush */
+    SEC_OSAL_TraceSummary(pOMXComponent, summary, sizeof(summary));
+    CHECK(strstr(summary, "seek   n=1 ") != NULL);
+
+    setState(pOMXComponent, OMX_StateIdle);
+
+    /* the seek latency in the trace summary starts at each input flush */
+    CHECK(countFlushTraces() == 3);
+    setState(pOMXComponent, OMX_StateLoaded);
+
+    /*
+     * Same trick for DeInit: a port enable queued behind it in the same
+     * wakeup must not run on a component that is being torn down.
+     */
+    n = gNumEvents;
+    armGate();
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandPortEnable, INPUT_PORT_INDEX, NULL);
+    waitGate();
+    pOMXComponent->SendCommand(pOMXComponent, (OMX_COMMANDTYPE)SEC_OMX_CommandComponentDeInit, 0, NULL);
+    pOMXComponent->SendCommand(pOMXComponent, OMX_CommandPortEnable, OUTPUT_PORT_INDEX, NULL);
+    releaseGate();
+
+    /* join the handler here so nothing it may still run races the checks */
+    while (pSECComponent->bExitMessageHandlerThread == OMX_FALSE)
+        SEC_OSAL_SleepMillisec(1);
+    SEC_OSAL_ThreadTerminate(pSECComponent->hMessageHandler);
+    pSECComponent->hMessageHandler = NULL;
+
+    CHECK(gNumEvents == n + 1);
+    checkEvent(n, OMX_EventCmdComplete, OMX_CommandPortEnable, INPUT_PORT_INDEX);
+    CHECK(pSECComponent->pSECPort[OUTPUT_PORT_INDEX].portDefinition.bEnabled == OMX_FALSE);
+
+    SEC_OMX_Port_Destructor(pOMXComponent);
+    SEC_OMX_BaseComponent_Destructor(pOMXComponent);
+
+    printf("cmdq_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,249 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        rm_test.c
+ * @brief       Resource manager against fake decoders: priority
+ *              pre-emption order, rejection and the vendor config
+ *              indexes that report the pool
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SEC_OMX_Def.h"
+#include "SEC_OMX_Macros.h"
+#include "SEC_OSAL_Memory.h"
+#include "SEC_OMX_Basecomponent.h"
+#include "SEC_OMX_Baseport.h"
+#include "SEC_OMX_Resourcemanager.h"
+
+#define RM_TEST_MAX_COMPS   16
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("rm_test: %s:%d: %s\n",                          \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static OMX_COMPONENTTYPE *gComps[RM_TEST_MAX_COMPS];
+static int                gNumComps;
+
+/* components told their resources are lost, and sent to Loaded */
+static OMX_COMPONENTTYPE *gLost[RM_TEST_MAX_COMPS];
+static int                gNumLost;
+static int                gNumLoaded;
+
+static OMX_ERRORTYPE eventHandler(OMX_HANDLETYPE hComponent, OMX_PTR pAppData,
+                                  OMX_EVENTTYPE eEvent, OMX_U32 nData1,
+                                  OMX_U32 nData2, OMX_PTR pEventData)
+{
+    if ((eEvent == OMX_EventError) && (nData1 == (OMX_U32)OMX_ErrorResourcesLost) &&
+        (gNumLost < RM_TEST_MAX_COMPS))
+        gLost[gNumLost++] = (OMX_COMPONENTTYPE *)hComponent;
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE sendCommand(OMX_HANDLETYPE hComponent, OMX_COMMANDTYPE Cmd,
+                                 OMX_U32 nParam, OMX_PTR pCmdData)
+{
+    if ((Cmd == OMX_CommandStateSet) && (nParam == OMX_StateLoaded))
+        gNumLoaded++;
+
+    return OMX_ErrorNone;
+}
+
+static OMX_CALLBACKTYPE gCallbacks = { eventHandler, NULL, NULL };
+
+static OMX_COMPONENTTYPE *newDecoder(OMX_U32 priority, OMX_STATETYPE state,
+                                     OMX_U32 width, OMX_U32 height)
+{
+    OMX_COMPONENTTYPE     *pOMXComponent = calloc(1, sizeof(OMX_COMPONENTTYPE));
+    SEC_OMX_BASECOMPONENT *pSECComponent = calloc(1, sizeof(SEC_OMX_BASECOMPONENT));
+
+    INIT_SET_SIZE_VERSION(pOMXComponent, OMX_COMPONENTTYPE);
+    pOMXComponent->pComponentPrivate = pSECComponent;
+    pOMXComponent->SendCommand = sendCommand;
+    pOMXComponent->GetConfig = SEC_OMX_GetConfig;
+    pOMXComponent->GetExtensionIndex = SEC_OMX_GetExtensionIndex;
+
+    pSECComponent->codecType = HW_VIDEO_DEC_CODEC;
+    pSECComponent->compPriority.nGroupPriority = priority;
+    pSECComponent->currentState = state;
+    pSECComponent->pCallbacks = &gCallbacks;
+    pSECComponent->pSECPort = calloc(ALL_PORT_NUM, sizeof(SEC_OMX_BASEPORT));
+    pSECComponent->pSECPort[INPUT_PORT_INDEX].portDefinition.format.video.nFrameWidth = width;
+    pSECComponent->pSECPort[INPUT_PORT_INDEX].portDefinition.format.video.nFrameHeight = height;
+    pSECComponent->pSECPort[INPUT_PORT_INDEX].portDefinition.format.video.xFramerate = 30 << 16;
+
+    gComps[gNumComps++] = pOMXComponent;
+
+    return pOMXComponent;
+}
+
+static SEC_OMX_BASECOMPONENT *priv(OMX_COMPONENTTYPE *pOMXComponent)
+{
+    return (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+}
+
+static void freeDecoders(void)
+{
+    int i;
+
+    for (i = 0; i < gNumComps; i++) {
+        if (priv(gComps[i])->pRMComponent != NULL)
+            SEC_OMX_Release_Resource(gComps[i]);
+        free(priv(gComps[i])->pSECPort);
+        free(priv(gComps[i]));
+        free(gComps[i]);
+    }
+    gNumComps = 0;
+    gNumLost = 0;
+    gNumLoaded = 0;
+}
+
+static void getStatus(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX_RM_STATUS *pStatus)
+{
+    OMX_INDEXTYPE index;
+
+    CHECK(pOMXComponent->GetExtensionIndex(pOMXComponent, SEC_INDEX_CONFIG_RESOURCE_STATUS, &index) == OMX_ErrorNone);
+    CHECK(pOMXComponent->GetConfig(pOMXComponent, index, pStatus) == OMX_ErrorNone);
+}
+
+/* a 1080p30 decoder is half the pool, only Idle components are pre-empted */
+static void testPreemptIdle(void)
+{
+    OMX_COMPONENTTYPE *pBusy, *pIdle, *pHigh, *pHighest;
+    SEC_OMX_RM_STATUS  status;
+
+    pBusy = newDecoder(5, OMX_StateExecuting, 1920, 1080);
+    pIdle = newDecoder(5, OMX_StateIdle, 1920, 1080);
+    CHECK(SEC_OMX_Get_Resource(pBusy) == OMX_ErrorNone);
+    CHECK(SEC_OMX_Get_Resource(pIdle) == OMX_ErrorNone);
+
+    pHigh = newDecoder(1, OMX_StateLoaded, 1920, 1080);
+    CHECK(SEC_OMX_Get_Resource(pHigh) == OMX_ErrorNone);
+    CHECK(priv(pIdle)->pRMComponent == NULL);
+    CHECK(priv(pBusy)->pRMComponent != NULL);
+    CHECK(gNumLost == 1 && gLost[0] == pIdle);
+    CHECK(gNumLoaded == 1);
+
+    /* pre-empting pHigh alone is not enough: rejected, nobody touched */
+    priv(pHigh)->currentState = OMX_StateIdle;
+    pHighest = newDecoder(0, OMX_StateLoaded, 3840, 1080);
+    CHECK(SEC_OMX_Get_Resource(pHighest) == OMX_ErrorInsufficientResources);
+    CHECK(priv(pHigh)->pRMComponent != NULL);
+    CHECK(gNumLost == 1);
+
+    getStatus(pBusy, &status);
+    CHECK(status.nInstances == 2);
+    CHECK(status.nLoad == status.nCapacity);
+
+    freeDecoders();
+}
+
+/* out of instances: victims come lowest priority first, Executing ones are passed over */
+static void testPreemptOrder(void)
+{
+    static const OMX_U32 priorities[] = { 2, 7, 4, 9, 3, 6 };
+    OMX_COMPONENTTYPE   *pDecoders[6];
+    OMX_COMPONENTTYPE   *pNew;
+    SEC_OMX_RM_STATUS    status;
+    int i;
+
+    for (i = 0; i < 6; i++) {
+        pDecoders[i] = newDecoder(priorities[i], OMX_StateIdle, 176, 144);
+        CHECK(SEC_OMX_Get_Resource(pDecoders[i]) == OMX_ErrorNone);
+    }
+    priv(pDecoders[3])->currentState = OMX_StateExecuting;
+
+    getStatus(pDecoders[0], &status);
+    CHECK(status.nInstances == status.nMaxInstances);
+
+    pNew = newDecoder(1, OMX_StateLoaded, 176, 144);
+    CHECK(SEC_OMX_Get_Resource(pNew) == OMX_ErrorNone);
+    CHECK(gNumLost == 1 && gLost[0] == pDecoders[1]);
+
+    pNew = newDecoder(5, OMX_StateLoaded, 176, 144);
+    CHECK(SEC_OMX_Get_Resource(pNew) == OMX_ErrorNone);
+    CHECK(gNumLost == 2 && gLost[1] == pDecoders[5]);
+
+    /* only the Executing 9 ranks below 6 now */
+    pNew = newDecoder(6, OMX_StateLoaded, 176, 144);
+    CHECK(SEC_OMX_Get_Resource(pNew) == OMX_ErrorInsufficientResources);
+    CHECK(gNumLost == 2);
+
+    /* once it is Idle it goes */
+    priv(pDecoders[3])->currentState = OMX_StateIdle;
+    CHECK(SEC_OMX_Get_Resource(pNew) == OMX_ErrorNone);
+    CHECK(gNumLost == 3 && gLost[2] == pDecoders[3]);
+
+    freeDecoders();
+}
+
+/* the event log as an application sees it */
+static void testEvents(void)
+{
+    OMX_COMPONENTTYPE   *pLow, *pHigh;
+    SEC_OMX_RM_EVENT     events[4];
+    SEC_OMX_RM_EVENTLIST eventList;
+    OMX_INDEXTYPE        index;
+
+    pLow = newDecoder(3, OMX_StateIdle, 3840, 1080);
+    pHigh = newDecoder(1, OMX_StateLoaded, 1920, 1080);
+    CHECK(SEC_OMX_Get_Resource(pLow) == OMX_ErrorNone);
+    CHECK(SEC_OMX_Get_Resource(pHigh) == OMX_ErrorNone);
+
+    eventList.nMaxEvents = 4;
+    eventList.nEvents = 0;
+    eventList.pEvents = events;
+    CHECK(pHigh->GetExtensionIndex(pHigh, SEC_INDEX_CONFIG_RESOURCE_EVENTS, &index) == OMX_ErrorNone);
+    CHECK(pHigh->GetConfig(pHigh, index, &eventList) == OMX_ErrorNone);
+    CHECK(eventList.nEvents == 4);
+    CHECK(events[1].eventType == SEC_OMX_RM_EVENT_ACQUIRE && events[1].pOMXComponent == pLow);
+    CHECK(events[2].eventType == SEC_OMX_RM_EVENT_PREEMPT && events[2].pOMXComponent == pLow);
+    CHECK(events[3].eventType == SEC_OMX_RM_EVENT_ACQUIRE && events[3].pOMXComponent == pHigh);
+    CHECK(events[3].nPoolLoad == events[3].nLoad);
+    CHECK(events[2].timeStamp <= events[3].timeStamp);
+
+    freeDecoders();
+}
+
+int main(int argc, char **argv)
+{
+    SEC_OMX_ResourceManager_Init();
+
+    testPreemptIdle();
+    testPreemptOrder();
+    testEvents();
+
+    SEC_OMX_ResourceManager_Deinit();
+
+    printf("rm_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
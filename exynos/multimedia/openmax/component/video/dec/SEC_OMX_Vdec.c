@@ -37,6 +37,7 @@
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Mutex.h"
 #include "SEC_OSAL_ETC.h"
+#include "SEC_OSAL_Trace.h"
 
 #ifdef USE_ANB
 #include "SEC_OSAL_Android.h"
@@ -144,7 +145,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -177,7 +178,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     ret = OMX_ErrorInsufficientResources;
 
 EXIT:
@@ -241,7 +242,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         SEC_OSAL_Free(temp_buffer);
         temp_buffer = NULL;
@@ -275,7 +276,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     SEC_OSAL_Free(temp_buffer);
     ret = OMX_ErrorInsufficientResources;
 
@@ -342,7 +343,7 @@ OMX_ERRORTYPE SEC_OMX_FreeBuffer(
                 }
                 pSECPort->assignedBufferNum--;
                 if (pSECPort->bufferStateAllocate[i] & HEADER_STATE_ALLOCATED) {
-                    SEC_OSAL_Free(pSECPort->bufferHeader[i]);
+                    SEC_OSAL_ArenaFree(pSECPort->bufferHeader[i]);
                     pSECPort->bufferHeader[i] = NULL;
                     pBufferHdr = NULL;
                 }
@@ -454,6 +455,8 @@ static OMX_ERRORTYPE SEC_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
             }
         }
 
+        SEC_OSAL_Trace(SEC_TRACE_INPUT_RETURN, pOMXComponent, bufferHeader->nTimeStamp);
+
         if (CHECK_PORT_TUNNELED(secOMXInputPort)) {
             OMX_FillThisBuffer(secOMXInputPort->tunneledComponent, bufferHeader);
         } else {
@@ -518,7 +521,7 @@ OMX_ERRORTYPE SEC_InputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             dataBuffer->nFlags = dataBuffer->bufferHeader->nFlags;
             dataBuffer->timeStamp = dataBuffer->bufferHeader->nTimeStamp;
 
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
 
             if (dataBuffer->allocSize <= dataBuffer->dataLen)
                 SEC_OSAL_Log(SEC_LOG_WARNING, "Input Buffer Full, Check input buffer size! allocSize:%d, dataLen:%d", dataBuffer->allocSize, dataBuffer->dataLen);
@@ -564,6 +567,8 @@ static OMX_ERRORTYPE SEC_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
                             bufferHeader->nFlags, NULL);
         }
 
+        SEC_OSAL_Trace(SEC_TRACE_OUTPUT_RETURN, pOMXComponent, bufferHeader->nTimeStamp);
+
         if (CHECK_PORT_TUNNELED(secOMXOutputPort)) {
             OMX_EmptyThisBuffer(secOMXOutputPort->tunneledComponent, bufferHeader);
         } else {
@@ -630,7 +635,7 @@ OMX_ERRORTYPE SEC_OutputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             pSECComponent->processData[OUTPUT_PORT_INDEX].dataBuffer = dataBuffer->bufferHeader->pBuffer;
             pSECComponent->processData[OUTPUT_PORT_INDEX].allocSize = dataBuffer->bufferHeader->nAllocLen;
 
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
         }
         SEC_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -784,6 +789,8 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
     }
 
     if (flagEOF == OMX_TRUE) {
+        SEC_OSAL_Trace(SEC_TRACE_INPUT_PARSED, pOMXComponent, inputData->timeStamp);
+
         if (pSECComponent->checkTimeStamp.needSetStartTimeStamp == OMX_TRUE) {
             pSECComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_TRUE;
             pSECComponent->checkTimeStamp.startTimeStamp = inputData->timeStamp;
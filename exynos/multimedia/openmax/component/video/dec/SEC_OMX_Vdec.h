@@ -65,6 +65,7 @@ typedef struct _SEC_MFC_NBDEC_THREAD
     OMX_BOOL        bDecoderRun;
 
     OMX_U32         oneFrameSize;
+    OMX_TICKS       timeStamp;      /* frame being decoded, for tracing */
 } SEC_MFC_NBDEC_THREAD;
 
 typedef struct _MFC_DEC_INPUT_BUFFER
@@ -15,6 +15,10 @@ LOCAL_CFLAGS :=
 
 ifeq ($(BOARD_NONBLOCK_MODE_PROCESS), true)
 LOCAL_CFLAGS += -DNONBLOCK_MODE_PROCESS
+ifeq ($(BOARD_USE_V4L2), true)
+# mfc_v4l2 queues the stream with SsbSipMfcDecExeNb(), no decode thread
+LOCAL_CFLAGS += -DUSE_MFC_EXE_NB
+endif
 endif
 
 ifeq ($(BOARD_USE_ANB), true)
@@ -35,6 +35,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "library_register.h"
 #include "SEC_OMX_H264dec.h"
 #include "SsbSipMfcApi.h"
@@ -777,7 +778,9 @@ OMX_ERRORTYPE SEC_MFC_DecodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoDec->NBDecThread.hDecFrameStart);
 
         if (pVideoDec->NBDecThread.bExitDecodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             pH264Dec->hMFCH264Handle.returnCodec = SsbSipMfcDecExe(pH264Dec->hMFCH264Handle.hMFCHandle, pVideoDec->NBDecThread.oneFrameSize);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameEnd);
         }
     }
@@ -789,6 +792,18 @@ EXIT:
     return ret;
 }
 
+#ifdef USE_MFC_EXE_NB
+/* SsbSipMfcDecWaitForOutBuf() retired the stream buffer of the frame in flight */
+static void SEC_MFC_H264Dec_InBufDone(void *cbData, void *virInBuf)
+{
+    OMX_COMPONENTTYPE          *pOMXComponent = (OMX_COMPONENTTYPE *)cbData;
+    SEC_OMX_BASECOMPONENT      *pSECComponent = (SEC_OMX_BASECOMPONENT *)pOMXComponent->pComponentPrivate;
+    SEC_OMX_VIDEODEC_COMPONENT *pVideoDec = (SEC_OMX_VIDEODEC_COMPONENT *)pSECComponent->hComponentHandle;
+
+    SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
+}
+#endif
+
 /* MFC Init */
 OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
 {
@@ -800,7 +815,7 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     OMX_PTR hMFCHandle       = NULL;
     OMX_PTR pStreamBuffer    = NULL;
     OMX_PTR pStreamPhyBuffer = NULL;
-#ifdef S3D_SUPPORT
+#if defined(S3D_SUPPORT) || defined(USE_MFC_EXE_NB)
     OMX_S32 setConfVal       = 0;
 #endif
 
@@ -829,6 +844,16 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     SsbSipMfcDecSetConfig(hMFCHandle, MFC_DEC_SETCONF_SEI_PARSE, &setConfVal);
 #endif
 
+#ifdef USE_MFC_EXE_NB
+    /* one stream buffer is filled while the other one is decoded */
+    setConfVal = MFC_INPUT_BUFFER_NUM_MAX;
+    if (SsbSipMfcDecSetConfig(hMFCHandle, MFC_DEC_SETCONF_INBUF_NUM, &setConfVal) != MFC_RET_OK) {
+        ret = OMX_ErrorInsufficientResources;
+        goto EXIT;
+    }
+    SsbSipMfcDecSetInBufDoneCallback(hMFCHandle, SEC_MFC_H264Dec_InBufDone, pOMXComponent);
+#endif
+
     /* Allocate decoder's input buffer */
     /* Get first input buffer */
     pStreamBuffer = SsbSipMfcDecGetInBuf(hMFCHandle, &pStreamPhyBuffer, DEFAULT_MFC_INPUT_BUFFER_SIZE / 2);
@@ -860,6 +885,9 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pVideoDec->NBDecThread.bExitDecodeThread = OMX_FALSE;
     pVideoDec->NBDecThread.bDecoderRun = OMX_FALSE;
     pVideoDec->NBDecThread.oneFrameSize = 0;
+#ifdef USE_MFC_EXE_NB
+    pH264Dec->hMFCH264Handle.returnCodec = MFC_RET_OK;
+#else
     SEC_OSAL_SemaphoreCreate(&(pVideoDec->NBDecThread.hDecFrameStart));
     SEC_OSAL_SemaphoreCreate(&(pVideoDec->NBDecThread.hDecFrameEnd));
     if (OMX_ErrorNone == SEC_OSAL_ThreadCreate(&pVideoDec->NBDecThread.hNBDecodeThread,
@@ -867,6 +895,7 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
                                                 pOMXComponent)) {
         pH264Dec->hMFCH264Handle.returnCodec = MFC_RET_OK;
     }
+#endif
 #endif
 
     pH264Dec->hMFCH264Handle.pMFCStreamBuffer    = pVideoDec->MFCDecInputBuffer[0].VirAddr;
@@ -1086,16 +1115,27 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC
     pSECComponent->timeStamp[pH264Dec->hMFCH264Handle.indexTimestamp] = pInputData->timeStamp;
     pSECComponent->nFlags[pH264Dec->hMFCH264Handle.indexTimestamp] = pInputData->nFlags;
 
+#ifdef USE_MFC_EXE_NB
+    /* collect the frame queued by the previous call, GetOutBuf below reads it */
+    if (pVideoDec->NBDecThread.bDecoderRun == OMX_TRUE) {
+        if (SsbSipMfcDecWaitForOutBuf(pH264Dec->hMFCH264Handle.hMFCHandle, &outputInfo) == MFC_GETOUTBUF_STATUS_NULL)
+            pH264Dec->hMFCH264Handle.returnCodec = MFC_RET_DEC_EXE_ERR;
+        pVideoDec->NBDecThread.bDecoderRun = OMX_FALSE;
+    }
+#endif
+
     if ((pH264Dec->hMFCH264Handle.returnCodec == MFC_RET_OK) &&
         (pVideoDec->bFirstFrame == OMX_FALSE)) {
         SSBSIP_MFC_DEC_OUTBUF_STATUS status;
         OMX_S32 indexTimestamp = 0;
 
+#ifndef USE_MFC_EXE_NB
         /* wait for mfc decode done */
         if (pVideoDec->NBDecThread.bDecoderRun == OMX_TRUE) {
             SEC_OSAL_SemaphoreWait(pVideoDec->NBDecThread.hDecFrameEnd);
             pVideoDec->NBDecThread.bDecoderRun = OMX_FALSE;
         }
+#endif
 
         SEC_OSAL_SleepMillisec(0);
         status = SsbSipMfcDecGetOutBuf(pH264Dec->hMFCH264Handle.hMFCHandle, &outputInfo);
@@ -1327,9 +1367,17 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC
         pVideoDec->NBDecThread.oneFrameSize = oneFrameSize;
 
         /* mfc decode start */
+        pVideoDec->NBDecThread.timeStamp = pInputData->timeStamp;
+#ifdef USE_MFC_EXE_NB
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
+        pH264Dec->hMFCH264Handle.returnCodec = SsbSipMfcDecExeNb(pH264Dec->hMFCH264Handle.hMFCHandle, oneFrameSize);
+        if (pH264Dec->hMFCH264Handle.returnCodec == MFC_RET_OK)
+            pVideoDec->NBDecThread.bDecoderRun = OMX_TRUE;
+#else
         SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameStart);
         pVideoDec->NBDecThread.bDecoderRun = OMX_TRUE;
         pH264Dec->hMFCH264Handle.returnCodec = MFC_RET_OK;
+#endif
 
         SEC_OSAL_SleepMillisec(0);
 
@@ -1385,6 +1433,7 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC
             pOutputData->dataLen = (actualWidth * actualHeight * 3) / 2;
         } else {
             SEC_OSAL_Log(SEC_LOG_TRACE, "YUV420p out for ThumbnailMode/Flash player mode");
+            SEC_OSAL_Trace(SEC_TRACE_CSC_START, pOMXComponent, pOutputData->timeStamp);
             switch (pSECComponent->pSECPort[OUTPUT_PORT_INDEX].portDefinition.format.video.eColorFormat) {
             case OMX_SEC_COLOR_FormatNV12Tiled:
 #ifdef S3D_SUPPORT
@@ -1461,6 +1510,7 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC
                     actualHeight / 2);
                 break;
             }
+            SEC_OSAL_Trace(SEC_TRACE_CSC_DONE, pOMXComponent, pOutputData->timeStamp);
         }
 #ifdef USE_ANB
         if (pSECOutputPort->bIsANBEnabled == OMX_TRUE) {
@@ -1609,7 +1659,9 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OM
         pSECComponent->nFlags[pH264Dec->hMFCH264Handle.indexTimestamp] = pInputData->nFlags;
         SsbSipMfcDecSetConfig(pH264Dec->hMFCH264Handle.hMFCHandle, MFC_DEC_SETCONF_FRAME_TAG, &(pH264Dec->hMFCH264Handle.indexTimestamp));
 
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
         returnCodec = SsbSipMfcDecExe(pH264Dec->hMFCH264Handle.hMFCHandle, oneFrameSize);
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
     } else {
         if (pSECComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE)
             pSECComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
@@ -1693,6 +1745,7 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OM
                 pOutputData->dataLen = (actualWidth * actualHeight * 3) / 2;
             } else {
                 SEC_OSAL_Log(SEC_LOG_TRACE, "YUV420p out for ThumbnailMode/Flash player mode");
+                SEC_OSAL_Trace(SEC_TRACE_CSC_START, pOMXComponent, pOutputData->timeStamp);
                 switch (pSECComponent->pSECPort[OUTPUT_PORT_INDEX].portDefinition.format.video.eColorFormat) {
                 case OMX_SEC_COLOR_FormatNV12Tiled:
                     SEC_OSAL_Memcpy(pOutputBuf, outputInfo.YVirAddr, FrameBufferYSize);
@@ -1751,6 +1804,7 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OM
                         actualHeight / 2);
                     break;
                 }
+                SEC_OSAL_Trace(SEC_TRACE_CSC_DONE, pOMXComponent, pOutputData->timeStamp);
             }
 
 #ifdef USE_ANB
@@ -35,6 +35,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "library_register.h"
 #include "SEC_OMX_Mpeg4dec.h"
 #include "SsbSipMfcApi.h"
@@ -926,7 +927,9 @@ OMX_ERRORTYPE SEC_MFC_DecodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoDec->NBDecThread.hDecFrameStart);
 
         if (pVideoDec->NBDecThread.bExitDecodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             pMpeg4Dec->hMFCMpeg4Handle.returnCodec = SsbSipMfcDecExe(pMpeg4Dec->hMFCMpeg4Handle.hMFCHandle, pVideoDec->NBDecThread.oneFrameSize);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameEnd);
         }
     }
@@ -1340,6 +1343,7 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SE
         pVideoDec->NBDecThread.oneFrameSize = oneFrameSize;
 
         /* mfc decode start */
+        pVideoDec->NBDecThread.timeStamp = pInputData->timeStamp;
         SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameStart);
         pVideoDec->NBDecThread.bDecoderRun = OMX_TRUE;
         pMpeg4Dec->hMFCMpeg4Handle.returnCodec = MFC_RET_OK;
@@ -1585,7 +1589,9 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_O
         pSECComponent->nFlags[pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp] = pInputData->nFlags;
         SsbSipMfcDecSetConfig(hMFCHandle, MFC_DEC_SETCONF_FRAME_TAG, &(pMpeg4Dec->hMFCMpeg4Handle.indexTimestamp));
 
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
         returnCodec = SsbSipMfcDecExe(hMFCHandle, oneFrameSize);
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
     } else {
         if (pSECComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE)
             pSECComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
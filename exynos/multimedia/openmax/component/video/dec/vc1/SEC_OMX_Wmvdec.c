@@ -37,6 +37,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "SEC_OSAL_Memory.h"
 #include "library_register.h"
 #include "SEC_OMX_Wmvdec.h"
@@ -786,7 +787,9 @@ OMX_ERRORTYPE SEC_MFC_DecodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoDec->NBDecThread.hDecFrameStart);
 
         if (pVideoDec->NBDecThread.bExitDecodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             pWmvDec->hMFCWmvHandle.returnCodec = SsbSipMfcDecExe(pWmvDec->hMFCWmvHandle.hMFCHandle, pVideoDec->NBDecThread.oneFrameSize);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameEnd);
         }
     }
@@ -1236,6 +1239,7 @@ OMX_ERRORTYPE SEC_MFC_Wmv_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC_
         pVideoDec->NBDecThread.oneFrameSize = oneFrameSize;
 #endif
         /* mfc decode start */
+        pVideoDec->NBDecThread.timeStamp = pInputData->timeStamp;
         SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameStart);
         pVideoDec->NBDecThread.bDecoderRun = OMX_TRUE;
         pWmvDec->hMFCWmvHandle.returnCodec = MFC_RET_OK;
@@ -1520,9 +1524,13 @@ OMX_ERRORTYPE SEC_MFC_Wmv_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
         SsbSipMfcDecSetConfig(pWmvDec->hMFCWmvHandle.hMFCHandle, MFC_DEC_SETCONF_FRAME_TAG, &(pWmvDec->hMFCWmvHandle.indexTimestamp));
 
 #ifdef WO_START_CODE
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
         returnCodec = SsbSipMfcDecExe(pWmvDec->hMFCWmvHandle.hMFCHandle, oneFrameSize+4); /* Frame Start Code */
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
 #else
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
         returnCodec = SsbSipMfcDecExe(pWmvDec->hMFCWmvHandle.hMFCHandle, oneFrameSize);
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
 #endif
     } else {
         if (pSECComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE)
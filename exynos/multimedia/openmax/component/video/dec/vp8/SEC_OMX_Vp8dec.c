@@ -35,6 +35,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "library_register.h"
 #include "SEC_OMX_Vp8dec.h"
 #include "SsbSipMfcApi.h"
@@ -546,7 +547,9 @@ OMX_ERRORTYPE SEC_MFC_DecodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoDec->NBDecThread.hDecFrameStart);
 
         if (pVideoDec->NBDecThread.bExitDecodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             pVp8Dec->hMFCVp8Handle.returnCodec = SsbSipMfcDecExe(pVp8Dec->hMFCVp8Handle.hMFCHandle, pVideoDec->NBDecThread.oneFrameSize);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoDec->NBDecThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameEnd);
         }
     }
@@ -931,6 +934,7 @@ OMX_ERRORTYPE SEC_MFC_VP8_Decode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC_
         pVideoDec->NBDecThread.oneFrameSize = oneFrameSize;
 
         /* mfc decode start */
+        pVideoDec->NBDecThread.timeStamp = pInputData->timeStamp;
         SEC_OSAL_SemaphorePost(pVideoDec->NBDecThread.hDecFrameStart);
         pVideoDec->NBDecThread.bDecoderRun = OMX_TRUE;
         pVp8Dec->hMFCVp8Handle.returnCodec = MFC_RET_OK;
@@ -1134,7 +1138,9 @@ OMX_ERRORTYPE SEC_MFC_VP8_Decode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX
         pSECComponent->nFlags[pVp8Dec->hMFCVp8Handle.indexTimestamp] = pInputData->nFlags;
         SsbSipMfcDecSetConfig(pVp8Dec->hMFCVp8Handle.hMFCHandle, MFC_DEC_SETCONF_FRAME_TAG, &(pVp8Dec->hMFCVp8Handle.indexTimestamp));
 
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
         returnCodec = SsbSipMfcDecExe(pVp8Dec->hMFCVp8Handle.hMFCHandle, oneFrameSize);
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
     } else {
         if (pSECComponent->checkTimeStamp.needCheckStartTimeStamp == OMX_TRUE)
             pSECComponent->checkTimeStamp.needSetStartTimeStamp = OMX_TRUE;
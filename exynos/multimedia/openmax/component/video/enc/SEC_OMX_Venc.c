@@ -36,6 +36,7 @@
 #include "SEC_OSAL_Mutex.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_ETC.h"
+#include "SEC_OSAL_Trace.h"
 #include "color_space_convertor.h"
 
 #ifdef USE_STOREMETADATA
@@ -124,7 +125,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -157,7 +158,7 @@ OMX_ERRORTYPE SEC_OMX_UseBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     ret = OMX_ErrorInsufficientResources;
 
 EXIT:
@@ -221,7 +222,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         SEC_OSAL_Free(temp_buffer);
         temp_buffer = NULL;
@@ -255,7 +256,7 @@ OMX_ERRORTYPE SEC_OMX_AllocateBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     SEC_OSAL_Free(temp_buffer);
     ret = OMX_ErrorInsufficientResources;
 
@@ -322,7 +323,7 @@ OMX_ERRORTYPE SEC_OMX_FreeBuffer(
                 }
                 pSECPort->assignedBufferNum--;
                 if (pSECPort->bufferStateAllocate[i] & HEADER_STATE_ALLOCATED) {
-                    SEC_OSAL_Free(pSECPort->bufferHeader[i]);
+                    SEC_OSAL_ArenaFree(pSECPort->bufferHeader[i]);
                     pSECPort->bufferHeader[i] = NULL;
                     pBufferHdr = NULL;
                 }
@@ -434,6 +435,8 @@ static OMX_ERRORTYPE SEC_InputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
             }
         }
 
+        SEC_OSAL_Trace(SEC_TRACE_INPUT_RETURN, pOMXComponent, bufferHeader->nTimeStamp);
+
         if (CHECK_PORT_TUNNELED(secOMXInputPort)) {
             OMX_FillThisBuffer(secOMXInputPort->tunneledComponent, bufferHeader);
         } else {
@@ -499,7 +502,7 @@ OMX_ERRORTYPE SEC_InputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             dataBuffer->timeStamp = dataBuffer->bufferHeader->nTimeStamp;
             pSECComponent->processData[INPUT_PORT_INDEX].dataBuffer = dataBuffer->bufferHeader->pBuffer;
             pSECComponent->processData[INPUT_PORT_INDEX].allocSize = dataBuffer->bufferHeader->nAllocLen;
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
         }
         SEC_OSAL_MutexUnlock(inputUseBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -542,6 +545,8 @@ static OMX_ERRORTYPE SEC_OutputBufferReturn(OMX_COMPONENTTYPE *pOMXComponent)
                             bufferHeader->nFlags, NULL);
         }
 
+        SEC_OSAL_Trace(SEC_TRACE_OUTPUT_RETURN, pOMXComponent, bufferHeader->nTimeStamp);
+
         if (CHECK_PORT_TUNNELED(secOMXOutputPort)) {
             OMX_EmptyThisBuffer(secOMXOutputPort->tunneledComponent, bufferHeader);
         } else {
@@ -605,7 +610,7 @@ OMX_ERRORTYPE SEC_OutputBufferGetQueue(SEC_OMX_BASECOMPONENT *pSECComponent)
             dataBuffer->dataValid =OMX_TRUE;
             /* dataBuffer->nFlags = dataBuffer->bufferHeader->nFlags; */
             /* dataBuffer->nTimeStamp = dataBuffer->bufferHeader->nTimeStamp; */
-            SEC_OSAL_Free(message);
+            SEC_OSAL_ArenaFree(message);
         }
         SEC_OSAL_MutexUnlock(outputUseBuffer->bufferMutex);
         ret = OMX_ErrorNone;
@@ -762,6 +767,8 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
                     width = pSECPort->portDefinition.format.video.nFrameWidth;
                     height = pSECPort->portDefinition.format.video.nFrameHeight;
 
+                    SEC_OSAL_Trace(SEC_TRACE_CSC_START, pOMXComponent, inputUseBuffer->timeStamp);
+
                     SEC_OSAL_Log(SEC_LOG_TRACE, "pVideoEnc->MFCEncInputBuffer[%d].YVirAddr : 0x%x", pVideoEnc->indexInputBuffer, pVideoEnc->MFCEncInputBuffer[pVideoEnc->indexInputBuffer].YVirAddr);
                     SEC_OSAL_Log(SEC_LOG_TRACE, "pVideoEnc->MFCEncInputBuffer[%d].CVirAddr : 0x%x", pVideoEnc->indexInputBuffer, pVideoEnc->MFCEncInputBuffer[pVideoEnc->indexInputBuffer].CVirAddr);
 
@@ -813,6 +820,7 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
                         }
                     }
 #endif
+                    SEC_OSAL_Trace(SEC_TRACE_CSC_DONE, pOMXComponent, inputUseBuffer->timeStamp);
                 }
             }
 
@@ -858,6 +866,8 @@ OMX_BOOL SEC_Preprocessor_InputData(OMX_COMPONENTTYPE *pOMXComponent)
     }
 
     if (flagEOF == OMX_TRUE) {
+        SEC_OSAL_Trace(SEC_TRACE_INPUT_PARSED, pOMXComponent, inputData->timeStamp);
+
         if (pSECComponent->checkTimeStamp.needSetStartTimeStamp == OMX_TRUE) {
             pSECComponent->checkTimeStamp.needCheckStartTimeStamp = OMX_TRUE;
             pSECComponent->checkTimeStamp.startTimeStamp = inputData->timeStamp;
@@ -1490,7 +1500,7 @@ OMX_ERRORTYPE SEC_OMX_VideoEncodeGetConfig(
     }
         break;
     default:
-        ret = SEC_OMX_SetConfig(hComponent, nIndex, pComponentConfigStructure);
+        ret = SEC_OMX_GetConfig(hComponent, nIndex, pComponentConfigStructure);
         break;
     }
 
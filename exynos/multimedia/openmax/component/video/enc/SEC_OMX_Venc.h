@@ -69,6 +69,7 @@ typedef struct _SEC_MFC_NBENC_THREAD
     OMX_HANDLETYPE  hEncFrameEnd;
     OMX_BOOL        bExitEncodeThread;
     OMX_BOOL        bEncoderRun;
+    OMX_TICKS       timeStamp;      /* frame being encoded, for tracing */
 } SEC_MFC_NBENC_THREAD;
 
 typedef struct _MFC_ENC_INPUT_BUFFER
@@ -35,6 +35,7 @@
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "SEC_OSAL_Android.h"
 #include "library_register.h"
 #include "SEC_OMX_H264enc.h"
@@ -839,7 +840,9 @@ OMX_ERRORTYPE SEC_MFC_EncodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoEnc->NBEncThread.hEncFrameStart);
 
         if (pVideoEnc->NBEncThread.bExitEncodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoEnc->NBEncThread.timeStamp);
             pH264Enc->hMFCH264Handle.returnCodec = SsbSipMfcEncExe(pH264Enc->hMFCH264Handle.hMFCHandle);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoEnc->NBEncThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoEnc->NBEncThread.hEncFrameEnd);
         }
     }
@@ -1186,6 +1189,7 @@ OMX_ERRORTYPE SEC_MFC_H264_Encode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SEC
     SsbSipMfcEncSetConfig(pH264Enc->hMFCH264Handle.hMFCHandle, MFC_ENC_SETCONF_FRAME_TAG, &(pH264Enc->hMFCH264Handle.indexTimestamp));
 
     /* mfc encode start */
+    pVideoEnc->NBEncThread.timeStamp = pInputData->timeStamp;
     SEC_OSAL_SemaphorePost(pVideoEnc->NBEncThread.hEncFrameStart);
     pVideoEnc->NBEncThread.bEncoderRun = OMX_TRUE;
     pH264Enc->hMFCH264Handle.indexTimestamp++;
@@ -1315,7 +1319,9 @@ OMX_ERRORTYPE SEC_MFC_H264_Encode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_OM
     pSECComponent->nFlags[pH264Enc->hMFCH264Handle.indexTimestamp] = pInputData->nFlags;
     SsbSipMfcEncSetConfig(pH264Enc->hMFCH264Handle.hMFCHandle, MFC_ENC_SETCONF_FRAME_TAG, &(pH264Enc->hMFCH264Handle.indexTimestamp));
 
+    SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
     returnCodec = SsbSipMfcEncExe(pH264Enc->hMFCH264Handle.hMFCHandle);
+    SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
     if (returnCodec == MFC_RET_OK) {
         OMX_S32 indexTimestamp = 0;
 
@@ -35,6 +35,7 @@
 #include "SEC_OMX_Venc.h"
 #include "SEC_OSAL_Semaphore.h"
 #include "SEC_OSAL_Thread.h"
+#include "SEC_OSAL_Trace.h"
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Android.h"
 #include "library_register.h"
@@ -1008,7 +1009,9 @@ OMX_ERRORTYPE SEC_MFC_EncodeThread(OMX_HANDLETYPE hComponent)
         SEC_OSAL_SemaphoreWait(pVideoEnc->NBEncThread.hEncFrameStart);
 
         if (pVideoEnc->NBEncThread.bExitEncodeThread == OMX_FALSE) {
+            SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pVideoEnc->NBEncThread.timeStamp);
             pMpeg4Enc->hMFCMpeg4Handle.returnCodec = SsbSipMfcEncExe(pMpeg4Enc->hMFCMpeg4Handle.hMFCHandle);
+            SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pVideoEnc->NBEncThread.timeStamp);
             SEC_OSAL_SemaphorePost(pVideoEnc->NBEncThread.hEncFrameEnd);
         }
     }
@@ -1351,6 +1354,7 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4_Encode_Nonblock(OMX_COMPONENTTYPE *pOMXComponent, SE
     SsbSipMfcEncSetConfig(hMFCHandle, MFC_ENC_SETCONF_FRAME_TAG, &(pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp));
 
     /* mfc encode start */
+    pVideoEnc->NBEncThread.timeStamp = pInputData->timeStamp;
     SEC_OSAL_SemaphorePost(pVideoEnc->NBEncThread.hEncFrameStart);
     pVideoEnc->NBEncThread.bEncoderRun = OMX_TRUE;
     pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp++;
@@ -1470,7 +1474,9 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4_Encode_Block(OMX_COMPONENTTYPE *pOMXComponent, SEC_O
     pSECComponent->nFlags[pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp] = pInputData->nFlags;
     SsbSipMfcEncSetConfig(hMFCHandle, MFC_ENC_SETCONF_FRAME_TAG, &(pMpeg4Enc->hMFCMpeg4Handle.indexTimestamp));
 
+    SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, pOMXComponent, pInputData->timeStamp);
     returnCodec = SsbSipMfcEncExe(hMFCHandle);
+    SEC_OSAL_Trace(SEC_TRACE_HW_DONE, pOMXComponent, pInputData->timeStamp);
     if (returnCodec == MFC_RET_OK) {
         OMX_S32 indexTimestamp = 0;
 
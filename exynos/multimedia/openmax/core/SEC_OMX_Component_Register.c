@@ -27,16 +27,19 @@
 #include <stdlib.h>
 #include <string.h>
 #include <dlfcn.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <errno.h>
 #include <assert.h>
-#include <dirent.h>
 
 #include "OMX_Component.h"
 #include "SEC_OSAL_Memory.h"
 #include "SEC_OSAL_ETC.h"
 #include "SEC_OSAL_Library.h"
+#include "SEC_OSAL_Mutex.h"
 #include "SEC_OMX_Component_Register.h"
 #include "SEC_OMX_Macros.h"
 
@@ -45,89 +48,328 @@
 #define SEC_LOG_OFF
 #include "SEC_OSAL_Log.h"
 
-OMX_ERRORTYPE SEC_OMX_Component_Register(SEC_OMX_COMPONENT_REGLIST **compList, OMX_U32 *compNum)
+#define SEC_OMX_LIB_PREFIX          "libOMX.SEC."
+#define SEC_OMX_REGISTRY_MAGIC      0x584D4F53  /* "SOMX" */
+#define SEC_OMX_REGISTRY_VERSION    1
+/* power of two, larger than MAX_OMX_COMPONENT_NUM */
+#define SEC_OMX_COMPONENT_HASH_SIZE 64
+
+/*
+ * Registry index file: a header, the component libraries it was built
+ * from (with their mtime and size) and the registered components. It is
+ * only used while the library table still matches SEC_OMX_INSTALL_PATH.
+ */
+typedef struct _SEC_OMX_REGISTRY_HEADER
 {
-    OMX_ERRORTYPE  ret = OMX_ErrorNone;
-    int            componentNum = 0, roleNum = 0, totalCompNum = 0;
-    int            read;
-    char          *libName;
-    size_t         len;
-    const char    *errorMsg;
-    DIR           *dir;
+    OMX_U32 magic;
+    OMX_U32 version;
+    OMX_U32 entrySize;
+    OMX_U32 libNum;
+    OMX_U32 compNum;
+} SEC_OMX_REGISTRY_HEADER;
+
+typedef struct _SEC_OMX_REGISTRY_LIB
+{
+    OMX_U8  libName[MAX_OMX_COMPONENT_LIBNAME_SIZE];
+    OMX_S64 mtime;
+    OMX_S64 size;
+} SEC_OMX_REGISTRY_LIB;
+
+typedef struct _SEC_OMX_LIB_CACHE
+{
+    OMX_U8         libName[MAX_OMX_COMPONENT_LIBNAME_SIZE];
+    OMX_HANDLETYPE libHandle;
+    OMX_U32        refCount;
+} SEC_OMX_LIB_CACHE;
+
+/* component name -> index + 1 in the registered list, 0 is empty */
+static OMX_U32 gComponentHash[SEC_OMX_COMPONENT_HASH_SIZE];
+
+/*
+ * A library is loaded once and shared by all of its live handles, it is
+ * closed when the last handle is freed. The mutex lives as long as the
+ * process since handles may outlive SEC_OMX_Deinit.
+ */
+static SEC_OMX_LIB_CACHE gLibCache[MAX_OMX_COMPONENT_NUM];
+static OMX_U32           gLibCacheNum = 0;
+static OMX_HANDLETYPE    ghLibCacheMutex = NULL;
+
+static OMX_U32 SEC_OMX_Component_Hash(OMX_U8 *name)
+{
+    /* FNV-1a */
+    OMX_U32 hash = 2166136261u;
+
+    while (*name) {
+        hash ^= *name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static void SEC_OMX_Component_BuildHash(SEC_OMX_COMPONENT_REGLIST *componentList, OMX_U32 compNum)
+{
+    OMX_U32 i, slot;
+
+    SEC_OSAL_Memset(gComponentHash, 0, sizeof(gComponentHash));
+
+    for (i = 0; i < compNum; i++) {
+        slot = SEC_OMX_Component_Hash(componentList[i].component.componentName);
+        while (gComponentHash[slot & (SEC_OMX_COMPONENT_HASH_SIZE - 1)] != 0)
+            slot++;
+        gComponentHash[slot & (SEC_OMX_COMPONENT_HASH_SIZE - 1)] = i + 1;
+    }
+}
+
+static int SEC_OMX_Component_LibCompare(const void *a, const void *b)
+{
+    return strcmp((const char *)((SEC_OMX_REGISTRY_LIB *)a)->libName,
+                  (const char *)((SEC_OMX_REGISTRY_LIB *)b)->libName);
+}
+
+/* list the component libraries, sorted so that the table is comparable */
+static OMX_U32 SEC_OMX_Component_ScanLibs(DIR *dir, SEC_OMX_REGISTRY_LIB *libList)
+{
+    OMX_U32        libNum = 0;
     struct dirent *d;
+    struct stat    st;
 
-    int (*SEC_OMX_COMPONENT_Library_Register)(SECRegisterComponentType **secComponents);
-    SECRegisterComponentType **secComponentsTemp;
-    SEC_OMX_COMPONENT_REGLIST *componentList;
+    while ((d = readdir(dir)) != NULL) {
+        if (SEC_OSAL_Strncmp(d->d_name, SEC_OMX_LIB_PREFIX, SEC_OSAL_Strlen(SEC_OMX_LIB_PREFIX)) != 0)
+            continue;
 
-    FunctionIn();
+        if (libNum >= MAX_OMX_COMPONENT_NUM) {
+            SEC_OSAL_Log(SEC_LOG_WARNING, "too many component libraries, %s skipped", d->d_name);
+            continue;
+        }
 
-    dir = opendir(SEC_OMX_INSTALL_PATH);
-    if (dir == NULL) {
-        ret = OMX_ErrorUndefined;
+        if (SEC_OSAL_Strlen(SEC_OMX_INSTALL_PATH) + SEC_OSAL_Strlen(d->d_name) >= MAX_OMX_COMPONENT_LIBNAME_SIZE)
+            continue;
+
+        SEC_OSAL_Memset(&libList[libNum], 0, sizeof(SEC_OMX_REGISTRY_LIB));
+        SEC_OSAL_Strcpy(libList[libNum].libName, SEC_OMX_INSTALL_PATH);
+        SEC_OSAL_Strcat(libList[libNum].libName, d->d_name);
+
+        if (stat((const char *)libList[libNum].libName, &st) != 0)
+            continue;
+
+        libList[libNum].mtime = st.st_mtime;
+        libList[libNum].size  = st.st_size;
+        libNum++;
+    }
+
+    qsort(libList, libNum, sizeof(SEC_OMX_REGISTRY_LIB), SEC_OMX_Component_LibCompare);
+
+    return libNum;
+}
+
+static OMX_U32 SEC_OMX_Component_ReadRegistry(SEC_OMX_REGISTRY_LIB *libList, OMX_U32 libNum,
+                                              SEC_OMX_COMPONENT_REGLIST *componentList)
+{
+    SEC_OMX_REGISTRY_HEADER *header;
+    OMX_U8                  *buf = NULL;
+    OMX_U32                  compNum = 0;
+    OMX_U32                  i;
+    struct stat              st;
+    size_t                   size;
+    int                      fd;
+
+    fd = open(SEC_OMX_REGISTRY_PATH, O_RDONLY);
+    if (fd < 0)
+        return 0;
+
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SEC_OMX_REGISTRY_HEADER))
+        goto EXIT;
+
+    size = st.st_size;
+    buf = SEC_OSAL_Malloc(size);
+    if (buf == NULL)
+        goto EXIT;
+
+    if (read(fd, buf, size) != (ssize_t)size)
+        goto EXIT;
+
+    header = (SEC_OMX_REGISTRY_HEADER *)buf;
+    if ((header->magic != SEC_OMX_REGISTRY_MAGIC) ||
+        (header->version != SEC_OMX_REGISTRY_VERSION) ||
+        (header->entrySize != sizeof(SEC_OMX_COMPONENT_REGLIST)) ||
+        (header->libNum != libNum) ||
+        (header->compNum == 0) ||
+        (header->compNum > MAX_OMX_COMPONENT_NUM) ||
+        (size != sizeof(SEC_OMX_REGISTRY_HEADER) +
+                 sizeof(SEC_OMX_REGISTRY_LIB) * header->libNum +
+                 sizeof(SEC_OMX_COMPONENT_REGLIST) * header->compNum))
+        goto EXIT;
+
+    if (memcmp(buf + sizeof(SEC_OMX_REGISTRY_HEADER), libList,
+               sizeof(SEC_OMX_REGISTRY_LIB) * libNum) != 0) {
+        SEC_OSAL_Log(SEC_LOG_TRACE, "component libraries changed, registry is stale");
         goto EXIT;
     }
 
-    componentList = (SEC_OMX_COMPONENT_REGLIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_COMPONENT_REGLIST) * MAX_OMX_COMPONENT_NUM);
-    SEC_OSAL_Memset(componentList, 0, sizeof(SEC_OMX_COMPONENT_REGLIST) * MAX_OMX_COMPONENT_NUM);
-    libName = SEC_OSAL_Malloc(MAX_OMX_COMPONENT_LIBNAME_SIZE);
+    SEC_OSAL_Memcpy(componentList,
+                    buf + sizeof(SEC_OMX_REGISTRY_HEADER) + sizeof(SEC_OMX_REGISTRY_LIB) * libNum,
+                    sizeof(SEC_OMX_COMPONENT_REGLIST) * header->compNum);
+
+    /* only a library just scanned from SEC_OMX_INSTALL_PATH is ever loaded */
+    for (i = 0; i < header->compNum; i++) {
+        if ((memchr(componentList[i].libName, '\0', MAX_OMX_COMPONENT_LIBNAME_SIZE) == NULL) ||
+            (bsearch(componentList[i].libName, libList, libNum, sizeof(SEC_OMX_REGISTRY_LIB),
+                     SEC_OMX_Component_LibCompare) == NULL)) {
+            SEC_OSAL_Log(SEC_LOG_WARNING, "%s names an unknown library, rescanning",
+                         SEC_OMX_REGISTRY_PATH);
+            goto EXIT;
+        }
+    }
+    compNum = header->compNum;
 
-    while ((d = readdir(dir)) != NULL) {
-        OMX_HANDLETYPE soHandle;
-        SEC_OSAL_Log(SEC_LOG_ERROR, "%s", d->d_name);
-
-        if (SEC_OSAL_Strncmp(d->d_name, "libOMX.SEC.", SEC_OSAL_Strlen("libOMX.SEC.")) == 0) {
-            SEC_OSAL_Memset(libName, 0, MAX_OMX_COMPONENT_LIBNAME_SIZE);
-            SEC_OSAL_Strcpy(libName, SEC_OMX_INSTALL_PATH);
-            SEC_OSAL_Strcat(libName, d->d_name);
-            SEC_OSAL_Log(SEC_LOG_ERROR, "Path & libName : %s", libName);
-            if ((soHandle = SEC_OSAL_dlopen(libName, RTLD_NOW)) != NULL) {
-                SEC_OSAL_dlerror();    /* clear error*/
-                if ((SEC_OMX_COMPONENT_Library_Register = SEC_OSAL_dlsym(soHandle, "SEC_OMX_COMPONENT_Library_Register")) != NULL) {
-                    int i = 0;
-                    unsigned int j = 0;
-
-                    componentNum = (*SEC_OMX_COMPONENT_Library_Register)(NULL);
-                    secComponentsTemp = (SECRegisterComponentType **)SEC_OSAL_Malloc(sizeof(SECRegisterComponentType*) * componentNum);
-                    for (i = 0; i < componentNum; i++) {
-                        secComponentsTemp[i] = SEC_OSAL_Malloc(sizeof(SECRegisterComponentType));
-                        SEC_OSAL_Memset(secComponentsTemp[i], 0, sizeof(SECRegisterComponentType));
-                    }
-                    (*SEC_OMX_COMPONENT_Library_Register)(secComponentsTemp);
+EXIT:
+    if (buf != NULL)
+        SEC_OSAL_Free(buf);
+    close(fd);
 
-                    for (i = 0; i < componentNum; i++) {
-                        SEC_OSAL_Strcpy(componentList[totalCompNum].component.componentName, secComponentsTemp[i]->componentName);
-                        for (j = 0; j < secComponentsTemp[i]->totalRoleNum; j++)
-                            SEC_OSAL_Strcpy(componentList[totalCompNum].component.roles[j], secComponentsTemp[i]->roles[j]);
-                        componentList[totalCompNum].component.totalRoleNum = secComponentsTemp[i]->totalRoleNum;
+    return compNum;
+}
 
-                        SEC_OSAL_Strcpy(componentList[totalCompNum].libName, libName);
+static void SEC_OMX_Component_WriteRegistry(SEC_OMX_REGISTRY_LIB *libList, OMX_U32 libNum,
+                                            SEC_OMX_COMPONENT_REGLIST *componentList, OMX_U32 compNum)
+{
+    SEC_OMX_REGISTRY_HEADER header;
+    char                    tmpName[MAX_OMX_COMPONENT_LIBNAME_SIZE];
+    ssize_t                 written = 0;
+    size_t                  size;
+    int                     fd;
+
+    header.magic     = SEC_OMX_REGISTRY_MAGIC;
+    header.version   = SEC_OMX_REGISTRY_VERSION;
+    header.entrySize = sizeof(SEC_OMX_COMPONENT_REGLIST);
+    header.libNum    = libNum;
+    header.compNum   = compNum;
+
+    snprintf(tmpName, sizeof(tmpName), "%s.%d", SEC_OMX_REGISTRY_PATH, getpid());
+
+    fd = open(tmpName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        SEC_OSAL_Log(SEC_LOG_TRACE, "can not create %s : %s", tmpName, strerror(errno));
+        return;
+    }
 
-                        totalCompNum++;
-                    }
-                    for (i = 0; i < componentNum; i++) {
-                        SEC_OSAL_Free(secComponentsTemp[i]);
+    size = sizeof(header) + sizeof(SEC_OMX_REGISTRY_LIB) * libNum +
+           sizeof(SEC_OMX_COMPONENT_REGLIST) * compNum;
+    written += write(fd, &header, sizeof(header));
+    written += write(fd, libList, sizeof(SEC_OMX_REGISTRY_LIB) * libNum);
+    written += write(fd, componentList, sizeof(SEC_OMX_COMPONENT_REGLIST) * compNum);
+    close(fd);
+
+    /* publish atomically, a half written index is never seen */
+    if ((written != (ssize_t)size) || (rename(tmpName, SEC_OMX_REGISTRY_PATH) != 0)) {
+        SEC_OSAL_Log(SEC_LOG_WARNING, "%s write failed", SEC_OMX_REGISTRY_PATH);
+        unlink(tmpName);
+    }
+}
+
+static OMX_U32 SEC_OMX_Component_ScanRegister(SEC_OMX_REGISTRY_LIB *libList, OMX_U32 libNum,
+                                              SEC_OMX_COMPONENT_REGLIST *componentList)
+{
+    int            componentNum = 0, totalCompNum = 0;
+    const char    *errorMsg;
+    OMX_U32        k;
+
+    int (*SEC_OMX_COMPONENT_Library_Register)(SECRegisterComponentType **secComponents);
+    SECRegisterComponentType **secComponentsTemp;
+
+    for (k = 0; k < libNum; k++) {
+        OMX_HANDLETYPE soHandle;
+        OMX_U8 *libName = libList[k].libName;
+
+        SEC_OSAL_Log(SEC_LOG_TRACE, "Path & libName : %s", libName);
+        if ((soHandle = SEC_OSAL_dlopen((const char *)libName, RTLD_NOW)) != NULL) {
+            SEC_OSAL_dlerror();    /* clear error*/
+            if ((SEC_OMX_COMPONENT_Library_Register = SEC_OSAL_dlsym(soHandle, "SEC_OMX_COMPONENT_Library_Register")) != NULL) {
+                int i = 0;
+                unsigned int j = 0;
+
+                componentNum = (*SEC_OMX_COMPONENT_Library_Register)(NULL);
+                secComponentsTemp = (SECRegisterComponentType **)SEC_OSAL_Malloc(sizeof(SECRegisterComponentType*) * componentNum);
+                for (i = 0; i < componentNum; i++) {
+                    secComponentsTemp[i] = SEC_OSAL_Malloc(sizeof(SECRegisterComponentType));
+                    SEC_OSAL_Memset(secComponentsTemp[i], 0, sizeof(SECRegisterComponentType));
+                }
+                (*SEC_OMX_COMPONENT_Library_Register)(secComponentsTemp);
+
+                for (i = 0; i < componentNum; i++) {
+                    if (totalCompNum >= MAX_OMX_COMPONENT_NUM) {
+                        SEC_OSAL_Log(SEC_LOG_WARNING, "too many components, %s skipped",
+                                     secComponentsTemp[i]->componentName);
+                        continue;
                     }
 
-                    SEC_OSAL_Free(secComponentsTemp);
-                } else {
-                    if ((errorMsg = SEC_OSAL_dlerror()) != NULL)
-                        SEC_OSAL_Log(SEC_LOG_WARNING, "dlsym failed: %s", errorMsg);
+                    SEC_OSAL_Strcpy(componentList[totalCompNum].component.componentName, secComponentsTemp[i]->componentName);
+                    for (j = 0; j < secComponentsTemp[i]->totalRoleNum; j++)
+                        SEC_OSAL_Strcpy(componentList[totalCompNum].component.roles[j], secComponentsTemp[i]->roles[j]);
+                    componentList[totalCompNum].component.totalRoleNum = secComponentsTemp[i]->totalRoleNum;
+
+                    SEC_OSAL_Strcpy(componentList[totalCompNum].libName, libName);
+
+                    totalCompNum++;
                 }
-                SEC_OSAL_dlclose(soHandle);
+                for (i = 0; i < componentNum; i++) {
+                    SEC_OSAL_Free(secComponentsTemp[i]);
+                }
+
+                SEC_OSAL_Free(secComponentsTemp);
             } else {
-                SEC_OSAL_Log(SEC_LOG_WARNING, "dlopen failed: %s", SEC_OSAL_dlerror());
+                if ((errorMsg = SEC_OSAL_dlerror()) != NULL)
+                    SEC_OSAL_Log(SEC_LOG_WARNING, "dlsym failed: %s", errorMsg);
             }
+            SEC_OSAL_dlclose(soHandle);
         } else {
-            /* not a component name line. skip */
-            continue;
+            SEC_OSAL_Log(SEC_LOG_WARNING, "dlopen failed: %s", SEC_OSAL_dlerror());
         }
     }
 
-    SEC_OSAL_Free(libName);
+    return totalCompNum;
+}
+
+OMX_ERRORTYPE SEC_OMX_Component_Register(SEC_OMX_COMPONENT_REGLIST **compList, OMX_U32 *compNum)
+{
+    OMX_ERRORTYPE  ret = OMX_ErrorNone;
+    OMX_U32        libNum = 0, totalCompNum = 0;
+    DIR           *dir;
+
+    SEC_OMX_REGISTRY_LIB      *libList;
+    SEC_OMX_COMPONENT_REGLIST *componentList;
+
+    FunctionIn();
+
+    dir = opendir(SEC_OMX_INSTALL_PATH);
+    if (dir == NULL) {
+        ret = OMX_ErrorUndefined;
+        goto EXIT;
+    }
+
+    componentList = (SEC_OMX_COMPONENT_REGLIST *)SEC_OSAL_Malloc(sizeof(SEC_OMX_COMPONENT_REGLIST) * MAX_OMX_COMPONENT_NUM);
+    SEC_OSAL_Memset(componentList, 0, sizeof(SEC_OMX_COMPONENT_REGLIST) * MAX_OMX_COMPONENT_NUM);
+    libList = (SEC_OMX_REGISTRY_LIB *)SEC_OSAL_Malloc(sizeof(SEC_OMX_REGISTRY_LIB) * MAX_OMX_COMPONENT_NUM);
 
+    libNum = SEC_OMX_Component_ScanLibs(dir, libList);
     closedir(dir);
 
+    totalCompNum = SEC_OMX_Component_ReadRegistry(libList, libNum, componentList);
+    if (totalCompNum == 0) {
+        SEC_OSAL_Memset(componentList, 0, sizeof(SEC_OMX_COMPONENT_REGLIST) * MAX_OMX_COMPONENT_NUM);
+        totalCompNum = SEC_OMX_Component_ScanRegister(libList, libNum, componentList);
+        if (totalCompNum > 0)
+            SEC_OMX_Component_WriteRegistry(libList, libNum, componentList, totalCompNum);
+    }
+
+    SEC_OSAL_Free(libList);
+
+    SEC_OMX_Component_BuildHash(componentList, totalCompNum);
+
+    if (ghLibCacheMutex == NULL)
+        SEC_OSAL_MutexCreate(&ghLibCacheMutex);
+
     *compList = componentList;
     *compNum = totalCompNum;
 
@@ -137,6 +379,80 @@ EXIT:
     return ret;
 }
 
+OMX_S32 SEC_OMX_Component_Find(SEC_OMX_COMPONENT_REGLIST *componentList, OMX_STRING componentName)
+{
+    OMX_U32 slot = SEC_OMX_Component_Hash((OMX_U8 *)componentName);
+    OMX_U32 i, index;
+
+    if (componentList == NULL)
+        return -1;
+
+    for (i = 0; i < SEC_OMX_COMPONENT_HASH_SIZE; i++, slot++) {
+        index = gComponentHash[slot & (SEC_OMX_COMPONENT_HASH_SIZE - 1)];
+        if (index == 0)
+            break;
+        if (SEC_OSAL_Strcmp(componentList[index - 1].component.componentName, componentName) == 0)
+            return index - 1;
+    }
+
+    return -1;
+}
+
+static OMX_HANDLETYPE SEC_OMX_Component_LibOpen(OMX_U8 *libName)
+{
+    OMX_HANDLETYPE libHandle = NULL;
+    OMX_U32        i;
+
+    SEC_OSAL_MutexLock(ghLibCacheMutex);
+
+    for (i = 0; i < gLibCacheNum; i++) {
+        if (SEC_OSAL_Strcmp(gLibCache[i].libName, libName) == 0) {
+            libHandle = gLibCache[i].libHandle;
+            gLibCache[i].refCount++;
+            goto EXIT;
+        }
+    }
+
+    if (gLibCacheNum >= MAX_OMX_COMPONENT_NUM)
+        goto EXIT;
+
+    libHandle = SEC_OSAL_dlopen((const char *)libName, RTLD_NOW);
+    if (libHandle != NULL) {
+        SEC_OSAL_Strcpy(gLibCache[gLibCacheNum].libName, libName);
+        gLibCache[gLibCacheNum].libHandle = libHandle;
+        gLibCache[gLibCacheNum].refCount = 1;
+        gLibCacheNum++;
+    }
+
+EXIT:
+    SEC_OSAL_MutexUnlock(ghLibCacheMutex);
+
+    return libHandle;
+}
+
+static void SEC_OMX_Component_LibClose(OMX_HANDLETYPE libHandle)
+{
+    OMX_U32 i;
+
+    SEC_OSAL_MutexLock(ghLibCacheMutex);
+
+    for (i = 0; i < gLibCacheNum; i++) {
+        if (gLibCache[i].libHandle != libHandle)
+            continue;
+
+        if (--gLibCache[i].refCount == 0) {
+            SEC_OSAL_dlclose(libHandle);
+            gLibCacheNum--;
+            if (i != gLibCacheNum)
+                SEC_OSAL_Memcpy(&gLibCache[i], &gLibCache[gLibCacheNum], sizeof(SEC_OMX_LIB_CACHE));
+            SEC_OSAL_Memset(&gLibCache[gLibCacheNum], 0, sizeof(SEC_OMX_LIB_CACHE));
+        }
+        break;
+    }
+
+    SEC_OSAL_MutexUnlock(ghLibCacheMutex);
+}
+
 OMX_ERRORTYPE SEC_OMX_Component_Unregister(SEC_OMX_COMPONENT_REGLIST *componentList)
 {
     OMX_ERRORTYPE ret = OMX_ErrorNone;
@@ -146,6 +462,16 @@ OMX_ERRORTYPE SEC_OMX_Component_Unregister(SEC_OMX_COMPONENT_REGLIST *componentL
         SEC_OSAL_Free(componentList);
     }
 
+    SEC_OSAL_Memset(gComponentHash, 0, sizeof(gComponentHash));
+
+    /* loaded libraries belong to their live handles, FreeHandle closes them */
+    if (ghLibCacheMutex != NULL) {
+        SEC_OSAL_MutexLock(ghLibCacheMutex);
+        if (gLibCacheNum > 0)
+            SEC_OSAL_Log(SEC_LOG_WARNING, "%d component libraries still in use", gLibCacheNum);
+        SEC_OSAL_MutexUnlock(ghLibCacheMutex);
+    }
+
 EXIT:
     return ret;
 }
@@ -189,7 +515,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentLoad(SEC_OMX_COMPONENT *sec_component)
 
     OMX_ERRORTYPE (*SEC_OMX_ComponentInit)(OMX_HANDLETYPE hComponent, OMX_STRING componentName);
 
-    libHandle = SEC_OSAL_dlopen((OMX_STRING)sec_component->libName, RTLD_NOW);
+    libHandle = SEC_OMX_Component_LibOpen(sec_component->libName);
     if (!libHandle) {
         ret = OMX_ErrorInvalidComponentName;
         SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_ErrorInvalidComponentName, Line:%d", __LINE__);
@@ -198,7 +524,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentLoad(SEC_OMX_COMPONENT *sec_component)
 
     SEC_OMX_ComponentInit = SEC_OSAL_dlsym(libHandle, "SEC_OMX_ComponentInit");
     if (!SEC_OMX_ComponentInit) {
-        SEC_OSAL_dlclose(libHandle);
+        SEC_OMX_Component_LibClose(libHandle);
         ret = OMX_ErrorInvalidComponent;
         SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_ErrorInvalidComponent, Line:%d", __LINE__);
         goto EXIT;
@@ -209,7 +535,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentLoad(SEC_OMX_COMPONENT *sec_component)
     ret = (*SEC_OMX_ComponentInit)((OMX_HANDLETYPE)pOMXComponent, (OMX_STRING)sec_component->componentName);
     if (ret != OMX_ErrorNone) {
         SEC_OSAL_Free(pOMXComponent);
-        SEC_OSAL_dlclose(libHandle);
+        SEC_OMX_Component_LibClose(libHandle);
         ret = OMX_ErrorInvalidComponent;
         SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_ErrorInvalidComponent, Line:%d", __LINE__);
         goto EXIT;
@@ -218,7 +544,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentLoad(SEC_OMX_COMPONENT *sec_component)
             if (NULL != pOMXComponent->ComponentDeInit)
                 pOMXComponent->ComponentDeInit(pOMXComponent);
             SEC_OSAL_Free(pOMXComponent);
-            SEC_OSAL_dlclose(libHandle);
+            SEC_OMX_Component_LibClose(libHandle);
             ret = OMX_ErrorInvalidComponent;
             SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_ErrorInvalidComponent, Line:%d", __LINE__);
             goto EXIT;
@@ -254,7 +580,7 @@ OMX_ERRORTYPE SEC_OMX_ComponentUnload(SEC_OMX_COMPONENT *sec_component)
     }
 
     if (sec_component->libHandle != NULL) {
-        SEC_OSAL_dlclose(sec_component->libHandle);
+        SEC_OMX_Component_LibClose(sec_component->libHandle);
         sec_component->libHandle = NULL;
     }
 
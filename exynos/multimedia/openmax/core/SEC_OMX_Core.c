@@ -143,7 +143,7 @@ OMX_API OMX_ERRORTYPE OMX_APIENTRY SEC_OMX_GetHandle(
     OMX_ERRORTYPE      ret = OMX_ErrorNone;
     SEC_OMX_COMPONENT *loadComponent;
     SEC_OMX_COMPONENT *currentComponent;
-    unsigned int i = 0;
+    OMX_S32 i = 0;
 
     FunctionIn();
 
@@ -158,48 +158,47 @@ OMX_API OMX_ERRORTYPE OMX_APIENTRY SEC_OMX_GetHandle(
     }
     SEC_OSAL_Log(SEC_LOG_TRACE, "ComponentName : %s", cComponentName);
 
-    for (i = 0; i < gComponentNum; i++) {
-        if (SEC_OSAL_Strcmp(cComponentName, gComponentList[i].component.componentName) == 0) {
-            loadComponent = SEC_OSAL_Malloc(sizeof(SEC_OMX_COMPONENT));
-            SEC_OSAL_Memset(loadComponent, 0, sizeof(SEC_OMX_COMPONENT));
-
-            SEC_OSAL_Strcpy(loadComponent->libName, gComponentList[i].libName);
-            SEC_OSAL_Strcpy(loadComponent->componentName, gComponentList[i].component.componentName);
-            ret = SEC_OMX_ComponentLoad(loadComponent);
-            if (ret != OMX_ErrorNone) {
-                SEC_OSAL_Free(loadComponent);
-                SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_Error, Line:%d", __LINE__);
-                goto EXIT;
-            }
+    i = SEC_OMX_Component_Find(gComponentList, cComponentName);
+    if (i < 0) {
+        ret = OMX_ErrorComponentNotFound;
+        goto EXIT;
+    }
 
-            ret = loadComponent->pOMXComponent->SetCallbacks(loadComponent->pOMXComponent, pCallBacks, pAppData);
-            if (ret != OMX_ErrorNone) {
-                SEC_OMX_ComponentUnload(loadComponent);
-                SEC_OSAL_Free(loadComponent);
-                SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_Error, Line:%d", __LINE__);
-                goto EXIT;
-            }
+    loadComponent = SEC_OSAL_Malloc(sizeof(SEC_OMX_COMPONENT));
+    SEC_OSAL_Memset(loadComponent, 0, sizeof(SEC_OMX_COMPONENT));
 
-            SEC_OSAL_MutexLock(ghLoadComponentListMutex);
-            if (gLoadComponentList == NULL) {
-                gLoadComponentList = loadComponent;
-            } else {
-                currentComponent = gLoadComponentList;
-                while (currentComponent->nextOMXComp != NULL) {
-                    currentComponent = currentComponent->nextOMXComp;
-                }
-                currentComponent->nextOMXComp = loadComponent;
-            }
-            SEC_OSAL_MutexUnlock(ghLoadComponentListMutex);
+    SEC_OSAL_Strcpy(loadComponent->libName, gComponentList[i].libName);
+    SEC_OSAL_Strcpy(loadComponent->componentName, gComponentList[i].component.componentName);
+    ret = SEC_OMX_ComponentLoad(loadComponent);
+    if (ret != OMX_ErrorNone) {
+        SEC_OSAL_Free(loadComponent);
+        SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_Error, Line:%d", __LINE__);
+        goto EXIT;
+    }
 
-            *pHandle = loadComponent->pOMXComponent;
-            ret = OMX_ErrorNone;
-            SEC_OSAL_Log(SEC_LOG_TRACE, "SEC_OMX_GetHandle : %s", "OMX_ErrorNone");
-            goto EXIT;
+    ret = loadComponent->pOMXComponent->SetCallbacks(loadComponent->pOMXComponent, pCallBacks, pAppData);
+    if (ret != OMX_ErrorNone) {
+        SEC_OMX_ComponentUnload(loadComponent);
+        SEC_OSAL_Free(loadComponent);
+        SEC_OSAL_Log(SEC_LOG_ERROR, "OMX_Error, Line:%d", __LINE__);
+        goto EXIT;
+    }
+
+    SEC_OSAL_MutexLock(ghLoadComponentListMutex);
+    if (gLoadComponentList == NULL) {
+        gLoadComponentList = loadComponent;
+    } else {
+        currentComponent = gLoadComponentList;
+        while (currentComponent->nextOMXComp != NULL) {
+            currentComponent = currentComponent->nextOMXComp;
         }
+        currentComponent->nextOMXComp = loadComponent;
     }
+    SEC_OSAL_MutexUnlock(ghLoadComponentListMutex);
 
-    ret = OMX_ErrorComponentNotFound;
+    *pHandle = loadComponent->pOMXComponent;
+    ret = OMX_ErrorNone;
+    SEC_OSAL_Log(SEC_LOG_TRACE, "SEC_OMX_GetHandle : %s", "OMX_ErrorNone");
 
 EXIT:
     FunctionOut();
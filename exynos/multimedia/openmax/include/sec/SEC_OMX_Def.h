@@ -47,6 +47,7 @@
 #define MAX_FLAGS            17
 
 #define SEC_OMX_INSTALL_PATH "/system/lib/omx/"
+#define SEC_OMX_REGISTRY_PATH "/data/misc/media/libOMX.SEC.registry"
 
 typedef enum _SEC_CODEC_TYPE
 {
@@ -70,6 +71,14 @@ typedef enum _SEC_OMX_INDEXTYPE
     OMX_IndexVendorThumbnailMode        = 0x7F000001,
 #define SEC_INDEX_CONFIG_VIDEO_INTRAPERIOD "OMX.SEC.index.VideoIntraPeriod"
     OMX_IndexConfigVideoIntraPeriod     = 0x7F000002,
+#define SEC_INDEX_CONFIG_AUDIO_PCM_BATCH "OMX.SEC.index.AudioPcmBatch"
+    OMX_IndexConfigAudioPcmBatch        = 0x7F000003,
+#define SEC_INDEX_CONFIG_AUDIO_WAKEUP_RATE "OMX.SEC.index.AudioWakeupRate"
+    OMX_IndexConfigAudioWakeupRate      = 0x7F000004,
+#define SEC_INDEX_CONFIG_RESOURCE_STATUS "OMX.SEC.index.ResourceStatus"
+    OMX_IndexConfigResourceStatus       = 0x7F000005,
+#define SEC_INDEX_CONFIG_RESOURCE_EVENTS "OMX.SEC.index.ResourceEvents"
+    OMX_IndexConfigResourceEvents       = 0x7F000006,
 
     /* for Android Native Window */
 #define SEC_INDEX_PARAM_ENABLE_ANB "OMX.google.android.index.enableAndroidNativeBuffers"
@@ -13,7 +13,8 @@ LOCAL_SRC_FILES := \
 	SEC_OSAL_Memory.c \
 	SEC_OSAL_Semaphore.c \
 	SEC_OSAL_Library.c \
-	SEC_OSAL_Log.c
+	SEC_OSAL_Log.c \
+	SEC_OSAL_Trace.c
 
 LOCAL_PRELINK_MODULE := false
 LOCAL_MODULE := libsecosal
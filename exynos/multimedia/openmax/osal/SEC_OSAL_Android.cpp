@@ -55,6 +55,7 @@ extern "C" {
 #endif
 
 OMX_ERRORTYPE useAndroidNativeBuffer(
+    SEC_OMX_BASECOMPONENT *pSECComponent,
     SEC_OMX_BASEPORT      *pSECPort,
     OMX_BUFFERHEADERTYPE **ppBufferHdr,
     OMX_U32                nPortIndex,
@@ -81,7 +82,8 @@ OMX_ERRORTYPE useAndroidNativeBuffer(
         goto EXIT;
     }
 
-    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_Malloc(sizeof(OMX_BUFFERHEADERTYPE));
+    /* released by the component's FreeBuffer, which returns headers to the arena */
+    temp_bufferHeader = (OMX_BUFFERHEADERTYPE *)SEC_OSAL_ArenaAlloc(pSECComponent->hMemArena, SEC_OMX_MEMCLASS_BUFFERHEADER);
     if (temp_bufferHeader == NULL) {
         ret = OMX_ErrorInsufficientResources;
         goto EXIT;
@@ -113,7 +115,7 @@ OMX_ERRORTYPE useAndroidNativeBuffer(
         }
     }
 
-    SEC_OSAL_Free(temp_bufferHeader);
+    SEC_OSAL_ArenaFree(temp_bufferHeader);
     ret = OMX_ErrorInsufficientResources;
 
 EXIT:
@@ -470,7 +472,8 @@ OMX_ERRORTYPE SEC_OSAL_SetANBParameter(
         nSizeBytes = ALIGN(pANB->width, 16) * ALIGN(pANB->height, 16);
         nSizeBytes += ALIGN(pANB->width / 2, 16) * ALIGN(pANB->height / 2, 16) * 2;
 
-        ret = useAndroidNativeBuffer(pSECPort,
+        ret = useAndroidNativeBuffer(pSECComponent,
+                                     pSECPort,
                                      pANBParams->bufferHeader,
                                      pANBParams->nPortIndex,
                                      pANBParams->pAppPrivate,
@@ -29,11 +29,49 @@
 #include <string.h>
 
 #include "SEC_OSAL_Memory.h"
+#include "SEC_OSAL_Mutex.h"
 
 #define SEC_LOG_OFF
 #include "SEC_OSAL_Log.h"
 
 
+#define SEC_ARENA_MAGIC       0x53424C4B /* "SBLK" */
+#define SEC_ARENA_NAME_LEN    32
+
+struct _SEC_ARENA_CLASS;
+
+/* object header, kept a multiple of 8 bytes so the payload stays aligned */
+typedef struct _SEC_ARENA_OBJ
+{
+    struct _SEC_ARENA_CLASS *pClass;
+    struct _SEC_ARENA_OBJ   *pNextFree;
+    OMX_U32                  magic;
+    OMX_U32                  bLive;
+} SEC_ARENA_OBJ;
+
+typedef union _SEC_ARENA_SLAB
+{
+    union _SEC_ARENA_SLAB *pNext;
+    OMX_U64                align[2];
+} SEC_ARENA_SLAB;
+
+typedef struct _SEC_ARENA_CLASS
+{
+    struct _SEC_ARENA *pArena;
+    OMX_U32            objStride;
+    SEC_ARENA_OBJ     *pFreeList;
+    SEC_ARENA_SLAB    *pSlabList;
+    SEC_ARENA_STATS    stats;
+} SEC_ARENA_CLASS;
+
+typedef struct _SEC_ARENA
+{
+    char            name[SEC_ARENA_NAME_LEN];
+    OMX_HANDLETYPE  hMutex;
+    OMX_U32         nClass;
+    SEC_ARENA_CLASS class[SEC_ARENA_MAX_CLASS];
+} SEC_ARENA;
+
 static int mem_cnt = 0;
 
 OMX_PTR SEC_OSAL_Malloc(OMX_U32 size)
@@ -69,3 +107,186 @@ OMX_PTR SEC_OSAL_Memmove(OMX_PTR dest, OMX_PTR src, OMX_S32 n)
 {
     return memmove(dest, src, n);
 }
+
+OMX_ERRORTYPE SEC_OSAL_ArenaCreate(OMX_HANDLETYPE *arenaHandle, const char *name,
+                                   const OMX_U32 *objSize, OMX_U32 nClass)
+{
+    SEC_ARENA *pArena = NULL;
+    OMX_ERRORTYPE ret = OMX_ErrorNone;
+    OMX_U32 i = 0;
+
+    if ((arenaHandle == NULL) || (objSize == NULL) ||
+        (nClass == 0) || (nClass > SEC_ARENA_MAX_CLASS))
+        return OMX_ErrorBadParameter;
+
+    *arenaHandle = NULL;
+
+    pArena = (SEC_ARENA *)SEC_OSAL_Malloc(sizeof(SEC_ARENA));
+    if (pArena == NULL)
+        return OMX_ErrorInsufficientResources;
+    SEC_OSAL_Memset(pArena, 0, sizeof(SEC_ARENA));
+
+    ret = SEC_OSAL_MutexCreate(&pArena->hMutex);
+    if (ret != OMX_ErrorNone) {
+        SEC_OSAL_Free(pArena);
+        return ret;
+    }
+
+    if (name != NULL)
+        strncpy(pArena->name, name, SEC_ARENA_NAME_LEN - 1);
+    pArena->nClass = nClass;
+    for (i = 0; i < nClass; i++) {
+        pArena->class[i].pArena = pArena;
+        pArena->class[i].objStride = sizeof(SEC_ARENA_OBJ) + ((objSize[i] + 7) & ~7);
+        pArena->class[i].stats.nObjSize = objSize[i];
+    }
+
+    *arenaHandle = (OMX_HANDLETYPE)pArena;
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SEC_OSAL_ArenaTerminate(OMX_HANDLETYPE arenaHandle)
+{
+    SEC_ARENA *pArena = (SEC_ARENA *)arenaHandle;
+    SEC_ARENA_CLASS *pClass = NULL;
+    SEC_ARENA_SLAB *pSlab = NULL;
+    OMX_U32 i = 0;
+
+    if (pArena == NULL)
+        return OMX_ErrorBadParameter;
+
+    SEC_OSAL_MutexLock(pArena->hMutex);
+    for (i = 0; i < pArena->nClass; i++) {
+        pClass = &pArena->class[i];
+
+        _SEC_OSAL_Log(SEC_LOG_TRACE, SEC_LOG_TAG, "arena %s class %d(%d bytes): alloc %d, free %d, peak %d, slab %d",
+                      pArena->name, i, pClass->stats.nObjSize, pClass->stats.nAlloc,
+                      pClass->stats.nFree, pClass->stats.nPeak, pClass->stats.nSlab);
+        if (pClass->stats.nLive != 0)
+            _SEC_OSAL_Log(SEC_LOG_WARNING, SEC_LOG_TAG, "arena %s class %d(%d bytes): %d object(s) leaked, reclaimed",
+                          pArena->name, i, pClass->stats.nObjSize, pClass->stats.nLive);
+
+        while (pClass->pSlabList != NULL) {
+            pSlab = pClass->pSlabList;
+            pClass->pSlabList = pSlab->pNext;
+            SEC_OSAL_Free(pSlab);
+        }
+        pClass->pFreeList = NULL;
+    }
+    SEC_OSAL_MutexUnlock(pArena->hMutex);
+
+    SEC_OSAL_MutexTerminate(pArena->hMutex);
+    SEC_OSAL_Free(pArena);
+
+    return OMX_ErrorNone;
+}
+
+static OMX_ERRORTYPE SEC_OSAL_ArenaGrow(SEC_ARENA_CLASS *pClass)
+{
+    SEC_ARENA_SLAB *pSlab = NULL;
+    SEC_ARENA_OBJ *pObj = NULL;
+    OMX_U8 *pBase = NULL;
+    int i = 0;
+
+    pSlab = (SEC_ARENA_SLAB *)SEC_OSAL_Malloc(sizeof(SEC_ARENA_SLAB) + (pClass->objStride * SEC_ARENA_SLAB_OBJS));
+    if (pSlab == NULL)
+        return OMX_ErrorInsufficientResources;
+
+    pSlab->pNext = pClass->pSlabList;
+    pClass->pSlabList = pSlab;
+    pClass->stats.nSlab++;
+
+    pBase = (OMX_U8 *)(pSlab + 1);
+    for (i = SEC_ARENA_SLAB_OBJS - 1; i >= 0; i--) {
+        pObj = (SEC_ARENA_OBJ *)(pBase + (pClass->objStride * i));
+        pObj->pClass = pClass;
+        pObj->magic = SEC_ARENA_MAGIC;
+        pObj->bLive = OMX_FALSE;
+        pObj->pNextFree = pClass->pFreeList;
+        pClass->pFreeList = pObj;
+    }
+
+    return OMX_ErrorNone;
+}
+
+OMX_PTR SEC_OSAL_ArenaAlloc(OMX_HANDLETYPE arenaHandle, OMX_U32 nClass)
+{
+    SEC_ARENA *pArena = (SEC_ARENA *)arenaHandle;
+    SEC_ARENA_CLASS *pClass = NULL;
+    SEC_ARENA_OBJ *pObj = NULL;
+
+    if ((pArena == NULL) || (nClass >= pArena->nClass))
+        return NULL;
+
+    pClass = &pArena->class[nClass];
+
+    SEC_OSAL_MutexLock(pArena->hMutex);
+    if ((pClass->pFreeList == NULL) &&
+        (SEC_OSAL_ArenaGrow(pClass) != OMX_ErrorNone)) {
+        SEC_OSAL_MutexUnlock(pArena->hMutex);
+        return NULL;
+    }
+
+    pObj = pClass->pFreeList;
+    pClass->pFreeList = pObj->pNextFree;
+    pObj->pNextFree = NULL;
+    pObj->bLive = OMX_TRUE;
+
+    pClass->stats.nAlloc++;
+    pClass->stats.nLive++;
+    if (pClass->stats.nLive > pClass->stats.nPeak)
+        pClass->stats.nPeak = pClass->stats.nLive;
+    SEC_OSAL_MutexUnlock(pArena->hMutex);
+
+    return (OMX_PTR)(pObj + 1);
+}
+
+void SEC_OSAL_ArenaFree(OMX_PTR addr)
+{
+    SEC_ARENA_OBJ *pObj = NULL;
+    SEC_ARENA_CLASS *pClass = NULL;
+    SEC_ARENA *pArena = NULL;
+
+    if (addr == NULL)
+        return;
+
+    pObj = ((SEC_ARENA_OBJ *)addr) - 1;
+    if ((pObj->magic != SEC_ARENA_MAGIC) || (pObj->pClass == NULL)) {
+        _SEC_OSAL_Log(SEC_LOG_ERROR, SEC_LOG_TAG, "%s: %p is not an arena object", __FUNCTION__, addr);
+        return;
+    }
+
+    pClass = pObj->pClass;
+    pArena = pClass->pArena;
+
+    SEC_OSAL_MutexLock(pArena->hMutex);
+    if (pObj->bLive != OMX_TRUE) {
+        SEC_OSAL_MutexUnlock(pArena->hMutex);
+        _SEC_OSAL_Log(SEC_LOG_ERROR, SEC_LOG_TAG, "%s: double free of %p in arena %s", __FUNCTION__, addr, pArena->name);
+        return;
+    }
+    pObj->bLive = OMX_FALSE;
+    pObj->pNextFree = pClass->pFreeList;
+    pClass->pFreeList = pObj;
+
+    pClass->stats.nFree++;
+    pClass->stats.nLive--;
+    SEC_OSAL_MutexUnlock(pArena->hMutex);
+
+    return;
+}
+
+OMX_ERRORTYPE SEC_OSAL_ArenaGetStats(OMX_HANDLETYPE arenaHandle, OMX_U32 nClass, SEC_ARENA_STATS *pStats)
+{
+    SEC_ARENA *pArena = (SEC_ARENA *)arenaHandle;
+
+    if ((pArena == NULL) || (pStats == NULL) || (nClass >= pArena->nClass))
+        return OMX_ErrorBadParameter;
+
+    SEC_OSAL_MutexLock(pArena->hMutex);
+    SEC_OSAL_Memcpy(pStats, &pArena->class[nClass].stats, sizeof(SEC_ARENA_STATS));
+    SEC_OSAL_MutexUnlock(pArena->hMutex);
+
+    return OMX_ErrorNone;
+}
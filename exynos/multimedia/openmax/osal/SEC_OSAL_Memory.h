@@ -28,8 +28,22 @@
 #define SEC_OSAL_MEMORY
 
 #include "OMX_Types.h"
+#include "OMX_Core.h"
 
 
+#define SEC_ARENA_MAX_CLASS   4
+#define SEC_ARENA_SLAB_OBJS   16
+
+typedef struct _SEC_ARENA_STATS
+{
+    OMX_U32 nObjSize;
+    OMX_U32 nAlloc;
+    OMX_U32 nFree;
+    OMX_U32 nLive;
+    OMX_U32 nPeak;
+    OMX_U32 nSlab;
+} SEC_ARENA_STATS;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,6 +54,18 @@ OMX_PTR SEC_OSAL_Memset(OMX_PTR dest, OMX_S32 c, OMX_S32 n);
 OMX_PTR SEC_OSAL_Memcpy(OMX_PTR dest, OMX_PTR src, OMX_S32 n);
 OMX_PTR SEC_OSAL_Memmove(OMX_PTR dest, OMX_PTR src, OMX_S32 n);
 
+/*
+ * Fixed-size object arena. Each class hands out objects of one size from
+ * slabs of SEC_ARENA_SLAB_OBJS objects; freed objects go back on the class
+ * freelist and slabs are only released by SEC_OSAL_ArenaTerminate.
+ */
+OMX_ERRORTYPE SEC_OSAL_ArenaCreate(OMX_HANDLETYPE *arenaHandle, const char *name,
+                                   const OMX_U32 *objSize, OMX_U32 nClass);
+OMX_ERRORTYPE SEC_OSAL_ArenaTerminate(OMX_HANDLETYPE arenaHandle);
+OMX_PTR       SEC_OSAL_ArenaAlloc(OMX_HANDLETYPE arenaHandle, OMX_U32 nClass);
+void          SEC_OSAL_ArenaFree(OMX_PTR addr);
+OMX_ERRORTYPE SEC_OSAL_ArenaGetStats(OMX_HANDLETYPE arenaHandle, OMX_U32 nClass, SEC_ARENA_STATS *pStats);
+
 #ifdef __cplusplus
 }
 #endif
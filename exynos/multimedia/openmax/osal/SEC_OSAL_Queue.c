@@ -37,8 +37,6 @@
 OMX_ERRORTYPE SEC_OSAL_QueueCreate(SEC_QUEUE *queueHandle)
 {
     int i = 0;
-    SEC_QElem *newqelem = NULL;
-    SEC_QElem *currentqelem = NULL;
     SEC_QUEUE *queue = (SEC_QUEUE *)queueHandle;
 
     OMX_ERRORTYPE ret = OMX_ErrorNone;
@@ -50,55 +48,38 @@ OMX_ERRORTYPE SEC_OSAL_QueueCreate(SEC_QUEUE *queueHandle)
     if (ret != OMX_ErrorNone)
         return ret;
 
-    queue->first = (SEC_QElem *)SEC_OSAL_Malloc(sizeof(SEC_QElem));
-    if (queue->first == NULL)
+    /* all ring nodes come from one block so create/terminate is one allocation */
+    queue->elemBlock = (SEC_QElem *)SEC_OSAL_Malloc(sizeof(SEC_QElem) * (MAX_QUEUE_ELEMENTS - 1));
+    if (queue->elemBlock == NULL) {
+        SEC_OSAL_MutexTerminate(queue->qMutex);
+        queue->qMutex = NULL;
         return OMX_ErrorInsufficientResources;
-
-    SEC_OSAL_Memset(queue->first, 0, sizeof(SEC_QElem));
-    currentqelem = queue->last = queue->first;
-    queue->numElem = 0;
-
-    for (i = 0; i < (MAX_QUEUE_ELEMENTS - 2); i++) {
-        newqelem = (SEC_QElem *)SEC_OSAL_Malloc(sizeof(SEC_QElem));
-        if (newqelem == NULL) {
-            while (queue->first != NULL) {
-                currentqelem = queue->first->qNext;
-                SEC_OSAL_Free((OMX_PTR)queue->first);
-                queue->first = currentqelem;
-            }
-            return OMX_ErrorInsufficientResources;
-        } else {
-            SEC_OSAL_Memset(newqelem, 0, sizeof(SEC_QElem));
-            currentqelem->qNext = newqelem;
-            currentqelem = newqelem;
-        }
     }
+    SEC_OSAL_Memset(queue->elemBlock, 0, sizeof(SEC_QElem) * (MAX_QUEUE_ELEMENTS - 1));
+
+    for (i = 0; i < (MAX_QUEUE_ELEMENTS - 2); i++)
+        queue->elemBlock[i].qNext = &queue->elemBlock[i + 1];
+    queue->elemBlock[MAX_QUEUE_ELEMENTS - 2].qNext = &queue->elemBlock[0];
 
-    currentqelem->qNext = queue->first;
+    queue->first = queue->last = queue->elemBlock;
+    queue->numElem = 0;
 
     return OMX_ErrorNone;
 }
 
 OMX_ERRORTYPE SEC_OSAL_QueueTerminate(SEC_QUEUE *queueHandle)
 {
-    int i = 0;
-    SEC_QElem *currentqelem = NULL;
     SEC_QUEUE *queue = (SEC_QUEUE *)queueHandle;
     OMX_ERRORTYPE ret = OMX_ErrorNone;
 
     if (!queue)
         return OMX_ErrorBadParameter;
 
-    for ( i = 0; i < (MAX_QUEUE_ELEMENTS - 2); i++) {
-        currentqelem = queue->first->qNext;
-        SEC_OSAL_Free(queue->first);
-        queue->first = currentqelem;
-    }
-
-    if(queue->first) {
-        SEC_OSAL_Free(queue->first);
-        queue->first = NULL;
+    if (queue->elemBlock) {
+        SEC_OSAL_Free(queue->elemBlock);
+        queue->elemBlock = NULL;
     }
+    queue->first = queue->last = NULL;
 
     ret = SEC_OSAL_MutexTerminate(queue->qMutex);
 
@@ -43,6 +43,7 @@ typedef struct _SEC_QUEUE
 {
     SEC_QElem     *first;
     SEC_QElem     *last;
+    SEC_QElem     *elemBlock;
     int            numElem;
     OMX_HANDLETYPE qMutex;
 } SEC_QUEUE;
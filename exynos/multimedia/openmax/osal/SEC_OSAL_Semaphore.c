@@ -27,6 +27,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <pthread.h>
 #include <semaphore.h>
 
@@ -104,6 +105,20 @@ OMX_ERRORTYPE SEC_OSAL_SemaphorePost(OMX_HANDLETYPE semaphoreHandle)
     return OMX_ErrorNone;
 }
 
+/* OMX_ErrorNotReady when the count is already zero */
+OMX_ERRORTYPE SEC_OSAL_SemaphoreTryWait(OMX_HANDLETYPE semaphoreHandle)
+{
+    sem_t *sema = (sem_t *)semaphoreHandle;
+
+    if (sema == NULL)
+        return OMX_ErrorBadParameter;
+
+    if (sem_trywait(sema) != 0)
+        return (errno == EAGAIN) ? OMX_ErrorNotReady : OMX_ErrorUndefined;
+
+    return OMX_ErrorNone;
+}
+
 OMX_ERRORTYPE SEC_OSAL_Set_SemaphoreCount(OMX_HANDLETYPE semaphoreHandle, OMX_S32 val)
 {
     sem_t *sema = (sem_t *)semaphoreHandle;
@@ -0,0 +1,493 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        SEC_OSAL_Trace.c
+ * @brief       binary per-frame trace events
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ *
+ * Every thread that records an event owns a ring of SEC_TRACE_RECORDs, so
+ * the hot path takes no lock and formats nothing. The rings are linked
+ * into a global list (the only mutex is taken when a thread records its
+ * first event) and are recycled once their thread exits. Readers copy the
+ * rings without stopping the writers, which is good enough for a report
+ * taken at the end of a session.
+ *
+ * libsecosal is linked statically, so every component library has its
+ * own copy of this file. The property is read on first use in each copy.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <cutils/properties.h>
+
+#include "SEC_OSAL_Trace.h"
+
+#undef  SEC_LOG_TAG
+#define SEC_LOG_TAG    "SEC_TRACE"
+#define SEC_LOG_OFF
+#include "SEC_OSAL_Log.h"
+
+typedef struct _SEC_TRACE_RING
+{
+    struct _SEC_TRACE_RING *pNext;
+    volatile OMX_S32        owned;
+    OMX_S32                 tid;
+    volatile OMX_U32        head;
+    SEC_TRACE_RECORD        record[SEC_TRACE_RING_SIZE];
+} SEC_TRACE_RING;
+
+typedef enum _SEC_TRACE_STAGE
+{
+    SEC_TRACE_STAGE_PARSE = 0,  /* arrive -> parsed */
+    SEC_TRACE_STAGE_QUEUE,      /* parsed -> submit */
+    SEC_TRACE_STAGE_HW,         /* submit -> done */
+    SEC_TRACE_STAGE_CSC,        /* csc start -> csc done */
+    SEC_TRACE_STAGE_OUTPUT,     /* done -> returned */
+    SEC_TRACE_STAGE_TOTAL,      /* arrive -> returned */
+    SEC_TRACE_STAGE_MAX
+} SEC_TRACE_STAGE;
+
+static const struct {
+    const char     *name;
+    SEC_TRACE_EVENT from;
+    SEC_TRACE_EVENT to;
+} gStage[SEC_TRACE_STAGE_MAX] = {
+    { "parse",  SEC_TRACE_INPUT_ARRIVE, SEC_TRACE_INPUT_PARSED  },
+    { "queue",  SEC_TRACE_INPUT_PARSED, SEC_TRACE_HW_SUBMIT     },
+    { "hw",     SEC_TRACE_HW_SUBMIT,    SEC_TRACE_HW_DONE       },
+    { "csc",    SEC_TRACE_CSC_START,    SEC_TRACE_CSC_DONE      },
+    { "output", SEC_TRACE_HW_DONE,      SEC_TRACE_OUTPUT_RETURN },
+    { "total",  SEC_TRACE_INPUT_ARRIVE, SEC_TRACE_OUTPUT_RETURN },
+};
+
+static const char *gEventName[SEC_TRACE_EVENT_MAX] = {
+    "input_arrive", "input_parsed", "hw", "hw", "csc", "csc", "output_return", "input_return", "flush"
+};
+
+/* -1 until the property has been read */
+volatile OMX_S32 gSECTraceEnabled = -1;
+
+static SEC_TRACE_RING  *gpTraceRingList = NULL;
+static pthread_mutex_t  gTraceListMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_key_t    gTraceKey;
+static pthread_once_t   gTraceOnce = PTHREAD_ONCE_INIT;
+static pthread_once_t   gTraceInitOnce = PTHREAD_ONCE_INIT;
+
+static void releaseRing(void *data)
+{
+    SEC_TRACE_RING *pRing = (SEC_TRACE_RING *)data;
+
+    __sync_synchronize();
+    pRing->owned = 0;
+}
+
+static void createKey(void)
+{
+    pthread_key_create(&gTraceKey, releaseRing);
+}
+
+static SEC_TRACE_RING *getRing(void)
+{
+    SEC_TRACE_RING *pRing;
+
+    pthread_once(&gTraceOnce, createKey);
+
+    pRing = (SEC_TRACE_RING *)pthread_getspecific(gTraceKey);
+    if (pRing != NULL)
+        return pRing;
+
+    pthread_mutex_lock(&gTraceListMutex);
+    for (pRing = gpTraceRingList; pRing != NULL; pRing = pRing->pNext) {
+        if (!pRing->owned)
+            break;
+    }
+    if (pRing == NULL) {
+        pRing = (SEC_TRACE_RING *)malloc(sizeof(SEC_TRACE_RING));
+        if (pRing != NULL) {
+            pRing->pNext = gpTraceRingList;
+            gpTraceRingList = pRing;
+        }
+    }
+    if (pRing != NULL) {
+        pRing->owned = 1;
+        pRing->tid = gettid();
+        pRing->head = 0;
+    }
+    pthread_mutex_unlock(&gTraceListMutex);
+
+    if (pRing != NULL)
+        pthread_setspecific(gTraceKey, pRing);
+
+    return pRing;
+}
+
+static OMX_S64 traceNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (OMX_S64)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static void readProperty(void)
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(SEC_TRACE_PROPERTY, value, "0");
+    gSECTraceEnabled = (atoi(value) != 0);
+}
+
+void SEC_OSAL_TraceInit(void)
+{
+    pthread_once(&gTraceInitOnce, readProperty);
+}
+
+void _SEC_OSAL_Trace(SEC_TRACE_EVENT event, OMX_PTR pComponent, OMX_TICKS key)
+{
+    SEC_TRACE_RING   *pRing;
+    SEC_TRACE_RECORD *pRecord;
+
+    if (gSECTraceEnabled < 0)
+        SEC_OSAL_TraceInit();
+    if (!gSECTraceEnabled)
+        return;
+
+    pRing = getRing();
+    if (pRing == NULL)
+        return;
+
+    pRecord = &pRing->record[pRing->head & (SEC_TRACE_RING_SIZE - 1)];
+    pRecord->time = traceNow();
+    pRecord->key = key;
+    pRecord->pComponent = pComponent;
+    pRecord->event = event;
+    pRecord->tid = pRing->tid;
+
+    __sync_synchronize();
+    pRing->head++;
+}
+
+/* copy every ring into one array, returns the number of records */
+static OMX_S32 collectRecords(SEC_TRACE_RECORD **ppRecords)
+{
+    SEC_TRACE_RING   *pRing;
+    SEC_TRACE_RECORD *pRecords;
+    OMX_U32 head, count, i;
+    OMX_S32 nRings = 0, n = 0;
+
+    pthread_mutex_lock(&gTraceListMutex);
+
+    for (pRing = gpTraceRingList; pRing != NULL; pRing = pRing->pNext)
+        nRings++;
+
+    pRecords = (SEC_TRACE_RECORD *)malloc(sizeof(SEC_TRACE_RECORD) * SEC_TRACE_RING_SIZE * (nRings ? nRings : 1));
+    if (pRecords == NULL) {
+        pthread_mutex_unlock(&gTraceListMutex);
+        return -1;
+    }
+
+    for (pRing = gpTraceRingList; pRing != NULL; pRing = pRing->pNext) {
+        head = pRing->head;
+        __sync_synchronize();
+        count = (head < SEC_TRACE_RING_SIZE) ? head : SEC_TRACE_RING_SIZE;
+        for (i = head - count; i != head; i++)
+            pRecords[n++] = pRing->record[i & (SEC_TRACE_RING_SIZE - 1)];
+    }
+
+    pthread_mutex_unlock(&gTraceListMutex);
+
+    *ppRecords = pRecords;
+
+    return n;
+}
+
+static int compareTime(const void *a, const void *b)
+{
+    const SEC_TRACE_RECORD *pA = (const SEC_TRACE_RECORD *)a;
+    const SEC_TRACE_RECORD *pB = (const SEC_TRACE_RECORD *)b;
+
+    return (pA->time < pB->time) ? -1 : (pA->time > pB->time);
+}
+
+/* group by component and frame, then by time */
+static int compareFrame(const void *a, const void *b)
+{
+    const SEC_TRACE_RECORD *pA = (const SEC_TRACE_RECORD *)a;
+    const SEC_TRACE_RECORD *pB = (const SEC_TRACE_RECORD *)b;
+
+    if (pA->pComponent != pB->pComponent)
+        return (pA->pComponent < pB->pComponent) ? -1 : 1;
+    if (pA->key != pB->key)
+        return (pA->key < pB->key) ? -1 : 1;
+
+    return compareTime(a, b);
+}
+
+static int compareS64(const void *a, const void *b)
+{
+    OMX_S64 x = *(const OMX_S64 *)a;
+    OMX_S64 y = *(const OMX_S64 *)b;
+
+    return (x < y) ? -1 : (x > y);
+}
+
+OMX_S32 SEC_OSAL_TraceExport(const char *path)
+{
+    SEC_TRACE_RECORD *pRecords = NULL;
+    FILE   *fp;
+    OMX_S32 n, i;
+    const char *phase;
+
+    n = collectRecords(&pRecords);
+    if (n < 0)
+        return -1;
+
+    fp = fopen(path, "w");
+    if (fp == NULL) {
+        SEC_OSAL_Log(SEC_LOG_ERROR, "%s: cannot open %s", __func__, path);
+        free(pRecords);
+        return -1;
+    }
+
+    qsort(pRecords, n, sizeof(SEC_TRACE_RECORD), compareTime);
+
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (i = 0; i < n; i++) {
+        switch (pRecords[i].event) {
+        case SEC_TRACE_HW_SUBMIT:
+        case SEC_TRACE_CSC_START:
+            phase = "\"ph\":\"B\"";
+            break;
+        case SEC_TRACE_HW_DONE:
+        case SEC_TRACE_CSC_DONE:
+            phase = "\"ph\":\"E\"";
+            break;
+        default:
+            phase = "\"ph\":\"i\",\"s\":\"t\"";
+            break;
+        }
+        fprintf(fp, "{\"name\":\"%s\",%s,\"ts\":%lld.%03lld,\"pid\":%d,\"tid\":%d,"
+                "\"args\":{\"component\":\"%p\",\"frame\":%lld}}%s\n",
+                gEventName[pRecords[i].event], phase,
+                pRecords[i].time / 1000, pRecords[i].time % 1000,
+                getpid(), pRecords[i].tid, pRecords[i].pComponent, pRecords[i].key,
+                (i + 1 < n) ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+
+    fclose(fp);
+    free(pRecords);
+
+    return n;
+}
+
+/* parse a file written by SEC_OSAL_TraceExport(), returns the number of records */
+OMX_S32 SEC_OSAL_TraceLoad(const char *path, SEC_TRACE_RECORD **ppRecords)
+{
+    SEC_TRACE_RECORD *pRecords = NULL, *pNew;
+    FILE   *fp;
+    char    line[512];
+    char    name[32];
+    char   *p;
+    long long us, ns, frame;
+    int     pid, tid;
+    OMX_S32 n = 0, size = 0;
+    OMX_U32 event;
+
+    fp = fopen(path, "r");
+    if (fp == NULL)
+        return -1;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "{\"name\":\"%31[^\"]\"", name) != 1)
+            continue;
+
+        for (event = 0; event < SEC_TRACE_EVENT_MAX; event++) {
+            if (strcmp(name, gEventName[event]) == 0)
+                break;
+        }
+        if (event == SEC_TRACE_EVENT_MAX)
+            continue;
+        /* begin and end share a name */
+        if ((event == SEC_TRACE_HW_SUBMIT) && (strstr(line, "\"ph\":\"E\"") != NULL))
+            event = SEC_TRACE_HW_DONE;
+        if ((event == SEC_TRACE_CSC_START) && (strstr(line, "\"ph\":\"E\"") != NULL))
+            event = SEC_TRACE_CSC_DONE;
+
+        if (n == size) {
+            size = size ? size * 2 : 256;
+            pNew = (SEC_TRACE_RECORD *)realloc(pRecords, sizeof(SEC_TRACE_RECORD) * size);
+            if (pNew == NULL)
+                break;
+            pRecords = pNew;
+        }
+
+        p = strstr(line, "\"ts\":");
+        if ((p == NULL) ||
+            (sscanf(p, "\"ts\":%lld.%lld,\"pid\":%d,\"tid\":%d,\"args\":{\"component\":\"%p\",\"frame\":%lld",
+                    &us, &ns, &pid, &tid, &pRecords[n].pComponent, &frame) != 6))
+            continue;
+
+        pRecords[n].time = us * 1000 + ns;
+        pRecords[n].key = frame;
+        pRecords[n].event = event;
+        pRecords[n].tid = tid;
+        n++;
+    }
+
+    fclose(fp);
+
+    *ppRecords = pRecords;
+
+    return n;
+}
+
+OMX_S32 SEC_OSAL_TraceSummary(OMX_PTR pComponent, char *buf, OMX_S32 len)
+{
+    SEC_TRACE_RECORD *pRecords = NULL;
+    OMX_S32 n, out;
+
+    n = collectRecords(&pRecords);
+    if (n < 0)
+        return 0;
+
+    out = SEC_OSAL_TraceSummarize(pRecords, n, pComponent, buf, len);
+    free(pRecords);
+
+    return out;
+}
+
+OMX_S32 SEC_OSAL_TraceSummarize(SEC_TRACE_RECORD *pRecords, OMX_S32 n,
+                                OMX_PTR pComponent, char *buf, OMX_S32 len)
+{
+    OMX_S64 *pLatency[SEC_TRACE_STAGE_MAX];
+    OMX_S32  nLatency[SEC_TRACE_STAGE_MAX];
+    OMX_S64  first[SEC_TRACE_EVENT_MAX];
+    OMX_S64 *pSeek = NULL, flushTime = -1;
+    OMX_S32  nSeek = 0;
+    OMX_S32  m, i, j, s, frames = 0, out = 0;
+
+    /* keep only this component's records */
+    for (i = 0, m = 0; i < n; i++) {
+        if (pRecords[i].pComponent == pComponent)
+            pRecords[m++] = pRecords[i];
+    }
+    n = m;
+
+    /* seek: flush -> first output returned after it; flush records are then dropped */
+    qsort(pRecords, n, sizeof(SEC_TRACE_RECORD), compareTime);
+    pSeek = (OMX_S64 *)malloc(sizeof(OMX_S64) * (n ? n : 1));
+    for (i = 0, m = 0; i < n; i++) {
+        if (pRecords[i].event == SEC_TRACE_FLUSH_DONE) {
+            flushTime = pRecords[i].time;
+            continue;
+        }
+        if ((pRecords[i].event == SEC_TRACE_OUTPUT_RETURN) && (flushTime >= 0)) {
+            if (pSeek != NULL)
+                pSeek[nSeek++] = pRecords[i].time - flushTime;
+            flushTime = -1;
+        }
+        pRecords[m++] = pRecords[i];
+    }
+    n = m;
+
+    qsort(pRecords, n, sizeof(SEC_TRACE_RECORD), compareFrame);
+
+    for (s = 0; s < SEC_TRACE_STAGE_MAX; s++) {
+        pLatency[s] = (OMX_S64 *)malloc(sizeof(OMX_S64) * (n ? n : 1));
+        nLatency[s] = 0;
+    }
+
+    for (i = 0; i < n; i = j) {
+        for (s = 0; s < SEC_TRACE_EVENT_MAX; s++)
+            first[s] = -1;
+        for (j = i; (j < n) && (pRecords[j].key == pRecords[i].key); j++) {
+            if (first[pRecords[j].event] < 0)
+                first[pRecords[j].event] = pRecords[j].time;
+        }
+        /* events not tied to a frame make no frame and no latency */
+        if (pRecords[i].key == SEC_TRACE_KEY_NONE)
+            continue;
+        frames++;
+
+        for (s = 0; s < SEC_TRACE_STAGE_MAX; s++) {
+            if ((pLatency[s] != NULL) &&
+                (first[gStage[s].from] >= 0) && (first[gStage[s].to] >= first[gStage[s].from]))
+                pLatency[s][nLatency[s]++] = first[gStage[s].to] - first[gStage[s].from];
+        }
+    }
+
+    out = snprintf(buf, len, "component %p: %d frames, %d events\n", pComponent, frames, n);
+    for (s = 0; (s < SEC_TRACE_STAGE_MAX) && (out < len); s++) {
+        OMX_S32 cnt = nLatency[s];
+
+        if (cnt == 0)
+            continue;
+        qsort(pLatency[s], cnt, sizeof(OMX_S64), compareS64);
+        out += snprintf(buf + out, len - out,
+                        "  %-6s n=%-5d p50 %6lld us  p90 %6lld us  p99 %6lld us  max %6lld us\n",
+                        gStage[s].name, cnt,
+                        pLatency[s][cnt * 50 / 100] / 1000,
+                        pLatency[s][cnt * 90 / 100] / 1000,
+                        pLatency[s][cnt * 99 / 100] / 1000,
+                        pLatency[s][cnt - 1] / 1000);
+    }
+
+    if ((nSeek > 0) && (out < len)) {
+        qsort(pSeek, nSeek, sizeof(OMX_S64), compareS64);
+        out += snprintf(buf + out, len - out,
+                        "  %-6s n=%-5d p50 %6lld us  p90 %6lld us  p99 %6lld us  max %6lld us\n",
+                        "seek", nSeek,
+                        pSeek[nSeek * 50 / 100] / 1000,
+                        pSeek[nSeek * 90 / 100] / 1000,
+                        pSeek[nSeek * 99 / 100] / 1000,
+                        pSeek[nSeek - 1] / 1000);
+    }
+
+    for (s = 0; s < SEC_TRACE_STAGE_MAX; s++)
+        free(pLatency[s]);
+    free(pSeek);
+
+    return (out < len) ? out : len;
+}
+
+/* end of a session: log the latency summary and export the trace */
+void SEC_OSAL_TraceReport(OMX_PTR pComponent)
+{
+    char summary[1024];
+    char path[64];
+    char *line, *save = NULL;
+
+    SEC_OSAL_TraceInit();
+    if (!gSECTraceEnabled)
+        return;
+
+    SEC_OSAL_TraceSummary(pComponent, summary, sizeof(summary));
+    for (line = strtok_r(summary, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+        _SEC_OSAL_Log(SEC_LOG_TRACE, SEC_LOG_TAG, "%s", line);
+
+    snprintf(path, sizeof(path), SEC_TRACE_EXPORT_PATH, getpid());
+    SEC_OSAL_TraceExport(path);
+}
@@ -0,0 +1,95 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        SEC_OSAL_Trace.h
+ * @brief       binary per-frame trace events
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#ifndef SEC_OSAL_TRACE
+#define SEC_OSAL_TRACE
+
+#include "OMX_Types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* "1" enables recording, read once per library on first use */
+#define SEC_TRACE_PROPERTY      "debug.sec.omx.trace"
+/* Chrome / Perfetto JSON written by SEC_OSAL_TraceReport(), %d is the pid */
+#define SEC_TRACE_EXPORT_PATH   "/data/misc/media/omx_trace_%d.json"
+
+/* key of events that do not belong to a frame */
+#define SEC_TRACE_KEY_NONE      ((OMX_TICKS)-1)
+
+/* records kept per thread, power of two */
+#define SEC_TRACE_RING_SIZE     2048
+
+typedef enum _SEC_TRACE_EVENT
+{
+    SEC_TRACE_INPUT_ARRIVE = 0, /* EmptyThisBuffer */
+    SEC_TRACE_INPUT_PARSED,     /* one frame assembled for the codec */
+    SEC_TRACE_HW_SUBMIT,
+    SEC_TRACE_HW_DONE,
+    SEC_TRACE_CSC_START,
+    SEC_TRACE_CSC_DONE,
+    SEC_TRACE_OUTPUT_RETURN,    /* FillBufferDone */
+    SEC_TRACE_INPUT_RETURN,     /* EmptyBufferDone */
+    SEC_TRACE_FLUSH_DONE,       /* input port flushed by the client, i.e. a seek */
+    SEC_TRACE_EVENT_MAX
+} SEC_TRACE_EVENT;
+
+typedef struct _SEC_TRACE_RECORD
+{
+    OMX_S64   time;             /* CLOCK_MONOTONIC, ns */
+    OMX_TICKS key;              /* frame timestamp */
+    OMX_PTR   pComponent;
+    OMX_U32   event;
+    OMX_S32   tid;
+} SEC_TRACE_RECORD;
+
+extern volatile OMX_S32 gSECTraceEnabled;
+
+#ifndef SEC_TRACE_OFF
+#define SEC_OSAL_Trace(event, comp, key)                    \
+    do {                                                    \
+        if (gSECTraceEnabled)                               \
+            _SEC_OSAL_Trace(event, comp, key);              \
+    } while (0)
+#else
+#define SEC_OSAL_Trace(event, comp, key) ((void)0)
+#endif
+
+void SEC_OSAL_TraceInit(void);
+void _SEC_OSAL_Trace(SEC_TRACE_EVENT event, OMX_PTR pComponent, OMX_TICKS key);
+OMX_S32 SEC_OSAL_TraceExport(const char *path);
+OMX_S32 SEC_OSAL_TraceSummary(OMX_PTR pComponent, char *buf, OMX_S32 len);
+/* pRecords is filtered and reordered in place */
+OMX_S32 SEC_OSAL_TraceSummarize(SEC_TRACE_RECORD *pRecords, OMX_S32 n,
+                                OMX_PTR pComponent, char *buf, OMX_S32 len);
+OMX_S32 SEC_OSAL_TraceLoad(const char *path, SEC_TRACE_RECORD **ppRecords);
+void SEC_OSAL_TraceReport(OMX_PTR pComponent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,46 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#                trace_test binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := trace_test.c
+
+LOCAL_MODULE := sec_omx_trace_test
+
+LOCAL_STATIC_LIBRARIES := libsecosal
+LOCAL_SHARED_LIBRARIES := libcutils libutils liblog
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	trace_test.c \
+	../SEC_OSAL_Trace.c \
+	../SEC_OSAL_Log.c
+
+LOCAL_MODULE := sec_omx_trace_test-host
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,168 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        trace_test.c
+ * @brief       SEC_OSAL_Trace recording, export/load round trip and summary
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "SEC_OSAL_Trace.h"
+
+#ifdef __BIONIC__
+#define TRACE_TEST_DIR  "/data/local/tmp"
+#else
+#define TRACE_TEST_DIR  "/tmp"
+#endif
+
+#define TRACE_TEST_FRAMES   100
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("trace_test: %s:%d: %s\n",                       \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static int compA, compB;
+
+static void *recordThread(void *arg)
+{
+    OMX_TICKS i;
+
+    for (i = 0; i < TRACE_TEST_FRAMES; i++) {
+        SEC_OSAL_Trace(SEC_TRACE_HW_SUBMIT, &compB, i);
+        SEC_OSAL_Trace(SEC_TRACE_HW_DONE, &compB, i);
+    }
+
+    return NULL;
+}
+
+/* one frame per key, hw takes key + 1 us */
+static OMX_S32 makeRecords(SEC_TRACE_RECORD *pRecords)
+{
+    static const SEC_TRACE_EVENT order[] = {
+        SEC_TRACE_INPUT_ARRIVE, SEC_TRACE_INPUT_PARSED, SEC_TRACE_HW_SUBMIT,
+        SEC_TRACE_HW_DONE, SEC_TRACE_OUTPUT_RETURN
+    };
+    OMX_S32 n = 0, i, e;
+    OMX_S64 t;
+
+    for (i = 0; i < TRACE_TEST_FRAMES; i++) {
+        t = (OMX_S64)i * 100000000LL;
+        for (e = 0; e < 5; e++) {
+            pRecords[n].time = t + e * 1000000LL;
+            if (order[e] == SEC_TRACE_HW_DONE)
+                pRecords[n].time = pRecords[n - 1].time + (i + 1) * 1000LL;
+            if (order[e] == SEC_TRACE_OUTPUT_RETURN)
+                pRecords[n].time = pRecords[n - 1].time + 2000000LL;
+            pRecords[n].key = i;
+            pRecords[n].pComponent = &compA;
+            pRecords[n].event = order[e];
+            pRecords[n].tid = 1;
+            n++;
+        }
+    }
+
+    /* a seek: flush, then the next output comes back 5 ms later */
+    pRecords[n].time = (OMX_S64)TRACE_TEST_FRAMES * 100000000LL;
+    pRecords[n].key = SEC_TRACE_KEY_NONE;
+    pRecords[n].pComponent = &compA;
+    pRecords[n].event = SEC_TRACE_FLUSH_DONE;
+    pRecords[n].tid = 1;
+    n++;
+    pRecords[n] = pRecords[n - 1];
+    pRecords[n].time += 5000000LL;
+    pRecords[n].key = TRACE_TEST_FRAMES;
+    pRecords[n].event = SEC_TRACE_OUTPUT_RETURN;
+    n++;
+
+    /* an input without a timestamp is no frame */
+    pRecords[n] = pRecords[n - 1];
+    pRecords[n].key = SEC_TRACE_KEY_NONE;
+    pRecords[n].event = SEC_TRACE_INPUT_ARRIVE;
+    n++;
+
+    return n;
+}
+
+int main(int argc, char **argv)
+{
+    SEC_TRACE_RECORD  records[TRACE_TEST_FRAMES * 5 + 3];
+    SEC_TRACE_RECORD *pLoaded = NULL;
+    pthread_t thread;
+    char      path[128];
+    char      summary[1024];
+    OMX_S32   n, i, a = 0, b = 0, done = 0;
+
+    /* the property is read on first use, force it on */
+    SEC_OSAL_TraceInit();
+    gSECTraceEnabled = 1;
+
+    for (i = 0; i < TRACE_TEST_FRAMES; i++) {
+        SEC_OSAL_Trace(SEC_TRACE_INPUT_ARRIVE, &compA, i);
+        SEC_OSAL_Trace(SEC_TRACE_OUTPUT_RETURN, &compA, i);
+    }
+    pthread_create(&thread, NULL, recordThread, NULL);
+    pthread_join(thread, NULL);
+
+    snprintf(path, sizeof(path), "%s/trace_test_%d.json", TRACE_TEST_DIR, getpid());
+    CHECK(SEC_OSAL_TraceExport(path) == TRACE_TEST_FRAMES * 4);
+
+    n = SEC_OSAL_TraceLoad(path, &pLoaded);
+    unlink(path);
+    CHECK(n == TRACE_TEST_FRAMES * 4);
+    for (i = 0; i < n; i++) {
+        if (pLoaded[i].pComponent == &compA)
+            a++;
+        if (pLoaded[i].pComponent == &compB)
+            b++;
+        if (pLoaded[i].event == SEC_TRACE_HW_DONE)
+            done++;
+        if (i > 0)
+            CHECK(pLoaded[i].time >= pLoaded[i - 1].time);
+    }
+    CHECK((a == TRACE_TEST_FRAMES * 2) && (b == TRACE_TEST_FRAMES * 2));
+    CHECK(done == TRACE_TEST_FRAMES);
+    free(pLoaded);
+
+    /* hw latencies are 1..100 us, so p50 is 51 and max is 100 */
+    n = makeRecords(records);
+    SEC_OSAL_TraceSummarize(records, n, &compA, summary, sizeof(summary));
+    fputs(summary, stdout);
+    CHECK(strstr(summary, "101 frames") != NULL);
+    CHECK(strstr(summary, "hw     n=100   p50     51 us") != NULL);
+    CHECK(strstr(summary, "max    100 us") != NULL);
+    CHECK(strstr(summary, "parse  n=100   p50   1000 us") != NULL);
+    CHECK(strstr(summary, "seek   n=1     p50   5000 us") != NULL);
+
+    printf("trace_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := \
+	sec_omx_trace_summary.c \
+	../SEC_OSAL_Trace.c \
+	../SEC_OSAL_Log.c
+
+LOCAL_MODULE := sec_omx_trace_summary
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/osal
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,83 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        sec_omx_trace_summary.c
+ * @brief       per-component latency summary of an exported OMX trace
+ * @version     1.1.0
+ * @history
+ *   2012.10.1 : Create
+ *
+ * usage: sec_omx_trace_summary omx_trace_<pid>.json
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SEC_OSAL_Trace.h"
+
+int main(int argc, char **argv)
+{
+    SEC_TRACE_RECORD *pRecords = NULL;
+    SEC_TRACE_RECORD *pCopy = NULL;
+    OMX_PTR *pComponents = NULL;
+    OMX_S32  n, nComponents = 0, i, j;
+    char     summary[1024];
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s omx_trace.json\n", argv[0]);
+        return 1;
+    }
+
+    n = SEC_OSAL_TraceLoad(argv[1], &pRecords);
+    if (n < 0) {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+        return 1;
+    }
+
+    pComponents = (OMX_PTR *)malloc(sizeof(OMX_PTR) * (n ? n : 1));
+    pCopy = (SEC_TRACE_RECORD *)malloc(sizeof(SEC_TRACE_RECORD) * (n ? n : 1));
+    if ((pComponents == NULL) || (pCopy == NULL)) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < nComponents; j++) {
+            if (pComponents[j] == pRecords[i].pComponent)
+                break;
+        }
+        if (j == nComponents)
+            pComponents[nComponents++] = pRecords[i].pComponent;
+    }
+
+    printf("%s: %ld events, %ld components\n", argv[1], (long)n, (long)nComponents);
+
+    /* SEC_OSAL_TraceSummarize() reorders its input */
+    for (j = 0; j < nComponents; j++) {
+        memcpy(pCopy, pRecords, sizeof(SEC_TRACE_RECORD) * n);
+        SEC_OSAL_TraceSummarize(pCopy, n, pComponents[j], summary, sizeof(summary));
+        fputs(summary, stdout);
+    }
+
+    free(pCopy);
+    free(pComponents);
+    free(pRecords);
+
+    return 0;
+}
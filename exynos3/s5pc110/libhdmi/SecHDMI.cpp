@@ -22,6 +22,7 @@
 #include <sys/poll.h>
 
 #include <sec_lcd.h>
+#include <hardware/hdmi.h>
 
 #include "SecHDMI.h"
 #include "fimd.h"
@@ -478,12 +479,20 @@ SecHDMI::SecHDMI()
       mTvOutVFd(-1),
       mLcdFd(-1),
       mHdcpEnabled(0),
-      mFlagConnected(false)
+      mFlagConnected(false),
+      mSrcW(0),
+      mSrcH(0),
+      mSrcFormat(0)
 {
     ALOGV("%s", __func__);
 
     memset(&mParams, 0, sizeof(struct v4l2_streamparm));
     memset(&mFlagLayerEnable, 0, sizeof(bool) * S5P_TV_LAYER_MAX);
+    memset(&mSrcImg, 0, sizeof(mSrcImg));
+    memset(&mSrcRect, 0, sizeof(mSrcRect));
+    memset(&mDstImg, 0, sizeof(mDstImg));
+    memset(&mDstRect, 0, sizeof(mDstRect));
+    fimc_stream_init(&mFimcStream);
 
     int ret = ioctl(mTvOutFd, VIDIOC_HDCP_ENABLE, &mHdcpEnabled);
     ALOG_IF(ret);
@@ -534,6 +543,10 @@ int SecHDMI::destroy()
         mTvOutFd = -1;
     }
     if(mFimc.dev_fd > 0) {
+        ALOGV("%s::frames %u reconfigs %u retargets %u", __func__,
+              mFimcStream.frames, mFimcStream.reconfigs,
+              mFimcStream.retargets);
+        fimc_stream_stop(&mFimc, &mFimcStream);
         fimc_close(&mFimc);
         mFimc.dev_fd = -1;
     }
@@ -541,6 +554,9 @@ int SecHDMI::destroy()
         fb_close(mLcdFd);
         mLcdFd = -1;
     }
+    mSrcW = 0;
+    mSrcH = 0;
+    mSrcFormat = 0;
 
     return 0;
 }
@@ -665,6 +681,21 @@ int SecHDMI::create(int width, int height)
                           (unsigned int) addr + y_size);
     RETURN_IF(ret);
 
+    /* FIMC only takes its destination at STREAMON, so it keeps writing
+     * to the buffer TV-out was pointed at above */
+    mDstImg.w       = p->win.w.width;
+    mDstImg.h       = p->win.w.height;
+    mDstImg.format  = HAL_PIXEL_FORMAT_YCbCr_420_SP;
+    mDstImg.base    = addr;
+    mDstImg.offset  = 0;
+    mDstImg.mem_id  = 0;
+    mDstImg.mem_type = FIMC_MEM_TYPE_PHYS;
+
+    mDstRect.x = p->win.w.top;
+    mDstRect.y = p->win.w.left;
+    mDstRect.w = mDstImg.w;
+    mDstRect.h = mDstImg.h;
+
     return 0;
 }
 
@@ -713,6 +744,9 @@ int SecHDMI::disconnect()
         return 0;
     }
 
+    ret = fimc_stream_stop(&mFimc, &mFimcStream);
+    ALOG_IF(ret);
+
     ret = tv20_v4l2_streamoff(mTvOutFd);
     RETURN_IF(ret);
 
@@ -726,6 +760,32 @@ int SecHDMI::disconnect()
     return 0;
 }
 
+void SecHDMI::setSrcGeometry(int srcW, int srcH, int srcColorFormat)
+{
+    mSrcImg.w       = srcW;
+    mSrcImg.h       = srcH;
+    mSrcImg.format  = srcColorFormat;
+    mSrcImg.base    = 0;
+    mSrcImg.offset  = 0;
+    mSrcImg.mem_id  = 0;
+    mSrcImg.mem_type = FIMC_MEM_TYPE_PHYS;
+    mSrcImg.w       = (mSrcImg.w + 15) & (~15);
+    mSrcImg.h       = (mSrcImg.h + 1)  & (~1) ;
+
+    mSrcRect.x = 0;
+    mSrcRect.y = 0;
+    mSrcRect.w = mSrcImg.w;
+    mSrcRect.h = mSrcImg.h;
+
+    mSrcW = srcW;
+    mSrcH = srcH;
+    mSrcFormat = srcColorFormat;
+
+    ALOGV("%s::sr_x %d sr_y %d sr_w %d sr_h %d dr_x %d dr_y %d dr_w %d dr_h %d ",
+          __func__, mSrcRect.x, mSrcRect.y, mSrcRect.w, mSrcRect.h,
+          mDstRect.x, mDstRect.y, mDstRect.w, mDstRect.h);
+}
+
 int SecHDMI::flush(int srcW, int srcH, int srcColorFormat,
                    unsigned int srcYAddr, unsigned int srcCbAddr, unsigned int srcCrAddr,
                    int dstX, int dstY,
@@ -737,15 +797,12 @@ int SecHDMI::flush(int srcW, int srcH, int srcColorFormat,
 #if 0
     usleep(1000 * 10);
 #else
-    sec_img         src_img;
-    sec_img         dst_img;
-    sec_rect        src_rect;
-    sec_rect        dst_rect;
     unsigned int    phyAddr[3/*MAX_NUM_PLANES*/];
 
     if(!srcYAddr) {
         struct s3cfb_next_info fb_info;
 
+        /* keep the node open, the address moves with every pan */
         if (mLcdFd < 0) {
             mLcdFd = fb_open(0);
         }
@@ -759,56 +816,22 @@ int SecHDMI::flush(int srcW, int srcH, int srcColorFormat,
         srcCbAddr = srcYAddr;
     }
 
-    memset(&src_img, 0, sizeof(src_img));
-    memset(&dst_img, 0, sizeof(src_img));
-    memset(&src_rect, 0, sizeof(src_rect));
-    memset(&dst_rect, 0, sizeof(src_rect));
-    memset(&phyAddr, 0, sizeof(int) * sizeof(phyAddr));
+    /* MFC decoded frames are read as they are, everything else goes in as
+     * YCbCr_420_SP like before */
+    if (layer != HDMI_MODE_VIDEO ||
+        srcColorFormat != HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED)
+        srcColorFormat = HAL_PIXEL_FORMAT_YCbCr_420_SP;
+
+    if (srcW != mSrcW || srcH != mSrcH || srcColorFormat != mSrcFormat)
+        setSrcGeometry(srcW, srcH, srcColorFormat);
 
     phyAddr[0] = srcYAddr;
     phyAddr[1] = srcCbAddr;
     phyAddr[2] = srcCrAddr;
 
-    src_img.w       = srcW;
-    src_img.h       = srcH;
-    src_img.format  = HAL_PIXEL_FORMAT_YCbCr_420_SP/*srcColorFormat*/;
-    src_img.base    = 0;
-    src_img.offset  = 0;
-    src_img.mem_id  = 0;
-    src_img.mem_type = FIMC_MEM_TYPE_PHYS;
-    src_img.w       = (src_img.w + 15) & (~15);
-    src_img.h       = (src_img.h + 1)  & (~1) ;
-
-    src_rect.x = 0;
-    src_rect.y = 0;
-    src_rect.w = src_img.w;
-    src_rect.h = src_img.h;
-
-    struct v4l2_window_s5p_tvout* p =
-        (struct v4l2_window_s5p_tvout*)&mParams.parm.raw_data;
-    if (!p) {
-        return -1;
-    }
-
-    dst_img.w       = p->win.w.width;
-    dst_img.h       = p->win.w.height;
-    dst_img.format  = HAL_PIXEL_FORMAT_YCbCr_420_SP;
-    dst_img.base    = (unsigned int) mFimc.out_buf.phys_addr;
-    dst_img.offset  = 0;
-    dst_img.mem_id  = 0;
-    dst_img.mem_type = FIMC_MEM_TYPE_PHYS;
-
-    dst_rect.x = p->win.w.top;
-    dst_rect.y = p->win.w.left;
-    dst_rect.w = dst_img.w;
-    dst_rect.h = dst_img.h;
-
-    ALOGV("%s::sr_x %d sr_y %d sr_w %d sr_h %d dr_x %d dr_y %d dr_w %d dr_h %d ",
-          __func__, src_rect.x, src_rect.y, src_rect.w, src_rect.h,
-          dst_rect.x, dst_rect.y, dst_rect.w, dst_rect.h);
-
-    ret = fimc_flush(&mFimc, &src_img, &src_rect, &dst_img, &dst_rect,
-                     phyAddr, 0);
+    /* the destination never changes, a frame is a QBUF/DQBUF pair */
+    ret = fimc_stream_flush(&mFimc, &mFimcStream, &mSrcImg, &mSrcRect,
+                            &mDstImg, &mDstRect, phyAddr, 0);
     RETURN_IF(ret);
 
 /*
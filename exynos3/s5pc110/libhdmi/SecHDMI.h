@@ -104,8 +104,18 @@ private:
     s5p_fimc_t      mFimc;
     v4l2_streamparm mParams;
 
+    struct fimc_stream mFimcStream;
+    struct sec_img  mSrcImg;
+    struct sec_rect mSrcRect;
+    struct sec_img  mDstImg;
+    struct sec_rect mDstRect;
+    int             mSrcW;
+    int             mSrcH;
+    int             mSrcFormat;
+
     int             startLayer(s5p_tv_layer layer);
     int             stopLayer(s5p_tv_layer layer);
+    void            setSrcGeometry(int srcW, int srcH, int srcColorFormat);
 };
     
 }; // namespace android
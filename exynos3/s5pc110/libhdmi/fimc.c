@@ -17,6 +17,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <linux/videodev.h>
 
@@ -156,6 +157,24 @@ int fimc_v4l2_set_dst(int fd,
     return 0;
 }
 
+static int fimc_v4l2_set_dst_addr(int fd, unsigned int addr)
+{
+    struct v4l2_framebuffer fbuf;
+
+    if (ioctl (fd, VIDIOC_G_FBUF, &fbuf) < 0) {
+        ALOGE("Error in video VIDIOC_G_FBUF");
+        return -1;
+    }
+
+    fbuf.base = (void *)addr;
+    if (ioctl (fd, VIDIOC_S_FBUF, &fbuf) < 0) {
+        ALOGE("Error in video VIDIOC_S_FBUF 0x%x", addr);
+        return -1;
+    }
+
+    return 0;
+}
+
 static int fimc_v4l2_stream_on(int fd, enum v4l2_buf_type type)
 {
     if (ioctl (fd, VIDIOC_STREAMON, &type) < 0) {
@@ -269,6 +288,7 @@ static int get_src_phys_addr(s5p_fimc_t *fimc,
    if(src_img->mem_type == FIMC_MEM_TYPE_PHYS) {
         switch(src_img->format) {
         case HAL_PIXEL_FORMAT_YCbCr_420_SP:
+        case HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED:
             fimc->params.src.buf_addr_phy_rgb_y = phyAddr[0];
             fimc->params.src.buf_addr_phy_cb    = phyAddr[1];
             break;
@@ -431,22 +451,18 @@ static inline int heightOfPP(int pp_color_format,
     return number;
 }
 
-static int fimc_core(s5p_fimc_t *fimc,
-                     sec_img *src_img,
-                     sec_rect *src_rect,
-                     uint32_t src_color_space,
-                     unsigned int dst_phys_addr,
-                     sec_img *dst_img,
-                     sec_rect *dst_rect,
-                     uint32_t dst_color_space,
-                     int transform)
+static int fimc_config(s5p_fimc_t *fimc,
+                       sec_img *src_img,
+                       sec_rect *src_rect,
+                       uint32_t src_color_space,
+                       unsigned int dst_phys_addr,
+                       sec_img *dst_img,
+                       sec_rect *dst_rect,
+                       uint32_t dst_color_space,
+                       int transform)
 {
     s5p_fimc_params_t * params = &(fimc->params);
 
-    unsigned int    frame_size = 0;
-    struct fimc_buf fimc_src_buf;
-
-    int src_bpp, src_planes;
     int flag_h_flip = 0;
     int flag_v_flip = 0;
     int rotate_value = rotateValueHAL2PP(transform, &flag_h_flip, &flag_v_flip);
@@ -577,19 +593,48 @@ static int fimc_core(s5p_fimc_t *fimc,
     if (fimc_v4l2_set_src(fimc->dev_fd, fimc->hw_ver, &params->src) < 0)
         return -1;
 
+    return 0;
+}
+
+static void fimc_set_src_buf(s5p_fimc_t *fimc,
+                             sec_img *src_img,
+                             struct fimc_buf *fimc_src_buf)
+{
+    s5p_fimc_params_t * params = &(fimc->params);
+
     /* set input dma address (Y/RGB, Cb, Cr) */
     switch (src_img->format) {
     case HAL_PIXEL_FORMAT_YCbCr_420_SP:
+    case HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED:
         /* for video display zero copy case */
-        fimc_src_buf.base[0] = params->src.buf_addr_phy_rgb_y;
-        fimc_src_buf.base[1] = params->src.buf_addr_phy_cb;
+        fimc_src_buf->base[0] = params->src.buf_addr_phy_rgb_y;
+        fimc_src_buf->base[1] = params->src.buf_addr_phy_cb;
         break;
 
     default:
         /* set source image */
-        fimc_src_buf.base[0] = params->src.buf_addr_phy_rgb_y;
+        fimc_src_buf->base[0] = params->src.buf_addr_phy_rgb_y;
         break;
     }
+}
+
+static int fimc_core(s5p_fimc_t *fimc,
+                     sec_img *src_img,
+                     sec_rect *src_rect,
+                     uint32_t src_color_space,
+                     unsigned int dst_phys_addr,
+                     sec_img *dst_img,
+                     sec_rect *dst_rect,
+                     uint32_t dst_color_space,
+                     int transform)
+{
+    struct fimc_buf fimc_src_buf;
+
+    if (fimc_config(fimc, src_img, src_rect, src_color_space, dst_phys_addr,
+                    dst_img, dst_rect, dst_color_space, transform) < 0)
+        return -1;
+
+    fimc_set_src_buf(fimc, src_img, &fimc_src_buf);
 
     if (fimc_handle_oneshot(fimc->dev_fd, &fimc_src_buf) < 0) {
         fimc_v4l2_clr_buf(fimc->dev_fd);
@@ -720,3 +765,133 @@ int fimc_flush(s5p_fimc_t *fimc,
 
     return 0;
 }
+
+void fimc_stream_init(struct fimc_stream *stream)
+{
+    memset(stream, 0, sizeof(struct fimc_stream));
+}
+
+static int fimc_stream_changed(struct fimc_stream *stream,
+                               sec_img *src_img,
+                               sec_rect *src_rect,
+                               sec_img *dst_img,
+                               sec_rect *dst_rect,
+                               uint32_t transform)
+{
+    /* the dst base is handled separately, see fimc_stream_flush() */
+    if (!stream->configured ||
+        stream->transform != transform ||
+        stream->src_img.w != src_img->w ||
+        stream->src_img.h != src_img->h ||
+        stream->src_img.format != src_img->format ||
+        stream->dst_img.w != dst_img->w ||
+        stream->dst_img.h != dst_img->h ||
+        stream->dst_img.format != dst_img->format ||
+        memcmp(&stream->src_rect, src_rect, sizeof(sec_rect)) ||
+        memcmp(&stream->dst_rect, dst_rect, sizeof(sec_rect)))
+        return 1;
+
+    return 0;
+}
+
+int fimc_stream_stop(s5p_fimc_t *fimc, struct fimc_stream *stream)
+{
+    int ret = 0;
+
+    if (stream->streaming) {
+        if (fimc_v4l2_stream_off(fimc->dev_fd) < 0)
+            ret = -1;
+        stream->streaming = 0;
+    }
+
+    if (stream->configured) {
+        fimc_v4l2_clr_buf(fimc->dev_fd);
+        stream->configured = 0;
+    }
+
+    return ret;
+}
+
+int fimc_stream_flush(s5p_fimc_t *fimc,
+                      struct fimc_stream *stream,
+                      struct sec_img *src_img,
+                      struct sec_rect *src_rect,
+                      struct sec_img *dst_img,
+                      struct sec_rect *dst_rect,
+                      unsigned int *phyAddr,
+                      uint32_t transform)
+{
+    unsigned int    dst_phys_addr = 0;
+    int32_t         src_color_space;
+    int32_t         dst_color_space;
+    struct fimc_buf fimc_src_buf;
+
+    if(0 > get_src_phys_addr(fimc, src_img, phyAddr))
+        return -1;
+
+    if(0 == (dst_phys_addr = get_dst_phys_addr(fimc, dst_img)))
+        return -2;
+
+    if (0 > (src_color_space = HAL_PIXEL_FORMAT_2_V4L2_PIX(src_img->format)))
+        return -3;
+
+    if (0 > (dst_color_space = HAL_PIXEL_FORMAT_2_V4L2_PIX(dst_img->format)))
+        return -4;
+
+    if (fimc_stream_changed(stream, src_img, src_rect, dst_img, dst_rect, transform)) {
+        if (fimc_stream_stop(fimc, stream) < 0)
+            return -5;
+
+        if (fimc_config(fimc, src_img, src_rect, (uint32_t)src_color_space,
+                        dst_phys_addr, dst_img, dst_rect,
+                        (uint32_t)dst_color_space, transform) < 0) {
+            fimc_v4l2_clr_buf(fimc->dev_fd);
+            return -5;
+        }
+
+        stream->src_img   = *src_img;
+        stream->src_rect  = *src_rect;
+        stream->dst_img   = *dst_img;
+        stream->dst_rect  = *dst_rect;
+        stream->transform = transform;
+        stream->dst_addr  = dst_phys_addr;
+        stream->configured = 1;
+        stream->reconfigs++;
+    } else if (stream->dst_addr != dst_phys_addr) {
+        /* the overlay base is only taken at STREAMON */
+        if (stream->streaming) {
+            if (fimc_v4l2_stream_off(fimc->dev_fd) < 0)
+                goto err;
+            stream->streaming = 0;
+        }
+
+        if (fimc_v4l2_set_dst_addr(fimc->dev_fd, dst_phys_addr) < 0)
+            goto err;
+
+        stream->dst_addr = dst_phys_addr;
+        stream->retargets++;
+    }
+
+    if (!stream->streaming) {
+        if (fimc_v4l2_stream_on(fimc->dev_fd, V4L2_BUF_TYPE_VIDEO_OUTPUT) < 0)
+            goto err;
+        stream->streaming = 1;
+    }
+
+    fimc_set_src_buf(fimc, src_img, &fimc_src_buf);
+
+    if (fimc_v4l2_queue(fimc->dev_fd, &fimc_src_buf) < 0)
+        goto err;
+
+    if (fimc_v4l2_dequeue(fimc->dev_fd) < 0)
+        goto err;
+
+    stream->frames++;
+
+    return 0;
+
+err:
+    /* start from a clean configuration on the next frame */
+    fimc_stream_stop(fimc, stream);
+    return -5;
+}
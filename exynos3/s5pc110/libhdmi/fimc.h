@@ -49,6 +49,27 @@ struct sec_img {
     int      mem_type;
 };
     
+/*
+ * Conversion stream kept running between frames. The programmed geometry
+ * is remembered and the device is only reconfigured when it changes. The
+ * destination base is only taken at STREAMON, so a new destination address
+ * alone still restarts the stream; keep it fixed for QBUF/DQBUF only frames.
+ */
+struct fimc_stream {
+    int             configured;
+    int             streaming;
+    struct sec_img  src_img;
+    struct sec_rect src_rect;
+    struct sec_img  dst_img;
+    struct sec_rect dst_rect;
+    uint32_t        transform;
+    unsigned int    dst_addr;
+
+    unsigned int    frames;
+    unsigned int    reconfigs;
+    unsigned int    retargets;
+};
+
 inline int SEC_MIN(int x, int y) {
     return ((x < y) ? x : y);
 }
@@ -69,6 +90,19 @@ int     fimc_flush(s5p_fimc_t *fimc,
                    unsigned int *phyAddr,
                    uint32_t transform);
 
+void    fimc_stream_init(struct fimc_stream *stream);
+
+int     fimc_stream_flush(s5p_fimc_t *fimc,
+                          struct fimc_stream *stream,
+                          struct sec_img *src_img,
+                          struct sec_rect *src_rect,
+                          struct sec_img *dst_img,
+                          struct sec_rect *dst_rect,
+                          unsigned int *phyAddr,
+                          uint32_t transform);
+
+int     fimc_stream_stop(s5p_fimc_t *fimc, struct fimc_stream *stream);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,8 +30,16 @@
 #include <signal.h>
 #include <cutils/log.h>
 
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
 #include "fimd.h"
 
+/* spans shorter than this are left to memcpy */
+#define FIMD_NEON_SPAN_MIN      1024
+#define FIMD_PREFETCH_AHEAD     256
+
 int fb_open(int win)
 {
     char node[20];
@@ -189,24 +197,135 @@ char* fb_init_display(int fp, int width, int height, int left_x, int top_y, int
     return fb;
 }
 
-#if 0
-
 static int get_bytes_per_pixel(int bits_per_pixel)
 {
     return (bits_per_pixel == 24 || bits_per_pixel == 25 ||
         bits_per_pixel == 28) ? 4 : bits_per_pixel / 8;
 }
 
+#if defined(__ARM_NEON__)
+/* 64 bytes per loop, the source is prefetched a few lines ahead */
+static void neon_copy(char *dest, const char *src, size_t len)
+{
+    for (; len >= 64; len -= 64, src += 64, dest += 64) {
+        uint8x16_t q0, q1, q2, q3;
+
+        __builtin_prefetch(src + FIMD_PREFETCH_AHEAD);
+        q0 = vld1q_u8((const uint8_t *)src);
+        q1 = vld1q_u8((const uint8_t *)src + 16);
+        q2 = vld1q_u8((const uint8_t *)src + 32);
+        q3 = vld1q_u8((const uint8_t *)src + 48);
+        vst1q_u8((uint8_t *)dest, q0);
+        vst1q_u8((uint8_t *)dest + 16, q1);
+        vst1q_u8((uint8_t *)dest + 32, q2);
+        vst1q_u8((uint8_t *)dest + 48, q3);
+    }
+
+    if (len)
+        memcpy(dest, src, len);
+}
+#endif
+
+static void copy_span(char *dest, const char *src, size_t len)
+{
+#if defined(__ARM_NEON__)
+    if (len >= FIMD_NEON_SPAN_MIN) {
+        neon_copy(dest, src, len);
+        return;
+    }
+#endif
+    memcpy(dest, src, len);
+}
+
+static int blit_rect(char *dest, int dest_stride,
+                     const char *src, int src_stride,
+                     int bytes_per_pixel, const struct fimd_rect *rect)
+{
+    size_t row = rect->w * bytes_per_pixel;
+    const char *s = src + rect->y * src_stride + rect->x * bytes_per_pixel;
+    char *d = dest + rect->y * dest_stride + rect->x * bytes_per_pixel;
+    int y;
+
+    /*
+     * Same layout on both sides: take the rows together with the gaps between
+     * them in one copy, unless the gaps are more than a quarter of it. The gap
+     * pixels come from the same frame, so copying them changes nothing.
+     */
+    if (src_stride == dest_stride && row * 4 >= (size_t)src_stride * 3) {
+        size_t len = (rect->h - 1) * src_stride + row;
+
+        copy_span(d, s, len);
+        return len;
+    }
+
+    for (y = 0; y < rect->h; y++) {
+        copy_span(d, s, row);
+        s += src_stride;
+        d += dest_stride;
+    }
+
+    return row * rect->h;
+}
+
+int fb_blit(char *dest, int dest_stride, const char *src, int src_stride,
+            int bits_per_pixel, int width, int height,
+            const struct fimd_rect *rects, int num_rects)
+{
+    int bytes_per_pixel = get_bytes_per_pixel(bits_per_pixel);
+    struct fimd_rect full;
+    int copied = 0;
+    int i = 0;
+
+    if (!dest || !src || bytes_per_pixel <= 0)
+        return -1;
+
+    if (!rects || num_rects <= 0) {
+        full.x = 0;
+        full.y = 0;
+        full.w = width;
+        full.h = height;
+        rects = &full;
+        num_rects = 1;
+    }
+
+    while (i < num_rects) {
+        struct fimd_rect r = rects[i++];
+
+        /* a rect going on straight below with the same columns joins in */
+        while (i < num_rects && rects[i].x == r.x && rects[i].w == r.w &&
+               rects[i].y == r.y + r.h)
+            r.h += rects[i++].h;
+
+        if (r.x < 0) {
+            r.w += r.x;
+            r.x = 0;
+        }
+        if (r.y < 0) {
+            r.h += r.y;
+            r.y = 0;
+        }
+        if (r.x + r.w > width)
+            r.w = width - r.x;
+        if (r.y + r.h > height)
+            r.h = height - r.y;
+        if (r.w <= 0 || r.h <= 0)
+            continue;
+
+        copied += blit_rect(dest, dest_stride, src, src_stride,
+                            bytes_per_pixel, &r);
+    }
+
+    return copied;
+}
+
 int simple_draw(char *dest, const char *src, int img_width,
         struct fb_var_screeninfo *var)
 {
     int bytes_per_pixel = get_bytes_per_pixel(var->bits_per_pixel);
-    unsigned int y;
 
-    for (y = 0; y < var->yres; y++)
-        memcpy(dest + y * var->xres * bytes_per_pixel,
-               src + y * img_width * bytes_per_pixel,
-               var->xres * bytes_per_pixel);
+    fb_blit(dest, var->xres * bytes_per_pixel,
+            src, img_width * bytes_per_pixel,
+            var->bits_per_pixel, var->xres, var->yres, NULL, 0);
 
     return 0;
 }
@@ -214,18 +333,5 @@ int simple_draw(char *dest, const char *src, int img_width,
 int draw(char *dest, const char *src, int img_width,
      struct fb_var_screeninfo *var)
 {
-    int bytes_per_pixel = get_bytes_per_pixel(var->bits_per_pixel);
-    unsigned int y;
-
-    if (var->bits_per_pixel == 16) {
-        memcpy(dest, src, var->xres * var->yres * 2);
-    } else {
-        for (y = 0; y < var->yres; y++)
-            memcpy(dest + y * var->xres * bytes_per_pixel,
-                   src + y * img_width * bytes_per_pixel,
-                   var->xres * bytes_per_pixel);
-    }
-
-    return 0;
+    return simple_draw(dest, src, img_width, var);
 }
-#endif
@@ -23,6 +23,14 @@
 
 #define TOTAL_FB_NUM 5
 
+/* damaged area, in pixels */
+struct fimd_rect {
+    int x;
+    int y;
+    int w;
+    int h;
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -40,12 +48,18 @@ int     fb_get_fscreeninfo(int fp, struct fb_fix_screeninfo *fix);
 int     fb_get_vscreeninfo(int fp, struct fb_var_screeninfo *var);
 int     fb_put_vscreeninfo(int fp, struct fb_var_screeninfo *var);
 
-#if 0
+/* copies the rects (all of width x height if there are none), returns
+ * the number of bytes written. Nothing in libhdmi calls these: the mirror
+ * path hands the framebuffer to the FIMC by physical address and never
+ * copies it on the CPU. They are kept for out of tree users, test3 checks
+ * them against the old row copy. */
+int     fb_blit(char *dest, int dest_stride, const char *src, int src_stride,
+            int bits_per_pixel, int width, int height,
+            const struct fimd_rect *rects, int num_rects);
 int     simple_draw(char *dest, const char *src,
             int img_width, struct fb_var_screeninfo *var);
 int     draw(char *dest, const char *src,\
             int img_width, struct fb_var_screeninfo *var);
-#endif
 
 #ifdef __cplusplus
 }
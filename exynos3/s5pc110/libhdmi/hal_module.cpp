@@ -21,6 +21,7 @@
 #include <string.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/file.h>
 #include <sys/types.h>
 #include <linux/fb.h>
 
@@ -42,6 +43,7 @@ struct sec_hdmi_device_t {
     SecHDMI*        hw;
     int             lcd_width;
     int             lcd_height;
+    int             owner_fd;   /* holds the TV-out, see hdmi_claim_tvout() */
 };
 
 static SecHDMI* sec_obtain_hw(struct hdmi_device_t* device)
@@ -120,6 +122,11 @@ static int hdmi_close(struct hdmi_device_t *dev)
         delete hw;
     }
 
+    struct sec_hdmi_device_t* hdmi_dev = (struct sec_hdmi_device_t *) dev;
+    if (hdmi_dev->owner_fd >= 0) {
+        close(hdmi_dev->owner_fd);
+    }
+
     free(dev);
 
     return 0;
@@ -157,6 +164,28 @@ static int hdmi_get_lcd_size(int* width, int* height)
     return 0;
 }
 
+/*
+ * The composer and the OMX decoders both program the one FIMC and TV-out
+ * behind this HAL from different processes. Only one device may exist at
+ * a time: it holds a lock on the TV-out node until it is closed, any
+ * other opener gets -EBUSY.
+ */
+static int hdmi_claim_tvout(void)
+{
+    int fd = open(TVOUT_DEV, O_RDWR);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    if (flock(fd, LOCK_EX | LOCK_NB) < 0) {
+        int err = (errno == EWOULDBLOCK) ? -EBUSY : -errno;
+        close(fd);
+        return err;
+    }
+
+    return fd;
+}
+
 static int hdmi_open(const struct hw_module_t *module, char const *name,
                          struct hw_device_t **device)
 {
@@ -170,16 +199,25 @@ static int hdmi_open(const struct hw_module_t *module, char const *name,
         return -EINVAL;
     }
 
+    int owner_fd = hdmi_claim_tvout();
+    if (owner_fd < 0) {
+        ALOGW("open: %s refused, the tv-out is in use (%d)", name, owner_fd);
+        return owner_fd;
+    }
+
     if(hdmi_get_lcd_size(&lcdWidth, &lcdHeight) < 0) {
+        close(owner_fd);
         return -EINVAL;
     }
 
     struct sec_hdmi_device_t *hdmi_dev =
            (struct sec_hdmi_device_t *) malloc(sizeof(struct sec_hdmi_device_t));
     if(!hdmi_dev) {
+        close(owner_fd);
         return -ENOMEM;
     }
     memset(hdmi_dev, 0, sizeof(*hdmi_dev));
+    hdmi_dev->owner_fd = owner_fd;
 
     hdmi_dev->base.common.tag = HARDWARE_DEVICE_TAG;
     hdmi_dev->base.common.version = 0;
@@ -59,3 +59,101 @@ LOCAL_MODULE_TAGS := optional
 LOCAL_SHARED_LIBRARIES := liblog libutils
 
 include $(BUILD_EXECUTABLE)
+
+# --------------------------------------------- #
+#                test3 binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -fno-short-enums
+LOCAL_CFLAGS += -DLOG_TAG=\"test3-hdmi\" -DLOG_TYPE=1
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/../ \
+    $(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+    ../fimd.c \
+    test3.cpp
+
+LOCAL_MODULE := test3-hdmi
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SHARED_LIBRARIES := liblog libutils
+
+include $(BUILD_EXECUTABLE)
+
+# same benchmark for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -DLOG_TAG=\"test3-hdmi\" -DLOG_TYPE=1
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/../ \
+    $(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+    ../fimd.c \
+    test3.cpp
+
+LOCAL_MODULE := test3-hdmi-host
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_STATIC_LIBRARIES := liblog
+
+include $(BUILD_HOST_EXECUTABLE)
+
+# --------------------------------------------- #
+#                test4 binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -fno-short-enums
+LOCAL_CFLAGS += -DLOG_TAG=\"test4-hdmi\" -DLOG_TYPE=1
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/../ \
+    $(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+    ../fimc.c \
+    ../fimd.c \
+    ../SecHDMI.cpp \
+    test4.cpp
+
+LOCAL_MODULE := test4-hdmi
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SHARED_LIBRARIES := liblog libutils
+
+include $(BUILD_EXECUTABLE)
+
+# --------------------------------------------- #
+#                test5 binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -fno-short-enums
+LOCAL_CFLAGS += -DLOG_TAG=\"test5-hdmi\" -DLOG_TYPE=1
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/../ \
+    $(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+    ../fimc.c \
+    ../fimd.c \
+    ../SecHDMI.cpp \
+    ../hal_module.cpp \
+    test5.cpp
+
+LOCAL_MODULE := test5-hdmi
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SHARED_LIBRARIES := liblog libutils
+
+include $(BUILD_EXECUTABLE)
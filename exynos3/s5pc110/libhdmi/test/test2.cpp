@@ -92,6 +92,20 @@ int main(int argc, char** argv) {
         }
     }
 
+    struct fimc_stream stream;
+
+    fimc_stream_init(&stream);
+    for(int i = 0; i < 5 && ret == 0; i++) {
+        ret = fimc_stream_flush(&fimc, &stream, &src_img, &src_rect,
+                                &dst_img, &dst_rect, phyAddr, 0);
+        if(ret < 0) {
+            LOGE("%s:: Can't flush to fimc stream[%d]", __func__, ret);
+        }
+    }
+    LOGI("%s:: stream frames %u reconfigs %u retargets %u", __func__,
+         stream.frames, stream.reconfigs, stream.retargets);
+    fimc_stream_stop(&fimc, &stream);
+
     fimc_close(&fimc);
     return ret;
 }
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2012 Havlena Petr, <havlenapetr@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * fb_blit() and simple_draw() against the row by row copy they replace, on
+ * plain memory so it runs on the host as well as on the device.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <fimd.h>
+
+#include "test.h"
+
+#define LOOPS   50
+
+struct panel {
+    int width;
+    int height;
+};
+
+static const struct panel panels[] = {
+    {  480,  800 },
+    {  800,  480 },
+    { 1024,  600 },
+    { 1280,  720 },
+};
+
+static long long now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+/* simple_draw() as it was, one memcpy per row of the whole screen */
+static void row_draw(char *dest, const char *src, int width, int height,
+                     int bytes_per_pixel)
+{
+    for (int y = 0; y < height; y++)
+        memcpy(dest + y * width * bytes_per_pixel,
+               src + y * width * bytes_per_pixel,
+               width * bytes_per_pixel);
+}
+
+static int run(const struct panel *p, int bpp)
+{
+    int bytes_per_pixel = bpp / 8;
+    int stride = p->width * bytes_per_pixel;
+    size_t size = stride * p->height;
+    char *src = (char *)malloc(size);
+    char *dst = (char *)malloc(size);
+    char *ref = (char *)malloc(size);
+    struct fimd_rect damage[3];
+    struct fb_var_screeninfo var;
+    long long t, rows, full, part;
+    int bytes = 0;
+    int ret = 0;
+
+    if (!src || !dst || !ref) {
+        LOGE("%s:: out of memory", __func__);
+        ret = -1;
+        goto out;
+    }
+
+    for (size_t i = 0; i < size; i++)
+        src[i] = (char)(i * 7);
+    memset(dst, 0, size);
+    memset(ref, 0, size);
+
+    /* status bar, clock and a list item, the usual UI update */
+    damage[0].x = 0;
+    damage[0].y = 0;
+    damage[0].w = p->width;
+    damage[0].h = p->height / 20;
+    damage[1].x = p->width - p->width / 6;
+    damage[1].y = damage[0].h;
+    damage[1].w = p->width / 6;
+    damage[1].h = p->height / 20;
+    damage[2].x = 0;
+    damage[2].y = p->height / 2;
+    damage[2].w = p->width;
+    damage[2].h = p->height / 10;
+
+    row_draw(ref, src, p->width, p->height, bytes_per_pixel);
+    fb_blit(dst, stride, src, stride, bpp, p->width, p->height, NULL, 0);
+    if (memcmp(dst, ref, size)) {
+        LOGE("%s:: %dx%d@%d full frame differs", __func__,
+             p->width, p->height, bpp);
+        ret = -1;
+        goto out;
+    }
+
+    /* the old entry point keeps its result */
+    memset(&var, 0, sizeof(var));
+    var.xres = p->width;
+    var.yres = p->height;
+    var.bits_per_pixel = bpp;
+    memset(dst, 0, size);
+    simple_draw(dst, src, p->width, &var);
+    if (memcmp(dst, ref, size)) {
+        LOGE("%s:: %dx%d@%d simple_draw differs", __func__,
+             p->width, p->height, bpp);
+        ret = -1;
+        goto out;
+    }
+
+    /* damage only, into a narrower destination */
+    memset(dst, 0, size);
+    fb_blit(dst, stride - bytes_per_pixel * 8, src, stride, bpp,
+            p->width - 8, p->height, damage, 3);
+    for (int r = 0; r < 3 && ret == 0; r++) {
+        int w = damage[r].x + damage[r].w > p->width - 8 ?
+                p->width - 8 - damage[r].x : damage[r].w;
+        for (int y = damage[r].y; y < damage[r].y + damage[r].h; y++) {
+            if (memcmp(dst + y * (stride - bytes_per_pixel * 8) + damage[r].x * bytes_per_pixel,
+                       src + y * stride + damage[r].x * bytes_per_pixel,
+                       w * bytes_per_pixel)) {
+                LOGE("%s:: %dx%d@%d damage rect %d differs", __func__,
+                     p->width, p->height, bpp, r);
+                ret = -1;
+                goto out;
+            }
+        }
+    }
+
+    t = now_us();
+    for (int i = 0; i < LOOPS; i++)
+        row_draw(dst, src, p->width, p->height, bytes_per_pixel);
+    rows = now_us() - t;
+
+    t = now_us();
+    for (int i = 0; i < LOOPS; i++)
+        fb_blit(dst, stride, src, stride, bpp, p->width, p->height, NULL, 0);
+    full = now_us() - t;
+
+    t = now_us();
+    for (int i = 0; i < LOOPS; i++)
+        bytes = fb_blit(dst, stride, src, stride, bpp, p->width, p->height,
+                        damage, 3);
+    part = now_us() - t;
+
+    LOGI("%4dx%-4d %2dbpp: rows %5lld us  blit %5lld us  damage %5lld us (%d of %d bytes)",
+         p->width, p->height, bpp, rows / LOOPS, full / LOOPS, part / LOOPS,
+         bytes, (int)size);
+
+out:
+    free(src);
+    free(dst);
+    free(ref);
+    return ret;
+}
+
+int main(int argc, char** argv) {
+    int ret = 0;
+
+    for (unsigned i = 0; i < sizeof(panels) / sizeof(panels[0]) && ret == 0; i++) {
+        ret = run(&panels[i], 16);
+        if (ret == 0)
+            ret = run(&panels[i], 32);
+    }
+
+    return ret;
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (C) 2012 Havlena Petr, <havlenapetr@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * SecHDMI::flush() against recording fds for FIMC, TV-out and the LCD
+ * framebuffer. open/close/ioctl are defined here, every other path is
+ * passed on to the kernel. Mirrored frames must be a QBUF/DQBUF pair on
+ * a stream that was programmed once, and must follow the panned
+ * framebuffer.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include <sec_lcd.h>
+#include <hardware/hdmi.h>
+
+#include "SecHDMI.h"
+
+#include "test.h"
+
+#define FAKE_FIMC_FD    1000
+#define FAKE_TVOUT_FD   1001
+#define FAKE_LCD_FD     1002
+
+#define FB_PHYS_ADDR    0x50000000
+#define FB_LINE_SIZE    (480 * 4)
+#define UI_FRAMES       60
+
+using namespace android;
+
+struct fake_hdmi {
+    int          streaming;
+    int          stream_on;
+    int          stream_off;
+    int          reqbufs;
+    int          s_fbuf;
+    int          qbuf;
+    int          dqbuf;
+    int          tvout_s_fmt;
+    int          fb_queries;
+    int          bad;           /* setup ioctls while streaming */
+    unsigned int yoffset;
+    unsigned int dst_addr;
+    unsigned int tvout_addr;
+    unsigned int src_addr;
+};
+
+static struct fake_hdmi fake;
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            LOGE("%s:%d: %s", __FILE__, __LINE__, #cond);           \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    if (strcmp(path, "/dev/video2") == 0)
+        return FAKE_FIMC_FD;
+    if (strcmp(path, TVOUT_DEV) == 0)
+        return FAKE_TVOUT_FD;
+    if (strncmp(path, "/dev/graphics/fb", 16) == 0)
+        return FAKE_LCD_FD;
+
+    va_list ap;
+    va_start(ap, flags);
+    int mode = va_arg(ap, int);
+    va_end(ap);
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" int close(int fd)
+{
+    if (FAKE_FIMC_FD <= fd && fd <= FAKE_LCD_FD)
+        return 0;
+    return syscall(SYS_close, fd);
+}
+
+static int fake_tvout_ioctl(unsigned int req, void *arg)
+{
+    struct v4l2_pix_format_s5p_tvout *pixfmt;
+    struct v4l2_fmtdesc *desc;
+
+    switch (req) {
+    case VIDIOC_QUERYCAP:
+        ((struct v4l2_capability *)arg)->capabilities = V4L2_CAP_VIDEO_OUTPUT;
+        break;
+    case VIDIOC_ENUM_FMT:
+        desc = (struct v4l2_fmtdesc *)arg;
+        if (desc->index != 0)
+            return -1;
+        desc->pixelformat = V4L2_PIX_FMT_NV12;
+        break;
+    case VIDIOC_S_FMT:
+        pixfmt = (struct v4l2_pix_format_s5p_tvout *)
+                 ((struct v4l2_format *)arg)->fmt.raw_data;
+        fake.tvout_addr = (unsigned int)(unsigned long)pixfmt->base_y;
+        fake.tvout_s_fmt++;
+        break;
+    }
+    return 0;
+}
+
+static int fake_fimc_ioctl(unsigned int req, void *arg)
+{
+    struct v4l2_control *ctrl;
+    struct v4l2_buffer *buf;
+
+    switch (req) {
+    case VIDIOC_QUERYCAP:
+        ((struct v4l2_capability *)arg)->capabilities =
+            V4L2_CAP_STREAMING | V4L2_CAP_VIDEO_OUTPUT;
+        break;
+    case VIDIOC_G_CTRL:
+        ctrl = (struct v4l2_control *)arg;
+        ctrl->value = (ctrl->id == V4L2_CID_FIMC_VERSION) ? 0x43 : 0x4000000;
+        break;
+    case VIDIOC_STREAMON:
+        if (fake.streaming)
+            fake.bad++;
+        fake.streaming = 1;
+        fake.stream_on++;
+        break;
+    case VIDIOC_STREAMOFF:
+        fake.streaming = 0;
+        fake.stream_off++;
+        break;
+    case VIDIOC_QBUF:
+        if (!fake.streaming)
+            fake.bad++;
+        buf = (struct v4l2_buffer *)arg;
+        fake.src_addr = ((struct fimc_buf *)buf->m.userptr)->base[0];
+        fake.qbuf++;
+        break;
+    case VIDIOC_DQBUF:
+        fake.dqbuf++;
+        break;
+    case VIDIOC_S_FBUF:
+        fake.dst_addr = (unsigned int)(unsigned long)
+                        ((struct v4l2_framebuffer *)arg)->base;
+        fake.s_fbuf++;
+        if (fake.streaming)
+            fake.bad++;
+        break;
+    case VIDIOC_REQBUFS:
+        fake.reqbufs++;
+        /* fall through */
+    case VIDIOC_S_FMT:
+    case VIDIOC_S_CROP:
+    case VIDIOC_S_CTRL:
+        if (fake.streaming)
+            fake.bad++;
+        break;
+    }
+    return 0;
+}
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+extern "C" int ioctl(int fd, int req, ...)
+#else
+extern "C" int ioctl(int fd, unsigned long req, ...)
+#endif
+{
+    va_list ap;
+    va_start(ap, req);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    switch (fd) {
+    case FAKE_FIMC_FD:
+        return fake_fimc_ioctl((unsigned int)req, arg);
+    case FAKE_TVOUT_FD:
+        return fake_tvout_ioctl((unsigned int)req, arg);
+    case FAKE_LCD_FD:
+        if ((unsigned int)req == S3CFB_GET_CURR_FB_INFO) {
+            ((struct s3cfb_next_info *)arg)->phy_start_addr =
+                FB_PHYS_ADDR + fake.yoffset * FB_LINE_SIZE;
+            fake.fb_queries++;
+        }
+        return 0;
+    }
+    return syscall(SYS_ioctl, fd, req, arg);
+}
+
+int main(int argc, char** argv) {
+    SecHDMI hdmi;
+    int reqbufs, s_fbuf;
+
+    CHECK(hdmi.create(720, 576) == 0);
+    CHECK(hdmi.connect() == 0);
+    CHECK(fake.tvout_s_fmt == 1);
+
+    /* steady mirroring: one setup, then QBUF/DQBUF only */
+    for (int i = 0; i < UI_FRAMES; i++) {
+        fake.yoffset = (i & 1) ? 800 : 0;
+        CHECK(hdmi.flush(480, 800, 0, 0, 0, 0, 0, 0, HDMI_MODE_UI, 0) == 0);
+        CHECK(fake.src_addr == FB_PHYS_ADDR + fake.yoffset * FB_LINE_SIZE);
+    }
+    CHECK(fake.stream_on == 1);
+    CHECK(fake.stream_off == 0);
+    CHECK(fake.reqbufs == 1);
+    CHECK(fake.s_fbuf == 1);
+    CHECK(fake.qbuf == UI_FRAMES && fake.dqbuf == UI_FRAMES);
+    CHECK(fake.fb_queries == UI_FRAMES);
+
+    /* FIMC writes where TV-out reads, TV-out is not reprogrammed */
+    CHECK(fake.dst_addr == fake.tvout_addr);
+    CHECK(fake.tvout_s_fmt == 1);
+
+    /* a new source size reconfigures once */
+    reqbufs = fake.reqbufs;
+    s_fbuf = fake.s_fbuf;
+    CHECK(hdmi.flush(800, 480, 0, 0, 0, 0, 0, 0, HDMI_MODE_UI, 0) == 0);
+    CHECK(hdmi.flush(800, 480, 0, 0, 0, 0, 0, 0, HDMI_MODE_UI, 0) == 0);
+    CHECK(fake.reqbufs == reqbufs + 2);
+    CHECK(fake.s_fbuf == s_fbuf + 1);
+    CHECK(fake.stream_on == 2);
+    CHECK(fake.dst_addr == fake.tvout_addr);
+
+    CHECK(hdmi.disconnect() == 0);
+    CHECK(!fake.streaming);
+    CHECK(hdmi.destroy() == 0);
+    CHECK(fake.bad == 0);
+
+    LOGI("stream on %d off %d reqbufs %d s_fbuf %d, %d failures",
+         fake.stream_on, fake.stream_off, fake.reqbufs, fake.s_fbuf, failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,266 @@
+/*
+ * Copyright (C) 2012 Havlena Petr, <havlenapetr@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The hdmi module against fake device nodes: one device at a time owns
+ * the TV-out, and decoded NV12T frames handed to the video layer reach
+ * the FIMC unchanged and in order. open/close/ioctl/flock are defined
+ * here, every other path is passed on to the kernel.
+ */
+
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/fb.h>
+
+#include <hardware/hardware.h>
+#include <hardware/hdmi.h>
+#include <sec_format.h>
+
+#include "SecHDMI.h"
+
+#include "test.h"
+
+#define FAKE_FD_BASE    1000
+#define FAKE_FD_MAX     16
+#define VIDEO_FRAMES    30
+#define FRAME_Y_ADDR(i) (0x40000000 + (i) * 0x200000)
+#define FRAME_C_ADDR(i) (0x48000000 + (i) * 0x200000)
+
+extern "C" struct hw_module_t HAL_MODULE_INFO_SYM;
+
+enum fake_node {
+    NODE_NONE = 0,
+    NODE_FIMC,
+    NODE_TVOUT,
+    NODE_LCD,
+};
+
+static struct {
+    int          node[FAKE_FD_MAX];
+    int          lock_owner;        /* fd holding the TV-out lock, or -1 */
+    int          qbuf;
+    unsigned int src_fmt;
+    unsigned int src_addr[VIDEO_FRAMES];
+} fake;
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            LOGE("%s:%d: %s", __FILE__, __LINE__, #cond);           \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static int fake_node(int fd)
+{
+    if (fd < FAKE_FD_BASE || FAKE_FD_BASE + FAKE_FD_MAX <= fd)
+        return NODE_NONE;
+    return fake.node[fd - FAKE_FD_BASE];
+}
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    int node = NODE_NONE;
+
+    if (strcmp(path, "/dev/video2") == 0)
+        node = NODE_FIMC;
+    else if (strcmp(path, TVOUT_DEV) == 0)
+        node = NODE_TVOUT;
+    else if (strncmp(path, "/dev/graphics/fb", 16) == 0)
+        node = NODE_LCD;
+
+    if (node != NODE_NONE) {
+        for (int i = 0; i < FAKE_FD_MAX; i++) {
+            if (fake.node[i] == NODE_NONE) {
+                fake.node[i] = node;
+                return FAKE_FD_BASE + i;
+            }
+        }
+        errno = EMFILE;
+        return -1;
+    }
+
+    va_list ap;
+    va_start(ap, flags);
+    int mode = va_arg(ap, int);
+    va_end(ap);
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" int close(int fd)
+{
+    if (fake_node(fd) == NODE_NONE)
+        return syscall(SYS_close, fd);
+
+    if (fake.lock_owner == fd)
+        fake.lock_owner = -1;
+    fake.node[fd - FAKE_FD_BASE] = NODE_NONE;
+    return 0;
+}
+
+/* every fd stands for its own open file, like separate processes would */
+extern "C" int flock(int fd, int operation)
+{
+    if (fake_node(fd) != NODE_TVOUT)
+        return syscall(SYS_flock, fd, operation);
+
+    if (operation & LOCK_UN) {
+        if (fake.lock_owner == fd)
+            fake.lock_owner = -1;
+        return 0;
+    }
+
+    if (fake.lock_owner != -1 && fake.lock_owner != fd) {
+        errno = EWOULDBLOCK;
+        return -1;
+    }
+
+    fake.lock_owner = fd;
+    return 0;
+}
+
+static int fake_fimc_ioctl(unsigned int req, void *arg)
+{
+    struct v4l2_control *ctrl;
+    struct v4l2_format *fmt;
+    struct v4l2_buffer *buf;
+
+    switch (req) {
+    case VIDIOC_QUERYCAP:
+        ((struct v4l2_capability *)arg)->capabilities =
+            V4L2_CAP_STREAMING | V4L2_CAP_VIDEO_OUTPUT;
+        break;
+    case VIDIOC_G_CTRL:
+        ctrl = (struct v4l2_control *)arg;
+        ctrl->value = (ctrl->id == V4L2_CID_FIMC_VERSION) ? 0x43 : 0x4000000;
+        break;
+    case VIDIOC_S_FMT:
+        fmt = (struct v4l2_format *)arg;
+        if (fmt->type == V4L2_BUF_TYPE_VIDEO_OUTPUT)
+            fake.src_fmt = fmt->fmt.pix.pixelformat;
+        break;
+    case VIDIOC_QBUF:
+        buf = (struct v4l2_buffer *)arg;
+        if (fake.qbuf < VIDEO_FRAMES)
+            fake.src_addr[fake.qbuf] = ((struct fimc_buf *)buf->m.userptr)->base[0];
+        fake.qbuf++;
+        break;
+    }
+    return 0;
+}
+
+static int fake_tvout_ioctl(unsigned int req, void *arg)
+{
+    struct v4l2_fmtdesc *desc;
+
+    switch (req) {
+    case VIDIOC_QUERYCAP:
+        ((struct v4l2_capability *)arg)->capabilities = V4L2_CAP_VIDEO_OUTPUT;
+        break;
+    case VIDIOC_ENUM_FMT:
+        desc = (struct v4l2_fmtdesc *)arg;
+        if (desc->index != 0)
+            return -1;
+        desc->pixelformat = V4L2_PIX_FMT_NV12;
+        break;
+    }
+    return 0;
+}
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+extern "C" int ioctl(int fd, int req, ...)
+#else
+extern "C" int ioctl(int fd, unsigned long req, ...)
+#endif
+{
+    va_list ap;
+    va_start(ap, req);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    switch (fake_node(fd)) {
+    case NODE_FIMC:
+        return fake_fimc_ioctl((unsigned int)req, arg);
+    case NODE_TVOUT:
+        return fake_tvout_ioctl((unsigned int)req, arg);
+    case NODE_LCD:
+        if ((unsigned int)req == FBIOGET_VSCREENINFO) {
+            ((struct fb_var_screeninfo *)arg)->xres = 480;
+            ((struct fb_var_screeninfo *)arg)->yres = 800;
+        }
+        return 0;
+    }
+    return syscall(SYS_ioctl, fd, req, arg);
+}
+
+static int open_hdmi(const char *name, hdmi_device_t **hdmi)
+{
+    struct hw_module_t *module = &HAL_MODULE_INFO_SYM;
+
+    *hdmi = NULL;
+    return module->methods->open(module, name, (struct hw_device_t **)hdmi);
+}
+
+int main(int argc, char** argv) {
+    hdmi_device_t *composer, *decoder;
+
+    fake.lock_owner = -1;
+
+    /* the composer owns the TV-out, the decoder is refused */
+    CHECK(open_hdmi("hdmi-composer", &composer) == 0);
+    CHECK(open_hdmi("hdmi-service", &decoder) == -EBUSY);
+    CHECK(decoder == NULL);
+
+    /* and gets it once the composer lets go */
+    composer->common.close(&composer->common);
+    CHECK(fake.lock_owner == -1);
+    CHECK(open_hdmi("hdmi-service", &decoder) == 0);
+    CHECK(open_hdmi("hdmi-composer", &composer) == -EBUSY);
+
+    /* decoded frames stay NV12T and reach the FIMC in order */
+    for (int i = 0; i < VIDEO_FRAMES; i++)
+        CHECK(decoder->blit(decoder, 1280, 720,
+                            HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED,
+                            FRAME_Y_ADDR(i), FRAME_C_ADDR(i), FRAME_C_ADDR(i),
+                            0, 0, HDMI_MODE_VIDEO, 1) == 0);
+    CHECK(fake.src_fmt == V4L2_PIX_FMT_NV12T);
+    CHECK(fake.qbuf == VIDEO_FRAMES);
+    for (int i = 0; i < VIDEO_FRAMES; i++)
+        CHECK(fake.src_addr[i] == (unsigned int)FRAME_Y_ADDR(i));
+
+    /* the UI layer is still fed as YCbCr_420_SP */
+    CHECK(decoder->blit(decoder, 1280, 720,
+                        HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED,
+                        FRAME_Y_ADDR(0), FRAME_C_ADDR(0), FRAME_C_ADDR(0),
+                        0, 0, HDMI_MODE_UI, 0) == 0);
+    CHECK(fake.src_fmt == V4L2_PIX_FMT_NV12);
+
+    decoder->common.close(&decoder->common);
+    CHECK(fake.lock_owner == -1);
+
+    LOGI("qbuf %d, %d failures", fake.qbuf, failures);
+
+    return failures ? 1 : 0;
+}
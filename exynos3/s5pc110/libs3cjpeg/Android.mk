@@ -29,3 +29,5 @@ LOCAL_MODULE:= libs3cjpeg
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -27,13 +27,18 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 #include <string.h>
+#include <stddef.h>
 
 #include "JpegEncoder.h"
 
 static const char ExifAsciiPrefix[] = { 0x41, 0x53, 0x43, 0x49, 0x49, 0x0, 0x0, 0x0 };
 
+/* offset and size of a per-shot field for addExifPatch() */
+#define EXIF_FIELD(f)   offsetof(exif_attribute_t, f), sizeof(((exif_attribute_t *)0)->f)
+
 namespace android {
-JpegEncoder::JpegEncoder() : available(false)
+JpegEncoder::JpegEncoder() : mExifTemplate(NULL), mExifTemplateLen(0),
+                             mExifPatchCount(0), available(false)
 {
     mArgs.mmapped_addr = (char *)MAP_FAILED;
     mArgs.enc_param       = NULL;
@@ -109,6 +114,8 @@ JpegEncoder::~JpegEncoder()
 
     delete mArgs.thumb_enc_param;
 
+    delete[] mExifTemplate;
+
     if (mDevFd > 0)
         close(mDevFd);
 }
@@ -386,9 +393,135 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
 
     ALOGD("makeExif E");
 
+    unsigned int tmp, len;
+    char *thumbBuf;
+    int thumbSize;
+
+    if (useMainbufForThumb) {
+        thumbBuf = mArgs.out_buf;
+        thumbSize = mArgs.enc_param->file_size;
+    } else {
+        thumbBuf = mArgs.out_thumb_buf;
+        thumbSize = mArgs.thumb_enc_param->file_size;
+    }
+
+    bool useThumb = exifInfo->enableThumb && (thumbBuf != NULL) && (thumbSize > 0);
+
+    if (!matchExifTemplate(exifInfo, useThumb)) {
+        if (buildExifTemplate(exifInfo, useThumb) != JPG_SUCCESS) {
+            ALOGE("Failed to build the EXIF template");
+            return JPG_FAIL;
+        }
+    }
+
+    memcpy(exifOut, mExifTemplate, mExifTemplateLen);
+    for (int i = 0; i < mExifPatchCount; i++) {
+        memcpy(exifOut + mExifPatch[i].pos,
+               (unsigned char *)exifInfo + mExifPatch[i].field,
+               mExifPatch[i].len);
+    }
+    len = mExifTemplateLen;
+
+    //2 Thumbnail, right behind the 1th IFD
+    if (useThumb) {
+        tmp = thumbSize;
+        memcpy(exifOut + mExifThumbLenPos, &tmp, OFFSET_SIZE);
+        memcpy(exifOut + len, thumbBuf, thumbSize);
+        len += thumbSize;
+    }
+
+    *size = len;
+    tmp = *size - 2;    // APP1 Maker isn't counted
+    unsigned char size_mm[2] = {(tmp >> 8) & 0xFF, tmp & 0xFF};
+    memcpy(exifOut + 2, size_mm, 2);
+
+    ALOGD("makeExif X");
+
+    return JPG_SUCCESS;
+}
+
+/* Whether the template was serialized for the static attributes of exifInfo */
+bool JpegEncoder::matchExifTemplate(exif_attribute_t *exifInfo, bool useThumb)
+{
+    exif_attribute_t *key = &mExifKey;
+
+    if (mExifTemplate == NULL || mExifTemplateLen == 0)
+        return false;
+
+    if (exifInfo->enableGps != key->enableGps || useThumb != mExifKeyThumb)
+        return false;
+
+    if (strcmp((char *)exifInfo->maker, (char *)key->maker) ||
+            strcmp((char *)exifInfo->model, (char *)key->model) ||
+            strcmp((char *)exifInfo->software, (char *)key->software) ||
+            strcmp((char *)exifInfo->user_comment, (char *)key->user_comment) ||
+            memcmp(exifInfo->exif_version, key->exif_version, sizeof(key->exif_version)))
+        return false;
+
+    if (exifInfo->ycbcr_positioning != key->ycbcr_positioning ||
+            exifInfo->exposure_program != key->exposure_program ||
+            exifInfo->color_space != key->color_space ||
+            exifInfo->exposure_mode != key->exposure_mode ||
+            memcmp(&exifInfo->fnumber, &key->fnumber, sizeof(rational_t)) ||
+            memcmp(&exifInfo->max_aperture, &key->max_aperture, sizeof(rational_t)) ||
+            memcmp(&exifInfo->focal_length, &key->focal_length, sizeof(rational_t)))
+        return false;
+
+    if (exifInfo->enableGps &&
+            (memcmp(exifInfo->gps_version_id, key->gps_version_id, sizeof(key->gps_version_id)) ||
+             strnlen((char *)exifInfo->gps_processing_method, sizeof(key->gps_processing_method)) !=
+             strnlen((char *)key->gps_processing_method, sizeof(key->gps_processing_method))))
+        return false;
+
+    if (useThumb &&
+            (memcmp(&exifInfo->x_resolution, &key->x_resolution, sizeof(rational_t)) ||
+             memcmp(&exifInfo->y_resolution, &key->y_resolution, sizeof(rational_t)) ||
+             exifInfo->resolution_unit != key->resolution_unit ||
+             exifInfo->compression_scheme != key->compression_scheme))
+        return false;
+
+    return true;
+}
+
+inline void JpegEncoder::addExifPatch(unsigned char *pos, unsigned int field, unsigned int len)
+{
+    exif_patch_t *patch;
+
+    // counted past the end, buildExifTemplate gives up on the template
+    if (mExifPatchCount >= NUM_EXIF_PATCH) {
+        mExifPatchCount = NUM_EXIF_PATCH + 1;
+        return;
+    }
+
+    patch = &mExifPatch[mExifPatchCount++];
+
+    patch->pos = pos - mExifTemplate;
+    patch->field = field;
+    patch->len = len;
+}
+
+/*
+ * Serializes the APP1 block for exifInfo up to where the thumbnail goes and
+ * records where each per-shot field landed. The thumbnail length is left
+ * to makeExif.
+ */
+jpg_return_status JpegEncoder::buildExifTemplate(exif_attribute_t *exifInfo, bool useThumb)
+{
     unsigned char *pCur, *pApp1Start, *pIfdStart, *pGpsIfdPtr, *pNextIfdOffset;
     unsigned int tmp, LongerTagOffest = 0;
-    pApp1Start = pCur = exifOut;
+
+    if (mExifTemplate == NULL) {
+        mExifTemplate = new unsigned char[EXIF_FILE_SIZE];
+        if (mExifTemplate == NULL) {
+            ALOGE("Failed to allocate for mExifTemplate");
+            return JPG_FAIL;
+        }
+    }
+    memset(mExifTemplate, 0, EXIF_FILE_SIZE);
+    mExifTemplateLen = 0;
+    mExifPatchCount = 0;
+
+    pApp1Start = pCur = mExifTemplate;
 
     //2 Exif Identifier Code & TIFF Header
     pCur += 4;  // Skip 4 Byte for APP1 marker and length
@@ -415,16 +548,20 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
 
     writeExifIfd(&pCur, EXIF_TAG_IMAGE_WIDTH, EXIF_TYPE_LONG,
                  1, exifInfo->width);
+    addExifPatch(pCur - 4, EXIF_FIELD(width));
     writeExifIfd(&pCur, EXIF_TAG_IMAGE_HEIGHT, EXIF_TYPE_LONG,
                  1, exifInfo->height);
+    addExifPatch(pCur - 4, EXIF_FIELD(height));
     writeExifIfd(&pCur, EXIF_TAG_MAKE, EXIF_TYPE_ASCII,
                  strlen((char *)exifInfo->maker) + 1, exifInfo->maker, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_MODEL, EXIF_TYPE_ASCII,
                  strlen((char *)exifInfo->model) + 1, exifInfo->model, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_ORIENTATION, EXIF_TYPE_SHORT,
                  1, exifInfo->orientation);
+    addExifPatch(pCur - 4, EXIF_FIELD(orientation));
     writeExifIfd(&pCur, EXIF_TAG_SOFTWARE, EXIF_TYPE_ASCII,
                  strlen((char *)exifInfo->software) + 1, exifInfo->software, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(date_time));
     writeExifIfd(&pCur, EXIF_TAG_DATE_TIME, EXIF_TYPE_ASCII,
                  20, exifInfo->date_time, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_YCBCR_POSITIONING, EXIF_TYPE_SHORT,
@@ -448,6 +585,7 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
 
     LongerTagOffest += NUM_SIZE + NUM_0TH_IFD_EXIF*IFD_SIZE + OFFSET_SIZE;
 
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(exposure_time));
     writeExifIfd(&pCur, EXIF_TAG_EXPOSURE_TIME, EXIF_TYPE_RATIONAL,
                  1, &exifInfo->exposure_time, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_FNUMBER, EXIF_TYPE_RATIONAL,
@@ -456,46 +594,61 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
                  1, exifInfo->exposure_program);
     writeExifIfd(&pCur, EXIF_TAG_ISO_SPEED_RATING, EXIF_TYPE_SHORT,
                  1, exifInfo->iso_speed_rating);
+    addExifPatch(pCur - 4, EXIF_FIELD(iso_speed_rating));
     writeExifIfd(&pCur, EXIF_TAG_EXIF_VERSION, EXIF_TYPE_UNDEFINED,
                  4, exifInfo->exif_version);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(date_time));
     writeExifIfd(&pCur, EXIF_TAG_DATE_TIME_ORG, EXIF_TYPE_ASCII,
                  20, exifInfo->date_time, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(date_time));
     writeExifIfd(&pCur, EXIF_TAG_DATE_TIME_DIGITIZE, EXIF_TYPE_ASCII,
                  20, exifInfo->date_time, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(shutter_speed));
     writeExifIfd(&pCur, EXIF_TAG_SHUTTER_SPEED, EXIF_TYPE_SRATIONAL,
                  1, (rational_t *)&exifInfo->shutter_speed, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(aperture));
     writeExifIfd(&pCur, EXIF_TAG_APERTURE, EXIF_TYPE_RATIONAL,
                  1, &exifInfo->aperture, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(brightness));
     writeExifIfd(&pCur, EXIF_TAG_BRIGHTNESS, EXIF_TYPE_SRATIONAL,
                  1, (rational_t *)&exifInfo->brightness, &LongerTagOffest, pIfdStart);
+    addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(exposure_bias));
     writeExifIfd(&pCur, EXIF_TAG_EXPOSURE_BIAS, EXIF_TYPE_SRATIONAL,
                  1, (rational_t *)&exifInfo->exposure_bias, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_MAX_APERTURE, EXIF_TYPE_RATIONAL,
                  1, &exifInfo->max_aperture, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_METERING_MODE, EXIF_TYPE_SHORT,
                  1, exifInfo->metering_mode);
+    addExifPatch(pCur - 4, EXIF_FIELD(metering_mode));
     writeExifIfd(&pCur, EXIF_TAG_FLASH, EXIF_TYPE_SHORT,
                  1, exifInfo->flash);
+    addExifPatch(pCur - 4, EXIF_FIELD(flash));
     writeExifIfd(&pCur, EXIF_TAG_FOCAL_LENGTH, EXIF_TYPE_RATIONAL,
                  1, &exifInfo->focal_length, &LongerTagOffest, pIfdStart);
-    char code[8] = { 0x00, 0x00, 0x00, 0x49, 0x49, 0x43, 0x53, 0x41 };
-    int commentsLen = strlen((char *)exifInfo->user_comment) + 1;
-    memmove(exifInfo->user_comment + sizeof(code), exifInfo->user_comment, commentsLen);
-    memcpy(exifInfo->user_comment, code, sizeof(code));
+    // the character code goes in front of the comment, not into exifInfo
+    unsigned char comment[8 + sizeof(exifInfo->user_comment)] =
+            { 0x00, 0x00, 0x00, 0x49, 0x49, 0x43, 0x53, 0x41 };
+    int commentsLen = strnlen((char *)exifInfo->user_comment,
+                              sizeof(exifInfo->user_comment) - 1) + 1;
+    memcpy(comment + 8, exifInfo->user_comment, commentsLen);
     writeExifIfd(&pCur, EXIF_TAG_USER_COMMENT, EXIF_TYPE_UNDEFINED,
-                 commentsLen + sizeof(code), exifInfo->user_comment, &LongerTagOffest, pIfdStart);
+                 commentsLen + 8, comment, &LongerTagOffest, pIfdStart);
     writeExifIfd(&pCur, EXIF_TAG_COLOR_SPACE, EXIF_TYPE_SHORT,
                  1, exifInfo->color_space);
     writeExifIfd(&pCur, EXIF_TAG_PIXEL_X_DIMENSION, EXIF_TYPE_LONG,
                  1, exifInfo->width);
+    addExifPatch(pCur - 4, EXIF_FIELD(width));
     writeExifIfd(&pCur, EXIF_TAG_PIXEL_Y_DIMENSION, EXIF_TYPE_LONG,
                  1, exifInfo->height);
+    addExifPatch(pCur - 4, EXIF_FIELD(height));
     writeExifIfd(&pCur, EXIF_TAG_EXPOSURE_MODE, EXIF_TYPE_LONG,
                  1, exifInfo->exposure_mode);
     writeExifIfd(&pCur, EXIF_TAG_WHITE_BALANCE, EXIF_TYPE_LONG,
                  1, exifInfo->white_balance);
+    addExifPatch(pCur - 4, EXIF_FIELD(white_balance));
     writeExifIfd(&pCur, EXIF_TAG_SCENCE_CAPTURE_TYPE, EXIF_TYPE_LONG,
                  1, exifInfo->scene_capture_type);
+    addExifPatch(pCur - 4, EXIF_FIELD(scene_capture_type));
     tmp = 0;
     memcpy(pCur, &tmp, OFFSET_SIZE); // next IFD offset
     pCur += OFFSET_SIZE;
@@ -522,29 +675,37 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
                      4, exifInfo->gps_version_id);
         writeExifIfd(&pCur, EXIF_TAG_GPS_LATITUDE_REF, EXIF_TYPE_ASCII,
                      2, exifInfo->gps_latitude_ref);
+        addExifPatch(pCur - 4, EXIF_FIELD(gps_latitude_ref));
+        addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(gps_latitude));
         writeExifIfd(&pCur, EXIF_TAG_GPS_LATITUDE, EXIF_TYPE_RATIONAL,
                      3, exifInfo->gps_latitude, &LongerTagOffest, pIfdStart);
         writeExifIfd(&pCur, EXIF_TAG_GPS_LONGITUDE_REF, EXIF_TYPE_ASCII,
                      2, exifInfo->gps_longitude_ref);
+        addExifPatch(pCur - 4, EXIF_FIELD(gps_longitude_ref));
+        addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(gps_longitude));
         writeExifIfd(&pCur, EXIF_TAG_GPS_LONGITUDE, EXIF_TYPE_RATIONAL,
                      3, exifInfo->gps_longitude, &LongerTagOffest, pIfdStart);
         writeExifIfd(&pCur, EXIF_TAG_GPS_ALTITUDE_REF, EXIF_TYPE_BYTE,
                      1, exifInfo->gps_altitude_ref);
+        addExifPatch(pCur - 4, EXIF_FIELD(gps_altitude_ref));
+        addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(gps_altitude));
         writeExifIfd(&pCur, EXIF_TAG_GPS_ALTITUDE, EXIF_TYPE_RATIONAL,
                      1, &exifInfo->gps_altitude, &LongerTagOffest, pIfdStart);
+        addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(gps_timestamp));
         writeExifIfd(&pCur, EXIF_TAG_GPS_TIMESTAMP, EXIF_TYPE_RATIONAL,
                      3, exifInfo->gps_timestamp, &LongerTagOffest, pIfdStart);
-        tmp = strlen((char*)exifInfo->gps_processing_method);
-	if (tmp > 0) {
-            if (tmp > 100) {
-                tmp = 100;
-            }
-            unsigned char tmp_buf[100+sizeof(ExifAsciiPrefix)];
+        tmp = strnlen((char*)exifInfo->gps_processing_method,
+                      sizeof(exifInfo->gps_processing_method));
+        if (tmp > 0) {
+            unsigned char tmp_buf[sizeof(exifInfo->gps_processing_method)+sizeof(ExifAsciiPrefix)];
             memcpy(tmp_buf, ExifAsciiPrefix, sizeof(ExifAsciiPrefix));
             memcpy(&tmp_buf[sizeof(ExifAsciiPrefix)], exifInfo->gps_processing_method, tmp);
+            addExifPatch(pIfdStart + LongerTagOffest + sizeof(ExifAsciiPrefix),
+                         offsetof(exif_attribute_t, gps_processing_method), tmp);
             writeExifIfd(&pCur, EXIF_TAG_GPS_PROCESSING_METHOD, EXIF_TYPE_UNDEFINED,
                          tmp+sizeof(ExifAsciiPrefix), tmp_buf, &LongerTagOffest, pIfdStart);
         }
+        addExifPatch(pIfdStart + LongerTagOffest, EXIF_FIELD(gps_datestamp));
         writeExifIfd(&pCur, EXIF_TAG_GPS_DATESTAMP, EXIF_TYPE_ASCII,
                      11, exifInfo->gps_datestamp, &LongerTagOffest, pIfdStart);
         tmp = 0;
@@ -553,18 +714,7 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
     }
 
     //2 1th IFD TIFF Tags
-    char *thumbBuf;
-    int thumbSize;
-
-    if (useMainbufForThumb) {
-        thumbBuf = mArgs.out_buf;
-        thumbSize = mArgs.enc_param->file_size;
-    } else {
-        thumbBuf = mArgs.out_thumb_buf;
-        thumbSize = mArgs.thumb_enc_param->file_size;
-    }
-
-    if (exifInfo->enableThumb && (thumbBuf != NULL) && (thumbSize > 0)) {
+    if (useThumb) {
         tmp = LongerTagOffest;
         memcpy(pNextIfdOffset, &tmp, OFFSET_SIZE);  // NEXT IFD offset skipped on 0th IFD
 
@@ -578,12 +728,15 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
 
         writeExifIfd(&pCur, EXIF_TAG_IMAGE_WIDTH, EXIF_TYPE_LONG,
                      1, exifInfo->widthThumb);
+        addExifPatch(pCur - 4, EXIF_FIELD(widthThumb));
         writeExifIfd(&pCur, EXIF_TAG_IMAGE_HEIGHT, EXIF_TYPE_LONG,
                      1, exifInfo->heightThumb);
+        addExifPatch(pCur - 4, EXIF_FIELD(heightThumb));
         writeExifIfd(&pCur, EXIF_TAG_COMPRESSION_SCHEME, EXIF_TYPE_SHORT,
                      1, exifInfo->compression_scheme);
         writeExifIfd(&pCur, EXIF_TAG_ORIENTATION, EXIF_TYPE_SHORT,
                      1, exifInfo->orientation);
+        addExifPatch(pCur - 4, EXIF_FIELD(orientation));
         writeExifIfd(&pCur, EXIF_TAG_X_RESOLUTION, EXIF_TYPE_RATIONAL,
                      1, &exifInfo->x_resolution, &LongerTagOffest, pIfdStart);
         writeExifIfd(&pCur, EXIF_TAG_Y_RESOLUTION, EXIF_TYPE_RATIONAL,
@@ -593,30 +746,31 @@ jpg_return_status JpegEncoder::makeExif (unsigned char *exifOut,
         writeExifIfd(&pCur, EXIF_TAG_JPEG_INTERCHANGE_FORMAT, EXIF_TYPE_LONG,
                      1, LongerTagOffest);
         writeExifIfd(&pCur, EXIF_TAG_JPEG_INTERCHANGE_FORMAT_LEN, EXIF_TYPE_LONG,
-                     1, thumbSize);
+                     1, (uint32_t)0);    // the thumbnail size is filled in by makeExif
+        mExifThumbLenPos = pCur - 4 - mExifTemplate;
 
         tmp = 0;
         memcpy(pCur, &tmp, OFFSET_SIZE); // next IFD offset
         pCur += OFFSET_SIZE;
-
-        memcpy(pIfdStart + LongerTagOffest,
-               thumbBuf, thumbSize);
-        LongerTagOffest += thumbSize;
     } else {
         tmp = 0;
         memcpy(pNextIfdOffset, &tmp, OFFSET_SIZE);  // NEXT IFD offset skipped on 0th IFD
     }
 
+    if (mExifPatchCount > NUM_EXIF_PATCH) {
+        ALOGE("More than %d per-shot EXIF fields", NUM_EXIF_PATCH);
+        mExifPatchCount = 0;
+        return JPG_FAIL;
+    }
+
     unsigned char App1Marker[2] = { 0xff, 0xe1 };
     memcpy(pApp1Start, App1Marker, 2);
-    pApp1Start += 2;
 
-    *size = 10 + LongerTagOffest;
-    tmp = *size - 2;    // APP1 Maker isn't counted
-    unsigned char size_mm[2] = {(tmp >> 8) & 0xFF, tmp & 0xFF};
-    memcpy(pApp1Start, size_mm, 2);
+    mExifTemplateLen = 10 + LongerTagOffest;
+    memcpy(&mExifKey, exifInfo, sizeof(exif_attribute_t));
+    mExifKeyThumb = useThumb;
 
-    ALOGD("makeExif X");
+    ALOGV("EXIF template: %d bytes, %d per-shot fields", mExifTemplateLen, mExifPatchCount);
 
     return JPG_SUCCESS;
 }
@@ -187,6 +187,16 @@ typedef struct {
     jpg_enc_proc_param  *thumb_enc_param;
 } jpg_args;
 
+/* A per-shot field of exif_attribute_t and where it lives in the EXIF template */
+typedef struct {
+    unsigned int    pos;
+    unsigned int    field;
+    unsigned int    len;
+} exif_patch_t;
+
+/* buildExifTemplate records 30 at most: GPS adds 9 and the thumbnail 3 */
+#define NUM_EXIF_PATCH  32
+
 typedef struct {
     unsigned int     frame_buf_size;
     unsigned int     thumb_frame_buf_size;
@@ -224,6 +234,10 @@ private:
     bool scaleDownYuv422(char *srcBuf, uint32_t srcWidth, uint32_t srcHight,
                          char *dstBuf, uint32_t dstWidth, uint32_t dstHight);
 
+    bool matchExifTemplate(exif_attribute_t *exifInfo, bool useThumb);
+    jpg_return_status buildExifTemplate(exif_attribute_t *exifInfo, bool useThumb);
+    inline void addExifPatch(unsigned char *pos, unsigned int field, unsigned int len);
+
     inline void writeExifIfd(unsigned char **pCur,
                                  unsigned short tag,
                                  unsigned short type,
@@ -252,6 +266,19 @@ private:
     jpg_args mArgs;
     jpg_info mInfo;
 
+    /*
+     * APP1 block up to the thumbnail, serialized for the static attributes
+     * in mExifKey. Shots with the same static attributes only copy it and
+     * patch the per-shot fields listed in mExifPatch.
+     */
+    unsigned char *mExifTemplate;
+    unsigned int mExifTemplateLen;
+    unsigned int mExifThumbLenPos;
+    exif_attribute_t mExifKey;
+    bool mExifKeyThumb;
+    exif_patch_t mExifPatch[NUM_EXIF_PATCH];
+    int mExifPatchCount;
+
     bool available;
 
 };
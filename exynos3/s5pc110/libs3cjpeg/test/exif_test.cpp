@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * makeExif() against a fake /dev/s3c-jpg. One encoder reuses its EXIF
+ * template over 60 shots that change every per-shot field and now and
+ * then a static one. Each APP1 block must match a new encoder that
+ * serializes the shot from scratch. Shot 1 must also match the bytes the
+ * generator wrote before the template existed.
+ *
+ * open/close/ioctl are defined here. The driver node is a temporary file,
+ * so the encoder's mmap() works unchanged. The driver returns buffer
+ * addresses as the ioctl result, so this only works as a 32-bit binary.
+ */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#ifndef __BIONIC__
+#ifndef PAGE_SIZE
+#define PAGE_SIZE 4096
+#endif
+typedef unsigned int uint_t;
+#endif
+
+#include "../JpegEncoder.cpp"
+
+#ifdef __BIONIC__
+#define TMP_DIR "/data/local/tmp"
+#else
+#define TMP_DIR "/tmp"
+#endif
+
+#define SHOTS           60
+#define MAX_FAKE_FDS    4
+#define MAX_THUMB_SIZE  4096
+#define THUMB_WIDTH     160
+#define THUMB_HEIGHT    128
+#define GOLDEN_SHOT     1
+#define GOLDEN_THUMB    1031
+
+using namespace android;
+
+/* shot 1 as the generator before the template wrote it, up to the thumbnail */
+static const unsigned char golden[] = {
+    0xff, 0xe1, 0x07, 0xb6, 0x45, 0x78, 0x69, 0x66, 0x00, 0x00, 0x49, 0x49,
+    0x2a, 0x00, 0x08, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x01, 0x04, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x80, 0x02, 0x00, 0x00, 0x01, 0x01, 0x04, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x0f, 0x01, 0x02, 0x00,
+    0x08, 0x00, 0x00, 0x00, 0x86, 0x00, 0x00, 0x00, 0x10, 0x01, 0x02, 0x00,
+    0x09, 0x00, 0x00, 0x00, 0x8e, 0x00, 0x00, 0x00, 0x12, 0x01, 0x03, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x31, 0x01, 0x02, 0x00,
+    0x0a, 0x00, 0x00, 0x00, 0x97, 0x00, 0x00, 0x00, 0x32, 0x01, 0x02, 0x00,
+    0x14, 0x00, 0x00, 0x00, 0xa1, 0x00, 0x00, 0x00, 0x13, 0x02, 0x03, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x69, 0x87, 0x04, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0xb5, 0x00, 0x00, 0x00, 0x25, 0x88, 0x04, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x41, 0x02, 0x00, 0x00, 0x25, 0x03, 0x00, 0x00,
+    0x53, 0x41, 0x4d, 0x53, 0x55, 0x4e, 0x47, 0x00, 0x47, 0x54, 0x2d, 0x49,
+    0x39, 0x30, 0x32, 0x30, 0x00, 0x43, 0x52, 0x45, 0x53, 0x50, 0x4f, 0x4a,
+    0x48, 0x32, 0x00, 0x32, 0x30, 0x31, 0x32, 0x3a, 0x30, 0x39, 0x3a, 0x30,
+    0x32, 0x20, 0x30, 0x31, 0x3a, 0x30, 0x31, 0x3a, 0x30, 0x37, 0x00, 0x16,
+    0x00, 0x9a, 0x82, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0xc3, 0x01, 0x00,
+    0x00, 0x9d, 0x82, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0xcb, 0x01, 0x00,
+    0x00, 0x22, 0x88, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00,
+    0x00, 0x27, 0x88, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x65, 0x00, 0x00,
+    0x00, 0x00, 0x90, 0x07, 0x00, 0x04, 0x00, 0x00, 0x00, 0x30, 0x32, 0x32,
+    0x30, 0x03, 0x90, 0x02, 0x00, 0x14, 0x00, 0x00, 0x00, 0xd3, 0x01, 0x00,
+    0x00, 0x04, 0x90, 0x02, 0x00, 0x14, 0x00, 0x00, 0x00, 0xe7, 0x01, 0x00,
+    0x00, 0x01, 0x92, 0x0a, 0x00, 0x01, 0x00, 0x00, 0x00, 0xfb, 0x01, 0x00,
+    0x00, 0x02, 0x92, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x02, 0x00,
+    0x00, 0x03, 0x92, 0x0a, 0x00, 0x01, 0x00, 0x00, 0x00, 0x0b, 0x02, 0x00,
+    0x00, 0x04, 0x92, 0x0a, 0x00, 0x01, 0x00, 0x00, 0x00, 0x13, 0x02, 0x00,
+    0x00, 0x05, 0x92, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1b, 0x02, 0x00,
+    0x00, 0x07, 0x92, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x09, 0x92, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x0a, 0x92, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x23, 0x02, 0x00,
+    0x00, 0x86, 0x92, 0x07, 0x00, 0x16, 0x00, 0x00, 0x00, 0x2b, 0x02, 0x00,
+    0x00, 0x01, 0xa0, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x02, 0xa0, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x80, 0x02, 0x00,
+    0x00, 0x03, 0xa0, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x80, 0x01, 0x00,
+    0x00, 0x02, 0xa4, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x03, 0xa4, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x06, 0xa4, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00,
+    0x00, 0x1a, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x32, 0x30, 0x31,
+    0x32, 0x3a, 0x30, 0x39, 0x3a, 0x30, 0x32, 0x20, 0x30, 0x31, 0x3a, 0x30,
+    0x31, 0x3a, 0x30, 0x37, 0x00, 0x32, 0x30, 0x31, 0x32, 0x3a, 0x30, 0x39,
+    0x3a, 0x30, 0x32, 0x20, 0x30, 0x31, 0x3a, 0x30, 0x31, 0x3a, 0x30, 0x37,
+    0x00, 0xfa, 0xff, 0xff, 0xff, 0x0a, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00,
+    0x00, 0x0a, 0x00, 0x00, 0x00, 0xfe, 0xff, 0xff, 0xff, 0x0a, 0x00, 0x00,
+    0x00, 0xff, 0xff, 0xff, 0xff, 0x0a, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00,
+    0x00, 0x0a, 0x00, 0x00, 0x00, 0x16, 0x01, 0x00, 0x00, 0x64, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x49, 0x49, 0x43, 0x53, 0x41, 0x55, 0x73, 0x65,
+    0x72, 0x20, 0x63, 0x6f, 0x6d, 0x6d, 0x65, 0x6e, 0x74, 0x73, 0x00, 0x0a,
+    0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00, 0x00, 0x00, 0x02, 0x02, 0x00,
+    0x00, 0x01, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x4e, 0x00, 0x00,
+    0x00, 0x02, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0xbf, 0x02, 0x00,
+    0x00, 0x03, 0x00, 0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x57, 0x00, 0x00,
+    0x00, 0x04, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0xd7, 0x02, 0x00,
+    0x00, 0x05, 0x00, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x06, 0x00, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0xef, 0x02, 0x00,
+    0x00, 0x07, 0x00, 0x05, 0x00, 0x03, 0x00, 0x00, 0x00, 0xf7, 0x02, 0x00,
+    0x00, 0x1b, 0x00, 0x07, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0f, 0x03, 0x00,
+    0x00, 0x1d, 0x00, 0x02, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x1a, 0x03, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x32, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x33, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x34, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x0f, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0xfb, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x41, 0x53, 0x43, 0x49, 0x49, 0x00, 0x00, 0x00, 0x47, 0x50, 0x53,
+    0x32, 0x30, 0x31, 0x32, 0x3a, 0x30, 0x39, 0x3a, 0x30, 0x32, 0x00, 0x09,
+    0x00, 0x00, 0x01, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0xa0, 0x00, 0x00,
+    0x00, 0x01, 0x01, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x78, 0x00, 0x00,
+    0x00, 0x03, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x12, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00,
+    0x00, 0x1a, 0x01, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x97, 0x03, 0x00,
+    0x00, 0x1b, 0x01, 0x05, 0x00, 0x01, 0x00, 0x00, 0x00, 0x9f, 0x03, 0x00,
+    0x00, 0x28, 0x01, 0x03, 0x00, 0x01, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00,
+    0x00, 0x01, 0x02, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0xa7, 0x03, 0x00,
+    0x00, 0x02, 0x02, 0x04, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x04, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x48, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00
+};
+
+static struct {
+    int fd[MAX_FAKE_FDS];
+    int thumb_size;
+} fake;
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("exif_test: %s:%d: %s\n",                        \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static int fake_slot(int fd)
+{
+    for (int i = 0; i < MAX_FAKE_FDS; i++) {
+        if (fd >= 0 && fake.fd[i] == fd)
+            return i;
+    }
+    return -1;
+}
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    va_list ap;
+    va_start(ap, flags);
+    int mode = va_arg(ap, int);
+    va_end(ap);
+
+    if (strcmp(path, JPG_DRIVER_NAME) != 0)
+        return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+
+    /* the driver's buffers, backed by an unlinked file */
+    int slot;
+    for (slot = 0; slot < MAX_FAKE_FDS && fake.fd[slot] >= 0; slot++)
+        ;
+    if (slot == MAX_FAKE_FDS)
+        return -1;
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s/exif_test.XXXXXX", TMP_DIR);
+    int fd = mkstemp(name);
+    if (fd < 0)
+        return -1;
+    unlink(name);
+    if (ftruncate(fd, JPG_TOTAL_BUF_SIZE) < 0) {
+        syscall(SYS_close, fd);
+        return -1;
+    }
+
+    fake.fd[slot] = fd;
+    return fd;
+}
+
+extern "C" int close(int fd)
+{
+    int slot = fake_slot(fd);
+
+    if (slot >= 0)
+        fake.fd[slot] = -1;
+    return syscall(SYS_close, fd);
+}
+
+static int fake_jpg_ioctl(unsigned int req, void *arg)
+{
+    jpg_info *info;
+    jpg_args *args;
+    char *base = (char *)arg;
+
+    switch (req) {
+    case IOCTL_JPG_GET_INFO:
+        info = (jpg_info *)arg;
+        info->frame_buf_size = JPG_FRAME_BUF_SIZE;
+        info->thumb_frame_buf_size = JPG_FRAME_THUMB_BUF_SIZE;
+        info->stream_buf_size = JPG_STREAM_BUF_SIZE;
+        info->thumb_stream_buf_size = JPG_STREAM_THUMB_BUF_SIZE;
+        info->total_buf_size = JPG_TOTAL_BUF_SIZE;
+        info->max_width = MAX_JPG_WIDTH;
+        info->max_height = MAX_JPG_HEIGHT;
+        info->max_thumb_width = MAX_JPG_THUMBNAIL_WIDTH;
+        info->max_thumb_height = MAX_JPG_THUMBNAIL_HEIGHT;
+        return 0;
+    case IOCTL_JPG_ENCODE:
+        /* only thumbnails are encoded here, see encodeThumbImg() */
+        args = (jpg_args *)arg;
+        for (int i = 0; i < fake.thumb_size; i++)
+            args->mmapped_addr[JPG_THUMB_START + i] = (char)(i * 13);
+        args->thumb_enc_param->file_size = fake.thumb_size;
+        return JPG_SUCCESS;
+    case IOCTL_JPG_GET_STRBUF:
+        return (int)(intptr_t)(base + JPG_MAIN_START);
+    case IOCTL_JPG_GET_THUMB_STRBUF:
+        return (int)(intptr_t)(base + JPG_THUMB_START);
+    case IOCTL_JPG_GET_FRMBUF:
+        return (int)(intptr_t)(base + IMG_MAIN_START);
+    case IOCTL_JPG_GET_THUMB_FRMBUF:
+        return (int)(intptr_t)(base + IMG_THUMB_START);
+    }
+    return -1;
+}
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+extern "C" int ioctl(int fd, int req, ...)
+#else
+extern "C" int ioctl(int fd, unsigned long req, ...)
+#endif
+{
+    va_list ap;
+    va_start(ap, req);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fake_slot(fd) >= 0)
+        return fake_jpg_ioctl((unsigned int)req, arg);
+    return syscall(SYS_ioctl, fd, req, arg);
+}
+
+static void static_attributes(exif_attribute_t *e)
+{
+    memset(e, 0, sizeof(*e));
+    strcpy((char *)e->maker, EXIF_DEF_MAKER);
+    strcpy((char *)e->model, EXIF_DEF_MODEL);
+    strcpy((char *)e->software, EXIF_DEF_SOFTWARE);
+    memcpy(e->exif_version, EXIF_DEF_EXIF_VERSION, 4);
+    strcpy((char *)e->user_comment, EXIF_DEF_USERCOMMENTS);
+    e->ycbcr_positioning = 1;
+    e->fnumber.num = 26;
+    e->fnumber.den = 10;
+    e->exposure_program = 3;
+    e->focal_length.num = 278;
+    e->focal_length.den = 100;
+    e->color_space = 1;
+    e->max_aperture.num = 24;
+    e->max_aperture.den = 10;
+    e->x_resolution.num = e->y_resolution.num = 72;
+    e->x_resolution.den = e->y_resolution.den = 1;
+    e->resolution_unit = 2;
+    e->compression_scheme = 6;
+    e->gps_version_id[0] = 2;
+    e->gps_version_id[1] = 2;
+}
+
+/* every per-shot field changes, GPS, the thumbnail and a few static ones now and then */
+static void shot_attributes(exif_attribute_t *e, int i)
+{
+    e->width = 800 - (i % 3) * 160;
+    e->height = 480 - (i % 3) * 96;
+    e->widthThumb = 160;
+    e->heightThumb = 120;
+    e->orientation = (i % 4 == 1) ? 6 : 1;
+    snprintf((char *)e->date_time, 20, "2012:09:%02d %02d:%02d:%02d",
+             i % 28 + 1, i % 24, i % 60, (i * 7) % 60);
+    e->exposure_time.num = 1;
+    e->exposure_time.den = 30 + i;
+    e->iso_speed_rating = 100 + i;
+    e->shutter_speed.num = -5 - i;
+    e->shutter_speed.den = 10;
+    e->aperture.num = 28;
+    e->aperture.den = 10;
+    e->brightness.num = i - 3;
+    e->brightness.den = 10;
+    e->exposure_bias.num = -i;
+    e->exposure_bias.den = 10;
+    e->metering_mode = i % 3;
+    e->flash = i & 1;
+    e->white_balance = i % 2;
+    e->scene_capture_type = i % 4;
+    e->enableThumb = (i % 5) != 4;
+    e->enableGps = (i % 3) != 2;
+    e->gps_latitude_ref[0] = (i & 1) ? 'N' : 'S';
+    e->gps_longitude_ref[0] = (i & 2) ? 'E' : 'W';
+    for (int k = 0; k < 3; k++) {
+        e->gps_latitude[k].num = 49 + i + k;
+        e->gps_latitude[k].den = 1;
+        e->gps_longitude[k].num = 14 + i * k;
+        e->gps_longitude[k].den = 1;
+        e->gps_timestamp[k].num = i + k;
+        e->gps_timestamp[k].den = 1;
+    }
+    e->gps_altitude_ref = i & 1;
+    e->gps_altitude.num = 250 + i;
+    e->gps_altitude.den = 1;
+    snprintf((char *)e->gps_datestamp, 11, "2012:09:%02d", i % 28 + 1);
+    /* a method of another length needs a new template */
+    strcpy((char *)e->gps_processing_method,
+           (i % 7 < 5) ? "GPS" : (i % 7 == 5 ? "NETWORK" : ""));
+    if (i == 20)
+        strcpy((char *)e->model, "GT-I9000");
+    if (i == 30)
+        strcpy((char *)e->user_comment, "Another comment");
+}
+
+static int make_exif(JpegEncoder *enc, exif_attribute_t *exif, int thumbSize,
+                     unsigned char *out, unsigned int *size)
+{
+    unsigned int len;
+
+    if (enc->setConfig(JPEG_SET_THUMBNAIL_WIDTH, THUMB_WIDTH) != JPG_SUCCESS ||
+        enc->setConfig(JPEG_SET_THUMBNAIL_HEIGHT, THUMB_HEIGHT) != JPG_SUCCESS)
+        return -1;
+
+    fake.thumb_size = thumbSize;
+    if (exif->enableThumb && enc->encodeThumbImg(&len, false) != JPG_SUCCESS)
+        return -1;
+
+    memset(out, 0, EXIF_FILE_SIZE + MAX_THUMB_SIZE);
+    *size = 0;
+    return enc->makeExif(out, exif, size) == JPG_SUCCESS ? 0 : -1;
+}
+
+int main(int argc, char **argv)
+{
+    static unsigned char out[EXIF_FILE_SIZE + MAX_THUMB_SIZE];
+    static unsigned char ref[EXIF_FILE_SIZE + MAX_THUMB_SIZE];
+    exif_attribute_t exif, copy;
+    unsigned int size, refSize;
+    int differs = 0;
+
+    for (int i = 0; i < MAX_FAKE_FDS; i++)
+        fake.fd[i] = -1;
+
+    JpegEncoder *enc = new JpegEncoder();
+
+    static_attributes(&exif);
+    for (int i = 0; i < SHOTS; i++) {
+        int thumbSize = 1000 + i * 31;
+
+        shot_attributes(&exif, i);
+
+        memcpy(&copy, &exif, sizeof(copy));
+        CHECK(make_exif(enc, &copy, thumbSize, out, &size) == 0);
+
+        JpegEncoder *fresh = new JpegEncoder();
+        memcpy(&copy, &exif, sizeof(copy));
+        CHECK(make_exif(fresh, &copy, thumbSize, ref, &refSize) == 0);
+        delete fresh;
+
+        if (size != refSize || memcmp(out, ref, size) != 0) {
+            printf("exif_test: shot %d differs (%u vs %u bytes)\n", i, size, refSize);
+            differs++;
+        }
+
+        if (i == GOLDEN_SHOT) {
+            CHECK(thumbSize == GOLDEN_THUMB);
+            CHECK(size == sizeof(golden) + GOLDEN_THUMB);
+            CHECK(memcmp(out, golden, sizeof(golden)) == 0);
+        }
+    }
+    CHECK(differs == 0);
+
+    /* the comment is prefixed on a copy, the attributes stay as they were */
+    memcpy(&copy, &exif, sizeof(copy));
+    CHECK(make_exif(enc, &copy, 1000, out, &size) == 0);
+    CHECK(memcmp(&copy, &exif, sizeof(copy)) == 0);
+
+    delete enc;
+    for (int i = 0; i < MAX_FAKE_FDS; i++)
+        CHECK(fake.fd[i] < 0);
+
+    printf("exif_test: %d shots, %d failures\n", SHOTS, failures);
+
+    return failures ? 1 : 0;
+}
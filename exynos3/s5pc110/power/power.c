@@ -15,33 +15,123 @@
  * limitations under the License.
  */
 #include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/timerfd.h>
 #include <fcntl.h>
 
 #define LOG_TAG "S5PC110 PowerHAL"
 #include <utils/Log.h>
 
+#include <cutils/properties.h>
 #include <hardware/hardware.h>
 #include <hardware/power.h>
 
-#define SCALING_GOVERNOR_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"
-#define BOOSTPULSE_ONDEMAND "/sys/devices/system/cpu/cpufreq/ondemand/boostpulse"
-#define BOOSTPULSE_INTERACTIVE "/sys/devices/system/cpu/cpufreq/interactive/boostpulse"
+#define CPUFREQ_PATH "/sys/devices/system/cpu/cpu0/cpufreq/"
+#define SCALING_GOVERNOR_PATH CPUFREQ_PATH "scaling_governor"
+#define SCALING_MIN_FREQ_PATH CPUFREQ_PATH "scaling_min_freq"
+#define SCALING_MAX_FREQ_PATH CPUFREQ_PATH "scaling_max_freq"
+#define ONDEMAND_PATH "/sys/devices/system/cpu/cpufreq/ondemand/"
+#define INTERACTIVE_PATH "/sys/devices/system/cpu/cpufreq/interactive/"
 #define TIMER_RATE_SCREEN_ON "30000"
 #define TIMER_RATE_SCREEN_OFF "150000"
 
+/* Minimum time between two boostpulse writes */
+#define BOOSTPULSE_INTERVAL_PROP "ro.power.boostpulse_interval_ms"
+#ifndef BOOSTPULSE_INTERVAL_MS
+#define BOOSTPULSE_INTERVAL_MS 40
+#endif
+
+/* The governor is read again at most this often while hints come in */
+#define GOVERNOR_CHECK_INTERVAL_NS 1000000000LL
+
+struct governor_tunable {
+    const char *node;
+    const char *value;
+};
+
+/* What the HAL knows about a cpufreq governor */
+struct governor_info {
+    const char *name;
+    const char *dir;
+    const char *boost_freq_node;   /* floor while a CPU_BOOST runs, NULL for max */
+    bool timer_rate;               /* timer_rate follows the screen state */
+    struct governor_tunable tunables[4];
+};
+
+static const struct governor_info governors[] = {
+    {
+        .name = "ondemand",
+        .dir = ONDEMAND_PATH,
+        .boost_freq_node = NULL,
+        .timer_rate = false,
+        .tunables = {
+            { "up_threshold", "95" },
+            { "io_is_busy", "1" },
+            { "sampling_down_factor", "4" },
+        },
+    },
+    {
+        .name = "interactive",
+        .dir = INTERACTIVE_PATH,
+        .boost_freq_node = "hispeed_freq",
+        .timer_rate = true,
+        .tunables = {
+            { "min_sample_time", "90000" },
+            { "above_hispeed_delay", "30000" },
+        },
+    },
+};
+
+/* Counters of the boost code, logged when the screen goes off */
+struct boost_stats {
+    uint32_t pulses;            /* boostpulse writes */
+    uint32_t pulses_skipped;    /* pulses dropped by the rate limit */
+    uint32_t cpu_boosts;        /* POWER_HINT_CPU_BOOST requests */
+    uint32_t activations;       /* times the frequency floor was raised */
+    uint32_t governor_changes;
+    int64_t boosted_ns;         /* total time spent with the floor raised */
+};
+
 struct s5pc110_power_module {
     struct power_module base;
     pthread_mutex_t lock;
     int boostpulse_fd;
     int boostpulse_warned;
+    int64_t boostpulse_last_ns;
+    int boostpulse_interval_ms;
+    /* current governor, NULL if it is not one we know */
+    char governor[20];
+    const struct governor_info *gov;
+    int64_t governor_checked_ns;
+    /* CPU_BOOST: scaling_min_freq is held at boost_freq until cpu_boost_end_ns */
+    char min_freq[10];
+    char boost_freq[10];
+    int64_t cpu_boost_end_ns;
+    bool boost_active;
+    int64_t boost_start_ns;
+    int boost_timer_fd;
+    struct boost_stats boost_stats;
 };
 
-static char governor[20];
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
-static int sysfs_read(char *path, char *s, int num_bytes)
+static int sysfs_read(const char *path, char *s, int num_bytes)
 {
     char buf[80];
     int count;
@@ -57,10 +147,13 @@ static int sysfs_read(char *path, char *s, int num_bytes)
 
     if ((count = read(fd, s, num_bytes - 1)) < 0) {
         strerror_r(errno, buf, sizeof(buf));
-        ALOGE("Error writing to %s: %s\n", path, buf);
+        ALOGE("Error reading from %s: %s\n", path, buf);
 
         ret = -1;
     } else {
+        // Strip newline at the end.
+        while (count > 0 && (s[count - 1] == '\n' || s[count - 1] == '\r'))
+            count--;
         s[count] = '\0';
     }
 
@@ -69,7 +162,7 @@ static int sysfs_read(char *path, char *s, int num_bytes)
     return ret;
 }
 
-static void sysfs_write(char *path, char *s)
+static void sysfs_write(const char *path, const char *s)
 {
     char buf[80];
     int len;
@@ -90,105 +183,316 @@ static void sysfs_write(char *path, char *s)
     close(fd);
 }
 
-static int get_scaling_governor() {
-    if (sysfs_read(SCALING_GOVERNOR_PATH, governor,
-                sizeof(governor)) == -1) {
-        // Can't obtain the scaling governor. Return.
-        return -1;
-    } else {
-        // Strip newline at the end.
-        int len = strlen(governor);
+static void governor_write(const struct governor_info *gov, const char *node,
+                           const char *s)
+{
+    char path[128];
 
-        len--;
+    snprintf(path, sizeof(path), "%s%s", gov->dir, node);
+    sysfs_write(path, s);
+}
 
-        while (len >= 0 && (governor[len] == '\n' || governor[len] == '\r'))
-            governor[len--] = '\0';
+static void boostpulse_close(struct s5pc110_power_module *s5pc110)
+{
+    if (s5pc110->boostpulse_fd >= 0) {
+        close(s5pc110->boostpulse_fd);
+        s5pc110->boostpulse_fd = -1;
+    }
+}
+
+/* You need to hold the powerhal lock before calling this function */
+static int boostpulse_open(struct s5pc110_power_module *s5pc110)
+{
+    char path[128];
+    char buf[80];
+
+    if (s5pc110->boostpulse_fd < 0 && s5pc110->gov != NULL) {
+        snprintf(path, sizeof(path), "%sboostpulse", s5pc110->gov->dir);
+        s5pc110->boostpulse_fd = open(path, O_WRONLY);
+        if (s5pc110->boostpulse_fd < 0 && !s5pc110->boostpulse_warned) {
+            strerror_r(errno, buf, sizeof(buf));
+            ALOGE("Error opening %s boostpulse interface: %s\n",
+                  s5pc110->governor, buf);
+            s5pc110->boostpulse_warned = 1;
+        } else if (s5pc110->boostpulse_fd >= 0) {
+            ALOGD("Opened %s boostpulse interface", s5pc110->governor);
+        }
     }
 
-    return 0;
+    return s5pc110->boostpulse_fd;
 }
 
-static void s5pc110_power_set_interactive(struct power_module *module, int on)
+/*
+ * Raise scaling_min_freq to the boost freq while a CPU_BOOST runs and put it
+ * back once the last one has ended.
+ *
+ * You need to hold the powerhal lock before calling this function
+ */
+static void boost_update(struct s5pc110_power_module *s5pc110)
 {
-    if (strncmp(governor, "interactive", 11) == 0)
-        sysfs_write("/sys/devices/system/cpu/cpufreq/interactive/timer_rate",
-                on ? TIMER_RATE_SCREEN_ON : TIMER_RATE_SCREEN_OFF);
+    int64_t now = now_ns();
+    bool active;
+
+    if (s5pc110->cpu_boost_end_ns != 0 && now >= s5pc110->cpu_boost_end_ns)
+        s5pc110->cpu_boost_end_ns = 0;
+
+    active = s5pc110->cpu_boost_end_ns != 0 && s5pc110->boost_freq[0] != '\0' &&
+             s5pc110->min_freq[0] != '\0';
+    if (active == s5pc110->boost_active)
+        return;
+
+    if (active) {
+        sysfs_write(SCALING_MIN_FREQ_PATH, s5pc110->boost_freq);
+        s5pc110->boost_start_ns = now;
+        s5pc110->boost_stats.activations++;
+    } else {
+        sysfs_write(SCALING_MIN_FREQ_PATH, s5pc110->min_freq);
+        s5pc110->boost_stats.boosted_ns += now - s5pc110->boost_start_ns;
+    }
+
+    s5pc110->boost_active = active;
+
+    ALOGV("%s: boost %s", __func__, active ? "on" : "off");
 }
 
-static void configure_governor()
+/* Tunables, timer_rate and the boost freq of the governor now running */
+static void configure_governor(struct s5pc110_power_module *s5pc110)
 {
-    s5pc110_power_set_interactive(NULL, 1);
+    const struct governor_info *gov = s5pc110->gov;
+    int i;
+
+    s5pc110->boost_freq[0] = '\0';
+    if (gov == NULL)
+        return;
+
+    for (i = 0; i < 4 && gov->tunables[i].node != NULL; i++)
+        governor_write(gov, gov->tunables[i].node, gov->tunables[i].value);
+
+    if (gov->timer_rate)
+        governor_write(gov, "timer_rate", TIMER_RATE_SCREEN_ON);
+
+    if (gov->boost_freq_node != NULL) {
+        char path[128];
 
-    if (strncmp(governor, "ondemand", 8) == 0) {
-        sysfs_write("/sys/devices/system/cpu/cpufreq/ondemand/up_threshold", "95");
-        sysfs_write("/sys/devices/system/cpu/cpufreq/ondemand/io_is_busy", "1");
-        sysfs_write("/sys/devices/system/cpu/cpufreq/ondemand/sampling_down_factor", "4");
-    } else if (strncmp(governor, "interactive", 11) == 0) {
-        sysfs_write("/sys/devices/system/cpu/cpufreq/interactive/min_sample_time", "90000");
-        sysfs_write("/sys/devices/system/cpu/cpufreq/interactive/above_hispeed_delay", "30000");
+        snprintf(path, sizeof(path), "%s%s", gov->dir, gov->boost_freq_node);
+        sysfs_read(path, s5pc110->boost_freq, sizeof(s5pc110->boost_freq));
+    } else {
+        sysfs_read(SCALING_MAX_FREQ_PATH, s5pc110->boost_freq,
+                   sizeof(s5pc110->boost_freq));
     }
 }
 
-static int boostpulse_open(struct s5pc110_power_module *s5pc110)
+/*
+ * Read scaling_governor again, at most every GOVERNOR_CHECK_INTERVAL_NS
+ * unless forced. A new governor gets its tunables and its own boostpulse.
+ *
+ * You need to hold the powerhal lock before calling this function
+ */
+static void governor_check(struct s5pc110_power_module *s5pc110, bool force)
+{
+    int64_t now = now_ns();
+    char governor[sizeof(s5pc110->governor)];
+    unsigned int i;
+
+    if (!force && s5pc110->governor_checked_ns != 0 &&
+            now - s5pc110->governor_checked_ns < GOVERNOR_CHECK_INTERVAL_NS)
+        return;
+    s5pc110->governor_checked_ns = now;
+
+    if (sysfs_read(SCALING_GOVERNOR_PATH, governor, sizeof(governor)) < 0) {
+        ALOGE("Can't read scaling governor.");
+        return;
+    }
+
+    if (strcmp(governor, s5pc110->governor) == 0)
+        return;
+
+    if (s5pc110->governor[0] != '\0') {
+        ALOGD("Governor changed from %s to %s", s5pc110->governor, governor);
+        s5pc110->boost_stats.governor_changes++;
+    }
+
+    /* the old floor belongs to the old governor */
+    s5pc110->cpu_boost_end_ns = 0;
+    boost_update(s5pc110);
+
+    strcpy(s5pc110->governor, governor);
+    s5pc110->gov = NULL;
+    for (i = 0; i < sizeof(governors) / sizeof(governors[0]); i++) {
+        if (strcmp(governor, governors[i].name) == 0) {
+            s5pc110->gov = &governors[i];
+            break;
+        }
+    }
+
+    boostpulse_close(s5pc110);
+    s5pc110->boostpulse_warned = 0;
+    configure_governor(s5pc110);
+}
+
+/* You need to hold the powerhal lock before calling this function */
+static void boostpulse(struct s5pc110_power_module *s5pc110)
 {
+    int64_t now = now_ns();
     char buf[80];
+    int len;
 
-    pthread_mutex_lock(&s5pc110->lock);
+    /* touch events arrive far faster than a boost pulse lasts */
+    if (now - s5pc110->boostpulse_last_ns <
+            (int64_t)s5pc110->boostpulse_interval_ms * 1000000LL) {
+        s5pc110->boost_stats.pulses_skipped++;
+        return;
+    }
 
-    if (s5pc110->boostpulse_fd < 0) {
-        if (get_scaling_governor() < 0) {
-            ALOGE("Can't read scaling governor.");
-            s5pc110->boostpulse_warned = 1;
-        } else {
-            if (strncmp(governor, "ondemand", 8) == 0)
-                s5pc110->boostpulse_fd = open(BOOSTPULSE_ONDEMAND, O_WRONLY);
-            else if (strncmp(governor, "interactive", 11) == 0)
-                s5pc110->boostpulse_fd = open(BOOSTPULSE_INTERACTIVE, O_WRONLY);
-
-            if (s5pc110->boostpulse_fd < 0 && !s5pc110->boostpulse_warned) {
-                strerror_r(errno, buf, sizeof(buf));
-                ALOGE("Error opening %s boostpulse interface: %s\n", governor, buf);
-                s5pc110->boostpulse_warned = 1;
-            } else if (s5pc110->boostpulse_fd > 0) {
-                configure_governor();
-                ALOGD("Opened %s boostpulse interface", governor);
-            }
+    if (boostpulse_open(s5pc110) < 0)
+        return;
+
+    len = write(s5pc110->boostpulse_fd, "1", 1);
+    if (len < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("Error writing to boostpulse: %s\n", buf);
+
+        /* most likely the governor went away under us */
+        boostpulse_close(s5pc110);
+        governor_check(s5pc110, true);
+        return;
+    }
+
+    s5pc110->boostpulse_last_ns = now;
+    s5pc110->boost_stats.pulses++;
+}
+
+/* You need to hold the powerhal lock before calling this function */
+static void boost_cpu(struct s5pc110_power_module *s5pc110, int duration_us)
+{
+    struct itimerspec its;
+    int64_t end = now_ns() + (int64_t)duration_us * 1000LL;
+
+    s5pc110->boost_stats.cpu_boosts++;
+
+    if (end > s5pc110->cpu_boost_end_ns) {
+        s5pc110->cpu_boost_end_ns = end;
+
+        if (s5pc110->boost_timer_fd >= 0) {
+            memset(&its, 0, sizeof(its));
+            its.it_value.tv_sec = end / 1000000000LL;
+            its.it_value.tv_nsec = end % 1000000000LL;
+            timerfd_settime(s5pc110->boost_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+        }
+    }
+
+    boost_update(s5pc110);
+}
+
+/* You need to hold the powerhal lock before calling this function */
+static void boost_log_stats(struct s5pc110_power_module *s5pc110)
+{
+    struct boost_stats *stats = &s5pc110->boost_stats;
+    int64_t boosted_ns = stats->boosted_ns;
+
+    if (s5pc110->boost_active)
+        boosted_ns += now_ns() - s5pc110->boost_start_ns;
+
+    ALOGD("%s: governor=%s pulses=%u skipped=%u cpu_boost=%u activations=%u "
+          "governor_changes=%u boosted=%lldms", __func__, s5pc110->governor,
+          stats->pulses, stats->pulses_skipped, stats->cpu_boosts,
+          stats->activations, stats->governor_changes,
+          (long long)(boosted_ns / 1000000));
+}
+
+/* Ends CPU_BOOSTs: the timer is armed for the latest requested end */
+static void *boost_timer_thread(void *arg)
+{
+    struct s5pc110_power_module *s5pc110 = (struct s5pc110_power_module *) arg;
+    char buf[80];
+    uint64_t expirations;
+    ssize_t len;
+
+    for (;;) {
+        len = read(s5pc110->boost_timer_fd, &expirations, sizeof(expirations));
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            strerror_r(errno, buf, sizeof(buf));
+            ALOGE("%s: Error reading boost timer: %s\n", __func__, buf);
+            break;
         }
+
+        pthread_mutex_lock(&s5pc110->lock);
+        boost_update(s5pc110);
+        pthread_mutex_unlock(&s5pc110->lock);
+    }
+
+    return NULL;
+}
+
+static void init_boost_timer(struct s5pc110_power_module *s5pc110)
+{
+    char buf[80];
+    pthread_attr_t attr;
+    pthread_t thread;
+    int rc;
+
+    s5pc110->boost_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (s5pc110->boost_timer_fd < 0) {
+        strerror_r(errno, buf, sizeof(buf));
+        ALOGE("%s: Error creating boost timer: %s\n", __func__, buf);
+        return;
     }
 
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thread, &attr, boost_timer_thread, s5pc110);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        ALOGE("%s: Error creating boost timer thread: %d\n", __func__, rc);
+        close(s5pc110->boost_timer_fd);
+        s5pc110->boost_timer_fd = -1;
+    }
+}
+
+static void s5pc110_power_set_interactive(struct power_module *module, int on)
+{
+    struct s5pc110_power_module *s5pc110 = (struct s5pc110_power_module *) module;
+
+    pthread_mutex_lock(&s5pc110->lock);
+
+    if (!on)
+        boost_log_stats(s5pc110);
+
+    governor_check(s5pc110, true);
+    if (s5pc110->gov != NULL && s5pc110->gov->timer_rate)
+        governor_write(s5pc110->gov, "timer_rate",
+                       on ? TIMER_RATE_SCREEN_ON : TIMER_RATE_SCREEN_OFF);
+
     pthread_mutex_unlock(&s5pc110->lock);
-    return s5pc110->boostpulse_fd;
 }
 
 static void s5pc110_power_hint(struct power_module *module, power_hint_t hint,
                             void *data)
 {
     struct s5pc110_power_module *s5pc110 = (struct s5pc110_power_module *) module;
-    char buf[80];
-    int len;
-    int duration = 1;
+    int duration_us;
 
     switch (hint) {
     case POWER_HINT_INTERACTION:
+        pthread_mutex_lock(&s5pc110->lock);
+        governor_check(s5pc110, false);
+        boostpulse(s5pc110);
+        pthread_mutex_unlock(&s5pc110->lock);
+        break;
+
     case POWER_HINT_CPU_BOOST:
-        if (boostpulse_open(s5pc110) >= 0) {
-            if (data != NULL)
-                duration = (int) data;
-
-            snprintf(buf, sizeof(buf), "%d", duration);
-            len = write(s5pc110->boostpulse_fd, buf, strlen(buf));
-
-            if (len < 0) {
-                strerror_r(errno, buf, sizeof(buf));
-                ALOGE("Error writing to boostpulse: %s\n", buf);
-
-                pthread_mutex_lock(&s5pc110->lock);
-                close(s5pc110->boostpulse_fd);
-                s5pc110->boostpulse_fd = -1;
-                s5pc110->boostpulse_warned = 0;
-                pthread_mutex_unlock(&s5pc110->lock);
-            }
-        }
+        /* data is the boost duration in microseconds, passed by value */
+        duration_us = (int)(intptr_t)data;
+        if (duration_us <= 0)
+            break;
+
+        pthread_mutex_lock(&s5pc110->lock);
+        governor_check(s5pc110, false);
+        boostpulse(s5pc110);
+        boost_cpu(s5pc110, duration_us);
+        pthread_mutex_unlock(&s5pc110->lock);
         break;
 
     case POWER_HINT_VSYNC:
@@ -201,8 +505,20 @@ static void s5pc110_power_hint(struct power_module *module, power_hint_t hint,
 
 static void s5pc110_power_init(struct power_module *module)
 {
-    get_scaling_governor();
-    configure_governor();
+    struct s5pc110_power_module *s5pc110 = (struct s5pc110_power_module *) module;
+    char value[PROPERTY_VALUE_MAX];
+
+    pthread_mutex_lock(&s5pc110->lock);
+
+    sysfs_read(SCALING_MIN_FREQ_PATH, s5pc110->min_freq, sizeof(s5pc110->min_freq));
+    governor_check(s5pc110, true);
+    init_boost_timer(s5pc110);
+
+    if (property_get(BOOSTPULSE_INTERVAL_PROP, value, NULL) > 0)
+        s5pc110->boostpulse_interval_ms = atoi(value);
+    ALOGV("%s: boostpulse interval: %d ms\n", __func__, s5pc110->boostpulse_interval_ms);
+
+    pthread_mutex_unlock(&s5pc110->lock);
 }
 
 static struct hw_module_methods_t power_module_methods = {
@@ -228,4 +544,6 @@ struct s5pc110_power_module HAL_MODULE_INFO_SYM = {
     lock: PTHREAD_MUTEX_INITIALIZER,
     boostpulse_fd: -1,
     boostpulse_warned: 0,
+    boostpulse_interval_ms: BOOSTPULSE_INTERVAL_MS,
+    boost_timer_fd: -1,
 };
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The power HAL against a fake cpufreq tree in a temporary directory:
+ * tunables, the boostpulse rate limit, timed CPU_BOOSTs and governor
+ * changes. open() is defined here and sends /sys paths into the fake
+ * tree, truncating on write the way a sysfs store replaces the value.
+ * Every other call goes to the kernel.
+ */
+
+#include <stdarg.h>
+#include <ftw.h>
+#include <sys/syscall.h>
+
+#include "../power.c"
+
+#ifdef __BIONIC__
+#define TMP_DIR "/data/local/tmp"
+#else
+#define TMP_DIR "/tmp"
+#endif
+
+#define CPUFREQ_DIR "/sys/devices/system/cpu/cpufreq/"
+
+static char root[64];
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("power_test: %s:%d: %s\n",                       \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+int open(const char *path, int flags, ...)
+{
+    char fake[256];
+    va_list ap;
+    int mode;
+
+    va_start(ap, flags);
+    mode = va_arg(ap, int);
+    va_end(ap);
+
+    if (root[0] != '\0' && strncmp(path, "/sys/", 5) == 0) {
+        snprintf(fake, sizeof(fake), "%s%s", root, path);
+        path = fake;
+        if ((flags & O_ACCMODE) != O_RDONLY)
+            flags |= O_TRUNC;
+    }
+
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+static void put(const char *path, const char *s)
+{
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+
+    if (fd < 0 || write(fd, s, strlen(s)) < 0)
+        printf("power_test: can't write %s\n", path);
+    if (fd >= 0)
+        close(fd);
+}
+
+static int is(const char *path, const char *s)
+{
+    char buf[80];
+
+    return sysfs_read(path, buf, sizeof(buf)) == 0 && strcmp(buf, s) == 0;
+}
+
+static void make_dirs(const char *path)
+{
+    char dir[256];
+    char *p;
+
+    snprintf(dir, sizeof(dir), "%s%s", root, path);
+    for (p = dir + strlen(root) + 1; *p != '\0'; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+}
+
+static int remove_node(const char *path, const struct stat *sb, int flag,
+                       struct FTW *ftw)
+{
+    return remove(path);
+}
+
+static void make_tree(void)
+{
+    static const char *nodes[] = {
+        CPUFREQ_DIR "ondemand/boostpulse",
+        CPUFREQ_DIR "ondemand/up_threshold",
+        CPUFREQ_DIR "ondemand/io_is_busy",
+        CPUFREQ_DIR "ondemand/sampling_down_factor",
+        CPUFREQ_DIR "interactive/boostpulse",
+        CPUFREQ_DIR "interactive/min_sample_time",
+        CPUFREQ_DIR "interactive/above_hispeed_delay",
+        CPUFREQ_DIR "interactive/timer_rate",
+    };
+    unsigned int i;
+
+    make_dirs(CPUFREQ_PATH);
+    make_dirs(ONDEMAND_PATH);
+    make_dirs(INTERACTIVE_PATH);
+
+    put(SCALING_GOVERNOR_PATH, "ondemand\n");
+    put(SCALING_MIN_FREQ_PATH, "100000\n");
+    put(SCALING_MAX_FREQ_PATH, "1000000\n");
+    put(INTERACTIVE_PATH "hispeed_freq", "800000\n");
+    for (i = 0; i < sizeof(nodes) / sizeof(nodes[0]); i++)
+        put(nodes[i], "");
+}
+
+int main(int argc, char **argv)
+{
+    struct s5pc110_power_module *m = &HAL_MODULE_INFO_SYM;
+    int duration_us;
+    int i;
+
+    snprintf(root, sizeof(root), "%s/power_test.XXXXXX", TMP_DIR);
+    if (mkdtemp(root) == NULL) {
+        printf("power_test: can't create %s\n", root);
+        return 1;
+    }
+    make_tree();
+
+    m->base.init(&m->base);
+    /* a device may set the interval property, the checks assume the default */
+    m->boostpulse_interval_ms = BOOSTPULSE_INTERVAL_MS;
+
+    /* ondemand: its tunables, boosting to scaling_max_freq */
+    CHECK(m->gov == &governors[0]);
+    CHECK(is(ONDEMAND_PATH "up_threshold", "95"));
+    CHECK(is(ONDEMAND_PATH "sampling_down_factor", "4"));
+    CHECK(strcmp(m->boost_freq, "1000000") == 0);
+
+    /* a burst of touches is one pulse */
+    for (i = 0; i < 10; i++)
+        m->base.powerHint(&m->base, POWER_HINT_INTERACTION, NULL);
+    CHECK(m->boost_stats.pulses == 1);
+    CHECK(m->boost_stats.pulses_skipped == 9);
+
+    /* the floor is raised for the boost and put back by the timer */
+    duration_us = 200000;
+    m->base.powerHint(&m->base, POWER_HINT_CPU_BOOST, (void *)(intptr_t)duration_us);
+    CHECK(is(SCALING_MIN_FREQ_PATH, "1000000"));
+    usleep(400000);
+    CHECK(is(SCALING_MIN_FREQ_PATH, "100000"));
+    CHECK(m->boost_stats.activations == 1);
+    CHECK(m->boost_stats.boosted_ns >= 190000000LL);
+
+    /* a second boost before the first ends extends it */
+    m->base.powerHint(&m->base, POWER_HINT_CPU_BOOST, (void *)(intptr_t)duration_us);
+    usleep(100000);
+    m->base.powerHint(&m->base, POWER_HINT_CPU_BOOST, (void *)(intptr_t)duration_us);
+    usleep(120000);
+    CHECK(is(SCALING_MIN_FREQ_PATH, "1000000"));
+    usleep(200000);
+    CHECK(is(SCALING_MIN_FREQ_PATH, "100000"));
+    CHECK(m->boost_stats.activations == 2);
+
+    /* a new governor is noticed when the screen goes off */
+    put(SCALING_GOVERNOR_PATH, "interactive\n");
+    m->base.setInteractive(&m->base, 0);
+    CHECK(m->gov == &governors[1]);
+    CHECK(m->boost_stats.governor_changes == 1);
+    CHECK(m->boostpulse_fd < 0);
+    CHECK(is(INTERACTIVE_PATH "timer_rate", TIMER_RATE_SCREEN_OFF));
+    CHECK(is(INTERACTIVE_PATH "min_sample_time", "90000"));
+    CHECK(strcmp(m->boost_freq, "800000") == 0);
+    m->base.setInteractive(&m->base, 1);
+    CHECK(is(INTERACTIVE_PATH "timer_rate", TIMER_RATE_SCREEN_ON));
+
+    /* and in the hint path once the check interval is over */
+    put(SCALING_GOVERNOR_PATH, "ondemand\n");
+    m->governor_checked_ns -= GOVERNOR_CHECK_INTERVAL_NS;
+    m->boostpulse_last_ns = 0;
+    m->base.powerHint(&m->base, POWER_HINT_INTERACTION, NULL);
+    CHECK(m->gov == &governors[0]);
+    CHECK(m->boost_stats.governor_changes == 2);
+    CHECK(m->boostpulse_fd >= 0);
+
+    /* a governor the HAL doesn't know gets no boostpulse */
+    put(SCALING_GOVERNOR_PATH, "performance\n");
+    m->base.setInteractive(&m->base, 0);
+    m->boostpulse_last_ns = 0;
+    m->base.powerHint(&m->base, POWER_HINT_INTERACTION, NULL);
+    CHECK(m->gov == NULL);
+    CHECK(m->boostpulse_fd < 0);
+
+    nftw(root, remove_node, 8, FTW_DEPTH | FTW_PHYS);
+
+    printf("power_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
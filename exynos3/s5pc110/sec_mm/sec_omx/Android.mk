@@ -10,6 +10,7 @@ SEC_OMX_INC := $(SEC_OMX_TOP)/sec_omx_include/
 SEC_OMX_COMPONENT := $(SEC_OMX_TOP)/sec_omx_component
 
 include $(SEC_OMX_TOP)/sec_osal/Android.mk
+include $(SEC_OMX_TOP)/sec_osal/test/Android.mk
 include $(SEC_OMX_TOP)/sec_omx_core/Android.mk
 
 include $(SEC_CODECS)/Android.mk
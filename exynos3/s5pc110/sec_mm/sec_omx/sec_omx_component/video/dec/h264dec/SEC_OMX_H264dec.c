@@ -36,6 +36,7 @@
 #include "SEC_OMX_H264dec.h"
 #include "SsbSipMfcApi.h"
 #include "color_space_convertor.h"
+#include "SEC_OSAL_TvOut.h"
 
 #undef  SEC_LOG_TAG
 #define SEC_LOG_TAG    "SEC_H264_DEC"
@@ -699,11 +700,11 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_GetExtensionIndex(
         ret = OMX_ErrorNone;
 #ifdef USE_ANDROID_EXTENSION
     } else if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_PARAM_ENABLE_ANB) == 0) {
-#ifndef USE_HWDECODING_TVOUT
+#if !defined(USE_HWDECODING_TVOUT) && !defined(BOARD_USES_HDMI)
             if (isTvOutEnabled()) {
-                // Samsung normally pushes HW-decoded frames to the TV Out driver
-                // but it's hard for us to do that without source, so return an error
-                // and let Android fallback to software decoding
+                // Without the hdmi HAL nothing pushes the HW-decoded frames to
+                // the TV Out driver, so return an error and let Android fallback
+                // to software decoding
                 ret = OMX_ErrorInsufficientResources;
                 goto EXIT;
             }
@@ -835,6 +836,9 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pH264Dec->NBDecThread.oneFrameSize = 0;
     SEC_OSAL_SemaphoreCreate(&(pH264Dec->NBDecThread.hDecFrameStart));
     SEC_OSAL_SemaphoreCreate(&(pH264Dec->NBDecThread.hDecFrameEnd));
+#ifdef BOARD_USES_HDMI
+    SEC_OSAL_TvOutCreate(&pH264Dec->hTvOut);
+#endif
     if (OMX_ErrorNone == SEC_OSAL_ThreadCreate(&pH264Dec->NBDecThread.hNBDecodeThread,
                                                 SEC_MFC_DecodeThread,
                                                 pOMXComponent)) {
@@ -890,6 +894,11 @@ OMX_ERRORTYPE SEC_MFC_H264Dec_Terminate(OMX_COMPONENTTYPE *pOMXComponent)
         pH264Dec->NBDecThread.hDecFrameStart = NULL;
     }
 
+    if (pH264Dec->hTvOut != NULL) {
+        SEC_OSAL_TvOutTerminate(pH264Dec->hTvOut);
+        pH264Dec->hTvOut = NULL;
+    }
+
     if (hMFCHandle != NULL) {
         SsbSipMfcDecClose(hMFCHandle);
         hMFCHandle = pH264Dec->hMFCH264Handle.hMFCHandle = NULL;
@@ -1250,6 +1259,15 @@ OMX_ERRORTYPE SEC_MFC_H264_Decode(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX_DATA
 #ifdef USE_ANDROID_EXTENSION
         if (pSECOutputPort->bUseAndroidNativeBuffer == OMX_TRUE)
             putVADDRtoANB(pOutputData->dataBuffer);
+#ifdef BOARD_USES_HDMI
+        /* the ANB copy is for the panel, TV-out reads the MFC buffer itself */
+        if ((pH264Dec->hTvOut != NULL) &&
+            (pH264Dec->hMFCH264Handle.bThumbnailMode == OMX_FALSE) &&
+            (pSECOutputPort->bUseAndroidNativeBuffer == OMX_TRUE))
+            SEC_OSAL_TvOutQueue(pH264Dec->hTvOut,
+                                outputInfo.img_width, outputInfo.img_height,
+                                outputInfo.YPhyAddr, outputInfo.CPhyAddr);
+#endif
 #endif
     } else {
         pOutputData->dataLen = 0;
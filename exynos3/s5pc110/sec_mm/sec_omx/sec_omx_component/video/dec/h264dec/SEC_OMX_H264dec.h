@@ -57,6 +57,9 @@ typedef struct _SEC_H264DEC_HANDLE
     OMX_BOOL bFirstFrame;
     MFC_DEC_INPUT_BUFFER MFCDecInputBuffer[MFC_INPUT_BUFFER_NUM_MAX];
     OMX_U32  indexInputBuffer;
+
+    /* TV-out mirroring of the decoded frames */
+    OMX_HANDLETYPE hTvOut;
 } SEC_H264DEC_HANDLE;
 
 #ifdef __cplusplus
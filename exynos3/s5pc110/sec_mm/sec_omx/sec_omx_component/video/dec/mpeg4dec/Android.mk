@@ -12,6 +12,10 @@ LOCAL_MODULE := libOMX.SEC.M4V.Decoder
 
 LOCAL_CFLAGS :=
 
+ifeq ($(BOARD_USES_HDMI),true)
+LOCAL_CFLAGS += -DBOARD_USES_HDMI
+endif
+
 LOCAL_ARM_MODE := arm
 
 LOCAL_STATIC_LIBRARIES := libSEC_OMX_Vdec libsecosal libsecbasecomponent \
@@ -36,6 +36,7 @@
 #include "SEC_OMX_Mpeg4dec.h"
 #include "SsbSipMfcApi.h"
 #include "color_space_convertor.h"
+#include "SEC_OSAL_TvOut.h"
 
 #undef  SEC_LOG_TAG
 #define SEC_LOG_TAG    "SEC_MPEG4_DEC"
@@ -836,11 +837,11 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4Dec_GetExtensionIndex(
         ret = OMX_ErrorNone;
 #ifdef USE_ANDROID_EXTENSION
     } else if (SEC_OSAL_Strcmp(cParameterName, SEC_INDEX_PARAM_ENABLE_ANB) == 0) {
-#ifndef USE_HWDECODING_TVOUT
+#if !defined(USE_HWDECODING_TVOUT) && !defined(BOARD_USES_HDMI)
             if (isTvOutEnabled()) {
-                // Samsung normally pushes HW-decoded frames to the TV Out driver
-                // but it's hard for us to do that without source, so return an error
-                // and let Android fallback to software decoding
+                // Without the hdmi HAL nothing pushes the HW-decoded frames to
+                // the TV Out driver, so return an error and let Android fallback
+                // to software decoding
                 ret = OMX_ErrorInsufficientResources;
                 goto EXIT;
             }
@@ -996,6 +997,9 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4Dec_Init(OMX_COMPONENTTYPE *pOMXComponent)
     pMpeg4Dec->NBDecThread.oneFrameSize = 0;
     SEC_OSAL_SemaphoreCreate(&(pMpeg4Dec->NBDecThread.hDecFrameStart));
     SEC_OSAL_SemaphoreCreate(&(pMpeg4Dec->NBDecThread.hDecFrameEnd));
+#ifdef BOARD_USES_HDMI
+    SEC_OSAL_TvOutCreate(&pMpeg4Dec->hTvOut);
+#endif
     if (OMX_ErrorNone == SEC_OSAL_ThreadCreate(&pMpeg4Dec->NBDecThread.hNBDecodeThread,
                                                 SEC_MFC_DecodeThread,
                                                 pOMXComponent)) {
@@ -1053,6 +1057,11 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4Dec_Terminate(OMX_COMPONENTTYPE *pOMXComponent)
         pMpeg4Dec->NBDecThread.hDecFrameStart = NULL;
     }
 
+    if (pMpeg4Dec->hTvOut != NULL) {
+        SEC_OSAL_TvOutTerminate(pMpeg4Dec->hTvOut);
+        pMpeg4Dec->hTvOut = NULL;
+    }
+
     if (hMFCHandle != NULL) {
         SsbSipMfcDecClose(hMFCHandle);
         pMpeg4Dec->hMFCMpeg4Handle.hMFCHandle = NULL;
@@ -1395,6 +1404,15 @@ OMX_ERRORTYPE SEC_MFC_Mpeg4_Decode(OMX_COMPONENTTYPE *pOMXComponent, SEC_OMX_DAT
 #ifdef USE_ANDROID_EXTENSION
         if (pSECOutputPort->bUseAndroidNativeBuffer == OMX_TRUE)
             putVADDRtoANB(pOutputData->dataBuffer);
+#ifdef BOARD_USES_HDMI
+        /* the ANB copy is for the panel, TV-out reads the MFC buffer itself */
+        if ((pMpeg4Dec->hTvOut != NULL) &&
+            (pMpeg4Dec->hMFCMpeg4Handle.bThumbnailMode == OMX_FALSE) &&
+            (pSECOutputPort->bUseAndroidNativeBuffer == OMX_TRUE))
+            SEC_OSAL_TvOutQueue(pMpeg4Dec->hTvOut,
+                                outputInfo.img_width, outputInfo.img_height,
+                                outputInfo.YPhyAddr, outputInfo.CPhyAddr);
+#endif
 #endif
     } else {
         pOutputData->dataLen = 0;
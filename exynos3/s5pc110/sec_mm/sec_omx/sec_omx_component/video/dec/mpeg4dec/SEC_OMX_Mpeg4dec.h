@@ -82,6 +82,9 @@ typedef struct _SEC_MPEG4_HANDLE
     OMX_BOOL bFirstFrame;
     MFC_DEC_INPUT_BUFFER MFCDecInputBuffer[MFC_INPUT_BUFFER_NUM_MAX];
     OMX_U32  indexInputBuffer;
+
+    /* TV-out mirroring of the decoded frames */
+    OMX_HANDLETYPE hTvOut;
 } SEC_MPEG4_HANDLE;
 
 #ifdef __cplusplus
@@ -13,6 +13,7 @@ LOCAL_SRC_FILES := \
 	SEC_OSAL_Semaphore.c \
 	SEC_OSAL_Library.c \
 	SEC_OSAL_Log.c \
+	SEC_OSAL_TvOut.c \
 	SEC_OSAL_Buffer.cpp
 
 
@@ -0,0 +1,171 @@
+/*
+ *
+ * Copyright 2010 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        SEC_OSAL_TvOut.c
+ * @brief       Hands MFC decoded NV12T frames to the hdmi HAL video layer
+ * @version     1.0
+ * @history
+ *   2012.9.20 : Create
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <hardware/hardware.h>
+#include <hardware/hdmi.h>
+#include <sec_format.h>
+
+#include "SEC_OSAL_Memory.h"
+#include "SEC_OSAL_TvOut.h"
+#include "SEC_OSAL_Buffer.h"
+
+#undef SEC_LOG_TAG
+#define SEC_LOG_TAG    "SEC_LOG_TVOUT"
+#define SEC_LOG_OFF
+#include "SEC_OSAL_Log.h"
+
+typedef struct _SEC_OSAL_TVOUT_HANDLE
+{
+    struct hdmi_device_t *hdmi;
+    OMX_U32 nProbe;     /* frames left before tvouthack is checked again */
+    OMX_U32 nFrames;
+    OMX_U32 nErrors;
+    OMX_BOOL bBusy;     /* the composer owns the TV-out */
+} SEC_OSAL_TVOUT_HANDLE;
+
+/*
+ * The HDMI link belongs to tvouthack, so the device is only used to blit:
+ * connect() and disconnect() are never called from here. Closing it stops
+ * the FIMC stream of this device and nothing else.
+ */
+static void TvOutClose(SEC_OSAL_TVOUT_HANDLE *pTvOut)
+{
+    if (pTvOut->hdmi == NULL)
+        return;
+
+    pTvOut->hdmi->common.close(&pTvOut->hdmi->common);
+    pTvOut->hdmi = NULL;
+}
+
+/*
+ * The hdmi HAL allows a single device at a time. When the composer holds
+ * it, it mirrors the video layer itself and the open is refused with
+ * -EBUSY; the decoder then only renders to its native buffers.
+ */
+static OMX_ERRORTYPE TvOutOpen(SEC_OSAL_TVOUT_HANDLE *pTvOut)
+{
+    const struct hw_module_t *module = NULL;
+    struct hw_device_t *device = NULL;
+    int ret;
+
+    if (hw_get_module(HDMI_HARDWARE_MODULE_ID, &module) != 0)
+        return OMX_ErrorHardware;
+
+    ret = module->methods->open(module, "hdmi-service", &device);
+    if (ret == -EBUSY) {
+        if (pTvOut->bBusy == OMX_FALSE)
+            SEC_OSAL_Log(SEC_LOG_TRACE, "tvout is driven by the composer");
+        pTvOut->bBusy = OMX_TRUE;
+        return OMX_ErrorResourcesLost;
+    }
+    if (ret != 0)
+        return OMX_ErrorHardware;
+
+    pTvOut->bBusy = OMX_FALSE;
+    pTvOut->hdmi = (struct hdmi_device_t *)device;
+
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SEC_OSAL_TvOutCreate(OMX_HANDLETYPE *tvOutHandle)
+{
+    SEC_OSAL_TVOUT_HANDLE *pTvOut;
+
+    pTvOut = (SEC_OSAL_TVOUT_HANDLE *)SEC_OSAL_Malloc(sizeof(SEC_OSAL_TVOUT_HANDLE));
+    if (!pTvOut)
+        return OMX_ErrorInsufficientResources;
+
+    SEC_OSAL_Memset(pTvOut, 0, sizeof(SEC_OSAL_TVOUT_HANDLE));
+
+    *tvOutHandle = (OMX_HANDLETYPE)pTvOut;
+    return OMX_ErrorNone;
+}
+
+OMX_ERRORTYPE SEC_OSAL_TvOutTerminate(OMX_HANDLETYPE tvOutHandle)
+{
+    SEC_OSAL_TVOUT_HANDLE *pTvOut = (SEC_OSAL_TVOUT_HANDLE *)tvOutHandle;
+
+    if (pTvOut == NULL)
+        return OMX_ErrorBadParameter;
+
+    TvOutClose(pTvOut);
+
+    SEC_OSAL_Log(SEC_LOG_TRACE, "tvout frames %d errors %d",
+                 pTvOut->nFrames, pTvOut->nErrors);
+
+    SEC_OSAL_Free(pTvOut);
+    return OMX_ErrorNone;
+}
+
+/*
+ * The frame is converted by the FIMC before blit() returns, so MFC may reuse
+ * the buffer as soon as this call is done and frames reach the TV in the
+ * order they are queued.
+ */
+OMX_ERRORTYPE SEC_OSAL_TvOutQueue(OMX_HANDLETYPE tvOutHandle,
+                                  OMX_U32 nWidth, OMX_U32 nHeight,
+                                  OMX_PTR pYPhyAddr, OMX_PTR pCPhyAddr)
+{
+    SEC_OSAL_TVOUT_HANDLE *pTvOut = (SEC_OSAL_TVOUT_HANDLE *)tvOutHandle;
+
+    if (pTvOut == NULL)
+        return OMX_ErrorBadParameter;
+
+    /* mirroring can be started and stopped while playing */
+    if (pTvOut->nProbe == 0) {
+        pTvOut->nProbe = TVOUT_PROBE_INTERVAL;
+        if (!isTvOutEnabled())
+            TvOutClose(pTvOut);
+        else if (pTvOut->hdmi == NULL && TvOutOpen(pTvOut) == OMX_ErrorHardware)
+            SEC_OSAL_Log(SEC_LOG_WARNING, "can't open the hdmi device");
+    }
+    pTvOut->nProbe--;
+
+    if (pTvOut->hdmi == NULL)
+        return OMX_ErrorNone;
+
+    if (pTvOut->hdmi->blit(pTvOut->hdmi, nWidth, nHeight,
+                           HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED,
+                           (uint32_t)pYPhyAddr,
+                           (uint32_t)pCPhyAddr,
+                           (uint32_t)pCPhyAddr,
+                           0, 0,
+                           HDMI_MODE_VIDEO, 1) < 0) {
+        SEC_OSAL_Log(SEC_LOG_ERROR, "tvout blit failed, frame %d", pTvOut->nFrames);
+        pTvOut->nErrors++;
+        /* let the next probe reopen the device */
+        TvOutClose(pTvOut);
+        pTvOut->nProbe = TVOUT_PROBE_INTERVAL;
+        return OMX_ErrorHardware;
+    }
+
+    pTvOut->nFrames++;
+    return OMX_ErrorNone;
+}
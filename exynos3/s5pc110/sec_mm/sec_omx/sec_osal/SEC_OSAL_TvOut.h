@@ -0,0 +1,50 @@
+/*
+ *
+ * Copyright 2010 Samsung Electronics S.LSI Co. LTD
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        SEC_OSAL_TvOut.h
+ * @brief       Hands MFC decoded NV12T frames to the hdmi HAL video layer
+ * @version     1.0
+ * @history
+ *   2012.9.20 : Create
+ */
+
+#ifndef SEC_OSAL_TVOUT
+#define SEC_OSAL_TVOUT
+
+#include "OMX_Types.h"
+#include "OMX_Core.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* tvouthack state is checked again every TVOUT_PROBE_INTERVAL frames */
+#define TVOUT_PROBE_INTERVAL    30
+
+OMX_ERRORTYPE SEC_OSAL_TvOutCreate(OMX_HANDLETYPE *tvOutHandle);
+OMX_ERRORTYPE SEC_OSAL_TvOutTerminate(OMX_HANDLETYPE tvOutHandle);
+OMX_ERRORTYPE SEC_OSAL_TvOutQueue(OMX_HANDLETYPE tvOutHandle,
+                                  OMX_U32 nWidth, OMX_U32 nHeight,
+                                  OMX_PTR pYPhyAddr, OMX_PTR pCPhyAddr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+LOCAL_PATH := $(call my-dir)
+
+# --------------------------------------------- #
+#                tvout_test binary
+# --------------------------------------------- #
+
+# hw_get_module() and isTvOutEnabled() are the test's own
+
+TVOUT_TEST_SRC := \
+	tvout_test.c \
+	../SEC_OSAL_TvOut.c \
+	../SEC_OSAL_Memory.c \
+	../SEC_OSAL_Log.c
+
+TVOUT_TEST_INC := $(SEC_OMX_INC)/khronos \
+	$(SEC_OMX_INC)/sec \
+	$(SEC_OMX_TOP)/sec_osal \
+	$(SEC_OMX_TOP)/../../include
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := $(TVOUT_TEST_SRC)
+
+LOCAL_MODULE := sec_osal_tvout_test
+
+LOCAL_SHARED_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(TVOUT_TEST_INC)
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := $(TVOUT_TEST_SRC)
+
+LOCAL_MODULE := sec_osal_tvout_test-host
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+
+LOCAL_C_INCLUDES := $(TVOUT_TEST_INC)
+
+include $(BUILD_HOST_EXECUTABLE)
@@ -0,0 +1,290 @@
+/*
+ *
+ * Copyright 2012 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * @file        tvout_test.c
+ * @brief       SEC_OSAL_TvOut against a fake hdmi module: frame handoff
+ *              and order, the tvouthack probe, recovery after a failed
+ *              blit and a TV-out owned by the composer
+ * @version     1.0
+ * @history
+ *   2012.10.1 : Create
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <hardware/hardware.h>
+#include <hardware/hdmi.h>
+#include <sec_format.h>
+
+#include "SEC_OSAL_TvOut.h"
+
+#define FRAME_WIDTH     1280
+#define FRAME_HEIGHT    720
+#define FRAME_Y_ADDR(i) (0x40000000 + (i) * 0x200000)
+#define FRAME_C_ADDR(i) (0x48000000 + (i) * 0x200000)
+#define FRAMES          100
+#define MAX_BLITS       256
+
+static struct {
+    int enabled;        /* init.svc.tvouthack */
+    int busy;           /* the composer holds the device */
+    int fail_blit;      /* the next blit fails */
+    int opens;
+    int refused;
+    int closes;
+    int open_devices;
+    int connects;
+    int disconnects;
+    int blits;
+    int bad_format;
+    unsigned int y_addr[MAX_BLITS];
+    unsigned int c_addr[MAX_BLITS];
+} fake;
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("tvout_test: %s:%d: %s\n",                       \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+int isTvOutEnabled()
+{
+    return fake.enabled;
+}
+
+static int fake_connect(struct hdmi_device_t *dev)
+{
+    fake.connects++;
+    return 0;
+}
+
+static int fake_disconnect(struct hdmi_device_t *dev)
+{
+    fake.disconnects++;
+    return 0;
+}
+
+static int fake_clear(struct hdmi_device_t *dev, int hdmiLayer)
+{
+    return 0;
+}
+
+static int fake_blit(struct hdmi_device_t *dev, int srcW, int srcH, int srcColorFormat,
+                     uint32_t srcYAddr, uint32_t srcCbAddr, uint32_t srcCrAddr,
+                     int dstX, int dstY, int layer, int num_of_hwc_layer)
+{
+    if (fake.fail_blit) {
+        fake.fail_blit = 0;
+        return -1;
+    }
+
+    if (srcColorFormat != HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP_TILED ||
+        layer != HDMI_MODE_VIDEO ||
+        srcW != FRAME_WIDTH || srcH != FRAME_HEIGHT)
+        fake.bad_format++;
+
+    if (fake.blits < MAX_BLITS) {
+        fake.y_addr[fake.blits] = srcYAddr;
+        fake.c_addr[fake.blits] = srcCbAddr;
+    }
+    fake.blits++;
+
+    return 0;
+}
+
+static int fake_close(struct hw_device_t *device)
+{
+    fake.closes++;
+    fake.open_devices--;
+    return 0;
+}
+
+static struct hdmi_device_t fake_device;
+
+static int fake_open(const struct hw_module_t *module, const char *name,
+                     struct hw_device_t **device)
+{
+    /* the hdmi HAL refuses a second device */
+    if (fake.busy || fake.open_devices > 0) {
+        fake.refused++;
+        return -EBUSY;
+    }
+
+    fake.opens++;
+    fake.open_devices++;
+    memset(&fake_device, 0, sizeof(fake_device));
+    fake_device.common.close = fake_close;
+    fake_device.connect = fake_connect;
+    fake_device.disconnect = fake_disconnect;
+    fake_device.clear = fake_clear;
+    fake_device.blit = fake_blit;
+    *device = &fake_device.common;
+
+    return 0;
+}
+
+static struct hw_module_methods_t fake_methods = {
+    .open = fake_open,
+};
+
+static struct hw_module_t fake_module = {
+    .tag = HARDWARE_MODULE_TAG,
+    .id = HDMI_HARDWARE_MODULE_ID,
+    .methods = &fake_methods,
+};
+
+int hw_get_module(const char *id, const struct hw_module_t **module)
+{
+    if (strcmp(id, HDMI_HARDWARE_MODULE_ID) != 0)
+        return -ENOENT;
+
+    *module = &fake_module;
+    return 0;
+}
+
+static void queueFrames(OMX_HANDLETYPE hTvOut, int first, int count)
+{
+    int i;
+
+    for (i = first; i < first + count; i++)
+        SEC_OSAL_TvOutQueue(hTvOut, FRAME_WIDTH, FRAME_HEIGHT,
+                            (OMX_PTR)FRAME_Y_ADDR(i), (OMX_PTR)FRAME_C_ADDR(i));
+}
+
+/* every decoded frame reaches the TV once, in decode order */
+static void testHandoff(void)
+{
+    OMX_HANDLETYPE hTvOut;
+    int i, ordered = 1;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.enabled = 1;
+    CHECK(SEC_OSAL_TvOutCreate(&hTvOut) == OMX_ErrorNone);
+
+    queueFrames(hTvOut, 0, FRAMES);
+    CHECK(fake.opens == 1);
+    CHECK(fake.blits == FRAMES);
+    for (i = 0; i < FRAMES; i++) {
+        if (fake.y_addr[i] != (unsigned int)FRAME_Y_ADDR(i) ||
+            fake.c_addr[i] != (unsigned int)FRAME_C_ADDR(i))
+            ordered = 0;
+    }
+    CHECK(ordered);
+    CHECK(fake.bad_format == 0);
+
+    CHECK(SEC_OSAL_TvOutTerminate(hTvOut) == OMX_ErrorNone);
+    CHECK(fake.open_devices == 0);
+
+    /* the HDMI link is tvouthack's, never touched from here */
+    CHECK(fake.connects == 0);
+    CHECK(fake.disconnects == 0);
+}
+
+/* stopping tvouthack closes the device by the next probe */
+static void testMirroringStops(void)
+{
+    OMX_HANDLETYPE hTvOut;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.enabled = 1;
+    CHECK(SEC_OSAL_TvOutCreate(&hTvOut) == OMX_ErrorNone);
+
+    queueFrames(hTvOut, 0, 1);
+    fake.enabled = 0;
+    queueFrames(hTvOut, 1, TVOUT_PROBE_INTERVAL);
+    CHECK(fake.open_devices == 0);
+    CHECK(fake.blits == TVOUT_PROBE_INTERVAL);
+
+    queueFrames(hTvOut, 1 + TVOUT_PROBE_INTERVAL, FRAMES);
+    CHECK(fake.blits == TVOUT_PROBE_INTERVAL);
+    CHECK(fake.opens == 1);
+
+    CHECK(SEC_OSAL_TvOutTerminate(hTvOut) == OMX_ErrorNone);
+    CHECK(fake.disconnects == 0);
+}
+
+/* a failed blit drops the device, the next probe opens it again */
+static void testBlitError(void)
+{
+    OMX_HANDLETYPE hTvOut;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.enabled = 1;
+    CHECK(SEC_OSAL_TvOutCreate(&hTvOut) == OMX_ErrorNone);
+
+    queueFrames(hTvOut, 0, 5);
+    fake.fail_blit = 1;
+    CHECK(SEC_OSAL_TvOutQueue(hTvOut, FRAME_WIDTH, FRAME_HEIGHT,
+                              (OMX_PTR)FRAME_Y_ADDR(5),
+                              (OMX_PTR)FRAME_C_ADDR(5)) == OMX_ErrorHardware);
+    CHECK(fake.open_devices == 0);
+
+    queueFrames(hTvOut, 6, TVOUT_PROBE_INTERVAL + 1);
+    CHECK(fake.opens == 2);
+    CHECK(fake.open_devices == 1);
+    CHECK(fake.blits == 5 + 1);
+    CHECK(fake.y_addr[5] == (unsigned int)FRAME_Y_ADDR(6 + TVOUT_PROBE_INTERVAL));
+
+    CHECK(SEC_OSAL_TvOutTerminate(hTvOut) == OMX_ErrorNone);
+    CHECK(fake.open_devices == 0);
+    CHECK(fake.connects == 0 && fake.disconnects == 0);
+}
+
+/* the composer mirrors the video layer itself, the decoder stays out */
+static void testComposerOwnsTvOut(void)
+{
+    OMX_HANDLETYPE hTvOut;
+
+    memset(&fake, 0, sizeof(fake));
+    fake.enabled = 1;
+    fake.busy = 1;
+    CHECK(SEC_OSAL_TvOutCreate(&hTvOut) == OMX_ErrorNone);
+
+    queueFrames(hTvOut, 0, TVOUT_PROBE_INTERVAL * 3);
+    CHECK(fake.opens == 0);
+    CHECK(fake.blits == 0);
+    CHECK(fake.refused == 3);
+
+    /* the composer lets go, the decoder takes over at the next probe */
+    fake.busy = 0;
+    queueFrames(hTvOut, 0, TVOUT_PROBE_INTERVAL);
+    CHECK(fake.opens == 1);
+    CHECK(fake.blits == TVOUT_PROBE_INTERVAL);
+
+    CHECK(SEC_OSAL_TvOutTerminate(hTvOut) == OMX_ErrorNone);
+    CHECK(fake.open_devices == 0);
+}
+
+int main(int argc, char **argv)
+{
+    testHandoff();
+    testMirroringStops();
+    testBlitError();
+    testComposerOwnsTvOut();
+
+    printf("tvout_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
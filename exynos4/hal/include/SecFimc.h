@@ -66,6 +66,7 @@ extern "C" {
 #define PFX_NODE_FIMC        "/dev/video"
 #define MAX_DST_BUFFERS     (3)
 #define MAX_SRC_BUFFERS     (1)
+#define MAX_INFLIGHT_BUFS   (3)
 #define MAX_PLANES          (3)
 
 #ifdef __cplusplus
@@ -90,7 +91,33 @@ public:
         MODE_MAX,
     };
 
+    //! draw() timing, a draw is counted from entry to its return
+    struct DrawStats {
+        unsigned int draws;
+        unsigned int streamOns;     //!< STREAMON issued, one per reconfigure
+        unsigned int flushes;
+        nsecs_t      lastNs;
+        nsecs_t      maxNs;
+        nsecs_t      totalNs;
+        nsecs_t      flushNs;
+    };
+
 private:
+    //! Last accepted set{Src,Dst}Params() request and its adjusted crop size
+    struct ParamCache {
+        bool         valid;
+        unsigned int width;
+        unsigned int height;
+        unsigned int cropX;
+        unsigned int cropY;
+        unsigned int cropWidth;
+        unsigned int cropHeight;
+        int          colorFormat;
+        int          rotVal;
+        unsigned int fimcWidth;
+        unsigned int fimcHeight;
+    };
+
     bool                        mFlagCreate;
     int                         mDev;
     int                         mFimcMode;
@@ -108,6 +135,10 @@ private:
     bool                        mFlagSetSrcParam;
     bool                        mFlagSetDstParam;
     bool                        mFlagStreamOn;
+    int                         mInFlightMax;
+    int                         mInFlight;
+    int                         mSrcQueueIndex;
+    DrawStats                   mDrawStats;
 
     s5p_fimc_t                  mS5pFimc;
     struct v4l2_capability      mFimcCap;
@@ -115,6 +146,15 @@ private:
     SecBuffer                   mSrcBuffer;
     SecBuffer                   mDstBuffer[MAX_DST_BUFFERS];
 
+    ParamCache                  mSrcReq;
+    ParamCache                  mDstReq;
+
+    //! Destination state as last written to the driver
+    bool                        mFlagDstProg;
+    int                         mDstProgRotVal;
+    unsigned int                mDstProgAddr;
+    s5p_fimc_img_info           mDstProg;
+
 public:
     SecFimc();
     virtual ~SecFimc();
@@ -164,9 +204,45 @@ public:
     virtual bool setColorKey(bool enable = true, int colorKey = 0xff);
 
     virtual bool draw(int src_index, int dst_index);
+    virtual bool drawBatch(SecBuffer *srcBuf, SecBuffer *dstBuf, int count);
+
+    /*
+     * Without BOARD_USE_V4L2 the stream stays on between draws and is only
+     * stopped when a src, dst, rotation or blending change needs it.
+     * setInFlight(n) lets draw() return with up to n - 1 conversions still
+     * queued, their sources must stay valid until flush() or later draws
+     * complete them.
+     *
+     * Both are hooks for callers that can keep their sources alive, no
+     * user in this tree raises the depth: HardwareConverter and SecHdmi
+     * read the destination right after draw() and keep the default of 1,
+     * where flush() has nothing to wait for. getDrawStats() reports what
+     * destroy() logs under DEBUG_LIB_FIMC. libfimc/test/test2.cpp covers
+     * all of them against a fake FIMC node.
+     */
+    virtual bool setInFlight(int depth);
+    virtual bool flush(void);
+    void getDrawStats(DrawStats *stats);
+    void resetDrawStats(void);
 
 private:
     bool m_streamOn(void);
+    bool m_streamOff(void);
+    void m_resetCache(void);
+    bool m_checkCache(ParamCache *cache,
+                      unsigned int width, unsigned int height,
+                      unsigned int cropX, unsigned int cropY,
+                      unsigned int *cropWidth, unsigned int *cropHeight,
+                      int colorFormat, int rotVal,
+                      bool forceChange);
+    void m_storeCache(ParamCache *cache,
+                      unsigned int width, unsigned int height,
+                      unsigned int cropX, unsigned int cropY,
+                      unsigned int cropWidth, unsigned int cropHeight,
+                      int colorFormat, int rotVal,
+                      unsigned int fimcWidth, unsigned int fimcHeight);
+    bool m_dstChanged(void);
+    bool m_setDstFmt(void);
     bool m_checkSrcSize(unsigned int width, unsigned int height,
                         unsigned int cropX, unsigned int cropY,
                         unsigned int *cropWidth, unsigned int *cropHeight,
@@ -1,6 +1,8 @@
 #ifndef __JPEG_API_H__
 #define __JPEG_API_H__
 
+#include <sys/types.h>
+
 #define JPEG_DRIVER_NAME        "/dev/s5p-jpeg"
 
 #define MAX_JPEG_WIDTH          3264
@@ -92,14 +94,51 @@ struct jpeg_args{
     struct jpeg_enc_param    *enc_param;
 };
 
+struct jpeg_session;
+
 struct jpeg_lib {
     int  jpeg_fd;
     struct jpeg_args args;
+    enum jpeg_test_mode mode;
+    struct jpeg_session *session;
+};
+
+/* Driver entry points, replaceable to run the library against a fake device */
+struct jpeg_dev_ops {
+    int   (*open)(const char *name, int flags);
+    int   (*close)(int fd);
+    long  (*ioctl)(int fd, unsigned long req, void *arg);
+    void *(*mmap)(void *addr, size_t length, int prot, int flags, int fd, off_t offset);
+    int   (*munmap)(void *addr, size_t length);
 };
 
 #ifdef __cplusplus
 extern "C" {
 #endif
+/*
+ * Handle based API. The device is opened and mapped by the first handle
+ * and closed with the last one. A handle owns the JPEG buffers from its
+ * first buffer, param or exe call until api_jpeg_done() or
+ * api_jpeg_close(); other handles on the same session wait meanwhile.
+ * With JPEG_DRIVER_MULTI_INSTANCE encode and decode use separate
+ * sessions and run concurrently.
+ */
+struct jpeg_lib *api_jpeg_open(enum jpeg_test_mode mode);
+int api_jpeg_close(struct jpeg_lib *jpeg);
+void api_jpeg_done(struct jpeg_lib *jpeg);
+void *api_jpeg_get_in_buf(struct jpeg_lib *jpeg, unsigned int size);
+void *api_jpeg_get_out_buf(struct jpeg_lib *jpeg);
+void api_jpeg_set_dec_param(struct jpeg_lib *jpeg, struct jpeg_dec_param *param);
+void api_jpeg_set_enc_param(struct jpeg_lib *jpeg, struct jpeg_enc_param *param);
+enum jpeg_ret_type api_jpeg_dec_exe(struct jpeg_lib *jpeg, struct jpeg_dec_param *dec_param);
+enum jpeg_ret_type api_jpeg_enc_exe(struct jpeg_lib *jpeg, struct jpeg_enc_param *enc_param);
+int api_jpeg_set_device(const char *name, const struct jpeg_dev_ops *ops);
+
+/*
+ * Single instance API, one encoder and one decoder per process. The
+ * device stays open for JPEG_LEGACY_IDLE_MS after a deinit, for the next
+ * init to reuse.
+ */
 int api_jpeg_decode_init();
 int api_jpeg_encode_init();
 int api_jpeg_decode_deinit(int dev_fd);
@@ -52,4 +52,6 @@ LOCAL_MODULE_TAGS := eng
 LOCAL_MODULE := libfimc
 include $(BUILD_SHARED_LIBRARY)
 
+include $(call all-makefiles-under,$(LOCAL_PATH))
+
 endif
@@ -529,6 +529,9 @@ SecFimc::SecFimc()
     mHwVersion = 0;
     mGlobalAlpha = 0x0;
     mFlagStreamOn = false;
+    mInFlightMax = 1;
+    mInFlight = 0;
+    mSrcQueueIndex = 0;
     mFlagSetSrcParam = false;
     mFlagSetDstParam = false;
     mFlagGlobalAlpha = false;
@@ -538,6 +541,9 @@ SecFimc::SecFimc()
     mFd = 0;
     mDev = 0;
     mColorKey = 0x0;
+
+    memset(&mDrawStats, 0, sizeof(mDrawStats));
+    m_resetCache();
 }
 
 SecFimc::~SecFimc()
@@ -677,6 +683,7 @@ bool SecFimc::create(enum DEV dev, enum MODE mode, int numOfBuf)
     }
 #endif
 
+    m_resetCache();
     mFlagCreate = true;
 
     return true;
@@ -698,20 +705,19 @@ bool SecFimc::destroy()
         return false;
     }
 
-    if (mFlagStreamOn == true) {
-        if (fimc_v4l2_stream_off(mFd, V4L2_BUF_TYPE_SRC) < 0) {
-            ALOGE("%s::fimc_v4l2_stream_off() failed", __func__);
-            return false;
-        }
-#ifdef BOARD_USE_V4L2
-        if (fimc_v4l2_stream_off(mFd, V4L2_BUF_TYPE_DST) < 0) {
-            ALOGE("%s::fimc_v4l2_stream_off() failed", __func__);
-            return false;
-        }
-#endif
-        mFlagStreamOn = false;
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
     }
 
+#ifdef DEBUG_LIB_FIMC
+    if (mDrawStats.draws != 0)
+        ALOGD("%s::draws %u, stream on %u, avg %lld us, max %lld us", __func__,
+              mDrawStats.draws, mDrawStats.streamOns,
+              mDrawStats.totalNs / mDrawStats.draws / 1000,
+              mDrawStats.maxNs / 1000);
+#endif
+
     if (fimc_v4l2_clr_buf(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
         ALOGE("%s::fimc_v4l2_clr_buf()[src] failed", __func__);
         return false;
@@ -732,6 +738,11 @@ bool SecFimc::destroy()
         close(mFd);
     mFd = 0;
 
+    m_resetCache();
+    mFlagSetSrcParam = false;
+    mFlagSetDstParam = false;
+    memset(&(mS5pFimc.params), 0, sizeof(s5p_fimc_params_t));
+
     mFlagCreate = false;
 
     return true;
@@ -782,6 +793,10 @@ bool SecFimc::setSrcParams(unsigned int width, unsigned int height,
         return false;
     }
 
+    if (m_checkCache(&mSrcReq, width, height, cropX, cropY,
+                     cropWidth, cropHeight, colorFormat, 0, forceChange) == true)
+        return true;
+
     int v4l2ColorFormat = HAL_PIXEL_FORMAT_2_V4L2_PIX(colorFormat);
     if (v4l2ColorFormat < 0) {
         ALOGE("%s::not supported color format", __func__);
@@ -818,8 +833,16 @@ bool SecFimc::setSrcParams(unsigned int width, unsigned int height,
         && (params->src.start_y == cropY)
         && (params->src.width == fimcWidth)
         && (params->src.height == fimcHeight)
-        && (params->src.color_space == (unsigned int)v4l2ColorFormat))
+        && (params->src.color_space == (unsigned int)v4l2ColorFormat)) {
+        m_storeCache(&mSrcReq, width, height, cropX, cropY,
+                     *cropWidth, *cropHeight, colorFormat, 0,
+                     fimcWidth, fimcHeight);
+        *cropWidth  = fimcWidth;
+        *cropHeight = fimcHeight;
         return true;
+    }
+
+    mSrcReq.valid = false;
 
     params->src.full_width  = width;
     params->src.full_height = height;
@@ -830,6 +853,13 @@ bool SecFimc::setSrcParams(unsigned int width, unsigned int height,
     params->src.color_space = v4l2ColorFormat;
     src_planes = (src_planes == -1) ? 1 : src_planes;
 
+#ifndef BOARD_USE_V4L2
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+#endif
+
     if (mFlagSetSrcParam == true) {
         if (fimc_v4l2_clr_buf(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
             ALOGE("%s::fimc_v4l2_clr_buf_src() failed", __func__);
@@ -842,11 +872,15 @@ bool SecFimc::setSrcParams(unsigned int width, unsigned int height,
         return false;
     }
 
-    if (fimc_v4l2_req_buf(mFd, 1, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
+    if (fimc_v4l2_req_buf(mFd, mInFlightMax, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
         ALOGE("%s::fimc_v4l2_req_buf()[src] failed", __func__);
         return false;
     }
 
+    m_storeCache(&mSrcReq, width, height, cropX, cropY,
+                 *cropWidth, *cropHeight, colorFormat, 0,
+                 fimcWidth, fimcHeight);
+
     *cropWidth  = fimcWidth;
     *cropHeight = fimcHeight;
 
@@ -970,6 +1004,11 @@ bool SecFimc::setDstParams(unsigned int width, unsigned int height,
         return false;
     }
 
+    if (   (mFlagDstProg == true)
+        && (m_checkCache(&mDstReq, width, height, cropX, cropY,
+                         cropWidth, cropHeight, colorFormat, mRotVal, forceChange) == true))
+        return true;
+
     int v4l2ColorFormat = HAL_PIXEL_FORMAT_2_V4L2_PIX(colorFormat);
     if (v4l2ColorFormat < 0) {
         ALOGE("%s::not supported color format", __func__);
@@ -1037,38 +1076,42 @@ bool SecFimc::setDstParams(unsigned int width, unsigned int height,
     params->dst.color_space = v4l2ColorFormat;
     dst_planes = (dst_planes == -1) ? 1 : dst_planes;
 
+    mDstReq.valid = false;
+
+    /* the same window may be reached through a different request */
+    if (mFlagSetDstParam == false || m_dstChanged() == true) {
 #ifdef BOARD_USE_V4L2
-    if (mFlagSetDstParam == true) {
-        if (fimc_v4l2_clr_buf(mFd, V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST) < 0) {
-            ALOGE("%s::fimc_v4l2_clr_buf_dst() failed", __func__);
-            return false;
+        if (mFlagSetDstParam == true) {
+            if (fimc_v4l2_clr_buf(mFd, V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST) < 0) {
+                ALOGE("%s::fimc_v4l2_clr_buf_dst() failed", __func__);
+                return false;
+            }
         }
-    }
 #endif
 
-    if (fimc_v4l2_s_ctrl(mFd, V4L2_ROTATE, mRotVal) < 0) {
-        ALOGE("%s::fimc_v4l2_s_ctrl(V4L2_ROTATE)", __func__);
-        return false;
-    }
-
-    if (fimc_v4l2_set_fmt(mFd, V4L2_BUF_TYPE_DST, V4L2_FIELD_ANY, &(params->dst), (unsigned int)mS5pFimc.out_buf.phys_addr) < 0) {
-        ALOGE("%s::fimc_v4l2_set_fmt()[dst] failed", __func__);
-        return false;
-    }
+        if (m_setDstFmt() == false) {
+            ALOGE("%s::m_setDstFmt() failed", __func__);
+            return false;
+        }
 
 #ifdef BOARD_USE_V4L2
-    if (fimc_v4l2_req_buf(mFd, mNumOfBuf, V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST) < 0) {
-        ALOGE("%s::fimc_v4l2_req_buf()[dst] failed", __func__);
-        return false;
-    }
+        if (fimc_v4l2_req_buf(mFd, mNumOfBuf, V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST) < 0) {
+            ALOGE("%s::fimc_v4l2_req_buf()[dst] failed", __func__);
+            return false;
+        }
 
-    for (int i = 0; i < mNumOfBuf; i++) {
-        if (fimc_v4l2_query_buf(mFd, &(mDstBuffer[i]),
-                           V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST, i, dst_planes) < 0) {
-            ALOGE("%s::fimc_v4l2_query_buf() failed", __func__);
+        for (int i = 0; i < mNumOfBuf; i++) {
+            if (fimc_v4l2_query_buf(mFd, &(mDstBuffer[i]),
+                               V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST, i, dst_planes) < 0) {
+                ALOGE("%s::fimc_v4l2_query_buf() failed", __func__);
+            }
         }
-    }
 #endif
+    }
+
+    m_storeCache(&mDstReq, width, height, cropX, cropY,
+                 *cropWidth, *cropHeight, colorFormat, mRotVal,
+                 fimcWidth, fimcHeight);
 
     *cropWidth  = fimcWidth;
     *cropHeight = fimcHeight;
@@ -1175,13 +1218,8 @@ bool SecFimc::setDstAddr(unsigned int physYAddr, unsigned int physCbAddr, unsign
         && ((unsigned int)mS5pFimc.out_buf.phys_addr != mDstBuffer[0].phys.p))
         mS5pFimc.use_ext_out_mem = 1;
 
-    if (fimc_v4l2_s_ctrl(mFd, V4L2_ROTATE, mRotVal) < 0) {
-        ALOGE("%s::fimc_v4l2_s_ctrl(V4L2_ROTATE)", __func__);
-        return false;
-    }
-
-    if (fimc_v4l2_set_fmt(mFd, V4L2_BUF_TYPE_DST, V4L2_FIELD_ANY, &(params->dst), (unsigned int)mS5pFimc.out_buf.phys_addr) < 0) {
-        ALOGE("%s::fimc_v4l2_set_fmt()[dst] failed", __func__);
+    if (m_setDstFmt() == false) {
+        ALOGE("%s::m_setDstFmt() failed", __func__);
         return false;
     }
 #endif
@@ -1198,9 +1236,21 @@ bool SecFimc::setRotVal(unsigned int rotVal)
         return false;
     }
 
-    if (fimc_v4l2_s_ctrl(mFd, V4L2_ROTATE, rotVal) < 0) {
-        ALOGE("%s::fimc_v4l2_s_ctrl(V4L2_ROTATE) failed", __func__);
-        return false;
+    if (mDstProgRotVal != (int)rotVal) {
+#ifndef BOARD_USE_V4L2
+        if (m_streamOff() == false) {
+            ALOGE("%s::m_streamOff() failed", __func__);
+            return false;
+        }
+#endif
+        if (fimc_v4l2_s_ctrl(mFd, V4L2_ROTATE, rotVal) < 0) {
+            ALOGE("%s::fimc_v4l2_s_ctrl(V4L2_ROTATE) failed", __func__);
+            mDstProgRotVal = -1;
+            return false;
+        }
+        mDstProgRotVal = rotVal;
+        /* the dst window has to be written again under the new rotation */
+        mFlagDstProg = false;
     }
 
     mRotVal = rotVal;
@@ -1217,13 +1267,20 @@ bool SecFimc::setGlobalAlpha(bool enable, int alpha)
         return false;
     }
 
+    if (mFlagGlobalAlpha == enable && mGlobalAlpha == alpha)
+        return true;
+
+#ifdef BOARD_USE_V4L2
     if (mFlagStreamOn == true) {
         ALOGE("%s::mFlagStreamOn == true", __func__);
         return false;
     }
-
-    if (mFlagGlobalAlpha == enable && mGlobalAlpha == alpha)
-        return true;
+#else
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+#endif
 
     memset(&fbuf, 0, sizeof(fbuf));
 
@@ -1272,13 +1329,20 @@ bool SecFimc::setLocalAlpha(bool enable)
         return false;
     }
 
+    if (mFlagLocalAlpha == enable)
+        return true;
+
+#ifdef BOARD_USE_V4L2
     if (mFlagStreamOn == true) {
         ALOGE("%s::mFlagStreamOn == true", __func__);
         return false;
     }
-
-    if (mFlagLocalAlpha == enable)
-        return true;
+#else
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+#endif
 
     return true;
 }
@@ -1293,13 +1357,20 @@ bool SecFimc::setColorKey(bool enable, int colorKey)
         return false;
     }
 
+    if (mFlagColorKey == enable && mColorKey == colorKey)
+        return true;
+
+#ifdef BOARD_USE_V4L2
     if (mFlagStreamOn == true) {
         ALOGE("%s::mFlagStreamOn == true", __func__);
         return false;
     }
-
-    if (mFlagColorKey == enable && mColorKey == colorKey)
-        return true;
+#else
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+#endif
 
     memset(&fbuf, 0, sizeof(fbuf));
 
@@ -1359,20 +1430,22 @@ bool SecFimc::draw(int src_index, int dst_index)
     }
 
     s5p_fimc_params_t *params = &(mS5pFimc.params);
-    bool flagStreamOn = false;
     int src_planes = m_getYuvPlanes(params->src.color_space);
     int dst_planes = m_getYuvPlanes(params->dst.color_space);
     src_planes  = (src_planes == -1) ? 1 : src_planes;
     dst_planes  = (dst_planes == -1) ? 1 : dst_planes;
+    nsecs_t start = systemTime();
 
-#ifdef BOARD_USE_V4L2
     if (mFlagStreamOn == false) {
         if (m_streamOn() == false) {
             ALOGE("%s::m_streamOn failed", __func__);
             return false;
         }
         mFlagStreamOn = true;
+        mDrawStats.streamOns++;
     }
+
+#ifdef BOARD_USE_V4L2
     if (fimc_v4l2_dequeue(mFd, V4L2_BUF_TYPE_DST, V4L2_MEMORY_TYPE_DST, &dst_index, dst_planes) < 0) {
         ALOGE("%s::fimc_v4l2_dequeue[dst](mNumOfBuf : %d) failed", __func__, mNumOfBuf);
         return false;
@@ -1393,37 +1466,194 @@ bool SecFimc::draw(int src_index, int dst_index)
         return false;
     }
 #else
-    if (fimc_v4l2_stream_on(mFd, V4L2_BUF_TYPE_SRC) < 0) {
-        ALOGE("%s::fimc_v4l2_stream_on() failed", __func__);
+    if (fimc_v4l2_queue(mFd, &(mSrcBuffer), V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC, mSrcQueueIndex, src_planes) < 0) {
+        ALOGE("%s::fimc_v4l2_queue(index : %d) (mInFlight : %d) failed", __func__, mSrcQueueIndex, mInFlight);
         goto err;
     }
 
-    flagStreamOn = true;
+    mSrcQueueIndex = (mSrcQueueIndex + 1) % mInFlightMax;
+    mInFlight++;
 
-    if (fimc_v4l2_queue(mFd, &(mSrcBuffer), V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC, src_index, src_planes) < 0) {
-        ALOGE("%s::fimc_v4l2_queue(index : %d) (mNumOfBuf : %d) failed", __func__, 0, mNumOfBuf);
-        goto err;
+    /* keep a free slot for the next draw, with depth 1 this waits for this one */
+    while (mInFlightMax <= mInFlight) {
+        if (fimc_v4l2_dequeue(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC, &src_index, src_planes) < 0) {
+            ALOGE("%s::fimc_v4l2_dequeue (mInFlight : %d) failed", __func__, mInFlight);
+            goto err;
+        }
+        mInFlight--;
     }
+#endif
 
-    if (fimc_v4l2_dequeue(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC, &src_index, src_planes) < 0) {
-        ALOGE("%s::fimc_v4l2_dequeue (mNumOfBuf : %d) failed", __func__, mNumOfBuf);
-        goto err;
+    mDrawStats.lastNs = systemTime() - start;
+    if (mDrawStats.maxNs < mDrawStats.lastNs)
+        mDrawStats.maxNs = mDrawStats.lastNs;
+    mDrawStats.totalNs += mDrawStats.lastNs;
+    mDrawStats.draws++;
+
+    return true;
+
+#ifndef BOARD_USE_V4L2
+err :
+    /* the queue state is unknown, start over on the next draw */
+    mInFlight = 0;
+    if (m_streamOff() == false)
+        ALOGE("%s::m_streamOff() failed", __func__);
+
+    return false;
+#endif
+}
+
+bool SecFimc::drawBatch(SecBuffer *srcBuf, SecBuffer *dstBuf, int count)
+{
+#ifdef DEBUG_LIB_FIMC
+    ALOGD("%s(count : %d)", __func__, count);
+#endif
+
+    if (mFlagCreate == false) {
+        ALOGE("%s::Not yet created", __func__);
+        return false;
+    }
+
+    if (mFlagSetSrcParam == false || mFlagSetDstParam == false) {
+        ALOGE("%s::params are not set fail", __func__);
+        return false;
+    }
+
+#ifdef BOARD_USE_V4L2
+    for (int i = 0; i < count; i++) {
+        mSrcBuffer.phys.extP[0] = srcBuf[i].phys.extP[0];
+        mSrcBuffer.phys.extP[1] = srcBuf[i].phys.extP[1];
+        mSrcBuffer.phys.extP[2] = srcBuf[i].phys.extP[2];
+
+        if (dstBuf != NULL) {
+            if (setDstAddr(dstBuf[i].phys.extP[0], dstBuf[i].phys.extP[1],
+                           dstBuf[i].phys.extP[2], i % mNumOfBuf) == false) {
+                ALOGE("%s::setDstAddr(%d) failed", __func__, i);
+                return false;
+            }
+        }
+
+        if (draw(0, i % mNumOfBuf) == false) {
+            ALOGE("%s::draw(%d) failed", __func__, i);
+            return false;
+        }
     }
+
+    return true;
+#else
+    /*
+     * All entries share the persistent stream. A new dst address makes
+     * setDstAddr() stop it, entries with the same dst run back to back.
+     */
+    for (int i = 0; i < count; i++) {
+        mSrcBuffer.phys.extP[0] = srcBuf[i].phys.extP[0];
+        mSrcBuffer.phys.extP[1] = srcBuf[i].phys.extP[1];
+        mSrcBuffer.phys.extP[2] = srcBuf[i].phys.extP[2];
+
+        if (dstBuf != NULL) {
+            if (setDstAddr(dstBuf[i].phys.extP[0], dstBuf[i].phys.extP[1],
+                           dstBuf[i].phys.extP[2]) == false) {
+                ALOGE("%s::setDstAddr(%d) failed", __func__, i);
+                return false;
+            }
+        }
+
+        if (draw(0, 0) == false) {
+            ALOGE("%s::draw(%d) failed", __func__, i);
+            return false;
+        }
+    }
+
+    return flush();
 #endif
+}
 
-err :
+bool SecFimc::setInFlight(int depth)
+{
+    if (mFlagCreate == false) {
+        ALOGE("%s::Not yet created", __func__);
+        return false;
+    }
+
+#ifdef BOARD_USE_V4L2
+    if (depth != 1) {
+        ALOGE("%s::depth(%d) not supported", __func__, depth);
+        return false;
+    }
+#else
+    if (depth < 1 || MAX_INFLIGHT_BUFS < depth) {
+        ALOGE("%s::invalid depth(%d)", __func__, depth);
+        return false;
+    }
+
+    if (mInFlightMax == depth)
+        return true;
+
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+
+    if (mFlagSetSrcParam == true) {
+        if (fimc_v4l2_clr_buf(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
+            ALOGE("%s::fimc_v4l2_clr_buf()[src] failed", __func__);
+            return false;
+        }
+
+        if (fimc_v4l2_req_buf(mFd, depth, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC) < 0) {
+            ALOGE("%s::fimc_v4l2_req_buf()[src] failed", __func__);
+            mFlagSetSrcParam = false;
+            mSrcReq.valid = false;
+            return false;
+        }
+    }
+
+    mInFlightMax = depth;
+#endif
+
+    return true;
+}
+
+bool SecFimc::flush(void)
+{
 #ifndef BOARD_USE_V4L2
-    if (flagStreamOn == true) {
-        if (fimc_v4l2_stream_off(mFd, V4L2_BUF_TYPE_SRC) < 0) {
-            ALOGE("%s::fimc_v4l2_stream_off() failed", __func__);
+    s5p_fimc_params_t *params = &(mS5pFimc.params);
+    int src_planes = m_getYuvPlanes(params->src.color_space);
+    int src_index;
+    nsecs_t start;
+    src_planes = (src_planes == -1) ? 1 : src_planes;
+
+    if (mInFlight == 0)
+        return true;
+
+    start = systemTime();
+
+    while (0 < mInFlight) {
+        if (fimc_v4l2_dequeue(mFd, V4L2_BUF_TYPE_SRC, V4L2_MEMORY_TYPE_SRC, &src_index, src_planes) < 0) {
+            ALOGE("%s::fimc_v4l2_dequeue (mInFlight : %d) failed", __func__, mInFlight);
+            mInFlight = 0;
             return false;
         }
+        mInFlight--;
     }
+
+    mDrawStats.flushes++;
+    mDrawStats.flushNs += systemTime() - start;
 #endif
 
     return true;
 }
 
+void SecFimc::getDrawStats(DrawStats *stats)
+{
+    *stats = mDrawStats;
+}
+
+void SecFimc::resetDrawStats(void)
+{
+    memset(&mDrawStats, 0, sizeof(mDrawStats));
+}
+
 bool SecFimc::m_streamOn()
 {
 #ifdef DEBUG_LIB_FIMC
@@ -1480,6 +1710,151 @@ bool SecFimc::m_streamOn()
     return true;
 }
 
+bool SecFimc::m_streamOff()
+{
+    bool ret = true;
+
+    if (mFlagStreamOn == false)
+        return true;
+
+    if (flush() == false) {
+        ALOGE("%s::flush() failed", __func__);
+        ret = false;
+    }
+
+    if (fimc_v4l2_stream_off(mFd, V4L2_BUF_TYPE_SRC) < 0) {
+        ALOGE("%s::fimc_v4l2_stream_off() failed", __func__);
+        return false;
+    }
+
+#ifdef BOARD_USE_V4L2
+    if (fimc_v4l2_stream_off(mFd, V4L2_BUF_TYPE_DST) < 0) {
+        ALOGE("%s::fimc_v4l2_stream_off() failed", __func__);
+        return false;
+    }
+#endif
+
+    mFlagStreamOn = false;
+    mSrcQueueIndex = 0;
+
+    return ret;
+}
+
+void SecFimc::m_resetCache(void)
+{
+    memset(&mSrcReq, 0, sizeof(mSrcReq));
+    memset(&mDstReq, 0, sizeof(mDstReq));
+    memset(&mDstProg, 0, sizeof(mDstProg));
+
+    mFlagDstProg = false;
+    mDstProgRotVal = -1;
+    mDstProgAddr = 0;
+}
+
+bool SecFimc::m_checkCache(ParamCache *cache,
+                           unsigned int width, unsigned int height,
+                           unsigned int cropX, unsigned int cropY,
+                           unsigned int *cropWidth, unsigned int *cropHeight,
+                           int colorFormat, int rotVal,
+                           bool forceChange)
+{
+    if (   (cache->valid == false)
+        || (cache->width != width)
+        || (cache->height != height)
+        || (cache->cropX != cropX)
+        || (cache->cropY != cropY)
+        || (cache->cropWidth != *cropWidth)
+        || (cache->cropHeight != *cropHeight)
+        || (cache->colorFormat != colorFormat)
+        || (cache->rotVal != rotVal))
+        return false;
+
+    /*
+     * The cached request may have been stored with an adjusted size,
+     * a caller which does not accept the change takes the full path.
+     */
+    if (   (forceChange == false)
+        && (   (cache->fimcWidth != *cropWidth)
+            || (cache->fimcHeight != *cropHeight)))
+        return false;
+
+    *cropWidth  = cache->fimcWidth;
+    *cropHeight = cache->fimcHeight;
+
+    return true;
+}
+
+void SecFimc::m_storeCache(ParamCache *cache,
+                           unsigned int width, unsigned int height,
+                           unsigned int cropX, unsigned int cropY,
+                           unsigned int cropWidth, unsigned int cropHeight,
+                           int colorFormat, int rotVal,
+                           unsigned int fimcWidth, unsigned int fimcHeight)
+{
+    cache->width       = width;
+    cache->height      = height;
+    cache->cropX       = cropX;
+    cache->cropY       = cropY;
+    cache->cropWidth   = cropWidth;
+    cache->cropHeight  = cropHeight;
+    cache->colorFormat = colorFormat;
+    cache->rotVal      = rotVal;
+    cache->fimcWidth   = fimcWidth;
+    cache->fimcHeight  = fimcHeight;
+    cache->valid       = true;
+}
+
+bool SecFimc::m_dstChanged(void)
+{
+    s5p_fimc_params_t *params = &(mS5pFimc.params);
+
+    if (   (mFlagDstProg == false)
+        || (mDstProgRotVal != mRotVal)
+        || (mDstProgAddr != (unsigned int)mS5pFimc.out_buf.phys_addr)
+        || (memcmp(&mDstProg, &(params->dst), sizeof(s5p_fimc_img_info)) != 0))
+        return true;
+
+    return false;
+}
+
+bool SecFimc::m_setDstFmt(void)
+{
+    s5p_fimc_params_t *params = &(mS5pFimc.params);
+
+    if (m_dstChanged() == false)
+        return true;
+
+#ifndef BOARD_USE_V4L2
+    /* the overlay window is only taken at STREAMON */
+    if (m_streamOff() == false) {
+        ALOGE("%s::m_streamOff() failed", __func__);
+        return false;
+    }
+#endif
+
+    mFlagDstProg = false;
+
+    if (mDstProgRotVal != mRotVal) {
+        if (fimc_v4l2_s_ctrl(mFd, V4L2_ROTATE, mRotVal) < 0) {
+            ALOGE("%s::fimc_v4l2_s_ctrl(V4L2_ROTATE)", __func__);
+            mDstProgRotVal = -1;
+            return false;
+        }
+        mDstProgRotVal = mRotVal;
+    }
+
+    if (fimc_v4l2_set_fmt(mFd, V4L2_BUF_TYPE_DST, V4L2_FIELD_ANY, &(params->dst), (unsigned int)mS5pFimc.out_buf.phys_addr) < 0) {
+        ALOGE("%s::fimc_v4l2_set_fmt()[dst] failed", __func__);
+        return false;
+    }
+
+    mDstProg     = params->dst;
+    mDstProgAddr = (unsigned int)mS5pFimc.out_buf.phys_addr;
+    mFlagDstProg = true;
+
+    return true;
+}
+
 bool SecFimc::m_checkSrcSize(unsigned int width, unsigned int height,
                              unsigned int cropX, unsigned int cropY,
                              unsigned int *cropWidth, unsigned int *cropHeight,
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Fake FIMC node for the libfimc tests. The test executable defines
+ * open/close/ioctl itself so /dev/video* never reaches the driver, every
+ * other path is passed on to the kernel. The counters record what
+ * SecFimc programmed, 'bad' counts format changes made while streaming.
+ */
+
+#ifndef _FAKE_FIMC_H_
+#define _FAKE_FIMC_H_
+
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include <cutils/log.h>
+#include "SecFimc.h"
+
+#define FAKE_FIMC_FD    1000
+
+/* bionic and glibc disagree on the request type */
+#ifdef __BIONIC__
+typedef int fake_ioctl_req_t;
+#else
+typedef unsigned long fake_ioctl_req_t;
+#endif
+
+struct fake_fimc {
+    int streaming;
+    int queued;
+    int max_queued;
+    int stream_on;
+    int stream_off;
+    int s_fmt;
+    int qbuf;
+    int dqbuf;
+    int bad;
+};
+
+static struct fake_fimc fake;
+
+extern "C" int open(const char *path, int flags, ...)
+{
+    if (strncmp(path, "/dev/video", 10) == 0)
+        return FAKE_FIMC_FD;
+
+    va_list ap;
+    va_start(ap, flags);
+    int mode = va_arg(ap, int);
+    va_end(ap);
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+extern "C" int close(int fd)
+{
+    if (fd == FAKE_FIMC_FD)
+        return 0;
+    return syscall(SYS_close, fd);
+}
+
+extern "C" int ioctl(int fd, fake_ioctl_req_t req, ...)
+{
+    va_list ap;
+    va_start(ap, req);
+    void *arg = va_arg(ap, void *);
+    va_end(ap);
+
+    if (fd != FAKE_FIMC_FD)
+        return syscall(SYS_ioctl, fd, req, arg);
+
+    switch ((unsigned int)req) {
+    case VIDIOC_QUERYCAP:
+        ((struct v4l2_capability *)arg)->capabilities =
+            V4L2_CAP_STREAMING | V4L2_CAP_VIDEO_OUTPUT;
+        break;
+    case VIDIOC_G_CTRL:
+        ((struct v4l2_control *)arg)->value = 0x43;
+        break;
+    case VIDIOC_STREAMON:
+        if (fake.streaming)
+            fake.bad++;
+        fake.streaming = 1;
+        fake.stream_on++;
+        break;
+    case VIDIOC_STREAMOFF:
+        fake.streaming = 0;
+        fake.queued = 0;
+        fake.stream_off++;
+        break;
+    case VIDIOC_QBUF:
+        if (!fake.streaming)
+            fake.bad++;
+        fake.queued++;
+        fake.qbuf++;
+        if (fake.queued > fake.max_queued)
+            fake.max_queued = fake.queued;
+        break;
+    case VIDIOC_DQBUF:
+        if (fake.queued <= 0)
+            fake.bad++;
+        fake.queued--;
+        fake.dqbuf++;
+        break;
+    case VIDIOC_S_FMT:
+        fake.s_fmt++;
+        /* fall through */
+    case VIDIOC_S_CTRL:
+    case VIDIOC_REQBUFS:
+    case VIDIOC_S_FBUF:
+        if (fake.streaming)
+            fake.bad++;
+        break;
+    }
+    return 0;
+}
+
+#endif // end of _FAKE_FIMC_H_
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _FIMC_TEST_H_
+#define _FIMC_TEST_H_
+
+#include <stdio.h>
+
+/* cutils/log.h may already own LOGI/LOGE */
+#define TLOGI(fmt, ...)                 \
+    do {                                \
+        printf(LOG_TAG "/I: " fmt "\n", __VA_ARGS__); \
+    } while (0)
+
+#define TLOGE(fmt, ...)                 \
+    do {                                \
+        printf(LOG_TAG "/E: " fmt "\n", __VA_ARGS__); \
+    } while (0)
+
+/* assert() is compiled out with NDEBUG, count failures instead */
+#define CHECK(cond)                     \
+    do {                                \
+        if (!(cond)) {                  \
+            TLOGE("%s:%d: %s", __FILE__, __LINE__, #cond); \
+            failures++;                 \
+        }                               \
+    } while (0)
+
+extern int failures;
+
+#endif // end of _FIMC_TEST_H_
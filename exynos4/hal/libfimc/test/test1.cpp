@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Parameter cache: repeated identical requests must not reprogram the
+ * device, and a cached size adjustment must not satisfy a caller which
+ * passes forceChange == false.
+ */
+
+#include "fake_fimc.h"
+#include "test.h"
+
+int failures;
+
+int main(int argc, char** argv) {
+    SecFimc fimc;
+    unsigned int cw, ch;
+    int s_fmt;
+
+    CHECK(fimc.create(SecFimc::DEV_0, SecFimc::MODE_SINGLE_BUF, 1));
+
+    cw = 640; ch = 480;
+    CHECK(fimc.setSrcParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP));
+    cw = 640; ch = 480;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP));
+    CHECK(fimc.setDstAddr(0x1000, 0x2000));
+    CHECK(fimc.draw(0, 0));
+
+    /* identical requests are served from the cache */
+    s_fmt = fake.s_fmt;
+    for (int i = 0; i < 10; i++) {
+        cw = 640; ch = 480;
+        CHECK(fimc.setSrcParams(640, 480, 0, 0, &cw, &ch,
+                                HAL_PIXEL_FORMAT_YCrCb_420_SP));
+        cw = 640; ch = 480;
+        CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                                HAL_PIXEL_FORMAT_YCrCb_420_SP));
+        CHECK(fimc.setDstAddr(0x1000, 0x2000));
+        CHECK(fimc.draw(0, 0));
+    }
+    CHECK(fake.s_fmt == s_fmt);
+    CHECK(fake.stream_on == 1);
+
+    /* an odd 420 crop height is rounded to even when the caller allows it */
+    cw = 640; ch = 479;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP, true));
+    CHECK(ch == 478);
+
+    /* the cached adjustment is reported again to a forcing caller */
+    cw = 640; ch = 479;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP, true));
+    CHECK(ch == 478);
+
+    /* but must not make the same request valid without forceChange */
+    cw = 640; ch = 479;
+    CHECK(!fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                             HAL_PIXEL_FORMAT_YCrCb_420_SP, false));
+    CHECK(ch == 479);
+
+    /* an unadjusted cache entry still hits without forceChange */
+    cw = 640; ch = 480;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP, true));
+    s_fmt = fake.s_fmt;
+    cw = 640; ch = 480;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP, false));
+    CHECK(fake.s_fmt == s_fmt);
+
+    CHECK(fimc.destroy());
+    CHECK(fake.bad == 0);
+
+    TLOGI("s_fmt %d stream on %d off %d, %d failures",
+         fake.s_fmt, fake.stream_on, fake.stream_off, failures);
+
+    return failures ? 1 : 0;
+}
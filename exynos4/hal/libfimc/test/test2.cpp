@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Stream handling without BOARD_USE_V4L2: the stream stays on across
+ * draws to a steady destination, a destination or blending change stops
+ * it first, setInFlight() bounds the queued conversions and flush()
+ * drains them. getDrawStats() counts what happened.
+ */
+
+#include "fake_fimc.h"
+#include "test.h"
+
+#define STEADY_DRAWS    100
+#define INFLIGHT_DRAWS  30
+#define INFLIGHT_DEPTH  3
+
+int failures;
+
+int main(int argc, char** argv) {
+    SecFimc fimc;
+    SecFimc::DrawStats stats;
+    unsigned int cw, ch;
+
+    CHECK(fimc.create(SecFimc::DEV_0, SecFimc::MODE_SINGLE_BUF, 1));
+
+    cw = 640; ch = 480;
+    CHECK(fimc.setSrcParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP));
+    cw = 640; ch = 480;
+    CHECK(fimc.setDstParams(640, 480, 0, 0, &cw, &ch,
+                            HAL_PIXEL_FORMAT_YCrCb_420_SP));
+    CHECK(fimc.setDstAddr(0x1000, 0x2000));
+
+    /* one STREAMON for a steady destination, every draw completes */
+    for (int i = 0; i < STEADY_DRAWS; i++) {
+        CHECK(fimc.setSrcAddr(0x10000 + i * 0x1000));
+        CHECK(fimc.setDstAddr(0x1000, 0x2000));
+        CHECK(fimc.draw(0, 0));
+        CHECK(fake.queued == 0);
+    }
+    CHECK(fake.stream_on == 1);
+    CHECK(fake.stream_off == 0);
+
+    /* a new destination needs the stream off */
+    CHECK(fimc.setDstAddr(0x3000, 0x4000));
+    CHECK(!fake.streaming);
+    CHECK(fake.stream_off == 1);
+
+    /* a deeper queue leaves conversions behind, flush() takes them back */
+    CHECK(fimc.setInFlight(INFLIGHT_DEPTH));
+    for (int i = 0; i < INFLIGHT_DRAWS; i++)
+        CHECK(fimc.draw(0, 0));
+    CHECK(fake.max_queued == INFLIGHT_DEPTH);
+    CHECK(fake.queued == INFLIGHT_DEPTH - 1);
+    CHECK(fimc.flush());
+    CHECK(fake.queued == 0);
+    CHECK(fake.streaming);
+
+    /* nothing queued, nothing to wait for */
+    CHECK(fimc.flush());
+
+    CHECK(!fimc.setInFlight(0));
+    CHECK(fimc.setGlobalAlpha(true, 0x80));
+    CHECK(!fake.streaming);
+
+    fimc.getDrawStats(&stats);
+    CHECK(stats.draws == STEADY_DRAWS + INFLIGHT_DRAWS);
+    CHECK(stats.streamOns == 2);
+    CHECK(stats.flushes == 1);
+    CHECK(stats.maxNs >= stats.lastNs);
+    CHECK(stats.totalNs >= stats.maxNs);
+
+    fimc.resetDrawStats();
+    fimc.getDrawStats(&stats);
+    CHECK(stats.draws == 0 && stats.streamOns == 0 && stats.flushes == 0);
+
+    CHECK(fimc.destroy());
+    CHECK(fake.bad == 0);
+    CHECK(fake.qbuf == fake.dqbuf);
+
+    TLOGI("qbuf %d dqbuf %d stream on %d off %d, %d failures",
+         fake.qbuf, fake.dqbuf, fake.stream_on, fake.stream_off, failures);
+
+    return failures ? 1 : 0;
+}
@@ -27,7 +27,7 @@ LOCAL_C_INCLUDES := \
     bionic/libc/include \
 	$(TARGET_HAL_PATH)/include
 
-LOCAL_SRC_FILES := SecHWCLog.cpp SecHWCUtils.cpp SecHWC.cpp
+LOCAL_SRC_FILES := SecHWCLog.cpp SecHWCUtils.cpp SecHWCVsync.cpp SecHWCPerf.cpp SecHWC.cpp
 
 LOCAL_C_INCLUDES += $(LOCAL_PATH)/../libfimg
 
@@ -79,3 +79,5 @@ endif
 LOCAL_MODULE := hwcomposer.$(TARGET_BOARD_PLATFORM)
 LOCAL_MODULE_TAGS := optional
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
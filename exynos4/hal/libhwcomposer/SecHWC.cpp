@@ -45,11 +45,6 @@
 
 #include "SecHdmi.h"
 
-//#define CHECK_EGL_FPS
-#ifdef CHECK_EGL_FPS
-extern void check_fps();
-#endif
-
 static int lcd_width, lcd_height;
 static int prev_usage = 0;
 
@@ -524,7 +519,7 @@ static void get_hwc_ui_lay_skipdraw_decision(struct hwc_context_t* ctx,
 }
 #endif
 
-static int hwc_prepare(hwc_composer_device_1_t *dev, size_t numDisplays, hwc_display_contents_1_t** displays)
+static int hwc_prepare_display(hwc_composer_device_1_t *dev, size_t numDisplays, hwc_display_contents_1_t** displays)
 {
 
     struct hwc_context_t* ctx = (struct hwc_context_t*)dev;
@@ -665,12 +660,27 @@ static int hwc_prepare(hwc_composer_device_1_t *dev, size_t numDisplays, hwc_dis
     return 0;
 }
 
-static int hwc_set(hwc_composer_device_1_t *dev,
+static int hwc_prepare(hwc_composer_device_1_t *dev, size_t numDisplays, hwc_display_contents_1_t** displays)
+{
+    struct hwc_context_t* ctx = (struct hwc_context_t*)dev;
+    int ret;
+
+    hwc_perf_prepare_start(&ctx->perf, hwc_get_time_ns());
+    ret = hwc_prepare_display(dev, numDisplays, displays);
+    hwc_perf_prepare_end(&ctx->perf, numDisplays > 0 ? displays[0] : NULL,
+            hwc_get_time_ns());
+
+    return ret;
+}
+
+static int hwc_set_display(hwc_composer_device_1_t *dev,
                    size_t numDisplays,
                    hwc_display_contents_1_t** displays)
 {
     struct hwc_context_t *ctx = (struct hwc_context_t *)dev;
     int skipped_window_mask = 0;
+    int pan_window_mask = 0;
+    EGLBoolean sucess = EGL_TRUE;
     hwc_layer_1_t* cur;
     struct hwc_win_info_t   *win;
     int ret;
@@ -685,6 +695,7 @@ static int hwc_set(hwc_composer_device_1_t *dev,
     memset(&dst_img, 0, sizeof(dst_img));
     memset(&src_work_rect, 0, sizeof(src_work_rect));
     memset(&dst_work_rect, 0, sizeof(dst_work_rect));
+    ctx->fimc_session.failed_mask = 0;
 
 #if defined(BOARD_USES_HDMI)
     int skip_hdmi_rendering = 0;
@@ -765,7 +776,7 @@ static int hwc_set(hwc_composer_device_1_t *dev,
                 set_src_dst_img_rect(cur, win, &src_img, &dst_img,
                                 &src_work_rect, &dst_work_rect, i);
 
-                ret = runFimc(ctx,
+                ret = runFimc(ctx, i,
                             &src_img, &src_work_rect,
                             &dst_img, &dst_work_rect,
                             cur->transform);
@@ -777,11 +788,7 @@ static int hwc_set(hwc_composer_device_1_t *dev,
                     continue;
                 }
 
-                window_pan_display(win);
-
-                win->buf_index = (win->buf_index + 1) % NUM_OF_WIN_BUF;
-                if (win->power_state == 0)
-                    window_show(win);
+                pan_window_mask |= (1 << i);
             } else {
                 SEC_HWC_Log(HWC_LOG_ERROR,
                         "%s:: error : layer %d compositionType should have been"
@@ -797,6 +804,41 @@ static int hwc_set(hwc_composer_device_1_t *dev,
         }
     }
 
+    if (need_swap_buffers) {
+#ifdef HWC_HWOVERLAY
+        unsigned char pixels[4];
+        glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+#endif
+        sucess = eglSwapBuffers((EGLDisplay)list->dpy, (EGLSurface)list->sur);
+        hwc_perf_add_swap(&ctx->perf);
+    }
+
+    /*
+     * The last FIMC conversion ran concurrently with the GLES swap,
+     * collect it before flipping the overlay windows.
+     */
+    hwc_fimc_session_complete(ctx);
+    for (int i = 0; i < NUM_OF_WIN; i++) {
+        if (!(ctx->fimc_session.failed_mask & (1 << i)))
+            continue;
+        /* only the window whose conversion failed is dropped */
+        ctx->layer_prev_buf[i] = 0;
+        skipped_window_mask |= (1 << i);
+        pan_window_mask &= ~(1 << i);
+    }
+
+    for (int i = 0; i < NUM_OF_WIN; i++) {
+        if (!(pan_window_mask & (1 << i)))
+            continue;
+
+        win = &ctx->win[i];
+        window_pan_display(win);
+
+        win->buf_index = (win->buf_index + 1) % NUM_OF_WIN_BUF;
+        if (win->power_state == 0)
+            window_show(win);
+    }
+
     if (skipped_window_mask) {
         //turn off the free windows
         for (int i = 0; i < NUM_OF_WIN; i++) {
@@ -807,18 +849,8 @@ static int hwc_set(hwc_composer_device_1_t *dev,
         }
     }
 
-    if (need_swap_buffers) {
-#ifdef CHECK_EGL_FPS
-        check_fps();
-#endif
-#ifdef HWC_HWOVERLAY
-        unsigned char pixels[4];
-        glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-#endif
-        EGLBoolean sucess = eglSwapBuffers((EGLDisplay)list->dpy, (EGLSurface)list->sur);
-        if (!sucess)
-            return HWC_EGL_ERROR;
-    }
+    if (!sucess)
+        return HWC_EGL_ERROR;
 
 #if defined(BOARD_USES_HDMI)
     android::SecHdmiClient *mHdmiClient = android::SecHdmiClient::getInstance();
@@ -897,6 +929,20 @@ static int hwc_set(hwc_composer_device_1_t *dev,
     return 0;
 }
 
+static int hwc_set(hwc_composer_device_1_t *dev,
+                   size_t numDisplays,
+                   hwc_display_contents_1_t** displays)
+{
+    struct hwc_context_t *ctx = (struct hwc_context_t *)dev;
+    int64_t start = hwc_get_time_ns();
+    int ret;
+
+    ret = hwc_set_display(dev, numDisplays, displays);
+    hwc_perf_set_end(&ctx->perf, start, hwc_get_time_ns());
+
+    return ret;
+}
+
 static void hwc_registerProcs(struct hwc_composer_device_1* dev,
         hwc_procs_t const* procs)
 {
@@ -916,7 +962,7 @@ static int hwc_query(struct hwc_composer_device_1* dev,
         break;
     case HWC_VSYNC_PERIOD:
         // vsync period in nanosecond
-        value[0] = 1000000000.0 / 57;
+        value[0] = (int)hwc_vsync_get_period(&ctx->vsync);
         break;
     default:
         // unsupported query
@@ -936,86 +982,37 @@ static int hwc_eventControl(struct hwc_composer_device_1* dev, int dpy,
         int err = ioctl(ctx->global_lcd_win.fd, S3CFB_SET_VSYNC_INT, &val);
         if (err < 0)
             return -errno;
-        
+
+        hwc_vsync_set_enabled(&ctx->vsync, val);
         return 0;
     }
     return -EINVAL;
 }
 
-#ifdef SYSFS_VSYNC_NOTIFICATION
-static void *hwc_vsync_sysfs_loop(void *data)
-{
-    static char buf[4096];
-    int vsync_timestamp_fd;
-    fd_set exceptfds;
-    int res;
-    int64_t timestamp = 0;
-    hwc_context_t * ctx = (hwc_context_t *)(data);
-
-    vsync_timestamp_fd = open("/sys/devices/platform/samsung-pd.2/s3cfb.0/vsync_time", O_RDONLY);
-    char thread_name[64] = "hwcVsyncThread";
-    prctl(PR_SET_NAME, (unsigned long) &thread_name, 0, 0, 0);
-    setpriority(PRIO_PROCESS, 0, -20);
-    memset(buf, 0, sizeof(buf));
-    
-    SEC_HWC_Log(HWC_LOG_DEBUG,"Using sysfs mechanism for VSYNC notification");
-
-    FD_ZERO(&exceptfds);
-    FD_SET(vsync_timestamp_fd, &exceptfds);
-    do {
-        ssize_t len = read(vsync_timestamp_fd, buf, sizeof(buf));
-        timestamp = strtoull(buf, NULL, 0);
-        if(ctx->procs)
-            ctx->procs->vsync(ctx->procs, 0, timestamp);
-        select(vsync_timestamp_fd + 1, NULL, NULL, &exceptfds, NULL);
-        lseek(vsync_timestamp_fd, 0, SEEK_SET);
-    } while (1);
-
-    return NULL;
-}
-#endif
-
-void handle_vsync_uevent(hwc_context_t *ctx, const char *buff, int len)
-{
-    uint64_t timestamp = 0;
-    const char *s = buff;
-
-    if(!ctx->procs || !ctx->procs->vsync)
-       return;
-
-    s += strlen(s) + 1;
-
-    while(*s) {
-        if (!strncmp(s, "VSYNC=", strlen("VSYNC=")))
-            timestamp = strtoull(s + strlen("VSYNC="), NULL, 0);
-
-        s += strlen(s) + 1;
-        if (s - buff >= len)
-            break;
-    }
-
-    ctx->procs->vsync(ctx->procs, 0, timestamp);
-}
-
-static void *hwc_vsync_thread(void *data)
+static void hwc_dump(struct hwc_composer_device_1* dev, char *buff, int buff_len)
 {
-    hwc_context_t *ctx = (hwc_context_t *)(data);
-    char uevent_desc[4096];
+    struct hwc_context_t* ctx = (struct hwc_context_t*)dev;
+    int len;
 
-    memset(uevent_desc, 0, sizeof(uevent_desc));
-    setpriority(PRIO_PROCESS, 0, HAL_PRIORITY_URGENT_DISPLAY);
-    uevent_init();
+    if (buff_len <= 0)
+        return;
 
-    while(true) {
+    len = snprintf(buff, buff_len,
+            "Samsung exynos4 hwcomposer\n"
+            "  layers: fb %d, hwc %d\n",
+            ctx->num_of_fb_layer, ctx->num_of_hwc_layer);
+    if (len >= buff_len)
+        return;
 
-        int len = uevent_next_event(uevent_desc, sizeof(uevent_desc) - 2);
+    len += hwc_vsync_dump(&ctx->vsync, buff + len, buff_len - len);
+    if (len >= buff_len)
+        return;
 
-        bool vsync = !strcmp(uevent_desc, "change@/devices/platform/samsung-pd.2/s3cfb.0");
-        if(vsync)
-            handle_vsync_uevent(ctx, uevent_desc, len);
-    }
+    len += hwc_perf_dump(&ctx->perf, buff + len, buff_len - len);
+    if (len >= buff_len)
+        return;
 
-    return NULL;
+    hwc_fimc_session_dump(ctx, buff + len, buff_len - len);
 }
 
 static int hwc_device_close(struct hw_device_t *dev)
@@ -1024,6 +1021,8 @@ static int hwc_device_close(struct hw_device_t *dev)
     int ret = 0;
     int i;
     if (ctx) {
+        hwc_fimc_session_stop(ctx);
+
         if (destroyFimc(&ctx->fimc) < 0) {
             SEC_HWC_Log(HWC_LOG_ERROR, "%s::destroyFimc fail", __func__);
             ret = -1;
@@ -1039,6 +1038,7 @@ static int hwc_device_close(struct hw_device_t *dev)
                 SEC_HWC_Log(HWC_LOG_DEBUG, "%s::window_close() fail", __func__);
         }
 
+        hwc_perf_deinit(&ctx->perf);
         free(ctx);
     }
     return ret;
@@ -1049,8 +1049,8 @@ static int hwc_blank(struct hwc_composer_device_1 *dev, int dpy, int blank)
     struct hwc_context_t* ctx = (struct hwc_context_t*)dev;
     if (blank) {
         // release our resources, the screen is turning off
-        // in our case, there is nothing to do.
         ctx->num_of_fb_layer_prev = 0;
+        hwc_fimc_session_stop(ctx);
         return 0;
     }
     else {
@@ -1086,10 +1086,14 @@ static int hwc_device_open(const struct hw_module_t* module, const char* name,
     dev->device.blank                = hwc_blank;
     dev->device.query                = hwc_query;
     dev->device.registerProcs        = hwc_registerProcs;
+    dev->device.dump                 = hwc_dump;
     *device = &dev->device.common;
 
     //initializing
     memset(&(dev->fimc),    0, sizeof(s5p_fimc_t));
+    hwc_vsync_init(&dev->vsync);
+    if (hwc_perf_init(&dev->perf) < 0)
+        SEC_HWC_Log(HWC_LOG_WARNING, "%s::hwc_perf_init() fail", __func__);
 
     /* open WIN0 & WIN1 here */
     for (int i = 0; i < NUM_OF_WIN; i++) {
@@ -1155,23 +1159,12 @@ static int hwc_device_open(const struct hw_module_t* module, const char* name,
         goto err;
     }
 
-#ifndef SYSFS_VSYNC_NOTIFICATION
     err = pthread_create(&dev->vsync_thread, NULL, hwc_vsync_thread, dev);
-    if (err) {
-        ALOGE("%s::pthread_create() failed : %s", __func__, strerror(err));
-        status = -err;
-        goto err;
-    }
-#endif
-
-#ifdef SYSFS_VSYNC_NOTIFICATION
-    err = pthread_create(&dev->vsync_thread, NULL, hwc_vsync_sysfs_loop, dev);
     if (err) {
         SEC_HWC_Log(HWC_LOG_ERROR, "%s::pthread_create() failed : %s", __func__, strerror(err));
         status = -err;
         goto err;
     }
-#endif
 
     SEC_HWC_Log(HWC_LOG_DEBUG, "%s:: hwc_device_open: SUCCESS", __func__);
 
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project <http://www.cyanogenmod.org>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Per-frame performance records for the exynos4 hwcomposer.
+ *
+ * hwc_prepare/hwc_set append one record per frame to a ring that lives in
+ * an ashmem region ("hwc_perf"). The composition thread is the only
+ * writer; readers (dump() on a binder thread, or another process that got
+ * the region from the HWC_PERF_SOCKET publisher) validate each slot against
+ * its sequence number, so no lock is ever taken.
+ */
+
+#include <stddef.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <cutils/ashmem.h>
+#include <cutils/atomic.h>
+
+#include "SecHWCUtils.h"
+
+/* root, system and shell may read the ring */
+static bool hwc_perf_peer_allowed(int client)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+
+    if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+        return false;
+
+    return cred.uid == 0 || cred.uid == 1000 || cred.uid == 2000;
+}
+
+static void hwc_perf_send_fd(int client, int fd)
+{
+    char data = 'H';
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+
+    iov.iov_base = &data;
+    iov.iov_len = 1;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    if (sendmsg(client, &msg, MSG_NOSIGNAL) < 0)
+        SEC_HWC_Log(HWC_LOG_WARNING, "%s::sendmsg fail : %s", __func__, strerror(errno));
+}
+
+/* hands the ring's fd to each client, sleeps in accept() otherwise */
+static void *hwc_perf_publisher(void *data)
+{
+    struct hwc_perf_t *perf = (struct hwc_perf_t *)data;
+    int client;
+
+    for (;;) {
+        client = accept(perf->sock_fd, NULL, NULL);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            break;  /* hwc_perf_deinit() shut the socket down */
+        }
+
+        if (hwc_perf_peer_allowed(client))
+            hwc_perf_send_fd(client, perf->ashmem_fd);
+        close(client);
+    }
+
+    return NULL;
+}
+
+static void hwc_perf_publish(struct hwc_perf_t *perf)
+{
+    struct sockaddr_un addr;
+    socklen_t len;
+
+    perf->sock_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (perf->sock_fd < 0) {
+        SEC_HWC_Log(HWC_LOG_WARNING, "%s::socket fail : %s", __func__, strerror(errno));
+        return;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path + 1, HWC_PERF_SOCKET);
+    len = offsetof(struct sockaddr_un, sun_path) + 1 + strlen(HWC_PERF_SOCKET);
+
+    if (bind(perf->sock_fd, (struct sockaddr *)&addr, len) < 0 ||
+        listen(perf->sock_fd, 2) < 0 ||
+        pthread_create(&perf->publisher, NULL, hwc_perf_publisher, perf) != 0) {
+        SEC_HWC_Log(HWC_LOG_WARNING, "%s::can't publish @%s : %s", __func__,
+                HWC_PERF_SOCKET, strerror(errno));
+        close(perf->sock_fd);
+        perf->sock_fd = -1;
+    }
+}
+
+int hwc_perf_init(struct hwc_perf_t *perf)
+{
+    struct hwc_perf_ring_t *ring = NULL;
+    size_t size = sizeof(struct hwc_perf_ring_t);
+
+    memset(perf, 0, sizeof(*perf));
+    perf->sock_fd = -1;
+
+    perf->ashmem_fd = ashmem_create_region("hwc_perf", size);
+    if (0 <= perf->ashmem_fd) {
+        ring = (struct hwc_perf_ring_t *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                MAP_SHARED, perf->ashmem_fd, 0);
+        if (ring == MAP_FAILED) {
+            SEC_HWC_Log(HWC_LOG_WARNING, "%s::mmap fail : %s", __func__, strerror(errno));
+            close(perf->ashmem_fd);
+            perf->ashmem_fd = -1;
+            ring = NULL;
+        } else {
+            /* our mapping stays writable, later ones are read-only */
+            ashmem_set_prot_region(perf->ashmem_fd, PROT_READ);
+        }
+    }
+
+    if (ring == NULL) {
+        /* dump() still works, there is just no snapshot to hand out */
+        ring = (struct hwc_perf_ring_t *)malloc(size);
+        if (ring == NULL) {
+            SEC_HWC_Log(HWC_LOG_ERROR, "%s::malloc fail", __func__);
+            return -1;
+        }
+    }
+
+    memset(ring, 0, size);
+    ring->magic      = HWC_PERF_MAGIC;
+    ring->version    = HWC_PERF_VERSION;
+    ring->entry_size = sizeof(struct hwc_perf_frame_t);
+    ring->size       = HWC_PERF_RING_SIZE;
+    perf->ring       = ring;
+
+    if (0 <= perf->ashmem_fd)
+        hwc_perf_publish(perf);
+
+    return 0;
+}
+
+void hwc_perf_deinit(struct hwc_perf_t *perf)
+{
+    if (perf->ring == NULL)
+        return;
+
+    if (0 <= perf->sock_fd) {
+        shutdown(perf->sock_fd, SHUT_RDWR);
+        pthread_join(perf->publisher, NULL);
+        close(perf->sock_fd);
+        perf->sock_fd = -1;
+    }
+
+    if (0 <= perf->ashmem_fd) {
+        munmap(perf->ring, sizeof(struct hwc_perf_ring_t));
+        close(perf->ashmem_fd);
+    } else {
+        free(perf->ring);
+    }
+
+    perf->ring = NULL;
+    perf->ashmem_fd = -1;
+}
+
+void hwc_perf_prepare_start(struct hwc_perf_t *perf, int64_t now)
+{
+    memset(&perf->cur, 0, sizeof(perf->cur));
+    perf->cur.timestamp = now;
+}
+
+void hwc_perf_prepare_end(struct hwc_perf_t *perf, hwc_display_contents_1_t *list, int64_t now)
+{
+    struct hwc_perf_frame_t *cur = &perf->cur;
+
+    cur->prepare_ns = (uint32_t)(now - cur->timestamp);
+
+    if (list == NULL)
+        return;
+
+    if (list->flags & HWC_GEOMETRY_CHANGED)
+        cur->flags |= HWC_PERF_GEOMETRY_CHANGED;
+
+    cur->num_layers = list->numHwLayers;
+    for (size_t i = 0; i < list->numHwLayers && i < 32; i++) {
+        if (list->hwLayers[i].compositionType == HWC_OVERLAY)
+            cur->overlay_mask |= (1u << i);
+    }
+}
+
+void hwc_perf_add_fimc(struct hwc_perf_t *perf, int64_t ns)
+{
+    perf->cur.fimc_ns += (uint32_t)ns;
+    perf->cur.num_fimc++;
+}
+
+void hwc_perf_add_fimc_wait(struct hwc_perf_t *perf, int64_t ns)
+{
+    perf->cur.fimc_wait_ns += (uint32_t)ns;
+}
+
+void hwc_perf_add_swap(struct hwc_perf_t *perf)
+{
+    perf->cur.flags |= HWC_PERF_GLES_SWAP;
+}
+
+void hwc_perf_set_end(struct hwc_perf_t *perf, int64_t start, int64_t now)
+{
+    struct hwc_perf_ring_t *ring = perf->ring;
+    struct hwc_perf_frame_t *frame;
+    int32_t seq;
+
+    if (ring == NULL)
+        return;
+
+    perf->cur.set_ns = (uint32_t)(now - start);
+
+    seq = ring->seq + 1;
+    frame = &ring->frame[seq & (HWC_PERF_RING_SIZE - 1)];
+
+    /* invalidate the slot, fill it, then publish it */
+    frame->seq = 0;
+    android_memory_barrier();
+    perf->cur.seq = 0;
+    memcpy(frame, &perf->cur, sizeof(*frame));
+    android_memory_barrier();
+    frame->seq = seq;
+    android_atomic_release_store(seq, &ring->seq);
+}
+
+/* copy up to max frames, newest last; returns the number copied */
+static int hwc_perf_snapshot(struct hwc_perf_ring_t *ring,
+        struct hwc_perf_frame_t *out, int max)
+{
+    int32_t last = android_atomic_acquire_load(&ring->seq);
+    int32_t first = last - SEC_MIN(max, HWC_PERF_RING_SIZE) + 1;
+    int n = 0;
+
+    if (first < 1)
+        first = 1;
+
+    for (int32_t seq = first; seq <= last; seq++) {
+        struct hwc_perf_frame_t *frame = &ring->frame[seq & (HWC_PERF_RING_SIZE - 1)];
+
+        if (frame->seq != (uint32_t)seq)
+            continue;
+        android_memory_barrier();
+        memcpy(&out[n], frame, sizeof(*frame));
+        android_memory_barrier();
+        if (frame->seq != (uint32_t)seq)
+            continue;
+        n++;
+    }
+
+    return n;
+}
+
+int hwc_perf_dump(struct hwc_perf_t *perf, char *buff, int buff_len)
+{
+    struct hwc_perf_frame_t frames[HWC_PERF_RING_SIZE];
+    uint64_t prepare_sum = 0, set_sum = 0, fimc_sum = 0, wait_sum = 0;
+    uint32_t prepare_max = 0, set_max = 0, fimc_max = 0, wait_max = 0;
+    int overlay = 0, gles = 0, geometry = 0;
+    int64_t span;
+    int n, len;
+
+    if (perf->ring == NULL)
+        return 0;
+
+    n = hwc_perf_snapshot(perf->ring, frames, HWC_PERF_RING_SIZE);
+    if (n == 0)
+        return snprintf(buff, buff_len, "  perf: no frames\n");
+
+    for (int i = 0; i < n; i++) {
+        prepare_sum += frames[i].prepare_ns;
+        set_sum     += frames[i].set_ns;
+        fimc_sum    += frames[i].fimc_ns;
+        wait_sum    += frames[i].fimc_wait_ns;
+        prepare_max  = SEC_MAX(prepare_max, frames[i].prepare_ns);
+        set_max      = SEC_MAX(set_max, frames[i].set_ns);
+        fimc_max     = SEC_MAX(fimc_max, frames[i].fimc_ns);
+        wait_max     = SEC_MAX(wait_max, frames[i].fimc_wait_ns);
+        if (frames[i].overlay_mask)
+            overlay++;
+        if (frames[i].flags & HWC_PERF_GLES_SWAP)
+            gles++;
+        if (frames[i].flags & HWC_PERF_GEOMETRY_CHANGED)
+            geometry++;
+    }
+
+    span = frames[n - 1].timestamp - frames[0].timestamp;
+
+    len = snprintf(buff, buff_len,
+            "  perf: %d frames (total %d), %lld.%01lld fps\n"
+            "    prepare avg %llu us, max %u us\n"
+            "    set     avg %llu us, max %u us\n"
+            "    fimc    avg %llu us, max %u us\n"
+            "    wait    avg %llu us, max %u us\n"
+            "    frames with overlay %d, with gles swap %d, geometry changes %d\n",
+            n, perf->ring->seq,
+            span > 0 ? (n - 1) * 1000000000LL / span : 0LL,
+            span > 0 ? ((n - 1) * 10000000000LL / span) % 10 : 0LL,
+            prepare_sum / n / 1000, prepare_max / 1000,
+            set_sum / n / 1000, set_max / 1000,
+            fimc_sum / n / 1000, fimc_max / 1000,
+            wait_sum / n / 1000, wait_max / 1000,
+            overlay, gles, geometry);
+
+    if (0 <= perf->sock_fd && len < buff_len)
+        len += snprintf(buff + len, buff_len - len,
+                "    snapshot: socket @%s (ashmem, %u bytes, version %u)\n",
+                HWC_PERF_SOCKET, (unsigned)sizeof(struct hwc_perf_ring_t),
+                HWC_PERF_VERSION);
+
+    for (int i = SEC_MAX(n - HWC_PERF_DUMP_FRAMES, 0); i < n && len < buff_len; i++) {
+        len += snprintf(buff + len, buff_len - len,
+                "    #%u: prepare %u us, set %u us, fimc %u us x%u, wait %u us, "
+                "layers %u, overlay 0x%x%s%s\n",
+                frames[i].seq, frames[i].prepare_ns / 1000, frames[i].set_ns / 1000,
+                frames[i].fimc_ns / 1000, frames[i].num_fimc,
+                frames[i].fimc_wait_ns / 1000,
+                frames[i].num_layers, frames[i].overlay_mask,
+                (frames[i].flags & HWC_PERF_GLES_SWAP) ? ", swap" : "",
+                (frames[i].flags & HWC_PERF_GEOMETRY_CHANGED) ? ", geometry" : "");
+    }
+
+    return len;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project <http://www.cyanogenmod.org>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_SEC_HWC_PERF_H_
+#define ANDROID_SEC_HWC_PERF_H_
+
+#include <stdint.h>
+
+#define HWC_PERF_SOCKET           "hwc_perf"      /* abstract namespace */
+#define HWC_PERF_MAGIC            (0x50435748)    /* "HWCP" */
+#define HWC_PERF_VERSION          (2)
+#define HWC_PERF_RING_SIZE        (128)           /* must be a power of 2 */
+
+enum {
+    HWC_PERF_GEOMETRY_CHANGED = 0x1,
+    HWC_PERF_GLES_SWAP        = 0x2,
+};
+
+struct hwc_perf_frame_t {
+    uint32_t   seq;
+    uint32_t   flags;
+    int64_t    timestamp;      /* start of hwc_prepare */
+    uint32_t   prepare_ns;
+    uint32_t   set_ns;
+    uint32_t   fimc_ns;        /* configuration and queueing */
+    uint32_t   fimc_wait_ns;   /* waiting for the conversion to complete */
+    uint32_t   overlay_mask;   /* bit n : layer n went to an overlay */
+    uint16_t   num_layers;
+    uint16_t   num_fimc;
+};
+
+/*
+ * layout of the "hwc_perf" ashmem region. A client connecting to the
+ * abstract unix socket HWC_PERF_SOCKET is sent the region's fd and can
+ * only map it read-only; it checks each slot's seq against the frame it
+ * expects, like dump() does.
+ */
+struct hwc_perf_ring_t {
+    uint32_t         magic;
+    uint32_t         version;
+    uint32_t         entry_size;
+    uint32_t         size;
+    volatile int32_t seq;      /* last published frame */
+    uint32_t         reserved;
+    struct hwc_perf_frame_t frame[HWC_PERF_RING_SIZE];
+};
+
+#endif /* ANDROID_SEC_HWC_PERF_H_ */
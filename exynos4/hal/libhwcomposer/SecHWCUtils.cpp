@@ -30,40 +30,6 @@
 
 #define EXYNOS4_ALIGN( value, base ) (((value) + ((base) - 1)) & ~((base) - 1))
 
-//#define CHECK_FPS
-#ifdef CHECK_FPS
-#include <sys/time.h>
-#include <unistd.h>
-#define CHK_FRAME_CNT 57
-
-void check_fps()
-{
-    static struct timeval tick, tick_old;
-    static int total = 0;
-    static int cnt = 0;
-    int FPS;
-    cnt++;
-    gettimeofday(&tick, NULL);
-    if (cnt > 10) {
-        if (tick.tv_sec > tick_old.tv_sec)
-            total += ((tick.tv_usec/1000) + (tick.tv_sec - tick_old.tv_sec)*1000 - (tick_old.tv_usec/1000));
-        else
-            total += ((tick.tv_usec - tick_old.tv_usec)/1000);
-
-        memcpy(&tick_old, &tick, sizeof(timeval));
-        if (cnt == (10 + CHK_FRAME_CNT)) {
-            FPS = 1000*CHK_FRAME_CNT/total;
-            ALOGE("[FPS]:%d\n", FPS);
-            total = 0;
-            cnt = 10;
-        }
-    } else {
-        memcpy(&tick_old, &tick, sizeof(timeval));
-        total = 0;
-    }
-}
-#endif
-
 struct yuv_fmt_list yuv_list[] = {
     { "V4L2_PIX_FMT_NV12",      "YUV420/2P/LSB_CBCR",   V4L2_PIX_FMT_NV12,     12, 2 },
     { "V4L2_PIX_FMT_NV12T",     "YUV420/2P/LSB_CBCR",   V4L2_PIX_FMT_NV12T,    12, 2 },
@@ -516,37 +482,6 @@ int fimc_v4l2_S_ctrl(int fd)
     return 0;
 }
 
-int fimc_handle_oneshot(int fd, struct fimc_buf *fimc_src_buf, struct fimc_buf *fimc_dst_buf)
-{
-#ifdef CHECK_FPS
-    check_fps();
-#endif
-
-    if (fimc_v4l2_stream_on(fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_stream_on()");
-        return -5;
-    }
-
-    if (fimc_v4l2_queue(fd, fimc_src_buf, V4L2_BUF_TYPE_OUTPUT, 0) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_queue()");
-        goto STREAM_OFF;
-    }
-    if (fimc_v4l2_dequeue(fd, fimc_src_buf, V4L2_BUF_TYPE_OUTPUT) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_dequeue()");
-        return -6;
-    }
-STREAM_OFF:
-    if (fimc_v4l2_stream_off(fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC  v4l2_stream_off()");
-        return -8;
-    }
-    if (fimc_v4l2_clr_buf(fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_clr_buf()");
-        return -10;
-    }
-    return 0;
-}
-
 static int memcpy_rect(void *dst, void *src, int fullW, int fullH, int realW, int realH, int format)
 {
     unsigned char *srcCb, *srcCr;
@@ -916,7 +851,177 @@ static unsigned int get_yuv_planes(unsigned int fmt)
         return yuv_list[sel].planes;
 }
 
-static int runFimcCore(struct hwc_context_t *ctx,
+static int fimc_v4l2_set_dst_addr(int fd, s5p_fimc_img_info *dst, unsigned int addr)
+{
+    struct v4l2_framebuffer fbuf;
+
+    if (ioctl(fd, VIDIOC_G_FBUF, &fbuf) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "%s::Error in video VIDIOC_G_FBUF", __func__);
+        return -1;
+    }
+
+    fbuf.base            = (void *)addr;
+    fbuf.fmt.width       = dst->full_width;
+    fbuf.fmt.height      = dst->full_height;
+    fbuf.fmt.pixelformat = dst->color_space;
+
+    if (ioctl(fd, VIDIOC_S_FBUF, &fbuf) < 0)
+        return -1;
+
+    return 0;
+}
+
+static bool fimc_img_geometry_equal(s5p_fimc_img_info *a, s5p_fimc_img_info *b)
+{
+    return a->full_width  == b->full_width  &&
+           a->full_height == b->full_height &&
+           a->start_x     == b->start_x     &&
+           a->start_y     == b->start_y     &&
+           a->width       == b->width       &&
+           a->height      == b->height      &&
+           a->color_space == b->color_space;
+}
+
+int hwc_fimc_session_complete(struct hwc_context_t *ctx)
+{
+    struct hwc_fimc_session_t *session = &ctx->fimc_session;
+    int ret = 0;
+
+    if (!session->in_flight)
+        return 0;
+
+    if (fimc_v4l2_dequeue(ctx->fimc.dev_fd, &session->src_buf, V4L2_BUF_TYPE_OUTPUT) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_dequeue() win %d", session->win_idx);
+        session->failed_mask |= (1 << session->win_idx);
+        ret = -1;
+    }
+    session->in_flight = 0;
+    hwc_perf_add_fimc_wait(&ctx->perf, hwc_get_time_ns() - session->submit_time);
+
+    if (ret < 0)
+        hwc_fimc_session_stop(ctx);
+
+    return ret;
+}
+
+int hwc_fimc_session_stop(struct hwc_context_t *ctx)
+{
+    struct hwc_fimc_session_t *session = &ctx->fimc_session;
+    int fd = ctx->fimc.dev_fd;
+    int ret = 0;
+
+    if (!session->streaming)
+        return 0;
+
+    if (session->in_flight) {
+        fimc_v4l2_dequeue(fd, &session->src_buf, V4L2_BUF_TYPE_OUTPUT);
+        session->in_flight = 0;
+    }
+
+    if (fimc_v4l2_stream_off(fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC  v4l2_stream_off()");
+        ret = -1;
+    }
+    fimc_v4l2_clr_buf(fd, V4L2_BUF_TYPE_OUTPUT);
+    session->streaming = 0;
+
+    return ret;
+}
+
+static int fimc_session_configure(struct hwc_context_t *ctx,
+        int rotation, int hflip, int vflip, unsigned int dst_addr)
+{
+    struct hwc_fimc_session_t *session = &ctx->fimc_session;
+    s5p_fimc_t *fimc = &ctx->fimc;
+    s5p_fimc_params_t *params = &fimc->params;
+
+    /*
+     * The single source slot must be free before it is reused. A failure
+     * here belongs to the previous window, it is in failed_mask and the
+     * stream has been stopped, so this one is set up from scratch.
+     */
+    hwc_fimc_session_complete(ctx);
+
+    if (session->streaming &&
+        fimc_img_geometry_equal(&session->src, &params->src) &&
+        fimc_img_geometry_equal(&session->dst, &params->dst) &&
+        session->rotation == rotation &&
+        session->hflip == hflip && session->vflip == vflip) {
+        if (session->dst_addr == dst_addr)
+            return 0;
+
+        /*
+         * The overlay base is only taken at STREAMON; an S_FBUF while
+         * streaming is accepted but the next frame still lands in the old
+         * buffer. Retarget the way libfimc does: STREAMOFF, S_FBUF and
+         * STREAMON, keeping the formats, crop and buffers.
+         */
+        if (fimc_v4l2_stream_off(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT) < 0 ||
+            fimc_v4l2_set_dst_addr(fimc->dev_fd, &params->dst, dst_addr) < 0 ||
+            fimc_v4l2_stream_on(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
+            SEC_HWC_Log(HWC_LOG_ERROR, "%s::dst retarget failed", __func__);
+            fimc_v4l2_clr_buf(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT);
+            session->streaming = 0;
+            return -1;
+        }
+        session->dst_addr = dst_addr;
+        session->restarts++;
+        return 0;
+    }
+
+    session->reconfigs++;
+    hwc_fimc_session_stop(ctx);
+
+   /* Set configuration related to destination (DMA-OUT)
+     *   - set input format & size
+     *   - crop input size
+     *   - set input buffer
+     *   - set buffer type (V4L2_MEMORY_USERPTR)
+     */
+    if (fimc_v4l2_set_dst(fimc->dev_fd, &params->dst, rotation, hflip, vflip, dst_addr) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "fimc_v4l2_set_dst is failed\n");
+        return -1;
+    }
+
+   /* Set configuration related to source (DMA-INPUT)
+     *   - set input format & size
+     *   - crop input size
+     *   - set input buffer
+     *   - set buffer type (V4L2_MEMORY_USERPTR)
+     */
+    if (fimc_v4l2_set_src(fimc->dev_fd, fimc->hw_ver, &params->src) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "fimc_v4l2_set_src is failed\n");
+        return -1;
+    }
+
+    if (fimc_v4l2_stream_on(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT) < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "Fail : SRC v4l2_stream_on()");
+        fimc_v4l2_clr_buf(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT);
+        return -1;
+    }
+
+    session->src       = params->src;
+    session->dst       = params->dst;
+    session->rotation  = rotation;
+    session->hflip     = hflip;
+    session->vflip     = vflip;
+    session->dst_addr  = dst_addr;
+    session->streaming = 1;
+
+    return 0;
+}
+
+int hwc_fimc_session_dump(struct hwc_context_t *ctx, char *buff, int buff_len)
+{
+    struct hwc_fimc_session_t *session = &ctx->fimc_session;
+
+    return snprintf(buff, buff_len,
+            "  fimc: %s, frames %u, reconfigs %u, dst restarts %u\n",
+            session->streaming ? "streaming" : "idle",
+            session->frames, session->reconfigs, session->restarts);
+}
+
+static int runFimcCore(struct hwc_context_t *ctx, int win_idx,
         unsigned int src_phys_addr, sec_img *src_img, sec_rect *src_rect,
         uint32_t src_color_space,
         unsigned int dst_phys_addr, sec_img *dst_img, sec_rect *dst_rect,
@@ -924,8 +1029,9 @@ static int runFimcCore(struct hwc_context_t *ctx,
 {
     s5p_fimc_t        * fimc = &ctx->fimc;
     s5p_fimc_params_t * params = &(fimc->params);
+    struct hwc_fimc_session_t *session = &ctx->fimc_session;
 
-    struct fimc_buf fimc_src_buf;
+    struct fimc_buf *fimc_src_buf;
     int src_bpp, src_planes;
 
     unsigned int    frame_size = 0;
@@ -1058,32 +1164,18 @@ static int runFimcCore(struct hwc_context_t *ctx,
         return -1;
     }
 
-   /* 3. Set configuration related to destination (DMA-OUT)
-     *   - set input format & size
-     *   - crop input size
-     *   - set input buffer
-     *   - set buffer type (V4L2_MEMORY_USERPTR)
-     */
-
-    if (fimc_v4l2_set_dst(fimc->dev_fd, &params->dst, rotate_value, hflip, vflip, dst_phys_addr) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "fimc_v4l2_set_dst is failed\n");
-        return -1;
-    }
-
-   /* 4. Set configuration related to source (DMA-INPUT)
-     *   - set input format & size
-     *   - crop input size
-     *   - set input buffer
-     *   - set buffer type (V4L2_MEMORY_USERPTR)
+    /* 3. Program the conversion unless the running session already matches
+     *    - a change of dst address alone is a STREAMOFF/S_FBUF/STREAMON
      */
-    if (fimc_v4l2_set_src(fimc->dev_fd, fimc->hw_ver, &params->src) < 0) {
-        SEC_HWC_Log(HWC_LOG_ERROR, "fimc_v4l2_set_src is failed\n");
+    if (fimc_session_configure(ctx, rotate_value, hflip, vflip, dst_phys_addr) < 0)
         return -1;
-    }
 
-    /* 5. Set input dma address (Y/RGB, Cb, Cr)
+    /* 4. Set input dma address (Y/RGB, Cb, Cr)
      *    - zero copy : mfc, camera
      */
+    fimc_src_buf = &session->src_buf;
+    memset(fimc_src_buf, 0, sizeof(*fimc_src_buf));
+
     switch (src_img->format) {
     case HAL_PIXEL_FORMAT_CUSTOM_YCbCr_420_SP:
     case HAL_PIXEL_FORMAT_CUSTOM_YCrCb_420_SP:
@@ -1091,8 +1183,8 @@ static int runFimcCore(struct hwc_context_t *ctx,
     case HAL_PIXEL_FORMAT_CUSTOM_YCbCr_422_SP:
     case HAL_PIXEL_FORMAT_CUSTOM_YCrCb_422_SP:
         /* for video contents zero copy case */
-        fimc_src_buf.base[0] = params->src.buf_addr_phy_rgb_y;
-        fimc_src_buf.base[1] = params->src.buf_addr_phy_cb;
+        fimc_src_buf->base[0] = params->src.buf_addr_phy_rgb_y;
+        fimc_src_buf->base[1] = params->src.buf_addr_phy_cb;
         break;
 
     case HAL_PIXEL_FORMAT_CUSTOM_YCbCr_422_I:
@@ -1107,30 +1199,32 @@ static int runFimcCore(struct hwc_context_t *ctx,
         }
 
         if (src_img->usage & GRALLOC_USAGE_HW_FIMC1) {
-            fimc_src_buf.base[0] = params->src.buf_addr_phy_rgb_y;
+            fimc_src_buf->base[0] = params->src.buf_addr_phy_rgb_y;
             if (src_cbcr_order == true) {
-                fimc_src_buf.base[1] = params->src.buf_addr_phy_cb;
-                fimc_src_buf.base[2] = params->src.buf_addr_phy_cr;
+                fimc_src_buf->base[1] = params->src.buf_addr_phy_cb;
+                fimc_src_buf->base[2] = params->src.buf_addr_phy_cr;
             }
             else {
-                fimc_src_buf.base[2] = params->src.buf_addr_phy_cb;
-                fimc_src_buf.base[1] = params->src.buf_addr_phy_cr;
+                fimc_src_buf->base[2] = params->src.buf_addr_phy_cb;
+                fimc_src_buf->base[1] = params->src.buf_addr_phy_cr;
             }
             SEC_HWC_Log(HWC_LOG_DEBUG,
                     "runFimcCore - Y=0x%X, U=0x%X, V=0x%X\n",
-                    fimc_src_buf.base[0], fimc_src_buf.base[1],fimc_src_buf.base[2]);
+                    fimc_src_buf->base[0], fimc_src_buf->base[1],fimc_src_buf->base[2]);
             break;
         }
     }
 
-    /* 6. Run FIMC
-     *    - stream on => queue => dequeue => stream off => clear buf
-     */
-    if (fimc_handle_oneshot(fimc->dev_fd, &fimc_src_buf, NULL) < 0) {
-        ALOGE("fimcrun fail");            
-        fimc_v4l2_clr_buf(fimc->dev_fd, V4L2_BUF_TYPE_OUTPUT);
+    /* 5. Queue the frame, hwc_fimc_session_complete() collects it */
+    if (fimc_v4l2_queue(fimc->dev_fd, fimc_src_buf, V4L2_BUF_TYPE_OUTPUT, 0) < 0) {
+        ALOGE("fimcrun fail");
+        hwc_fimc_session_stop(ctx);
         return -1;
     }
+    session->in_flight   = 1;
+    session->win_idx     = win_idx;
+    session->submit_time = hwc_get_time_ns();
+    session->frames++;
 
     return 0;
 }
@@ -1210,7 +1304,7 @@ int destroyFimc(s5p_fimc_t *fimc)
     return 0;
 }
 
-int runFimc(struct hwc_context_t *ctx,
+int runFimc(struct hwc_context_t *ctx, int win_idx,
             struct sec_img *src_img, struct sec_rect *src_rect,
             struct sec_img *dst_img, struct sec_rect *dst_rect,
             uint32_t transform)
@@ -1222,6 +1316,8 @@ int runFimc(struct hwc_context_t *ctx,
     int          rotate_value   = 0;
     int32_t      src_color_space;
     int32_t      dst_color_space;
+    int64_t      start;
+    int          ret;
 
     /* 1. source address and size */
     src_phys_addr = get_src_phys_addr(ctx, src_img, src_rect);
@@ -1242,9 +1338,12 @@ int runFimc(struct hwc_context_t *ctx,
         return -4;
 
     /* 4. FIMC: src_rect of src_img => dst_rect of dst_img */
-    if (runFimcCore(ctx, src_phys_addr, src_img, src_rect,
+    start = hwc_get_time_ns();
+    ret = runFimcCore(ctx, win_idx, src_phys_addr, src_img, src_rect,
                 (uint32_t)src_color_space, dst_phys_addr, dst_img, dst_rect,
-                (uint32_t)dst_color_space, transform) < 0)
+                (uint32_t)dst_color_space, transform);
+    hwc_perf_add_fimc(&ctx->perf, hwc_get_time_ns() - start);
+    if (ret < 0)
         return -5;
 
     return 0;
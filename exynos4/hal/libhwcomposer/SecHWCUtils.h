@@ -41,11 +41,14 @@
 #include <sys/mman.h>
 #include <sys/resource.h>
 #include <hardware/gralloc.h>
+#include <pthread.h>
+#include <time.h>
 
 #include "linux/fb.h"
 
 #include "s3c_lcd.h"
 #include "sec_format.h"
+#include "SecHWCPerf.h"
 
 //#define HWC_DEBUG 1
 #if defined(BOARD_USES_FIMGAPI)
@@ -114,6 +117,14 @@ inline int SEC_MAX(int x, int y)
     return ((x > y) ? x : y);
 }
 
+inline int64_t hwc_get_time_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 struct hwc_win_info_t {
     int        fd;
     int        size;
@@ -143,6 +154,68 @@ enum {
     HWC_VIRT_MEM_TYPE,
 };
 
+/* vsync period reported until the model has locked on the panel */
+#define HWC_VSYNC_DEFAULT_PERIOD  (1000000000LL / 57)
+
+struct hwc_vsync_info_t {
+    volatile int32_t enabled;
+    /* set on enable, the vsync thread restarts the model on the next sample */
+    volatile int32_t reset;
+    int        sysfs_fd;
+    uint32_t   uevent_hash;
+    int        uevent_len;
+
+    /* refresh period model */
+    int64_t    period;
+    int64_t    last_timestamp;
+    int64_t    predicted;
+    int        locked;
+    int        lock_count;
+
+    /* statistics, reported through dump() */
+    uint64_t   count;
+    uint64_t   suppressed;
+    uint64_t   missed;
+    uint64_t   synthesized;
+    uint64_t   jitter_samples;
+    int64_t    jitter_sum;
+    int64_t    jitter_max;
+};
+
+/*
+ * FIMC is kept streaming across frames while the conversion setup is
+ * unchanged; a frame is queued from runFimc and collected later by
+ * hwc_fimc_session_complete, so it overlaps with the GLES swap.
+ */
+struct hwc_fimc_session_t {
+    int                 streaming;
+    int                 in_flight;
+    int                 win_idx;          /* window of the frame in flight */
+    int                 failed_mask;      /* windows whose conversion failed */
+    s5p_fimc_img_info   src;
+    s5p_fimc_img_info   dst;
+    int                 rotation;
+    int                 hflip;
+    int                 vflip;
+    unsigned int        dst_addr;
+    struct fimc_buf     src_buf;
+    int64_t             submit_time;
+
+    uint32_t            frames;
+    uint32_t            reconfigs;
+    uint32_t            restarts;         /* dst changes, see configure */
+};
+
+#define HWC_PERF_DUMP_FRAMES      (8)
+
+struct hwc_perf_t {
+    struct hwc_perf_ring_t  *ring;
+    int                      ashmem_fd;
+    int                      sock_fd;     /* HWC_PERF_SOCKET, -1 if not published */
+    pthread_t                publisher;
+    struct hwc_perf_frame_t  cur;
+};
+
 #ifdef SKIP_DUMMY_UI_LAY_DRAWING
 struct hwc_ui_lay_info{
     uint32_t   layer_prev_buf;
@@ -168,9 +241,12 @@ struct hwc_context_t {
 
     struct fb_var_screeninfo  lcd_info;
     s5p_fimc_t                fimc;
+    struct hwc_fimc_session_t fimc_session;
     hwc_procs_t               *procs;
     pthread_t                 uevent_thread;
     pthread_t                 vsync_thread;
+    struct hwc_vsync_info_t   vsync;
+    struct hwc_perf_t         perf;
 
     int                       num_of_fb_layer;
     int                       num_of_hwc_layer;
@@ -283,10 +359,29 @@ int window_get_global_lcd_info(struct hwc_context_t *ctx);
 
 int createFimc (s5p_fimc_t *fimc);
 int destroyFimc(s5p_fimc_t *fimc);
-int runFimc(struct hwc_context_t *ctx,
+int runFimc(struct hwc_context_t *ctx, int win_idx,
 	    struct sec_img *src_img, struct sec_rect *src_rect,
 	    struct sec_img *dst_img, struct sec_rect *dst_rect,
 	    uint32_t transform);
+int hwc_fimc_session_complete(struct hwc_context_t *ctx);
+int hwc_fimc_session_stop(struct hwc_context_t *ctx);
+int hwc_fimc_session_dump(struct hwc_context_t *ctx, char *buff, int buff_len);
 int check_yuv_format(unsigned int color_format);
 
+int  hwc_perf_init         (struct hwc_perf_t *perf);
+void hwc_perf_deinit       (struct hwc_perf_t *perf);
+void hwc_perf_prepare_start(struct hwc_perf_t *perf, int64_t now);
+void hwc_perf_prepare_end  (struct hwc_perf_t *perf, hwc_display_contents_1_t *list, int64_t now);
+void hwc_perf_add_fimc     (struct hwc_perf_t *perf, int64_t ns);
+void hwc_perf_add_fimc_wait(struct hwc_perf_t *perf, int64_t ns);
+void hwc_perf_add_swap     (struct hwc_perf_t *perf);
+void hwc_perf_set_end      (struct hwc_perf_t *perf, int64_t start, int64_t now);
+int  hwc_perf_dump         (struct hwc_perf_t *perf, char *buff, int buff_len);
+
+void    hwc_vsync_init       (struct hwc_vsync_info_t *vsync);
+void    hwc_vsync_set_enabled(struct hwc_vsync_info_t *vsync, int enabled);
+int64_t hwc_vsync_get_period (struct hwc_vsync_info_t *vsync);
+int     hwc_vsync_dump       (struct hwc_vsync_info_t *vsync, char *buff, int buff_len);
+void   *hwc_vsync_thread     (void *data);
+
 #endif /* ANDROID_SEC_HWC_UTILS_H_*/
@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project <http://www.cyanogenmod.org>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * VSYNC dispatcher for the exynos4 hwcomposer.
+ *
+ * Timestamps come either from the s3cfb uevent or from the vsync_time
+ * sysfs node (SYSFS_VSYNC_NOTIFICATION). Every sample is fed into a
+ * small phase-locked model of the refresh period, which is used to
+ * count missed interrupts, measure jitter and to synthesize a timestamp
+ * when the kernel hands us a bogus one.
+ */
+
+#include <cutils/atomic.h>
+
+#include <hardware_legacy/uevent.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+#include "SecHWCUtils.h"
+
+#define VSYNC_UEVENT_PATH   "change@/devices/platform/samsung-pd.2/s3cfb.0"
+#define VSYNC_SYSFS_PATH    "/sys/devices/platform/samsung-pd.2/s3cfb.0/vsync_time"
+#define VSYNC_UEVENT_KEY    "VSYNC="
+
+/* loop gain of the period filter is 1 / (1 << HWC_VSYNC_PLL_SHIFT) */
+#define HWC_VSYNC_PLL_SHIFT     (4)
+/* consecutive in-phase samples before the model is considered locked */
+#define HWC_VSYNC_LOCK_COUNT    (8)
+
+static uint32_t vsync_hash(const char *s, int *len)
+{
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+    const char *p = s;
+
+    while (*p) {
+        hash ^= (unsigned char)*p++;
+        hash *= 16777619u;
+    }
+    *len = p - s;
+
+    return hash;
+}
+
+static uint64_t vsync_parse(const char *s)
+{
+    uint64_t val = 0;
+
+    while (*s >= '0' && *s <= '9')
+        val = val * 10 + (*s++ - '0');
+
+    return val;
+}
+
+static inline int64_t vsync_abs(int64_t v)
+{
+    return (v < 0) ? -v : v;
+}
+
+void hwc_vsync_init(struct hwc_vsync_info_t *vsync)
+{
+    memset(vsync, 0, sizeof(*vsync));
+
+    vsync->sysfs_fd    = -1;
+    vsync->uevent_hash = vsync_hash(VSYNC_UEVENT_PATH, &vsync->uevent_len);
+    vsync->period      = HWC_VSYNC_DEFAULT_PERIOD;
+}
+
+void hwc_vsync_set_enabled(struct hwc_vsync_info_t *vsync, int enabled)
+{
+    /*
+     * No interrupts arrive while vsync is off : the gap must not count as
+     * missed vsyncs nor pull the period estimate.
+     */
+    if (enabled && !android_atomic_acquire_load(&vsync->enabled))
+        android_atomic_release_store(1, &vsync->reset);
+
+    android_atomic_release_store(!!enabled, &vsync->enabled);
+}
+
+int64_t hwc_vsync_get_period(struct hwc_vsync_info_t *vsync)
+{
+    if (!vsync->locked)
+        return HWC_VSYNC_DEFAULT_PERIOD;
+
+    return vsync->period;
+}
+
+/*
+ * Feed one hardware timestamp into the model and return the timestamp to
+ * report, or 0 if the sample has to be dropped.
+ */
+static int64_t vsync_update_model(struct hwc_vsync_info_t *vsync, int64_t timestamp)
+{
+    int64_t delta, err, n;
+    int synthesized = 0;
+
+    if (android_atomic_and(0, &vsync->reset)) {
+        /* keep the learnt period, but lock on the panel again */
+        vsync->last_timestamp = 0;
+        vsync->predicted = 0;
+        vsync->locked = 0;
+        vsync->lock_count = 0;
+    }
+
+    if (timestamp <= vsync->last_timestamp) {
+        /* unparsable or stale sample : fall back to the prediction */
+        if (!vsync->locked)
+            return 0;
+        timestamp = vsync->predicted;
+        vsync->synthesized++;
+        synthesized = 1;
+    }
+
+    if (vsync->last_timestamp == 0) {
+        vsync->last_timestamp = timestamp;
+        vsync->predicted = timestamp + vsync->period;
+        return timestamp;
+    }
+
+    delta = timestamp - vsync->last_timestamp;
+    n = (delta + (vsync->period >> 1)) / vsync->period;
+    if (n < 1)
+        n = 1;
+    if (n > 1)
+        vsync->missed += n - 1;
+
+    err = delta - n * vsync->period;
+    vsync->period += err / (n << HWC_VSYNC_PLL_SHIFT);
+
+    if (vsync->period < (HWC_VSYNC_DEFAULT_PERIOD >> 1) ||
+        vsync->period > (HWC_VSYNC_DEFAULT_PERIOD << 1)) {
+        SEC_HWC_Log(HWC_LOG_WARNING, "%s::period %lld out of range, resetting",
+                __func__, vsync->period);
+        vsync->period = HWC_VSYNC_DEFAULT_PERIOD;
+        vsync->locked = 0;
+        vsync->lock_count = 0;
+    }
+
+    err = vsync_abs(err);
+    if (!synthesized) {
+        /* a predicted sample has no jitter of its own */
+        vsync->jitter_samples++;
+        vsync->jitter_sum += err;
+        if (err > vsync->jitter_max)
+            vsync->jitter_max = err;
+    }
+
+    if (err < (vsync->period >> 3)) {
+        if (vsync->lock_count < HWC_VSYNC_LOCK_COUNT)
+            vsync->lock_count++;
+        else
+            vsync->locked = 1;
+    } else {
+        vsync->lock_count = 0;
+    }
+
+    vsync->last_timestamp = timestamp;
+    vsync->predicted = timestamp + vsync->period;
+
+    return timestamp;
+}
+
+static void vsync_dispatch(struct hwc_context_t *ctx, int64_t timestamp)
+{
+    struct hwc_vsync_info_t *vsync = &ctx->vsync;
+
+    timestamp = vsync_update_model(vsync, timestamp);
+    if (timestamp == 0)
+        return;
+
+    vsync->count++;
+
+    if (!android_atomic_acquire_load(&vsync->enabled) ||
+        !ctx->procs || !ctx->procs->vsync) {
+        vsync->suppressed++;
+        return;
+    }
+
+    ctx->procs->vsync(ctx->procs, 0, timestamp);
+}
+
+#ifdef SYSFS_VSYNC_NOTIFICATION
+void *hwc_vsync_thread(void *data)
+{
+    struct hwc_context_t *ctx = (struct hwc_context_t *)data;
+    struct hwc_vsync_info_t *vsync = &ctx->vsync;
+    char buf[32];
+    fd_set exceptfds;
+    ssize_t len;
+
+    prctl(PR_SET_NAME, (unsigned long)"hwcVsyncThread", 0, 0, 0);
+    setpriority(PRIO_PROCESS, 0, HAL_PRIORITY_URGENT_DISPLAY);
+
+    vsync->sysfs_fd = open(VSYNC_SYSFS_PATH, O_RDONLY);
+    if (vsync->sysfs_fd < 0) {
+        SEC_HWC_Log(HWC_LOG_ERROR, "%s::open(%s) fail : %s",
+                __func__, VSYNC_SYSFS_PATH, strerror(errno));
+        return NULL;
+    }
+
+    SEC_HWC_Log(HWC_LOG_DEBUG, "Using sysfs mechanism for VSYNC notification");
+
+    while (true) {
+        len = pread(vsync->sysfs_fd, buf, sizeof(buf) - 1, 0);
+        if (len > 0) {
+            buf[len] = '\0';
+            vsync_dispatch(ctx, vsync_parse(buf));
+        }
+
+        FD_ZERO(&exceptfds);
+        FD_SET(vsync->sysfs_fd, &exceptfds);
+        select(vsync->sysfs_fd + 1, NULL, NULL, &exceptfds, NULL);
+    }
+
+    return NULL;
+}
+#else
+static int64_t vsync_uevent_timestamp(const char *buff, int len, int path_len)
+{
+    const char *s = buff + path_len + 1;
+    const int key_len = sizeof(VSYNC_UEVENT_KEY) - 1;
+
+    while (s - buff < len && *s) {
+        if (!strncmp(s, VSYNC_UEVENT_KEY, key_len))
+            return vsync_parse(s + key_len);
+        s += strlen(s) + 1;
+    }
+
+    return 0;
+}
+
+void *hwc_vsync_thread(void *data)
+{
+    struct hwc_context_t *ctx = (struct hwc_context_t *)data;
+    struct hwc_vsync_info_t *vsync = &ctx->vsync;
+    char uevent_desc[4096];
+    int len, path_len;
+
+    memset(uevent_desc, 0, sizeof(uevent_desc));
+    prctl(PR_SET_NAME, (unsigned long)"hwcVsyncThread", 0, 0, 0);
+    setpriority(PRIO_PROCESS, 0, HAL_PRIORITY_URGENT_DISPLAY);
+    uevent_init();
+
+    while (true) {
+        len = uevent_next_event(uevent_desc, sizeof(uevent_desc) - 2);
+        if (len <= 0)
+            continue;
+
+        if (vsync_hash(uevent_desc, &path_len) != vsync->uevent_hash ||
+            path_len != vsync->uevent_len ||
+            memcmp(uevent_desc, VSYNC_UEVENT_PATH, path_len))
+            continue;
+
+        vsync_dispatch(ctx, vsync_uevent_timestamp(uevent_desc, len, path_len));
+    }
+
+    return NULL;
+}
+#endif
+
+int hwc_vsync_dump(struct hwc_vsync_info_t *vsync, char *buff, int buff_len)
+{
+    int64_t jitter_avg = vsync->jitter_samples ?
+            vsync->jitter_sum / (int64_t)vsync->jitter_samples : 0;
+
+    return snprintf(buff, buff_len,
+            "  vsync: %s, %s, period %lld ns (%lld.%02lld Hz)\n"
+            "    events %llu, suppressed %llu, missed %llu, synthesized %llu\n"
+            "    jitter avg %lld ns, max %lld ns\n",
+            vsync->enabled ? "enabled" : "disabled",
+            vsync->locked ? "locked" : "unlocked",
+            vsync->period,
+            1000000000LL / vsync->period,
+            (100000000000LL / vsync->period) % 100,
+            vsync->count, vsync->suppressed, vsync->missed, vsync->synthesized,
+            jitter_avg, vsync->jitter_max);
+}
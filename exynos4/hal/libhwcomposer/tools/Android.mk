@@ -0,0 +1,12 @@
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SRC_FILES := hwc_perf_snapshot.c
+
+LOCAL_MODULE := hwc_perf_snapshot
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/..
+
+include $(BUILD_EXECUTABLE)
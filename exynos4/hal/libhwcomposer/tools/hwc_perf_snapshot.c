@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2012 The CyanogenMod Project <http://www.cyanogenmod.org>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Prints the newest frames of the hwcomposer's performance ring. The ring
+ * is mapped read-only from the fd handed out on HWC_PERF_SOCKET, the
+ * composer is not stopped or asked to format anything.
+ *
+ * usage: hwc_perf_snapshot [frames]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "SecHWCPerf.h"
+
+static int receive_ring_fd(void)
+{
+    struct sockaddr_un addr;
+    socklen_t len;
+    char data;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov;
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    int sock, fd = -1;
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+        return -1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path + 1, HWC_PERF_SOCKET);
+    len = offsetof(struct sockaddr_un, sun_path) + 1 + strlen(HWC_PERF_SOCKET);
+
+    if (connect(sock, (struct sockaddr *)&addr, len) < 0) {
+        perror("connect @" HWC_PERF_SOCKET);
+        close(sock);
+        return -1;
+    }
+
+    iov.iov_base = &data;
+    iov.iov_len = 1;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(sock, &msg, 0) == 1) {
+        cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg != NULL && cmsg->cmsg_level == SOL_SOCKET &&
+            cmsg->cmsg_type == SCM_RIGHTS)
+            memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+
+    close(sock);
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    struct hwc_perf_ring_t *ring;
+    struct hwc_perf_frame_t frame;
+    int32_t last, seq;
+    int frames = 16;
+    int fd;
+
+    if (argc > 1)
+        frames = atoi(argv[1]);
+    if (frames <= 0 || frames > HWC_PERF_RING_SIZE)
+        frames = HWC_PERF_RING_SIZE;
+
+    fd = receive_ring_fd();
+    if (fd < 0) {
+        fprintf(stderr, "no ring from @%s\n", HWC_PERF_SOCKET);
+        return 1;
+    }
+
+    ring = (struct hwc_perf_ring_t *)mmap(NULL, sizeof(*ring), PROT_READ,
+                                          MAP_SHARED, fd, 0);
+    close(fd);
+    if (ring == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+
+    if (ring->magic != HWC_PERF_MAGIC || ring->version != HWC_PERF_VERSION ||
+        ring->entry_size != sizeof(frame) || ring->size != HWC_PERF_RING_SIZE) {
+        fprintf(stderr, "unknown ring layout (magic 0x%x version %u)\n",
+                ring->magic, ring->version);
+        munmap(ring, sizeof(*ring));
+        return 1;
+    }
+
+    last = ring->seq;
+    __sync_synchronize();
+    for (seq = last - frames + 1; seq <= last; seq++) {
+        const struct hwc_perf_frame_t *slot = &ring->frame[seq & (HWC_PERF_RING_SIZE - 1)];
+
+        if (seq < 1 || slot->seq != (uint32_t)seq)
+            continue;
+        __sync_synchronize();
+        memcpy(&frame, slot, sizeof(frame));
+        __sync_synchronize();
+        if (slot->seq != (uint32_t)seq)
+            continue;   /* overwritten while copying */
+
+        printf("#%u: %lld ns, prepare %u us, set %u us, fimc %u us x%u, wait %u us, "
+               "layers %u, overlay 0x%x%s%s\n",
+               frame.seq, (long long)frame.timestamp,
+               frame.prepare_ns / 1000, frame.set_ns / 1000,
+               frame.fimc_ns / 1000, frame.num_fimc, frame.fimc_wait_ns / 1000,
+               frame.num_layers, frame.overlay_mask,
+               (frame.flags & HWC_PERF_GLES_SWAP) ? ", swap" : "",
+               (frame.flags & HWC_PERF_GEOMETRY_CHANGED) ? ", geometry" : "");
+    }
+
+    munmap(ring, sizeof(*ring));
+    return 0;
+}
@@ -24,6 +24,10 @@ LOCAL_SRC_FILES:= \
 LOCAL_SHARED_LIBRARIES:= liblog
 LOCAL_SHARED_LIBRARIES+= libdl
 
+ifeq ($(BOARD_JPEG_DRIVER_MULTI_INSTANCE),true)
+LOCAL_CFLAGS += -DJPEG_DRIVER_MULTI_INSTANCE
+endif
+
 LOCAL_MODULE_TAGS := eng
 
 LOCAL_MODULE:= libs5pjpeg
@@ -31,3 +35,5 @@ LOCAL_MODULE:= libs5pjpeg
 LOCAL_PRELINK_MODULE := false
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
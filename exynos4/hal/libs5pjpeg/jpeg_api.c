@@ -32,18 +32,88 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/time.h>
+#include <time.h>
 #include <signal.h>
 #include <math.h>
 #include <sys/poll.h>
+#include <pthread.h>
 
 #ifdef S5P_VMEM
 #include "s5p_vmem_api.h"
 #endif
 #include "jpeg_api.h"
 
-static struct jpeg_lib  *jpeg_ctx = NULL;
+#ifdef JPEG_DRIVER_MULTI_INSTANCE
+#define JPEG_SESSION_NUM    2   /* One per jpeg_test_mode */
+#else
+#define JPEG_SESSION_NUM    1
+#endif
+
+/* How long a deinitialised single instance handle keeps the device open */
+#ifndef JPEG_LEGACY_IDLE_MS
+#define JPEG_LEGACY_IDLE_MS 5000
+#endif
+
+/*
+ * Open and mapped device, shared by the handles of one mode (or all of
+ * them) and closed with the last of them.
+ */
+struct jpeg_session {
+    int opened;
+    int fd;
+#ifdef S5P_VMEM
+    int mem_fp;
+#endif
+    char *mmapped_addr;
+    int refs;
+    struct jpeg_lib *owner;     /* Handle using the buffers, NULL if free */
+#ifndef S5P_VMEM
+    char *buf[2][2];            /* [mode][in, out] as returned by the driver */
+#endif
+};
+
+static long jpeg_sys_ioctl(int fd, unsigned long req, void *arg)
+{
+    return ioctl(fd, req, arg);
+}
+
+static int jpeg_sys_open(const char *name, int flags)
+{
+    return open(name, flags);
+}
+
+static const struct jpeg_dev_ops jpeg_sys_ops = {
+    .open   = jpeg_sys_open,
+    .close  = close,
+    .ioctl  = jpeg_sys_ioctl,
+    .mmap   = mmap,
+    .munmap = munmap,
+};
+
+static pthread_mutex_t jpeg_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jpeg_cond = PTHREAD_COND_INITIALIZER;
+static struct jpeg_session jpeg_sessions[JPEG_SESSION_NUM];
+static const char *jpeg_dev_name = JPEG_DRIVER_NAME;
+static const struct jpeg_dev_ops *jpeg_ops = &jpeg_sys_ops;
+
+/*
+ * Handles behind the single instance API. Deinit only marks a handle idle,
+ * so a capture per init/deinit pair doesn't reopen and remap the device;
+ * jpeg_legacy_reaper() closes it once it has been idle JPEG_LEGACY_IDLE_MS,
+ * and jpeg_legacy_unload() when the library goes away. jpeg_legacy_lock
+ * is taken before jpeg_lock.
+ */
+static pthread_mutex_t jpeg_legacy_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t jpeg_legacy_cond = PTHREAD_COND_INITIALIZER;
+static pthread_once_t jpeg_legacy_once = PTHREAD_ONCE_INIT;
+static pthread_t jpeg_legacy_thread;
+static int jpeg_legacy_thread_ok;
+static int jpeg_legacy_exit;
+static struct jpeg_lib *jpeg_legacy[2];
+static int jpeg_legacy_busy[2];                 /* between init and deinit */
+static struct timespec jpeg_legacy_idle_end[2];
+
 #ifdef S5P_VMEM
-static int mem_fp;
 unsigned int cookie;
 #endif /* S5P_VMEM */
 
@@ -90,229 +160,278 @@ static int check_input_size(unsigned int width, unsigned int height)
     return 0;
 }
 
-static void init_decode_param(void)
+/* Returns the session for mode with a reference held, called with jpeg_lock */
+static struct jpeg_session *jpeg_session_get(enum jpeg_test_mode mode)
 {
-    jpeg_ctx = (struct jpeg_lib *)malloc(sizeof(struct jpeg_lib));
-    memset(jpeg_ctx, 0x00, sizeof(struct jpeg_lib));
+    struct jpeg_session *session = &jpeg_sessions[(JPEG_SESSION_NUM > 1) ? mode : 0];
 
-    jpeg_ctx->args.dec_param = (struct jpeg_dec_param *)malloc(sizeof(struct jpeg_dec_param));
-    memset(jpeg_ctx->args.dec_param, 0x00, sizeof(struct jpeg_dec_param));
-}
+    if (!session->opened) {
+        session->fd = jpeg_ops->open(jpeg_dev_name, O_RDWR);
+        if (session->fd < 0) {
+            ALOGE("JPEG driver open failed %d\n", session->fd);
+            return NULL;
+        }
 
-static void init_encode_param(void)
-{
-    jpeg_ctx = (struct jpeg_lib *)malloc(sizeof(struct jpeg_lib));
-    memset(jpeg_ctx, 0x00, sizeof(struct jpeg_lib));
+#ifdef S5P_VMEM
+        session->mem_fp = s5p_vmem_open();
+        ALOGV("s5p_vmem_open\n");
+#else
+        session->mmapped_addr = (char *)jpeg_ops->mmap(0,
+                            JPEG_TOTAL_BUF_SIZE,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            session->fd, 0);
+
+        if (session->mmapped_addr == MAP_FAILED || session->mmapped_addr == NULL) {
+            ALOGE("JPEG mmap failed\n");
+            jpeg_ops->close(session->fd);
+            session->mmapped_addr = NULL;
+            return NULL;
+        }
+        memset(session->buf, 0, sizeof(session->buf));
+        ALOGV("jpeg_session_get mmapped_addr %p\n", session->mmapped_addr);
+#endif /* S5P_VMEM */
+        session->opened = 1;
+    }
 
-    jpeg_ctx->args.enc_param = (struct jpeg_enc_param *)malloc(sizeof(struct jpeg_enc_param));
-    memset(jpeg_ctx->args.enc_param, 0x00, sizeof(struct jpeg_enc_param));
+    session->refs++;
+    return session;
 }
 
-int api_jpeg_decode_init()
+/* Drops a reference, the last one closes the device, called with jpeg_lock */
+static void jpeg_session_put(struct jpeg_session *session)
 {
-    init_decode_param();
-    jpeg_ctx->jpeg_fd = open(JPEG_DRIVER_NAME, O_RDWR);
-
-    if (jpeg_ctx->jpeg_fd < 0) {
-        ALOGE("JPEG driver open failed\n");
-        return -1;
-    }
+    if (--session->refs > 0)
+        return;
 
 #ifdef S5P_VMEM
-    mem_fp = s5p_vmem_open();
-    ALOGV("s5p_vmem_open\n");
+    s5p_vmem_close(session->mem_fp);
 #else
-    jpeg_ctx->args.mmapped_addr = (char *) mmap(0,
-                        JPEG_TOTAL_BUF_SIZE,
-                        PROT_READ | PROT_WRITE,
-                        MAP_SHARED,
-                        jpeg_ctx->jpeg_fd, 0);
-
-    if (jpeg_ctx->args.mmapped_addr == NULL) {
-        ALOGE("JPEG mmap failed\n");
-        return -1;
-    }
-    ALOGV("api_jpeg_decode_init jpeg_ctx->args.mmapped_addr 0x%08x\n",
-                                                jpeg_ctx->args.mmapped_addr);
-#endif /* S5P_VMEM */
+    jpeg_ops->munmap(session->mmapped_addr, JPEG_TOTAL_BUF_SIZE);
+    session->mmapped_addr = NULL;
+#endif
+    jpeg_ops->close(session->fd);
+    session->opened = 0;
+}
 
-    return jpeg_ctx->jpeg_fd;
+/* Waits until no other handle uses the session buffers and takes them */
+static void jpeg_claim(struct jpeg_lib *jpeg)
+{
+    struct jpeg_session *session = jpeg->session;
+
+    pthread_mutex_lock(&jpeg_lock);
+    while (session->owner != NULL && session->owner != jpeg)
+        pthread_cond_wait(&jpeg_cond, &jpeg_lock);
+    session->owner = jpeg;
+    pthread_mutex_unlock(&jpeg_lock);
 }
 
-int api_jpeg_encode_init()
+void api_jpeg_done(struct jpeg_lib *jpeg)
 {
-    init_encode_param();
-    jpeg_ctx->jpeg_fd = open(JPEG_DRIVER_NAME, O_RDWR);
+    if (jpeg == NULL)
+        return;
 
-    if (jpeg_ctx->jpeg_fd < 0) {
-        ALOGE("JPEG driver open failed %d\n", jpeg_ctx->jpeg_fd);
-        return -1;
+    pthread_mutex_lock(&jpeg_lock);
+    if (jpeg->session->owner == jpeg) {
+        jpeg->session->owner = NULL;
+        pthread_cond_broadcast(&jpeg_cond);
     }
+    pthread_mutex_unlock(&jpeg_lock);
+}
 
-#ifdef S5P_VMEM
-    mem_fp = s5p_vmem_open();
-    ALOGI("s5p_vmem_open\n");
-#else
+struct jpeg_lib *api_jpeg_open(enum jpeg_test_mode mode)
+{
+    struct jpeg_lib *jpeg;
 
-    jpeg_ctx->args.mmapped_addr = (char *) mmap(0,
-            JPEG_TOTAL_BUF_SIZE,
-            PROT_READ | PROT_WRITE,
-            MAP_SHARED,
-            jpeg_ctx->jpeg_fd, 0);
+    jpeg = (struct jpeg_lib *)calloc(1, sizeof(struct jpeg_lib));
+    if (jpeg == NULL)
+        return NULL;
 
-    if (jpeg_ctx->args.mmapped_addr == NULL) {
-        ALOGE("JPEG mmap failed\n");
-        return -1;
+    jpeg->mode = mode;
+    if (mode == decode_mode)
+        jpeg->args.dec_param = (struct jpeg_dec_param *)calloc(1, sizeof(struct jpeg_dec_param));
+    else
+        jpeg->args.enc_param = (struct jpeg_enc_param *)calloc(1, sizeof(struct jpeg_enc_param));
+
+    if (jpeg->args.dec_param == NULL && jpeg->args.enc_param == NULL) {
+        free(jpeg);
+        return NULL;
     }
-    ALOGV("api_jpeg_encode_init jpeg_ctx->args.mmapped_addr 0x%08x\n",
-                                                jpeg_ctx->args.mmapped_addr);
-#endif /* S5P_VMEM */
-    return jpeg_ctx->jpeg_fd;
+
+    pthread_mutex_lock(&jpeg_lock);
+    jpeg->session = jpeg_session_get(mode);
+    pthread_mutex_unlock(&jpeg_lock);
+
+    if (jpeg->session == NULL) {
+        free(jpeg->args.dec_param);
+        free(jpeg->args.enc_param);
+        free(jpeg);
+        return NULL;
+    }
+
+    jpeg->jpeg_fd = jpeg->session->fd;
+    jpeg->args.mmapped_addr = jpeg->session->mmapped_addr;
+
+    return jpeg;
 }
 
-int api_jpeg_decode_deinit(int dev_fd)
+#ifdef S5P_VMEM
+static void jpeg_free_shares(struct jpeg_lib *jpeg)
 {
-    if (jpeg_ctx->args.mmapped_addr != NULL)
-        munmap(jpeg_ctx->args.mmapped_addr, JPEG_TOTAL_BUF_SIZE);
+    if (jpeg->args.in_buf != NULL)
+        s5p_free_share(jpeg->session->mem_fp, jpeg->args.in_cookie, jpeg->args.in_buf);
+    if (jpeg->args.out_buf != NULL)
+        s5p_free_share(jpeg->session->mem_fp, jpeg->args.out_cookie, jpeg->args.out_buf);
+    jpeg->args.in_buf = NULL;
+    jpeg->args.out_buf = NULL;
+}
+#endif
+
+int api_jpeg_close(struct jpeg_lib *jpeg)
+{
+    if (jpeg == NULL)
+        return JPEG_FAIL;
 
 #ifdef S5P_VMEM
-    s5p_free_share(mem_fp, jpeg_ctx->args.in_cookie, jpeg_ctx->args.in_buf);
-    s5p_free_share(mem_fp, jpeg_ctx->args.out_cookie, jpeg_ctx->args.out_buf);
-    s5p_vmem_close(mem_fp);
+    jpeg_free_shares(jpeg);
 #endif
 
-    close(jpeg_ctx->jpeg_fd);
+    api_jpeg_done(jpeg);
 
-    if (jpeg_ctx->args.dec_param != NULL)
-        free(jpeg_ctx->args.dec_param);
+    pthread_mutex_lock(&jpeg_lock);
+    jpeg_session_put(jpeg->session);
+    pthread_mutex_unlock(&jpeg_lock);
 
-    free(jpeg_ctx);
+    free(jpeg->args.dec_param);
+    free(jpeg->args.enc_param);
+    free(jpeg);
 
     return JPEG_OK;
 }
 
-int api_jpeg_encode_deinit(int dev_fd)
+int api_jpeg_set_device(const char *name, const struct jpeg_dev_ops *ops)
 {
-    if (jpeg_ctx->args.mmapped_addr != NULL)
-        munmap(jpeg_ctx->args.mmapped_addr, JPEG_TOTAL_BUF_SIZE);
+    int i;
+    int ret = 0;
+
+    pthread_mutex_lock(&jpeg_lock);
+    for (i = 0; i < JPEG_SESSION_NUM; i++) {
+        if (jpeg_sessions[i].opened) {
+            ALOGE("%s: device already open\n", __func__);
+            ret = -1;
+            goto exit;
+        }
+    }
 
-#ifdef S5P_VMEM
-    s5p_free_share(mem_fp, jpeg_ctx->args.in_cookie, jpeg_ctx->args.in_buf);
-    s5p_free_share(mem_fp, jpeg_ctx->args.out_cookie, jpeg_ctx->args.out_buf);
-    s5p_vmem_close(mem_fp);
-#endif
-    close(jpeg_ctx->jpeg_fd);
+    jpeg_dev_name = name ? name : JPEG_DRIVER_NAME;
+    jpeg_ops = ops ? ops : &jpeg_sys_ops;
 
-    if (jpeg_ctx->args.enc_param != NULL)
-        free(jpeg_ctx->args.enc_param);
+exit:
+    pthread_mutex_unlock(&jpeg_lock);
+    return ret;
+}
 
-    free(jpeg_ctx);
+#ifndef S5P_VMEM
+/* The driver hands out fixed offsets of the mapping, ask it once per mode */
+static char *jpeg_get_buf(struct jpeg_lib *jpeg, int out, unsigned long req)
+{
+    struct jpeg_session *session = jpeg->session;
+    char **buf = &session->buf[jpeg->mode][out];
 
-    return JPEG_OK;
+    if (*buf == NULL)
+        *buf = (char *)jpeg_ops->ioctl(session->fd, req, session->mmapped_addr);
+
+    return *buf;
 }
+#endif
 
-void *api_jpeg_get_decode_in_buf(int dev_fd, unsigned int size)
+void *api_jpeg_get_in_buf(struct jpeg_lib *jpeg, unsigned int size)
 {
-    if (size < 0 || size > MAX_JPEG_RES) {
-        ALOGE("Invalid decode input buffer size\r\n");
-        return NULL;
-    }
+    jpeg_claim(jpeg);
+
+    if (jpeg->mode == decode_mode) {
+        if (size > MAX_JPEG_RES) {
+            ALOGE("Invalid decode input buffer size\r\n");
+            return NULL;
+        }
 #ifdef S5P_VMEM
-    jpeg_ctx->args.in_cookie = (unsigned int)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_DEC_IN_BUF, size);
-    jpeg_ctx->args.in_buf = s5p_malloc_share(mem_fp,
-                                        jpeg_ctx->args.in_cookie,
-                                        &jpeg_ctx->args.in_buf_size);
+        jpeg->args.in_cookie = (unsigned int)jpeg_ops->ioctl(jpeg->jpeg_fd,
+                                    IOCTL_GET_DEC_IN_BUF, (void *)size);
+        jpeg->args.in_buf = s5p_malloc_share(jpeg->session->mem_fp,
+                                            jpeg->args.in_cookie,
+                                            &jpeg->args.in_buf_size);
 #else
-    jpeg_ctx->args.in_buf = (char *)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_DEC_IN_BUF,
-                                jpeg_ctx->args.mmapped_addr);
+        jpeg->args.in_buf = jpeg_get_buf(jpeg, 0, IOCTL_GET_DEC_IN_BUF);
 #endif /* S5P_VMEM */
-    return (void *)(jpeg_ctx->args.in_buf);
-}
-
-void *api_jpeg_get_encode_in_buf(int dev_fd, unsigned int size)
-{
+    } else {
 #ifdef S5P_VMEM
-    jpeg_ctx->args.in_cookie = (unsigned int)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_ENC_IN_BUF, (size*3));
-    jpeg_ctx->args.in_buf = s5p_malloc_share(mem_fp,
-                                        jpeg_ctx->args.in_cookie,
-                                        &jpeg_ctx->args.in_buf_size);
+        jpeg->args.in_cookie = (unsigned int)jpeg_ops->ioctl(jpeg->jpeg_fd,
+                                    IOCTL_GET_ENC_IN_BUF, (void *)(size * 3));
+        jpeg->args.in_buf = s5p_malloc_share(jpeg->session->mem_fp,
+                                            jpeg->args.in_cookie,
+                                            &jpeg->args.in_buf_size);
 #else
-    jpeg_ctx->args.enc_param->size = size;
-    jpeg_ctx->args.in_buf = (char *)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_ENC_IN_BUF,
-                                jpeg_ctx->args.mmapped_addr);
+        jpeg->args.enc_param->size = size;
+        jpeg->args.in_buf = jpeg_get_buf(jpeg, 0, IOCTL_GET_ENC_IN_BUF);
 #endif
+        ALOGV("api_jpeg_get_in_buf: %p\n", jpeg->args.in_buf);
+    }
 
-    ALOGV("api_jpeg_get_encode_in_buf: 0x%x\n",
-                        jpeg_ctx->args.in_buf);
-
-    return (void *)(jpeg_ctx->args.in_buf);
+    return (void *)(jpeg->args.in_buf);
 }
 
-void *api_jpeg_get_decode_out_buf(int dev_fd)
+void *api_jpeg_get_out_buf(struct jpeg_lib *jpeg)
 {
+    jpeg_claim(jpeg);
+
+    if (jpeg->mode == decode_mode) {
 #ifdef S5P_VMEM
-    jpeg_ctx->args.out_cookie = (unsigned int)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_DEC_OUT_BUF, JPEG_FRAME_BUF_SIZE);
-    jpeg_ctx->args.out_buf = s5p_malloc_share(mem_fp,
-                                        jpeg_ctx->args.out_cookie,
-                                        &jpeg_ctx->args.out_buf_size);
+        jpeg->args.out_cookie = (unsigned int)jpeg_ops->ioctl(jpeg->jpeg_fd,
+                                    IOCTL_GET_DEC_OUT_BUF, (void *)JPEG_FRAME_BUF_SIZE);
+        jpeg->args.out_buf = s5p_malloc_share(jpeg->session->mem_fp,
+                                            jpeg->args.out_cookie,
+                                            &jpeg->args.out_buf_size);
 #else
-    jpeg_ctx->args.out_buf = (char *)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_DEC_OUT_BUF,
-                                jpeg_ctx->args.mmapped_addr);
+        jpeg->args.out_buf = jpeg_get_buf(jpeg, 1, IOCTL_GET_DEC_OUT_BUF);
 #endif /* S5P_VMEM */
-    /*
-    ALOGV("api_jpeg_get_decode_out_buf: 0x%x\n",
-                        jpeg_ctx->args.out_buf);
-    */
-    return (void *)(jpeg_ctx->args.out_buf);
-}
-
-void *api_jpeg_get_encode_out_buf(int dev_fd)
-{
+    } else {
 #ifdef S5P_VMEM
-    jpeg_ctx->args.out_cookie = (unsigned int)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_ENC_OUT_BUF, JPEG_STREAM_BUF_SIZE);
-    jpeg_ctx->args.out_buf = s5p_malloc_share(mem_fp,
-                                        jpeg_ctx->args.out_cookie,
-                                        &jpeg_ctx->args.out_buf_size);
+        jpeg->args.out_cookie = (unsigned int)jpeg_ops->ioctl(jpeg->jpeg_fd,
+                                    IOCTL_GET_ENC_OUT_BUF, (void *)JPEG_STREAM_BUF_SIZE);
+        jpeg->args.out_buf = s5p_malloc_share(jpeg->session->mem_fp,
+                                            jpeg->args.out_cookie,
+                                            &jpeg->args.out_buf_size);
 #else
-    jpeg_ctx->args.out_buf = (char *)ioctl(jpeg_ctx->jpeg_fd,
-                                IOCTL_GET_ENC_OUT_BUF,
-                                jpeg_ctx->args.mmapped_addr);
+        jpeg->args.out_buf = jpeg_get_buf(jpeg, 1, IOCTL_GET_ENC_OUT_BUF);
 #endif /* S5P_VMEM */
+        ALOGV("api_jpeg_get_out_buf: %p\n", jpeg->args.out_buf);
+    }
 
-    ALOGV("api_jpeg_get_encode_out_buf: 0x%x\n",
-                        jpeg_ctx->args.out_buf);
-
-    return (void *)(jpeg_ctx->args.out_buf);
+    return (void *)(jpeg->args.out_buf);
 }
 
-void api_jpeg_set_decode_param(struct jpeg_dec_param *param)
+void api_jpeg_set_dec_param(struct jpeg_lib *jpeg, struct jpeg_dec_param *param)
 {
-    memcpy(jpeg_ctx->args.dec_param, param, sizeof(struct jpeg_dec_param));
-    ioctl(jpeg_ctx->jpeg_fd, IOCTL_SET_DEC_PARAM, jpeg_ctx->args.dec_param);
+    jpeg_claim(jpeg);
+    memcpy(jpeg->args.dec_param, param, sizeof(struct jpeg_dec_param));
+    jpeg_ops->ioctl(jpeg->jpeg_fd, IOCTL_SET_DEC_PARAM, jpeg->args.dec_param);
 }
 
-void api_jpeg_set_encode_param(struct jpeg_enc_param *param)
+void api_jpeg_set_enc_param(struct jpeg_lib *jpeg, struct jpeg_enc_param *param)
 {
-    memcpy(jpeg_ctx->args.enc_param, param, sizeof(struct jpeg_enc_param));
-    ioctl(jpeg_ctx->jpeg_fd, IOCTL_SET_ENC_PARAM, jpeg_ctx->args.enc_param);
+    jpeg_claim(jpeg);
+    memcpy(jpeg->args.enc_param, param, sizeof(struct jpeg_enc_param));
+    jpeg_ops->ioctl(jpeg->jpeg_fd, IOCTL_SET_ENC_PARAM, jpeg->args.enc_param);
 }
 
-enum jpeg_ret_type api_jpeg_decode_exe(int dev_fd,
-                                    struct jpeg_dec_param *dec_param)
+enum jpeg_ret_type api_jpeg_dec_exe(struct jpeg_lib *jpeg, struct jpeg_dec_param *dec_param)
 {
-    struct jpeg_args *arg;
+    struct jpeg_args *arg = &(jpeg->args);
 
-    arg = &(jpeg_ctx->args);
+    jpeg_claim(jpeg);
 
-    ioctl(jpeg_ctx->jpeg_fd, IOCTL_JPEG_DEC_EXE, arg->dec_param);
-    ALOGV("api_jpeg_decode_exe dec_param->out_fmt :%d \
+    jpeg_ops->ioctl(jpeg->jpeg_fd, IOCTL_JPEG_DEC_EXE, arg->dec_param);
+    ALOGV("api_jpeg_dec_exe dec_param->out_fmt :%d \
                         dec_param->width : %d dec_param->height : %d\n",
                         arg->dec_param->out_fmt,
                         arg->dec_param->width,
@@ -326,22 +445,211 @@ enum jpeg_ret_type api_jpeg_decode_exe(int dev_fd,
     return JPEG_DECODE_OK;
 }
 
-enum jpeg_ret_type api_jpeg_encode_exe(int dev_fd,
-                                        struct jpeg_enc_param *enc_param)
+enum jpeg_ret_type api_jpeg_enc_exe(struct jpeg_lib *jpeg, struct jpeg_enc_param *enc_param)
 {
-    struct jpeg_args     *arg;
-    arg = &(jpeg_ctx->args);
+    struct jpeg_args *arg = &(jpeg->args);
 
     // check MCU validation width & height & sampling mode
-    if (check_input_size(jpeg_ctx->args.enc_param->width,
-                                jpeg_ctx->args.enc_param->height) < 0) {
+    if (check_input_size(arg->enc_param->width, arg->enc_param->height) < 0) {
         ALOGV("width/height doesn't match with MCU\r\n");
         return JPEG_FAIL;
     }
 
-    ioctl(jpeg_ctx->jpeg_fd, IOCTL_JPEG_ENC_EXE, arg->enc_param);
+    jpeg_claim(jpeg);
+
+    jpeg_ops->ioctl(jpeg->jpeg_fd, IOCTL_JPEG_ENC_EXE, arg->enc_param);
 
     enc_param->size = arg->enc_param->size;
 
     return JPEG_ENCODE_OK;
 }
+
+/* Closes the handles idle past their deadline, called with jpeg_legacy_lock */
+static int jpeg_legacy_reap(const struct timespec *now, struct timespec *next)
+{
+    struct timespec *end;
+    int mode;
+    int pending = 0;
+
+    for (mode = 0; mode < 2; mode++) {
+        if (jpeg_legacy[mode] == NULL || jpeg_legacy_busy[mode])
+            continue;
+
+        end = &jpeg_legacy_idle_end[mode];
+        if (now == NULL || end->tv_sec < now->tv_sec ||
+                (end->tv_sec == now->tv_sec && end->tv_nsec <= now->tv_nsec)) {
+            api_jpeg_close(jpeg_legacy[mode]);
+            jpeg_legacy[mode] = NULL;
+        } else if (!pending || end->tv_sec < next->tv_sec ||
+                (end->tv_sec == next->tv_sec && end->tv_nsec < next->tv_nsec)) {
+            *next = *end;
+            pending = 1;
+        }
+    }
+
+    return pending;
+}
+
+static void *jpeg_legacy_reaper(void *arg)
+{
+    struct timespec now, next;
+
+    pthread_mutex_lock(&jpeg_legacy_lock);
+    while (!jpeg_legacy_exit) {
+        clock_gettime(CLOCK_REALTIME, &now);
+        if (jpeg_legacy_reap(&now, &next))
+            pthread_cond_timedwait(&jpeg_legacy_cond, &jpeg_legacy_lock, &next);
+        else
+            pthread_cond_wait(&jpeg_legacy_cond, &jpeg_legacy_lock);
+    }
+    pthread_mutex_unlock(&jpeg_legacy_lock);
+
+    return NULL;
+}
+
+static void jpeg_legacy_start_reaper(void)
+{
+    if (pthread_create(&jpeg_legacy_thread, NULL, jpeg_legacy_reaper, NULL) == 0)
+        jpeg_legacy_thread_ok = 1;
+    else
+        ALOGE("%s: no idle timeout, handles stay open until unload\n", __func__);
+}
+
+/* The reaper must be gone before the code it runs is unmapped */
+static void __attribute__((destructor)) jpeg_legacy_unload(void)
+{
+    pthread_mutex_lock(&jpeg_legacy_lock);
+    jpeg_legacy_exit = 1;
+    pthread_cond_broadcast(&jpeg_legacy_cond);
+    pthread_mutex_unlock(&jpeg_legacy_lock);
+
+    if (jpeg_legacy_thread_ok)
+        pthread_join(jpeg_legacy_thread, NULL);
+
+    pthread_mutex_lock(&jpeg_legacy_lock);
+    jpeg_legacy_reap(NULL, NULL);
+    pthread_mutex_unlock(&jpeg_legacy_lock);
+}
+
+static int jpeg_legacy_init(enum jpeg_test_mode mode)
+{
+    int ret;
+
+    pthread_mutex_lock(&jpeg_legacy_lock);
+    if (jpeg_legacy[mode] == NULL)
+        jpeg_legacy[mode] = api_jpeg_open(mode);
+
+    if (jpeg_legacy[mode] != NULL) {
+        jpeg_legacy_busy[mode] = 1;
+        ret = jpeg_legacy[mode]->jpeg_fd;
+    } else {
+        ret = -1;
+    }
+    pthread_mutex_unlock(&jpeg_legacy_lock);
+
+    return ret;
+}
+
+static int jpeg_legacy_deinit(enum jpeg_test_mode mode)
+{
+    struct timespec *end = &jpeg_legacy_idle_end[mode];
+
+    pthread_once(&jpeg_legacy_once, jpeg_legacy_start_reaper);
+
+    pthread_mutex_lock(&jpeg_legacy_lock);
+    if (jpeg_legacy[mode] == NULL || !jpeg_legacy_busy[mode]) {
+        pthread_mutex_unlock(&jpeg_legacy_lock);
+        return JPEG_FAIL;
+    }
+
+#ifdef S5P_VMEM
+    jpeg_free_shares(jpeg_legacy[mode]);
+#endif
+    api_jpeg_done(jpeg_legacy[mode]);
+    jpeg_legacy_busy[mode] = 0;
+
+    clock_gettime(CLOCK_REALTIME, end);
+    end->tv_sec += JPEG_LEGACY_IDLE_MS / 1000;
+    end->tv_nsec += (JPEG_LEGACY_IDLE_MS % 1000) * 1000000L;
+    if (end->tv_nsec >= 1000000000L) {
+        end->tv_sec++;
+        end->tv_nsec -= 1000000000L;
+    }
+    pthread_cond_broadcast(&jpeg_legacy_cond);
+    pthread_mutex_unlock(&jpeg_legacy_lock);
+
+    return JPEG_OK;
+}
+
+int api_jpeg_decode_init()
+{
+    return jpeg_legacy_init(decode_mode);
+}
+
+int api_jpeg_encode_init()
+{
+    return jpeg_legacy_init(encode_mode);
+}
+
+int api_jpeg_decode_deinit(int dev_fd)
+{
+    return jpeg_legacy_deinit(decode_mode);
+}
+
+int api_jpeg_encode_deinit(int dev_fd)
+{
+    return jpeg_legacy_deinit(encode_mode);
+}
+
+void *api_jpeg_get_decode_in_buf(int dev_fd, unsigned int size)
+{
+    return api_jpeg_get_in_buf(jpeg_legacy[decode_mode], size);
+}
+
+void *api_jpeg_get_encode_in_buf(int dev_fd, unsigned int size)
+{
+    return api_jpeg_get_in_buf(jpeg_legacy[encode_mode], size);
+}
+
+void *api_jpeg_get_decode_out_buf(int dev_fd)
+{
+    return api_jpeg_get_out_buf(jpeg_legacy[decode_mode]);
+}
+
+void *api_jpeg_get_encode_out_buf(int dev_fd)
+{
+    return api_jpeg_get_out_buf(jpeg_legacy[encode_mode]);
+}
+
+void api_jpeg_set_decode_param(struct jpeg_dec_param *param)
+{
+    api_jpeg_set_dec_param(jpeg_legacy[decode_mode], param);
+}
+
+void api_jpeg_set_encode_param(struct jpeg_enc_param *param)
+{
+    api_jpeg_set_enc_param(jpeg_legacy[encode_mode], param);
+}
+
+/*
+ * The single instance API never held the device past a call, so the
+ * buffers are given back as soon as the job is done. Otherwise an encode
+ * would keep a decode on the same session waiting until the next deinit.
+ */
+enum jpeg_ret_type api_jpeg_decode_exe(int dev_fd,
+                                    struct jpeg_dec_param *dec_param)
+{
+    enum jpeg_ret_type ret = api_jpeg_dec_exe(jpeg_legacy[decode_mode], dec_param);
+
+    api_jpeg_done(jpeg_legacy[decode_mode]);
+    return ret;
+}
+
+enum jpeg_ret_type api_jpeg_encode_exe(int dev_fd,
+                                        struct jpeg_enc_param *enc_param)
+{
+    enum jpeg_ret_type ret = api_jpeg_enc_exe(jpeg_legacy[encode_mode], enc_param);
+
+    api_jpeg_done(jpeg_legacy[encode_mode]);
+    return ret;
+}
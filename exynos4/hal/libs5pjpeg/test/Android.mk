@@ -0,0 +1,66 @@
+# Copyright (C) 2012 The Android Open Source Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH:= $(call my-dir)
+
+# --------------------------------------------- #
+#            jpeg_session_test binary
+# --------------------------------------------- #
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+	../jpeg_api.c \
+	jpeg_session_test.c
+
+# legacy handles are closed after 100 ms idle instead of seconds
+LOCAL_CFLAGS := -DJPEG_LEGACY_IDLE_MS=100
+ifeq ($(BOARD_JPEG_DRIVER_MULTI_INSTANCE),true)
+LOCAL_CFLAGS += -DJPEG_DRIVER_MULTI_INSTANCE
+endif
+
+LOCAL_MODULE := jpeg_session_test
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_SHARED_LIBRARIES := liblog
+
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/../../include
+
+LOCAL_SRC_FILES := \
+	../jpeg_api.c \
+	jpeg_session_test.c
+
+# legacy handles are closed after 100 ms idle instead of seconds
+LOCAL_CFLAGS := -DJPEG_LEGACY_IDLE_MS=100
+ifeq ($(BOARD_JPEG_DRIVER_MULTI_INSTANCE),true)
+LOCAL_CFLAGS += -DJPEG_DRIVER_MULTI_INSTANCE
+endif
+
+LOCAL_MODULE := jpeg_session_test-host
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lpthread
+
+include $(BUILD_HOST_EXECUTABLE)
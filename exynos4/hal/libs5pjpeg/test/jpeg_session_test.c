@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Device sessions of libs5pjpeg against fake device ops: the device is
+ * open exactly while handles exist, buffer addresses are asked once per
+ * session, handles on one session never overlap, and the single instance
+ * API gives the buffers back after every job and keeps the device open
+ * across captures until it has been idle a while.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+
+#include "jpeg_api.h"
+
+#define FAKE_JPEG_FD        1000
+#define ENC_THREADS         4
+#define ENC_LOOPS           20
+
+#ifndef JPEG_LEGACY_IDLE_MS
+#define JPEG_LEGACY_IDLE_MS 5000
+#endif
+
+/* a test that deadlocks fails instead of hanging the run */
+#define TEST_TIMEOUT_SEC    30
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("jpeg_session_test: %s:%d: %s\n",                \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static struct {
+    pthread_mutex_t lock;
+    int opens;
+    int closes;
+    int maps;
+    int buf_ioctls;
+    int busy;           /* jobs inside EXE right now */
+    int overlaps;       /* EXE entered while another job held the device */
+    int clobbered;      /* EXE saw params set by someone else */
+    unsigned int enc_width;
+    char *mem;
+} fake = { PTHREAD_MUTEX_INITIALIZER };
+
+static int fake_open(const char *name, int flags)
+{
+    pthread_mutex_lock(&fake.lock);
+    fake.opens++;
+    pthread_mutex_unlock(&fake.lock);
+
+    return FAKE_JPEG_FD;
+}
+
+static int fake_close(int fd)
+{
+    pthread_mutex_lock(&fake.lock);
+    fake.closes++;
+    pthread_mutex_unlock(&fake.lock);
+
+    return 0;
+}
+
+static long fake_ioctl(int fd, unsigned long req, void *arg)
+{
+    struct jpeg_enc_param *enc_param;
+    unsigned int width;
+    long ret = 0;
+
+    switch (req) {
+    case IOCTL_GET_ENC_IN_BUF:
+    case IOCTL_GET_DEC_IN_BUF:
+        pthread_mutex_lock(&fake.lock);
+        fake.buf_ioctls++;
+        pthread_mutex_unlock(&fake.lock);
+        ret = (long)fake.mem;
+        break;
+    case IOCTL_GET_ENC_OUT_BUF:
+    case IOCTL_GET_DEC_OUT_BUF:
+        pthread_mutex_lock(&fake.lock);
+        fake.buf_ioctls++;
+        pthread_mutex_unlock(&fake.lock);
+        ret = (long)(fake.mem + JPEG_STREAM_BUF_SIZE);
+        break;
+    case IOCTL_SET_ENC_PARAM:
+        pthread_mutex_lock(&fake.lock);
+        fake.enc_width = ((struct jpeg_enc_param *)arg)->width;
+        pthread_mutex_unlock(&fake.lock);
+        break;
+    case IOCTL_JPEG_ENC_EXE:
+    case IOCTL_JPEG_DEC_EXE:
+        pthread_mutex_lock(&fake.lock);
+        if (fake.busy++)
+            fake.overlaps++;
+        width = fake.enc_width;
+        pthread_mutex_unlock(&fake.lock);
+
+        usleep(1000);
+
+        pthread_mutex_lock(&fake.lock);
+        if (req == IOCTL_JPEG_ENC_EXE) {
+            enc_param = (struct jpeg_enc_param *)arg;
+            if (enc_param->width != width || fake.enc_width != width)
+                fake.clobbered++;
+            enc_param->size = enc_param->width;
+        }
+        fake.busy--;
+        pthread_mutex_unlock(&fake.lock);
+        break;
+    default:
+        break;
+    }
+
+    return ret;
+}
+
+static void *fake_mmap(void *addr, size_t length, int prot, int flags, int fd, off_t offset)
+{
+    pthread_mutex_lock(&fake.lock);
+    fake.maps++;
+    pthread_mutex_unlock(&fake.lock);
+
+    return fake.mem;
+}
+
+static int fake_munmap(void *addr, size_t length)
+{
+    return 0;
+}
+
+static const struct jpeg_dev_ops fake_ops = {
+    .open   = fake_open,
+    .close  = fake_close,
+    .ioctl  = fake_ioctl,
+    .mmap   = fake_mmap,
+    .munmap = fake_munmap,
+};
+
+/*
+ * Long enough for idle legacy handles to be closed. The counts are then
+ * read after the closing thread's updates, which took fake.lock.
+ */
+static void wait_legacy_idle(void)
+{
+    usleep((JPEG_LEGACY_IDLE_MS + 200) * 1000);
+
+    pthread_mutex_lock(&fake.lock);
+    pthread_mutex_unlock(&fake.lock);
+}
+
+static void *enc_thread(void *arg)
+{
+    unsigned int width = (unsigned int)(long)arg;
+    struct jpeg_enc_param param;
+    struct jpeg_lib *jpeg;
+    int i;
+
+    for (i = 0; i < ENC_LOOPS; i++) {
+        jpeg = api_jpeg_open(encode_mode);
+        CHECK(jpeg != NULL);
+        if (jpeg == NULL)
+            break;
+
+        memset(&param, 0, sizeof(param));
+        param.width = width;
+        param.height = 240;
+        api_jpeg_set_enc_param(jpeg, &param);
+        CHECK(api_jpeg_get_in_buf(jpeg, width * 240 * 2) == fake.mem);
+        CHECK(api_jpeg_get_out_buf(jpeg) != NULL);
+        CHECK(api_jpeg_enc_exe(jpeg, &param) == JPEG_ENCODE_OK);
+        CHECK(param.size == width);
+        api_jpeg_close(jpeg);
+    }
+
+    return NULL;
+}
+
+/* legacy captures in a row share one open, it is closed once idle */
+static void test_legacy_cycles(void)
+{
+    struct jpeg_enc_param param;
+    int i, fd;
+
+    for (i = 0; i < 3; i++) {
+        fd = api_jpeg_encode_init();
+        CHECK(fd == FAKE_JPEG_FD);
+        memset(&param, 0, sizeof(param));
+        param.width = 320;
+        param.height = 240;
+        api_jpeg_set_encode_param(&param);
+        CHECK(api_jpeg_get_encode_in_buf(fd, 320 * 240 * 2) == fake.mem);
+        CHECK(api_jpeg_encode_exe(fd, &param) == JPEG_ENCODE_OK);
+        CHECK(api_jpeg_encode_deinit(fd) == JPEG_OK);
+    }
+    CHECK(fake.opens == 1);
+    CHECK(fake.maps == 1);
+    CHECK(fake.buf_ioctls == 1);
+    CHECK(fake.closes == 0);
+
+    /* a deinit without an init is refused */
+    CHECK(api_jpeg_encode_deinit(fd) == JPEG_FAIL);
+
+    wait_legacy_idle();
+    CHECK(fake.closes == 1);
+
+    /* and the next capture opens it again */
+    fd = api_jpeg_encode_init();
+    CHECK(fd == FAKE_JPEG_FD);
+    CHECK(fake.opens == 2);
+    CHECK(api_jpeg_encode_deinit(fd) == JPEG_OK);
+    wait_legacy_idle();
+    CHECK(fake.closes == 2);
+}
+
+/* handles share one open device, the last close releases it */
+static void test_shared_session(void)
+{
+    struct jpeg_lib *a, *b;
+    int opens = fake.opens, closes = fake.closes, buf_ioctls = fake.buf_ioctls;
+
+    a = api_jpeg_open(encode_mode);
+    b = api_jpeg_open(encode_mode);
+    CHECK(a != NULL && b != NULL);
+    if (a == NULL || b == NULL)
+        return;
+    CHECK(fake.opens == opens + 1);
+
+    CHECK(api_jpeg_get_in_buf(a, 16) == fake.mem);
+    api_jpeg_done(a);
+    CHECK(api_jpeg_get_in_buf(b, 16) == fake.mem);
+    api_jpeg_done(b);
+    CHECK(fake.buf_ioctls == buf_ioctls + 1);
+
+    /* no other device while this one is open */
+    CHECK(api_jpeg_set_device("fake", NULL) == -1);
+
+    api_jpeg_close(a);
+    CHECK(fake.closes == closes);
+    api_jpeg_close(b);
+    CHECK(fake.closes == closes + 1);
+
+    CHECK(api_jpeg_set_device("fake", &fake_ops) == 0);
+}
+
+/* a legacy encode left initialised must not hold a legacy decode back */
+static void test_legacy_encode_then_decode(void)
+{
+    struct jpeg_enc_param enc_param;
+    struct jpeg_dec_param dec_param;
+    int enc_fd, dec_fd;
+
+    enc_fd = api_jpeg_encode_init();
+    memset(&enc_param, 0, sizeof(enc_param));
+    enc_param.width = 320;
+    enc_param.height = 240;
+    api_jpeg_set_encode_param(&enc_param);
+    CHECK(api_jpeg_get_encode_in_buf(enc_fd, 320 * 240 * 2) != NULL);
+    CHECK(api_jpeg_encode_exe(enc_fd, &enc_param) == JPEG_ENCODE_OK);
+
+    dec_fd = api_jpeg_decode_init();
+    memset(&dec_param, 0, sizeof(dec_param));
+    dec_param.out_fmt = YUV_422;
+    api_jpeg_set_decode_param(&dec_param);
+    CHECK(api_jpeg_get_decode_in_buf(dec_fd, 1024) != NULL);
+    CHECK(api_jpeg_get_decode_out_buf(dec_fd) != NULL);
+    CHECK(api_jpeg_decode_exe(dec_fd, &dec_param) == JPEG_DECODE_OK);
+
+    CHECK(api_jpeg_decode_deinit(dec_fd) == JPEG_OK);
+    CHECK(api_jpeg_encode_deinit(enc_fd) == JPEG_OK);
+    wait_legacy_idle();
+    CHECK(fake.opens == fake.closes);
+}
+
+/* concurrent encoders on one session run one at a time */
+static void test_concurrent_encoders(void)
+{
+    pthread_t threads[ENC_THREADS];
+    long i;
+
+    for (i = 0; i < ENC_THREADS; i++)
+        pthread_create(&threads[i], NULL, enc_thread, (void *)(320 + i * 16));
+    for (i = 0; i < ENC_THREADS; i++)
+        pthread_join(threads[i], NULL);
+
+    CHECK(fake.overlaps == 0);
+    CHECK(fake.clobbered == 0);
+    CHECK(fake.opens == fake.closes);
+}
+
+int main(int argc, char **argv)
+{
+    alarm(TEST_TIMEOUT_SEC);
+
+    fake.mem = (char *)calloc(1, JPEG_TOTAL_BUF_SIZE);
+    if (fake.mem == NULL)
+        return 1;
+    CHECK(api_jpeg_set_device("fake", &fake_ops) == 0);
+
+    test_legacy_cycles();
+    test_shared_session();
+    test_legacy_encode_then_decode();
+    test_concurrent_encoders();
+
+    api_jpeg_set_device(NULL, NULL);
+    free(fake.mem);
+
+    printf("jpeg_session_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -37,6 +37,10 @@ LOCAL_SRC_FILES := lights.c
 LOCAL_SHARED_LIBRARIES := liblog
 LOCAL_STATIC_LIBRARIES := liblights_helper
 
+ifeq ($(TARGET_LIGHTS_COALESCE_BACKLIGHT),true)
+    LOCAL_CFLAGS += -DLIGHTS_COALESCE_BACKLIGHT
+endif
+
 LOCAL_MODULE := lights.$(TARGET_BOOTLOADER_BOARD_NAME)
 LOCAL_MODULE_RELATIVE_PATH := hw
 LOCAL_MODULE_TAGS := optional
@@ -44,3 +48,5 @@ LOCAL_MODULE_TAGS := optional
 include $(BUILD_SHARED_LIBRARY)
 
 endif
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -19,6 +19,11 @@
 
 #include <samsung_lights.h>
 
+struct lights_write_stats {
+    unsigned int issued;        /* writes that reached sysfs */
+    unsigned int suppressed;    /* writes dropped as unchanged */
+};
+
 /*
  * Interfaces for other modules accessing lights HAL data.
  * For documentation, see lights_helper.c
@@ -28,5 +33,8 @@ extern int get_cur_panel_brightness();
 extern int get_max_panel_brightness();
 extern int set_cur_panel_brightness(const int brightness);
 extern int set_max_panel_brightness(const int brightness);
+extern int set_led_blink(const char *blink);
+
+extern void get_lights_write_stats(struct lights_write_stats *stats);
 
 #endif // SAMSUNG_LIGHTS_HELPER_H
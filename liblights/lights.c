@@ -25,6 +25,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <stdbool.h>
+#include <time.h>
 
 #include <sys/ioctl.h>
 #include <sys/types.h>
@@ -38,6 +40,9 @@
 
 #define MAX_INPUT_BRIGHTNESS 255
 
+/* One display frame at 60 Hz, the coalescing period of backlight writes */
+#define BACKLIGHT_FRAME_NS 16666667LL
+
 static pthread_once_t g_init = PTHREAD_ONCE_INIT;
 static pthread_mutex_t g_lock = PTHREAD_MUTEX_INITIALIZER;
 
@@ -53,42 +58,82 @@ struct led_config {
 static struct backlight_config g_backlight; // For panel backlight
 static struct led_config g_leds[3]; // For battery, notifications, and attention.
 static int g_cur_led = -1;          // Presently showing LED of the above.
+static struct led_config g_led_written;     // Last config sent to LED_BLINK_NODE
+static bool g_led_written_valid;
+
+#ifdef LIGHTS_COALESCE_BACKLIGHT
+/*
+ * set_light_backlight() only records the latest brightness; this thread
+ * writes it, at most once per display frame.
+ */
+static pthread_once_t g_backlight_init = PTHREAD_ONCE_INIT;
+static pthread_cond_t g_backlight_cond = PTHREAD_COND_INITIALIZER;
+static int g_backlight_pending = -1;
+#endif
 
 void init_g_lock(void)
 {
     pthread_mutex_init(&g_lock, NULL);
 }
 
-static int write_str(char const *path, const char* value)
+static int rgb_to_brightness(struct light_state_t const *state)
 {
-    int fd;
-    static int already_warned;
+    int color = state->color & COLOR_MASK;
 
-    already_warned = 0;
+    return ((77*((color>>16) & 0x00ff))
+        + (150*((color>>8) & 0x00ff)) + (29*(color & 0x00ff))) >> 8;
+}
 
-    ALOGV("write_str: path %s, value %s", path, value);
-    fd = open(path, O_RDWR);
+#ifdef LIGHTS_COALESCE_BACKLIGHT
+static void *backlight_thread(void *arg __unused)
+{
+    struct timespec next = { 0, 0 };
+    int brightness;
 
-    if (fd >= 0) {
-        int amt = write(fd, value, strlen(value));
-        close(fd);
-        return amt == -1 ? -errno : 0;
-    } else {
-        if (already_warned == 0) {
-            ALOGE("write_str failed to open %s\n", path);
-            already_warned = 1;
+    pthread_mutex_lock(&g_lock);
+    for (;;) {
+        while (g_backlight_pending < 0)
+            pthread_cond_wait(&g_backlight_cond, &g_lock);
+
+        brightness = g_backlight_pending;
+        g_backlight_pending = -1;
+
+        pthread_mutex_unlock(&g_lock);
+        /* Wait out the rest of the frame, later requests replace this one */
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        pthread_mutex_lock(&g_lock);
+
+        if (g_backlight_pending >= 0) {
+            brightness = g_backlight_pending;
+            g_backlight_pending = -1;
+        }
+
+        if (set_cur_panel_brightness(brightness) == 0)
+            g_backlight.cur_brightness = brightness;
+
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        next.tv_nsec += BACKLIGHT_FRAME_NS;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
         }
-        return -errno;
     }
+
+    return NULL;
 }
 
-static int rgb_to_brightness(struct light_state_t const *state)
+static void init_backlight_thread(void)
 {
-    int color = state->color & COLOR_MASK;
-
-    return ((77*((color>>16) & 0x00ff))
-        + (150*((color>>8) & 0x00ff)) + (29*(color & 0x00ff))) >> 8;
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&thread, &attr, backlight_thread, NULL) != 0)
+        ALOGE("%s: failed to start backlight thread", __func__);
+    pthread_attr_destroy(&attr);
 }
+#endif
 
 static int set_light_backlight(struct light_device_t *dev __unused,
                                struct light_state_t const *state)
@@ -109,9 +154,14 @@ static int set_light_backlight(struct light_device_t *dev __unused,
     }
 
     pthread_mutex_lock(&g_lock);
+#ifdef LIGHTS_COALESCE_BACKLIGHT
+    g_backlight_pending = brightness;
+    pthread_cond_signal(&g_backlight_cond);
+#else
     err = set_cur_panel_brightness(brightness);
     if (err == 0)
         g_backlight.cur_brightness = brightness;
+#endif
 
     pthread_mutex_unlock(&g_lock);
     return err;
@@ -134,7 +184,11 @@ static int set_light_buttons(struct light_device_t* dev __unused,
 
 static int close_lights(struct light_device_t *dev)
 {
-    ALOGV("close_light is called");
+    struct lights_write_stats stats;
+
+    get_lights_write_stats(&stats);
+    ALOGV("close_light is called, writes: %u issued, %u suppressed",
+          stats.issued, stats.suppressed);
     if (dev)
         free(dev);
 
@@ -153,6 +207,16 @@ static int write_leds(const struct led_config *led)
     if (led == NULL)
         led = &led_off;
 
+    pthread_mutex_lock(&g_lock);
+    if (g_led_written_valid &&
+            g_led_written.color == led->color &&
+            g_led_written.delay_on == led->delay_on &&
+            g_led_written.delay_off == led->delay_off) {
+        pthread_mutex_unlock(&g_lock);
+        return 0;
+    }
+    pthread_mutex_unlock(&g_lock);
+
     count = snprintf(blink,
                      sizeof(blink) - 1,
                      "0x%08x %d %d",
@@ -174,7 +238,9 @@ static int write_leds(const struct led_config *led)
     blink[count+1] = '\0';
 
     pthread_mutex_lock(&g_lock);
-    err = write_str(LED_BLINK_NODE, blink);
+    err = set_led_blink(blink);
+    g_led_written = *led;
+    g_led_written_valid = (err == 0);
     pthread_mutex_unlock(&g_lock);
 
     return err;
@@ -312,6 +378,10 @@ static int open_lights(const struct hw_module_t *module, char const *name,
     g_backlight.max_brightness = max_brightness;
 
     pthread_once(&g_init, init_g_lock);
+#ifdef LIGHTS_COALESCE_BACKLIGHT
+    if (set_light == set_light_backlight)
+        pthread_once(&g_backlight_init, init_backlight_thread);
+#endif
 
     struct light_device_t *dev = malloc(sizeof(struct light_device_t));
     memset(dev, 0, sizeof(*dev));
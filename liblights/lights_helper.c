@@ -16,14 +16,102 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 #include <cutils/log.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
 #include <liblights/samsung_lights_helper.h>
 
+/*
+ * Build with -DLIGHTS_SYSFS_ROOT=\"/some/dir\" to use a copy of the sysfs
+ * tree (e.g. on tmpfs) instead of the real one.
+ */
+#ifdef LIGHTS_SYSFS_ROOT
+#define SYSFS_ROOT LIGHTS_SYSFS_ROOT
+#else
+#define SYSFS_ROOT ""
+#endif
+
+#define NODE_CACHE_SIZE 8
+#define NODE_VALUE_LEN  32
+#define NODE_PATH_LEN   256
+
+/*
+ * A node written through write_str()/write_int(). The fd stays open and
+ * value holds the last string written, so an identical write is dropped.
+ * A failed write closes the fd and forgets the value: the next write
+ * reopens the node and always goes out.
+ */
+struct sysfs_node {
+    char *path;
+    int fd;
+    char value[NODE_VALUE_LEN];
+};
+
+static struct sysfs_node g_nodes[NODE_CACHE_SIZE];
+static int g_num_nodes;
+static struct lights_write_stats g_stats;
+static pthread_mutex_t g_nodes_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* You need to hold g_nodes_lock before calling this function */
+static struct sysfs_node *get_node(char const *path)
+{
+    static int already_warned;
+    char full_path[NODE_PATH_LEN];
+    struct sysfs_node *node;
+    int fd, i;
+
+    node = NULL;
+    for (i = 0; i < g_num_nodes; i++) {
+        if (strcmp(g_nodes[i].path, path) == 0) {
+            node = &g_nodes[i];
+            if (node->fd >= 0)
+                return node;
+            break;
+        }
+    }
+
+    snprintf(full_path, sizeof(full_path), "%s%s", SYSFS_ROOT, path);
+    fd = open(full_path, O_RDWR);
+    if (fd < 0) {
+        if (already_warned == 0) {
+            ALOGE("%s: failed to open %s\n", __func__, full_path);
+            already_warned = 1;
+        }
+        return NULL;
+    }
+
+    if (node != NULL) {
+        node->fd = fd;
+        return node;
+    }
+
+    if (g_num_nodes == NODE_CACHE_SIZE) {
+        ALOGE("%s: node cache full, not caching %s\n", __func__, path);
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    node = &g_nodes[g_num_nodes];
+    node->path = strdup(path);
+    if (node->path == NULL) {
+        close(fd);
+        errno = ENOMEM;
+        return NULL;
+    }
+    node->fd = fd;
+    node->value[0] = '\0';
+    g_num_nodes++;
+
+    return node;
+}
+
 /*
  * Reads an Integer from a file.
  *
@@ -37,9 +125,12 @@ int read_int(char const *path)
     char buf[11];
     int retval;
 
-    fd = open(path, O_RDONLY);
+    char full_path[NODE_PATH_LEN];
+
+    snprintf(full_path, sizeof(full_path), "%s%s", SYSFS_ROOT, path);
+    fd = open(full_path, O_RDONLY);
     if (fd < 0) {
-        ALOGE("%s: failed to open %s\n", __func__, path);
+        ALOGE("%s: failed to open %s\n", __func__, full_path);
         goto fail;
     }
 
@@ -62,6 +153,55 @@ fail:
     return -1;
 }
 
+/*
+ * Writes a string to a file, unless it is what was last written to it.
+ *
+ * @param path The absolute path string.
+ * @param value The string to be written.
+ * @return 0 on success, -1 or errno on error.
+ */
+static int write_str(char const *path, const char *value)
+{
+    struct sysfs_node *node;
+    size_t len = strlen(value);
+    int amt, err = 0;
+
+    pthread_mutex_lock(&g_nodes_lock);
+
+    node = get_node(path);
+    if (node == NULL) {
+        err = errno ? -errno : -1;
+        goto out;
+    }
+
+    if (strcmp(node->value, value) == 0) {
+        g_stats.suppressed++;
+        goto out;
+    }
+
+    ALOGV("write_str: path %s, value %s", path, value);
+
+    amt = pwrite(node->fd, value, len, 0);
+    if (amt == -1) {
+        err = -errno;
+        /* the node may hold anything now, start over on the next write */
+        close(node->fd);
+        node->fd = -1;
+        node->value[0] = '\0';
+        goto out;
+    }
+
+    g_stats.issued++;
+    if (len < sizeof(node->value))
+        memcpy(node->value, value, len + 1);
+    else
+        node->value[0] = '\0';
+
+out:
+    pthread_mutex_unlock(&g_nodes_lock);
+    return err;
+}
+
 /*
  * Writes an Integer to a file.
  *
@@ -71,27 +211,23 @@ fail:
  */
 int write_int(char const *path, const int value)
 {
-    int fd;
-    static int already_warned;
+    char buffer[20];
 
-    already_warned = 0;
+    snprintf(buffer, sizeof(buffer), "%d\n", value);
 
-    ALOGV("write_int: path %s, value %d", path, value);
-    fd = open(path, O_RDWR);
+    return write_str(path, buffer);
+}
 
-    if (fd >= 0) {
-        char buffer[20];
-        int bytes = sprintf(buffer, "%d\n", value);
-        int amt = write(fd, buffer, bytes);
-        close(fd);
-        return amt == -1 ? -errno : 0;
-    } else {
-        if (already_warned == 0) {
-            ALOGE("write_int failed to open %s\n", path);
-            already_warned = 1;
-        }
-        return -errno;
-    }
+/*
+ * Copy the counters of write_str()/write_int().
+ *
+ * @param stats Filled with writes issued and writes suppressed.
+ */
+void get_lights_write_stats(struct lights_write_stats *stats)
+{
+    pthread_mutex_lock(&g_nodes_lock);
+    *stats = g_stats;
+    pthread_mutex_unlock(&g_nodes_lock);
 }
 
 /*
@@ -146,3 +282,14 @@ inline int set_max_panel_brightness(const int brightness)
 {
     return write_int(PANEL_MAX_BRIGHTNESS_NODE, brightness);
 }
+
+/*
+ * Set the LED color and blink pattern via sysfs.
+ *
+ * @param blink "<color> <delay on> <delay off>", e.g. "0x00ff0000 500 1000\n".
+ * @return 0 on success, -1 or errno on error.
+ */
+int set_led_blink(const char *blink)
+{
+    return write_str(LED_BLINK_NODE, blink);
+}
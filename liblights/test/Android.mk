@@ -0,0 +1,46 @@
+# Copyright (C) 2016 The CyanogenMod Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+
+# the lights HAL against a fake sysfs tree under LIGHTS_SYSFS_ROOT
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	../lights_helper.c \
+	../lights.c \
+	lights_test.c
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+LOCAL_CFLAGS := -DLIGHTS_SYSFS_ROOT=\"/data/local/tmp/lights_test\"
+LOCAL_SHARED_LIBRARIES := liblog
+LOCAL_MODULE := lights_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES := \
+	../lights_helper.c \
+	../lights.c \
+	lights_test.c
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+LOCAL_CFLAGS := -D_GNU_SOURCE -DLIGHTS_SYSFS_ROOT=\"/tmp/lights_test\"
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_MODULE := lights_test-host
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
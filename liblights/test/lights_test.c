@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The lights HAL built with LIGHTS_SYSFS_ROOT, against a fake tree made
+ * there: backlight and LED writes land in the right nodes, and writes of
+ * an unchanged value are suppressed. The fake nodes are regular files
+ * that a shorter write doesn't cut, so only their first line is compared.
+ */
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <hardware/lights.h>
+#include <liblights/samsung_lights_helper.h>
+
+extern struct hw_module_t HAL_MODULE_INFO_SYM;
+
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("lights_test: %s:%d: %s\n",                      \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+static void put(const char *node, const char *s)
+{
+    char path[256];
+    int fd;
+
+    snprintf(path, sizeof(path), "%s%s", LIGHTS_SYSFS_ROOT, node);
+    fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, s, strlen(s)) < 0)
+        printf("lights_test: can't write %s\n", path);
+    if (fd >= 0)
+        close(fd);
+}
+
+static int is(const char *node, const char *s)
+{
+    char path[256];
+    char buf[80];
+    ssize_t len = -1;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s%s", LIGHTS_SYSFS_ROOT, node);
+    fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+    }
+    if (len < 0)
+        return 0;
+    buf[len] = '\0';
+    buf[strcspn(buf, "\n")] = '\0';
+
+    return strcmp(buf, s) == 0;
+}
+
+static void make_dirs(const char *node)
+{
+    char dir[256];
+    char *p;
+
+    snprintf(dir, sizeof(dir), "%s%s", LIGHTS_SYSFS_ROOT, node);
+    for (p = dir + 1; *p != '\0'; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+}
+
+static int remove_node(const char *path, const struct stat *sb, int flag,
+                       struct FTW *ftw)
+{
+    return remove(path);
+}
+
+static void make_tree(void)
+{
+    nftw(LIGHTS_SYSFS_ROOT, remove_node, 8, FTW_DEPTH | FTW_PHYS);
+
+    make_dirs(PANEL_BRIGHTNESS_NODE);
+    make_dirs(BUTTON_BRIGHTNESS_NODE);
+    make_dirs(LED_BLINK_NODE);
+
+    put(PANEL_MAX_BRIGHTNESS_NODE, "255\n");
+    put(PANEL_BRIGHTNESS_NODE, "0\n");
+    put(BUTTON_BRIGHTNESS_NODE, "0\n");
+    put(LED_BLINK_NODE, "0x00000000 0 0\n");
+}
+
+static struct light_device_t *open_light(const char *name)
+{
+    struct hw_device_t *device = NULL;
+
+    CHECK(HAL_MODULE_INFO_SYM.methods->open(&HAL_MODULE_INFO_SYM, name, &device) == 0);
+
+    return (struct light_device_t *)device;
+}
+
+int main(int argc, char **argv)
+{
+    struct light_device_t *backlight, *battery, *notifications;
+    struct light_state_t state;
+    struct lights_write_stats stats;
+
+    make_tree();
+
+    backlight = open_light(LIGHT_ID_BACKLIGHT);
+    battery = open_light(LIGHT_ID_BATTERY);
+    notifications = open_light(LIGHT_ID_NOTIFICATIONS);
+    if (backlight == NULL || battery == NULL || notifications == NULL)
+        return 1;
+
+    /* the backlight goes to the panel, a repeat is not written again */
+    memset(&state, 0, sizeof(state));
+    state.color = 0xff808080;
+    CHECK(backlight->set_light(backlight, &state) == 0);
+    CHECK(is(PANEL_BRIGHTNESS_NODE, "128"));
+    CHECK(get_cur_panel_brightness() == 128);
+    CHECK(backlight->set_light(backlight, &state) == 0);
+    get_lights_write_stats(&stats);
+    CHECK(stats.issued == 1);
+    CHECK(stats.suppressed == 1);
+
+    state.color = 0xffffffff;
+    CHECK(backlight->set_light(backlight, &state) == 0);
+    CHECK(is(PANEL_BRIGHTNESS_NODE, "255"));
+
+    /* a blinking notification, shown over the battery LED */
+    state.color = 0xff00ff00;
+    state.flashMode = LIGHT_FLASH_NONE;
+    CHECK(battery->set_light(battery, &state) == 0);
+    CHECK(is(LED_BLINK_NODE, "0x0000ff00 0 0"));
+
+    state.color = 0xffff0000;
+    state.flashMode = LIGHT_FLASH_TIMED;
+    state.flashOnMS = 500;
+    state.flashOffMS = 1000;
+    CHECK(notifications->set_light(notifications, &state) == 0);
+    CHECK(is(LED_BLINK_NODE, "0x00ff0000 500 1000"));
+
+    /* the battery LED comes back when the notification is cleared */
+    state.color = 0;
+    CHECK(notifications->set_light(notifications, &state) == 0);
+    CHECK(is(LED_BLINK_NODE, "0x0000ff00 0 0"));
+    get_lights_write_stats(&stats);
+    CHECK(stats.issued == 5);
+
+    backlight->common.close(&backlight->common);
+    battery->common.close(&battery->common);
+    notifications->common.close(&notifications->common);
+
+    nftw(LIGHTS_SYSFS_ROOT, remove_node, 8, FTW_DEPTH | FTW_PHYS);
+
+    printf("lights_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -25,14 +25,17 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/timerfd.h>
 
 #define LOG_TAG "SamsungPowerHAL"
 /* #define LOG_NDEBUG 0 */
 #include <utils/Log.h>
+#include <cutils/properties.h>
 
 #include <hardware/hardware.h>
 #include <hardware/power.h>
@@ -40,18 +43,95 @@
 
 #include "samsung_power.h"
 
+/* Device headers that predate the boost manager don't name the floor nodes */
+#ifndef CPU0_MIN_FREQ_PATH
+#define CPU0_MIN_FREQ_PATH "/sys/devices/system/cpu/cpu0/cpufreq/scaling_min_freq"
+#endif
+#ifndef CPU4_MIN_FREQ_PATH
+#define CPU4_MIN_FREQ_PATH "/sys/devices/system/cpu/cpu4/cpufreq/scaling_min_freq"
+#endif
+
+/*
+ * Build with -DPOWER_SYSFS_ROOT=\"/some/dir\" to run the HAL against a
+ * copy of the sysfs tree (e.g. on tmpfs) instead of the real one.
+ */
+#ifdef POWER_SYSFS_ROOT
+#define SYSFS_ROOT POWER_SYSFS_ROOT
+#else
+#define SYSFS_ROOT ""
+#endif
+#define SYSFS_PATH(path) SYSFS_ROOT path
+
+/* Where the boost manager counters are published, see boost_report_stats() */
+#define BOOST_STATS_PROP "sys.power.boost_stats"
+
+/* Minimum time between two boostpulse writes for POWER_HINT_INTERACTION */
+#define BOOSTPULSE_INTERVAL_PROP "ro.power.boostpulse_interval_ms"
+#ifndef BOOSTPULSE_INTERVAL_MS
+#define BOOSTPULSE_INTERVAL_MS 40
+#endif
+
+#define SYSFS_CACHE_SIZE 16
+#define SYSFS_VALUE_LEN  16
+#define SYSFS_BATCH_SIZE 8
+
+/*
+ * A sysfs node we write to. The fd stays open until a write fails, e.g.
+ * with ENODEV once the cpufreq nodes of a hotplugged core are gone, and is
+ * reopened on the next write. value holds what was last written to (or
+ * read from) the node. A write of the same value is only skipped once the
+ * node itself reads back that value, as anyone may have written it since.
+ */
+struct sysfs_node {
+    char *path;
+    int fd;
+    bool readable;
+    char value[SYSFS_VALUE_LEN];
+};
+
+/* A set of node writes applied back to back by sysfs_batch_commit() */
+struct sysfs_batch {
+    int count;
+    struct {
+        const char *path;
+        const char *value;
+    } op[SYSFS_BATCH_SIZE];
+};
+
+/* Counters of the boost manager, reported when the screen goes off */
+struct boost_stats {
+    uint32_t vsync_boosts;      /* POWER_HINT_VSYNC on requests */
+    uint32_t cpu_boosts;        /* POWER_HINT_CPU_BOOST requests */
+    uint32_t activations;       /* times the frequency floor was raised */
+    int64_t boosted_ns;         /* total time spent with the floor raised */
+};
+
 struct samsung_power_module {
     struct power_module base;
     pthread_mutex_t lock;
     int boostpulse_fd;
     int boostpulse_warned;
+    int64_t boostpulse_last_ns;
+    int boostpulse_interval_ms;
     char cpu0_hispeed_freq[10];
     char cpu0_max_freq[10];
     char cpu4_hispeed_freq[10];
     char cpu4_max_freq[10];
+    char cpu0_min_freq[10];
+    char cpu4_min_freq[10];
+    bool cpu4_present;
+    /* boost manager: floor at hispeed freq while vsync or a CPU_BOOST is active */
+    bool vsync_boost;
+    int64_t cpu_boost_end_ns;
+    bool boost_active;
+    int64_t boost_start_ns;
+    int boost_timer_fd;
+    struct boost_stats boost_stats;
     char* touchscreen_power_path;
     char* touchkey_power_path;
     bool touchkey_blocked;
+    struct sysfs_node nodes[SYSFS_CACHE_SIZE];
+    int num_nodes;
 };
 
 enum power_profile_e {
@@ -65,8 +145,149 @@ static enum power_profile_e current_power_profile = PROFILE_BALANCED;
  *** HELPER FUNCTIONS
  **********************************************************/
 
-static int sysfs_read(char *path, char *s, int num_bytes)
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static struct sysfs_node *sysfs_node_find(struct samsung_power_module *samsung_pwr,
+                                          const char *path)
+{
+    int i;
+
+    for (i = 0; i < samsung_pwr->num_nodes; i++) {
+        if (strcmp(samsung_pwr->nodes[i].path, path) == 0) {
+            return &samsung_pwr->nodes[i];
+        }
+    }
+
+    return NULL;
+}
+
+/* Read-write if the node allows it, so sysfs_write() can read it back */
+static int sysfs_node_open(const char *path, bool *readable)
+{
+    char errno_str[64];
+    int fd;
+
+    fd = open(path, O_RDWR);
+    *readable = (fd >= 0);
+    if (fd < 0 && errno == EACCES) {
+        fd = open(path, O_WRONLY);
+    }
+    if (fd < 0) {
+        strerror_r(errno, errno_str, sizeof(errno_str));
+        ALOGE("Error opening %s: %s\n", path, errno_str);
+    }
+
+    return fd;
+}
+
+/* Forget the fd and the value, the next write reopens the node */
+static void sysfs_node_invalidate(struct sysfs_node *node)
+{
+    if (node->fd >= 0) {
+        close(node->fd);
+        node->fd = -1;
+    }
+    node->value[0] = '\0';
+}
+
+/* You need to request the powerhal lock before calling this function */
+static struct sysfs_node *sysfs_node_get(struct samsung_power_module *samsung_pwr,
+                                         const char *path)
+{
+    struct sysfs_node *node;
+    bool readable;
+    int fd;
+
+    if (path == NULL) {
+        return NULL;
+    }
+
+    node = sysfs_node_find(samsung_pwr, path);
+    if (node != NULL) {
+        if (node->fd < 0) {
+            node->fd = sysfs_node_open(path, &node->readable);
+            if (node->fd < 0) {
+                return NULL;
+            }
+        }
+        return node;
+    }
+
+    fd = sysfs_node_open(path, &readable);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    if (samsung_pwr->num_nodes == SYSFS_CACHE_SIZE) {
+        ALOGE("%s: node cache full, not caching %s\n", __func__, path);
+        close(fd);
+        return NULL;
+    }
+
+    node = &samsung_pwr->nodes[samsung_pwr->num_nodes];
+    node->path = strdup(path);
+    if (node->path == NULL) {
+        close(fd);
+        return NULL;
+    }
+    node->fd = fd;
+    node->readable = readable;
+    node->value[0] = '\0';
+    samsung_pwr->num_nodes++;
+
+    return node;
+}
+
+/* Length of s without the trailing newline (or other whitespace) */
+static size_t sysfs_value_len(const char *s)
+{
+    size_t len = strlen(s);
+
+    while (len > 0 && isspace((unsigned char)s[len - 1])) {
+        len--;
+    }
+
+    return len;
+}
+
+/* Values as read from and written to sysfs, trailing whitespace aside */
+static bool sysfs_value_equal(const char *a, const char *b)
+{
+    size_t len = sysfs_value_len(a);
+
+    return len == sysfs_value_len(b) && strncmp(a, b, len) == 0;
+}
+
+/* True if the node currently reads back s */
+static bool sysfs_node_holds(struct sysfs_node *node, const char *s)
 {
+    char buf[SYSFS_VALUE_LEN + 1];
+    ssize_t len;
+
+    if (!node->readable) {
+        return false;
+    }
+
+    len = pread(node->fd, buf, sizeof(buf) - 1, 0);
+    if (len < 0) {
+        return false;
+    }
+    buf[len] = '\0';
+
+    return sysfs_value_equal(buf, s);
+}
+
+static int sysfs_read(struct samsung_power_module *samsung_pwr,
+                      const char *path, char *s, int num_bytes)
+{
+    struct sysfs_node *node;
     char errno_str[64];
     int len;
     int ret = 0;
@@ -92,29 +313,85 @@ static int sysfs_read(char *path, char *s, int num_bytes)
 
     close(fd);
 
+    /* someone else may have written the node, resync the cached value */
+    node = sysfs_node_find(samsung_pwr, path);
+    if (node != NULL) {
+        if (ret == 0) {
+            snprintf(node->value, sizeof(node->value), "%.*s",
+                     (int)sysfs_value_len(s), s);
+        } else {
+            node->value[0] = '\0';
+        }
+    }
+
     return ret;
 }
 
-static void sysfs_write(const char *path, char *s)
+/* You need to request the powerhal lock before calling this function */
+static void sysfs_write(struct samsung_power_module *samsung_pwr,
+                        const char *path, const char *s)
 {
+    struct sysfs_node *node;
     char errno_str[64];
+    size_t size = strlen(s);
     int len;
-    int fd;
 
-    fd = open(path, O_WRONLY);
-    if (fd < 0) {
-        strerror_r(errno, errno_str, sizeof(errno_str));
-        ALOGE("Error opening %s: %s\n", path, errno_str);
+    node = sysfs_node_get(samsung_pwr, path);
+    if (node == NULL) {
+        return;
+    }
+
+    if (sysfs_value_equal(node->value, s) && sysfs_node_holds(node, s)) {
+        ALOGV("%s: %s already %s\n", __func__, path, s);
         return;
     }
 
-    len = write(fd, s, strlen(s));
+    len = pwrite(node->fd, s, size, 0);
     if (len < 0) {
         strerror_r(errno, errno_str, sizeof(errno_str));
         ALOGE("Error writing to %s: %s\n", path, errno_str);
+        sysfs_node_invalidate(node);
+        return;
     }
 
-    close(fd);
+    if (size < sizeof(node->value)) {
+        memcpy(node->value, s, size + 1);
+    } else {
+        node->value[0] = '\0';
+    }
+}
+
+static void sysfs_batch_add(struct sysfs_batch *batch, const char *path, const char *value)
+{
+    if (path == NULL || batch->count == SYSFS_BATCH_SIZE) {
+        return;
+    }
+
+    batch->op[batch->count].path = path;
+    batch->op[batch->count].value = value;
+    batch->count++;
+}
+
+/*
+ * Apply every write of a batch. All nodes are opened first so the writes
+ * themselves go out back to back; unchanged nodes are skipped.
+ *
+ * You need to request the powerhal lock before calling this function
+ */
+static void sysfs_batch_commit(struct samsung_power_module *samsung_pwr,
+                               struct sysfs_batch *batch)
+{
+    int i;
+
+    for (i = 0; i < batch->count; i++) {
+        sysfs_node_get(samsung_pwr, batch->op[i].path);
+    }
+
+    for (i = 0; i < batch->count; i++) {
+        sysfs_write(samsung_pwr, batch->op[i].path, batch->op[i].value);
+    }
+
+    batch->count = 0;
 }
 
 /**********************************************************
@@ -127,11 +404,11 @@ static int boostpulse_open(struct samsung_power_module *samsung_pwr)
     char errno_str[64];
 
     if (samsung_pwr->boostpulse_fd < 0) {
-        samsung_pwr->boostpulse_fd = open(BOOSTPULSE_PATH, O_WRONLY);
+        samsung_pwr->boostpulse_fd = open(SYSFS_PATH(BOOSTPULSE_PATH), O_WRONLY);
         if (samsung_pwr->boostpulse_fd < 0) {
             if (!samsung_pwr->boostpulse_warned) {
                 strerror_r(errno, errno_str, sizeof(errno_str));
-                ALOGE("Error opening %s: %s\n", BOOSTPULSE_PATH, errno_str);
+                ALOGE("Error opening %s: %s\n", SYSFS_PATH(BOOSTPULSE_PATH), errno_str);
                 samsung_pwr->boostpulse_warned = 1;
             }
         }
@@ -140,11 +417,129 @@ static int boostpulse_open(struct samsung_power_module *samsung_pwr)
     return samsung_pwr->boostpulse_fd;
 }
 
+/*
+ * Raise the scaling_min_freq of each cluster to its hispeed freq while a
+ * boost is active and drop it back to the boot value once none is.
+ *
+ * You need to request the powerhal lock before calling this function
+ */
+static void boost_update(struct samsung_power_module *samsung_pwr)
+{
+    struct sysfs_batch batch = { .count = 0 };
+    int64_t now = now_ns();
+    bool active;
+
+    if (samsung_pwr->cpu_boost_end_ns != 0 && now >= samsung_pwr->cpu_boost_end_ns) {
+        samsung_pwr->cpu_boost_end_ns = 0;
+    }
+
+    active = (samsung_pwr->vsync_boost || samsung_pwr->cpu_boost_end_ns != 0) &&
+             current_power_profile != PROFILE_POWER_SAVE;
+    if (active == samsung_pwr->boost_active) {
+        return;
+    }
+
+    if (active) {
+        sysfs_batch_add(&batch, SYSFS_PATH(CPU0_MIN_FREQ_PATH), samsung_pwr->cpu0_hispeed_freq);
+        if (samsung_pwr->cpu4_present) {
+            sysfs_batch_add(&batch, SYSFS_PATH(CPU4_MIN_FREQ_PATH), samsung_pwr->cpu4_hispeed_freq);
+        }
+        samsung_pwr->boost_start_ns = now;
+        samsung_pwr->boost_stats.activations++;
+    } else {
+        sysfs_batch_add(&batch, SYSFS_PATH(CPU0_MIN_FREQ_PATH), samsung_pwr->cpu0_min_freq);
+        if (samsung_pwr->cpu4_present) {
+            sysfs_batch_add(&batch, SYSFS_PATH(CPU4_MIN_FREQ_PATH), samsung_pwr->cpu4_min_freq);
+        }
+        samsung_pwr->boost_stats.boosted_ns += now - samsung_pwr->boost_start_ns;
+    }
+
+    sysfs_batch_commit(samsung_pwr, &batch);
+    samsung_pwr->boost_active = active;
+
+    ALOGV("%s: boost %s (vsync=%d cpu_boost=%d)", __func__, active ? "on" : "off",
+          samsung_pwr->vsync_boost, samsung_pwr->cpu_boost_end_ns != 0);
+}
+
+/*
+ * Log the counters and publish them in BOOST_STATS_PROP as
+ * "<vsync> <cpu_boost> <activations> <boosted ms>", e.g. for bugreports.
+ *
+ * You need to request the powerhal lock before calling this function
+ */
+static void boost_report_stats(struct samsung_power_module *samsung_pwr)
+{
+    struct boost_stats *stats = &samsung_pwr->boost_stats;
+    int64_t boosted_ns = stats->boosted_ns;
+    char value[PROPERTY_VALUE_MAX];
+
+    if (samsung_pwr->boost_active) {
+        boosted_ns += now_ns() - samsung_pwr->boost_start_ns;
+    }
+
+    ALOGD("%s: active=%d vsync=%u cpu_boost=%u activations=%u boosted=%lldms", __func__,
+          samsung_pwr->boost_active, stats->vsync_boosts, stats->cpu_boosts,
+          stats->activations, (long long)(boosted_ns / 1000000));
+
+    snprintf(value, sizeof(value), "%u %u %u %lld", stats->vsync_boosts, stats->cpu_boosts,
+             stats->activations, (long long)(boosted_ns / 1000000));
+    property_set(BOOST_STATS_PROP, value);
+}
+
+/* Ends CPU_BOOSTs: the timer is armed for the latest requested end */
+static void *boost_timer_thread(void *arg)
+{
+    struct samsung_power_module *samsung_pwr = (struct samsung_power_module *) arg;
+    char errno_str[64];
+    uint64_t expirations;
+    ssize_t len;
+
+    for (;;) {
+        len = read(samsung_pwr->boost_timer_fd, &expirations, sizeof(expirations));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            strerror_r(errno, errno_str, sizeof(errno_str));
+            ALOGE("%s: Error reading boost timer: %s\n", __func__, errno_str);
+            break;
+        }
+
+        pthread_mutex_lock(&samsung_pwr->lock);
+        boost_update(samsung_pwr);
+        pthread_mutex_unlock(&samsung_pwr->lock);
+    }
+
+    return NULL;
+}
+
+/* You need to request the powerhal lock before calling this function */
+static void boost_cpu(struct samsung_power_module *samsung_pwr, int duration_us)
+{
+    struct itimerspec its;
+    int64_t end = now_ns() + (int64_t)duration_us * 1000LL;
+
+    samsung_pwr->boost_stats.cpu_boosts++;
+
+    if (end > samsung_pwr->cpu_boost_end_ns) {
+        samsung_pwr->cpu_boost_end_ns = end;
+
+        if (samsung_pwr->boost_timer_fd >= 0) {
+            memset(&its, 0, sizeof(its));
+            its.it_value.tv_sec = end / 1000000000LL;
+            its.it_value.tv_nsec = end % 1000000000LL;
+            timerfd_settime(samsung_pwr->boost_timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+        }
+    }
+
+    boost_update(samsung_pwr);
+}
+
+/* You need to request the powerhal lock before calling this function */
 static void set_power_profile(struct samsung_power_module *samsung_pwr,
                               enum power_profile_e profile)
 {
-    int rc;
-    struct stat sb;
+    struct sysfs_batch batch = { .count = 0 };
 
     if (current_power_profile == profile) {
         return;
@@ -155,34 +550,36 @@ static void set_power_profile(struct samsung_power_module *samsung_pwr,
     switch (profile) {
         case PROFILE_POWER_SAVE:
             // Limit to hispeed freq
-            sysfs_write(CPU0_MAX_FREQ_PATH, samsung_pwr->cpu0_hispeed_freq);
-            rc = stat(CPU4_MAX_FREQ_PATH, &sb);
-            if (rc == 0) {
-                sysfs_write(CPU4_MAX_FREQ_PATH, samsung_pwr->cpu4_hispeed_freq);
+            sysfs_batch_add(&batch, SYSFS_PATH(CPU0_MAX_FREQ_PATH), samsung_pwr->cpu0_hispeed_freq);
+            if (samsung_pwr->cpu4_present) {
+                sysfs_batch_add(&batch, SYSFS_PATH(CPU4_MAX_FREQ_PATH), samsung_pwr->cpu4_hispeed_freq);
             }
             ALOGD("%s: set powersave mode", __func__);
             break;
         case PROFILE_BALANCED:
             // Restore normal max freq
-            sysfs_write(CPU0_MAX_FREQ_PATH, samsung_pwr->cpu0_max_freq);
-            rc = stat(CPU4_MAX_FREQ_PATH, &sb);
-            if (rc == 0) {
-                sysfs_write(CPU4_MAX_FREQ_PATH, samsung_pwr->cpu4_max_freq);
+            sysfs_batch_add(&batch, SYSFS_PATH(CPU0_MAX_FREQ_PATH), samsung_pwr->cpu0_max_freq);
+            if (samsung_pwr->cpu4_present) {
+                sysfs_batch_add(&batch, SYSFS_PATH(CPU4_MAX_FREQ_PATH), samsung_pwr->cpu4_max_freq);
             }
             ALOGD("%s: set balanced mode", __func__);
             break;
         case PROFILE_HIGH_PERFORMANCE:
             // Restore normal max freq
-            sysfs_write(CPU0_MAX_FREQ_PATH, samsung_pwr->cpu0_max_freq);
-            rc = stat(CPU4_MAX_FREQ_PATH, &sb);
-            if (rc == 0) {
-                sysfs_write(CPU4_MAX_FREQ_PATH, samsung_pwr->cpu4_max_freq);
+            sysfs_batch_add(&batch, SYSFS_PATH(CPU0_MAX_FREQ_PATH), samsung_pwr->cpu0_max_freq);
+            if (samsung_pwr->cpu4_present) {
+                sysfs_batch_add(&batch, SYSFS_PATH(CPU4_MAX_FREQ_PATH), samsung_pwr->cpu4_max_freq);
             }
             ALOGD("%s: set performance mode", __func__);
             break;
     }
 
+    sysfs_batch_commit(samsung_pwr, &batch);
+
     current_power_profile = profile;
+
+    /* no frequency floor in powersave mode */
+    boost_update(samsung_pwr);
 }
 
 static void find_input_nodes(struct samsung_power_module *samsung_pwr, char *dir)
@@ -216,7 +613,7 @@ static void find_input_nodes(struct samsung_power_module *samsung_pwr, char *dir
             }
 
             snprintf(path, pathsize, "%s/%s", dir, filename);
-            sysfs_read(path, file_content, sizeof(file_content));
+            sysfs_read(samsung_pwr, path, file_content, sizeof(file_content));
 
             snprintf(node_path, node_pathsize, "%s/%s", dir, "enabled");
 
@@ -262,21 +659,28 @@ static void init_cpufreqs(struct samsung_power_module *samsung_pwr)
     int rc;
     struct stat sb;
 
-    sysfs_read(CPU0_HISPEED_FREQ_PATH, samsung_pwr->cpu0_hispeed_freq,
+    sysfs_read(samsung_pwr, SYSFS_PATH(CPU0_HISPEED_FREQ_PATH), samsung_pwr->cpu0_hispeed_freq,
                sizeof(samsung_pwr->cpu0_hispeed_freq));
-    sysfs_read(CPU0_MAX_FREQ_PATH, samsung_pwr->cpu0_max_freq,
+    sysfs_read(samsung_pwr, SYSFS_PATH(CPU0_MAX_FREQ_PATH), samsung_pwr->cpu0_max_freq,
                sizeof(samsung_pwr->cpu0_max_freq));
+    sysfs_read(samsung_pwr, SYSFS_PATH(CPU0_MIN_FREQ_PATH), samsung_pwr->cpu0_min_freq,
+               sizeof(samsung_pwr->cpu0_min_freq));
     ALOGV("%s: CPU 0 hispeed freq: %s\n", __func__, samsung_pwr->cpu0_hispeed_freq);
     ALOGV("%s: CPU 0 max freq: %s\n", __func__, samsung_pwr->cpu0_max_freq);
+    ALOGV("%s: CPU 0 min freq: %s\n", __func__, samsung_pwr->cpu0_min_freq);
 
-    rc = stat(CPU4_HISPEED_FREQ_PATH, &sb);
+    rc = stat(SYSFS_PATH(CPU4_HISPEED_FREQ_PATH), &sb);
     if (rc == 0) {
-        sysfs_read(CPU4_HISPEED_FREQ_PATH, samsung_pwr->cpu4_hispeed_freq,
+        sysfs_read(samsung_pwr, SYSFS_PATH(CPU4_HISPEED_FREQ_PATH), samsung_pwr->cpu4_hispeed_freq,
                    sizeof(samsung_pwr->cpu4_hispeed_freq));
-        sysfs_read(CPU4_MAX_FREQ_PATH, samsung_pwr->cpu4_max_freq,
+        sysfs_read(samsung_pwr, SYSFS_PATH(CPU4_MAX_FREQ_PATH), samsung_pwr->cpu4_max_freq,
                    sizeof(samsung_pwr->cpu4_max_freq));
+        sysfs_read(samsung_pwr, SYSFS_PATH(CPU4_MIN_FREQ_PATH), samsung_pwr->cpu4_min_freq,
+                   sizeof(samsung_pwr->cpu4_min_freq));
+        samsung_pwr->cpu4_present = (stat(SYSFS_PATH(CPU4_MAX_FREQ_PATH), &sb) == 0);
         ALOGV("%s: CPU 4 hispeed freq: %s\n", __func__, samsung_pwr->cpu4_hispeed_freq);
         ALOGV("%s: CPU 4 max freq: %s\n", __func__, samsung_pwr->cpu4_max_freq);
+        ALOGV("%s: CPU 4 min freq: %s\n", __func__, samsung_pwr->cpu4_min_freq);
     }
 }
 
@@ -287,11 +691,36 @@ static void init_touch_input_power_path(struct samsung_power_module *samsung_pwr
     uint32_t i;
 
     for (i = 0; i < 20; i++) {
-        snprintf(dir, sizeof(dir), "/sys/class/input/input%d", i);
+        snprintf(dir, sizeof(dir), SYSFS_PATH("/sys/class/input/input%d"), i);
         find_input_nodes(samsung_pwr, dir);
     }
 }
 
+static void init_boost_timer(struct samsung_power_module *samsung_pwr)
+{
+    char errno_str[64];
+    pthread_attr_t attr;
+    pthread_t thread;
+    int rc;
+
+    samsung_pwr->boost_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (samsung_pwr->boost_timer_fd < 0) {
+        strerror_r(errno, errno_str, sizeof(errno_str));
+        ALOGE("%s: Error creating boost timer: %s\n", __func__, errno_str);
+        return;
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    rc = pthread_create(&thread, &attr, boost_timer_thread, samsung_pwr);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        ALOGE("%s: Error creating boost timer thread: %d\n", __func__, rc);
+        close(samsung_pwr->boost_timer_fd);
+        samsung_pwr->boost_timer_fd = -1;
+    }
+}
+
 /*
  * The init function performs power management setup actions at runtime
  * startup, such as to set default cpufreq parameters.  This is called only by
@@ -301,8 +730,17 @@ static void samsung_power_init(struct power_module *module)
 {
     struct samsung_power_module *samsung_pwr = (struct samsung_power_module *) module;
 
+    pthread_mutex_lock(&samsung_pwr->lock);
+
     init_cpufreqs(samsung_pwr);
     init_touch_input_power_path(samsung_pwr);
+    init_boost_timer(samsung_pwr);
+
+    samsung_pwr->boostpulse_interval_ms =
+        property_get_int32(BOOSTPULSE_INTERVAL_PROP, BOOSTPULSE_INTERVAL_MS);
+    ALOGV("%s: boostpulse interval: %d ms\n", __func__, samsung_pwr->boostpulse_interval_ms);
+
+    pthread_mutex_unlock(&samsung_pwr->lock);
 }
 
 /*
@@ -331,13 +769,17 @@ static void samsung_power_init(struct power_module *module)
 static void samsung_power_set_interactive(struct power_module *module, int on)
 {
     struct samsung_power_module *samsung_pwr = (struct samsung_power_module *) module;
-    struct stat sb;
-    char buf[80];
+    struct sysfs_batch batch = { .count = 0 };
     char touchkey_node[2];
-    int rc;
 
     ALOGV("power_set_interactive: %d\n", on);
 
+    pthread_mutex_lock(&samsung_pwr->lock);
+
+    if (!on) {
+        boost_report_stats(samsung_pwr);
+    }
+
     // Get panel backlight brightness from lights HAL
     // Do not disable any input devices if the screen is on but we are in a non-interactive state
     if (!on) {
@@ -348,15 +790,14 @@ static void samsung_power_set_interactive(struct power_module *module, int on)
         }
     }
 
-    sysfs_write(samsung_pwr->touchscreen_power_path, on ? "1" : "0");
+    sysfs_batch_add(&batch, samsung_pwr->touchscreen_power_path, on ? "1" : "0");
 
-    rc = stat(samsung_pwr->touchkey_power_path, &sb);
-    if (rc < 0) {
+    if (samsung_pwr->touchkey_power_path == NULL) {
         goto out;
     }
 
     if (!on) {
-        if (sysfs_read(samsung_pwr->touchkey_power_path, touchkey_node,
+        if (sysfs_read(samsung_pwr, samsung_pwr->touchkey_power_path, touchkey_node,
                        sizeof(touchkey_node)) == 0) {
             /*
              * If touchkey_node is 0, the keys have been disabled by another component
@@ -367,15 +808,18 @@ static void samsung_power_set_interactive(struct power_module *module, int on)
                 samsung_pwr->touchkey_blocked = true;
             } else {
                 samsung_pwr->touchkey_blocked = false;
-                sysfs_write(samsung_pwr->touchkey_power_path, "0");
+                sysfs_batch_add(&batch, samsung_pwr->touchkey_power_path, "0");
             }
         }
     } else if (!samsung_pwr->touchkey_blocked) {
-        sysfs_write(samsung_pwr->touchkey_power_path, "1");
+        sysfs_batch_add(&batch, samsung_pwr->touchkey_power_path, "1");
     }
 
 out:
-    sysfs_write(IO_IS_BUSY_PATH, on ? "1" : "0");
+    sysfs_batch_add(&batch, SYSFS_PATH(IO_IS_BUSY_PATH), on ? "1" : "0");
+    sysfs_batch_commit(samsung_pwr, &batch);
+
+    pthread_mutex_unlock(&samsung_pwr->lock);
     ALOGV("power_set_interactive: %d done\n", on);
 }
 
@@ -427,7 +871,7 @@ static void samsung_power_hint(struct power_module *module,
         case POWER_HINT_INTERACTION: {
             char errno_str[64];
             ssize_t len;
-            int fd;
+            int64_t now;
 
             if (current_power_profile == PROFILE_POWER_SAVE) {
                 return;
@@ -435,20 +879,56 @@ static void samsung_power_hint(struct power_module *module,
 
             ALOGV("%s: POWER_HINT_INTERACTION", __func__);
 
+            pthread_mutex_lock(&samsung_pwr->lock);
+
+            /* touch events arrive far faster than a boost pulse lasts */
+            now = now_ns();
+            if (now - samsung_pwr->boostpulse_last_ns <
+                    (int64_t)samsung_pwr->boostpulse_interval_ms * 1000000LL) {
+                pthread_mutex_unlock(&samsung_pwr->lock);
+                return;
+            }
+
             if (boostpulse_open(samsung_pwr) >= 0) {
                 len = write(samsung_pwr->boostpulse_fd, "1", 1);
 
                 if (len < 0) {
                     strerror_r(errno, errno_str, sizeof(errno_str));
-                    ALOGE("Error writing to %s: %s\n", BOOSTPULSE_PATH, errno_str);
+                    ALOGE("Error writing to %s: %s\n", SYSFS_PATH(BOOSTPULSE_PATH), errno_str);
+                } else {
+                    samsung_pwr->boostpulse_last_ns = now;
                 }
             }
 
+            pthread_mutex_unlock(&samsung_pwr->lock);
             break;
         }
         case POWER_HINT_VSYNC: {
+            bool on = (data != NULL) && (*((int *)data) != 0);
+
+            ALOGV("%s: POWER_HINT_VSYNC %d", __func__, on);
+
+            pthread_mutex_lock(&samsung_pwr->lock);
+            if (on && !samsung_pwr->vsync_boost) {
+                samsung_pwr->boost_stats.vsync_boosts++;
+            }
+            samsung_pwr->vsync_boost = on;
+            boost_update(samsung_pwr);
+            pthread_mutex_unlock(&samsung_pwr->lock);
+            break;
+        }
+        case POWER_HINT_CPU_BOOST: {
+            int duration_us = (int)(intptr_t)data;
+
+            ALOGV("%s: POWER_HINT_CPU_BOOST %d us", __func__, duration_us);
+
+            if (duration_us <= 0) {
+                break;
+            }
 
-            ALOGV("%s: POWER_HINT_VSYNC", __func__);
+            pthread_mutex_lock(&samsung_pwr->lock);
+            boost_cpu(samsung_pwr, duration_us);
+            pthread_mutex_unlock(&samsung_pwr->lock);
             break;
         }
         case POWER_HINT_SET_PROFILE: {
@@ -456,7 +936,9 @@ static void samsung_power_hint(struct power_module *module,
 
             ALOGV("%s: POWER_HINT_SET_PROFILE", __func__);
 
+            pthread_mutex_lock(&samsung_pwr->lock);
             set_power_profile(samsung_pwr, profile);
+            pthread_mutex_unlock(&samsung_pwr->lock);
             break;
         }
         default:
@@ -482,7 +964,9 @@ static void samsung_set_feature(struct power_module *module, feature_t feature,
 #ifdef TARGET_TAP_TO_WAKE_NODE
         case POWER_FEATURE_DOUBLE_TAP_TO_WAKE:
             ALOGV("%s: %s double tap to wake", __func__, state ? "enabling" : "disabling");
-            sysfs_write(TARGET_TAP_TO_WAKE_NODE, state > 0 ? "1" : "0");
+            pthread_mutex_lock(&samsung_pwr->lock);
+            sysfs_write(samsung_pwr, SYSFS_PATH(TARGET_TAP_TO_WAKE_NODE), state > 0 ? "1" : "0");
+            pthread_mutex_unlock(&samsung_pwr->lock);
             break;
 #endif
         default:
@@ -516,4 +1000,6 @@ struct samsung_power_module HAL_MODULE_INFO_SYM = {
     .lock = PTHREAD_MUTEX_INITIALIZER,
     .boostpulse_fd = -1,
     .boostpulse_warned = 0,
+    .boostpulse_interval_ms = BOOSTPULSE_INTERVAL_MS,
+    .boost_timer_fd = -1,
 };
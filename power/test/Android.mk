@@ -0,0 +1,38 @@
+# Copyright (C) 2015 The CyanogenMod Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+LOCAL_PATH := $(call my-dir)
+
+# power.c is built into the test, which fakes the sysfs tree and the
+# lights helper
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+LOCAL_SHARED_LIBRARIES := liblog libcutils
+LOCAL_SRC_FILES := power_test.c
+LOCAL_MODULE := samsung_power_test
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_EXECUTABLE)
+
+# same test for the build host
+include $(CLEAR_VARS)
+
+LOCAL_CFLAGS := -D_GNU_SOURCE
+LOCAL_C_INCLUDES := $(LOCAL_PATH)/../include
+LOCAL_STATIC_LIBRARIES := libcutils liblog
+LOCAL_LDLIBS := -lpthread
+LOCAL_SRC_FILES := power_test.c
+LOCAL_MODULE := samsung_power_test-host
+LOCAL_MODULE_TAGS := optional
+include $(BUILD_HOST_EXECUTABLE)
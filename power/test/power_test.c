@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2015 The CyanogenMod Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * The power HAL against a fake cpufreq tree in a temporary directory:
+ * unchanged values are not written again, whatever newline the kernel
+ * reads back with, and timed CPU_BOOSTs. open() is defined here and sends /sys paths into the
+ * fake tree, truncating on write the way a sysfs store replaces the
+ * value, and so does stat(); pwrite() counts the node writes and cuts the
+ * file after them for the same reason. Every other call goes to the
+ * kernel.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <ftw.h>
+#include <sys/syscall.h>
+
+#include "../power.c"
+
+#ifdef __BIONIC__
+#define TMP_DIR "/data/local/tmp"
+#else
+#define TMP_DIR "/tmp"
+#endif
+
+#define CPU_DIR "/sys/devices/system/cpu/"
+
+static char root[64];
+static int writes;
+static int failures;
+
+#define CHECK(cond)                                                 \
+    do {                                                            \
+        if (!(cond)) {                                              \
+            printf("power_test: %s:%d: %s\n",                       \
+                   __FILE__, __LINE__, #cond);                      \
+            failures++;                                             \
+        }                                                           \
+    } while (0)
+
+int open(const char *path, int flags, ...)
+{
+    char fake[256];
+    va_list ap;
+    int mode;
+
+    va_start(ap, flags);
+    mode = va_arg(ap, int);
+    va_end(ap);
+
+    if (root[0] != '\0' && strncmp(path, "/sys/", 5) == 0) {
+        snprintf(fake, sizeof(fake), "%s%s", root, path);
+        path = fake;
+        if ((flags & O_ACCMODE) != O_RDONLY)
+            flags |= O_TRUNC;
+    }
+
+    return syscall(SYS_openat, AT_FDCWD, path, flags, mode);
+}
+
+int stat(const char *path, struct stat *sb)
+{
+    char fake[256];
+
+    if (root[0] != '\0' && strncmp(path, "/sys/", 5) == 0) {
+        snprintf(fake, sizeof(fake), "%s%s", root, path);
+        path = fake;
+    }
+
+    return fstatat(AT_FDCWD, path, sb, 0);
+}
+
+ssize_t pwrite(int fd, const void *buf, size_t count, off_t offset)
+{
+    ssize_t len;
+
+    writes++;
+
+    len = syscall(SYS_pwrite64, fd, buf, count, offset);
+    if (len >= 0)
+        ftruncate(fd, offset + len);
+
+    return len;
+}
+
+/* the screen is off whenever the test asks */
+int get_cur_panel_brightness(void)
+{
+    return 0;
+}
+
+static void put(const char *path, const char *s)
+{
+    int fd = open(path, O_WRONLY | O_CREAT, 0644);
+
+    if (fd < 0 || write(fd, s, strlen(s)) < 0)
+        printf("power_test: can't write %s\n", path);
+    if (fd >= 0)
+        close(fd);
+}
+
+static int is(const char *path, const char *s)
+{
+    char buf[80];
+    int fd = open(path, O_RDONLY);
+    ssize_t len = -1;
+
+    if (fd >= 0) {
+        len = read(fd, buf, sizeof(buf) - 1);
+        close(fd);
+    }
+    if (len < 0)
+        return 0;
+    buf[len] = '\0';
+
+    return strcmp(buf, s) == 0;
+}
+
+static void make_dirs(const char *path)
+{
+    char dir[256];
+    char *p;
+
+    snprintf(dir, sizeof(dir), "%s%s", root, path);
+    for (p = dir + strlen(root) + 1; *p != '\0'; p++) {
+        if (*p == '/') {
+            *p = '\0';
+            mkdir(dir, 0755);
+            *p = '/';
+        }
+    }
+}
+
+static int remove_node(const char *path, const struct stat *sb, int flag,
+                       struct FTW *ftw)
+{
+    return remove(path);
+}
+
+/* the way the kernel shows them, newline included */
+static void make_tree(void)
+{
+    make_dirs(CPU0_HISPEED_FREQ_PATH);
+    make_dirs(CPU4_HISPEED_FREQ_PATH);
+
+    put(CPU0_HISPEED_FREQ_PATH, "1000000\n");
+    put(CPU0_MAX_FREQ_PATH, "1400000\n");
+    put(CPU0_MIN_FREQ_PATH, "400000\n");
+    put(CPU4_HISPEED_FREQ_PATH, "1200000\n");
+    put(CPU4_MAX_FREQ_PATH, "1900000\n");
+    put(CPU4_MIN_FREQ_PATH, "800000\n");
+    put(BOOSTPULSE_PATH, "");
+    put(IO_IS_BUSY_PATH, "0\n");
+}
+
+int main(int argc, char **argv)
+{
+    struct samsung_power_module *m = &HAL_MODULE_INFO_SYM;
+    intptr_t profile;
+    int on;
+
+    snprintf(root, sizeof(root), "%s/power_test.XXXXXX", TMP_DIR);
+    if (mkdtemp(root) == NULL) {
+        printf("power_test: can't create %s\n", root);
+        return 1;
+    }
+    make_tree();
+
+    m->base.init(&m->base);
+    CHECK(m->cpu4_present);
+
+    /* the max freqs are written back as read at init, once */
+    writes = 0;
+    profile = PROFILE_HIGH_PERFORMANCE;
+    m->base.powerHint(&m->base, POWER_HINT_SET_PROFILE, &profile);
+    CHECK(writes == 2);
+    CHECK(is(CPU0_MAX_FREQ_PATH, "1400000\n"));
+    writes = 0;
+    profile = PROFILE_BALANCED;
+    m->base.powerHint(&m->base, POWER_HINT_SET_PROFILE, &profile);
+    CHECK(writes == 0);
+
+    /* a changed value goes out, and only once */
+    on = 1;
+    m->base.powerHint(&m->base, POWER_HINT_VSYNC, &on);
+    CHECK(writes == 2);
+    CHECK(is(CPU0_MIN_FREQ_PATH, "1000000\n"));
+    CHECK(is(CPU4_MIN_FREQ_PATH, "1200000\n"));
+    on = 0;
+    m->base.powerHint(&m->base, POWER_HINT_VSYNC, &on);
+    CHECK(writes == 4);
+    CHECK(is(CPU0_MIN_FREQ_PATH, "400000\n"));
+    CHECK(is(CPU4_MIN_FREQ_PATH, "800000\n"));
+
+    /* CPU_BOOST passes its duration by value, the timer ends it */
+    m->base.powerHint(&m->base, POWER_HINT_CPU_BOOST, (void *)(intptr_t)100000);
+    CHECK(is(CPU0_MIN_FREQ_PATH, "1000000\n"));
+    usleep(250000);
+    CHECK(is(CPU0_MIN_FREQ_PATH, "400000\n"));
+    CHECK(m->boost_stats.cpu_boosts == 1);
+    CHECK(m->boost_stats.activations == 2);
+
+    /* a node that reads back without the newline still holds the value */
+    put(CPU0_MAX_FREQ_PATH, "1400000");
+    writes = 0;
+    profile = PROFILE_HIGH_PERFORMANCE;
+    m->base.powerHint(&m->base, POWER_HINT_SET_PROFILE, &profile);
+    CHECK(writes == 0);
+
+    /* someone else wrote the node: it is written back */
+    put(CPU0_MAX_FREQ_PATH, "1200000\n");
+    profile = PROFILE_BALANCED;
+    m->base.powerHint(&m->base, POWER_HINT_SET_PROFILE, &profile);
+    CHECK(writes == 1);
+    CHECK(is(CPU0_MAX_FREQ_PATH, "1400000\n"));
+
+    /* io_is_busy reads back with its newline, it is set once */
+    writes = 0;
+    m->base.setInteractive(&m->base, 1);
+    CHECK(writes == 1);
+    writes = 0;
+    m->base.setInteractive(&m->base, 1);
+    CHECK(writes == 0);
+
+    nftw(root, remove_node, 8, FTW_DEPTH | FTW_PHYS);
+
+    printf("power_test: %d failures\n", failures);
+
+    return failures ? 1 : 0;
+}